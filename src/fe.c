@@ -30,12 +30,18 @@
 #include <wchar.h>
 #else
 #include <sys/time.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
 #endif
 #include <limits.h>
+#include <stddef.h>
 #include <string.h>
+#include <sys/stat.h>
 #include "fe.h"
 #include "fex.h"
 #include "fex_internal.h"
+#include "fex_span.h"
 
 #define unused(x)     ( (void) (x) )
 #define car(x)        ( (x)->car.o )
@@ -45,7 +51,7 @@
 #define type(x) \
    ( FE_IS_FIXNUM(x)              ? FE_TNUMBER :          \
      FE_IS_BOOLEAN(x)             ? FE_TBOOLEAN :         \
-     ((tag(x) & 1)                ? tag(x) >> 2 : FE_TPAIR) )
+     ((tag(x) & 1)                ? ((tag(x) >> 2) & 0x1F) : FE_TPAIR) )
 #define settype(x,t)  ( tag(x) = (t) << 2 | 1 )
 #define number(x)     ( (x)->cdr.n )
 #define prim(x)       ( (x)->cdr.c )
@@ -53,6 +59,11 @@
 #define nval(o)       fe_num_value(o)
 
 #define GCMARKBIT     ( 0x2 )
+/* Set on a symbol the first time it is used as a local binding key (fn/mac
+   parameter or local let).  Symbols without it resolve straight to their
+   global cell in getbound(), skipping the environment walk; the bit is
+   sticky, so a symbol that is ever shadowed always takes the full search. */
+#define SYMSHADOWBIT  ( 0x80 )
 #define GCSTACKSIZE   ( 1024 )
 
 /* --- Recursion depth defaults --- */
@@ -63,8 +74,13 @@
 #define GC_GROWTH_FACTOR 2
 #define GC_INITIAL_DIVISOR 4
 #define GC_MIN_THRESHOLD 1024
+#define GC_SWEEP_SLICE 64   /* arena slots swept per allocation (incremental) */
 #define FE_IO_ABORT_CHECK_INTERVAL 64u
 
+/* Sources at least this large are memory-mapped instead of copied through
+   stdio; smaller files are not worth a mapping of their own. */
+#define FE_MMAP_SOURCE_MIN (64u * 1024u)
+
 
 #ifdef FE_OPT_NO_MALLOC_STRINGS
 /* --- String Slab Allocator Constants --- */
@@ -100,19 +116,37 @@ static const char *primnames[] = {
 
 static const char *typenames[] = {
   "pair", "free", "nil", "number", "symbol", "string", "bytes",
-  "func", "macro", "prim", "cfunc", "ptr", "map",
+  "func", "macro", "prim", "cfunc", "ptr", "map", "array",
   "boolean"
 };
 
+/* Robin-hood open addressing with cached hashes. A slot is empty when its
+   `keys` entry is NULL; deletion backward-shifts the following cluster, so
+   there are no tombstones. Growth is incremental: the previous arrays are
+   kept as a draining "old" table and a bounded number of entries migrate
+   per map operation, so no single set pays a full rehash. Migrated old
+   slots keep their key and hash and only NULL the value ("ghosts"), which
+   preserves the old table's probe chains for keys that have not moved. */
 typedef struct {
-  int count;
-  int used;
-  int capacity;
-  fe_Object **keys;
+  int count;               /* live entries across both tables */
+  int capacity;            /* active table size; always a power of two */
+  fe_Object **keys;        /* NULL = empty slot */
   fe_Object **values;
-  unsigned char *states;
+  unsigned long *hashes;   /* cached full hash per occupied slot */
+  fe_Object **old_keys;    /* draining table from the last growth, or NULL */
+  fe_Object **old_values;
+  unsigned long *old_hashes;
+  int old_capacity;
+  int old_cursor;          /* next old slot the migration visits */
+  int old_count;           /* entries not yet migrated out or deleted */
 } fe_Map;
 
+typedef struct {
+  int count;
+  int capacity;
+  fe_Object **items;
+} fe_Array;
+
 typedef union {
   size_t size;
   void *ptr;
@@ -122,17 +156,88 @@ typedef union {
 
 typedef union { fe_Object *o; fe_CFunc f; fe_Number n; char c; char *s; void *p; uint32_t u32; } Value;
 
+/* Active bytecode run frames; see "Bytecode fast path" below. */
+typedef struct fe_CodeRun fe_CodeRun;
+
+/* Extra object chunks added on demand when the growable arena mode is
+   enabled; the embedded fe_open() arena stays the first region. */
+typedef struct fe_ObjectChunk fe_ObjectChunk;
+struct fe_ObjectChunk {
+  fe_Object *objects;
+  int count;
+  fe_ObjectChunk *next;
+};
+
+/* Read-only file mappings backing large scripts and imported modules;
+   kept mapped until fe_close() so span excerpts and per-thread contexts
+   can share the pages instead of each holding a heap copy. */
+typedef struct fe_MappedSource fe_MappedSource;
+struct fe_MappedSource {
+  void *addr;
+  size_t len;
+  fe_MappedSource *next;
+};
+
 struct fe_Object {
   Value car, cdr;
   uint8_t flags;                 /* holds GC-mark + type tag   */
 };
 
+#define FE_PROFILE_BUCKETS   256
+#define FE_PROFILE_MAX_DEPTH 1024
+
+/* One aggregated profiler row; see fe_profile_start(). Rows are keyed by
+   the interned callee symbol (stable for the context's lifetime), or by
+   the call-form pair for anonymous callees. */
+typedef struct fe_ProfileEntry {
+  fe_Object *key;
+  size_t calls;
+  uint64_t incl_us, excl_us;
+  size_t incl_steps, excl_steps;
+  struct fe_ProfileEntry *next;
+} fe_ProfileEntry;
+
+/* A call currently being timed; lives on ctx->profile_stack. child_us and
+   child_steps accumulate the inclusive cost of nested profiled calls so
+   the exclusive cost can be derived when the frame closes. */
+typedef struct {
+  fe_Object *key;
+  uint64_t start_us;
+  size_t start_steps;
+  uint64_t child_us;
+  size_t child_steps;
+} fe_ProfileFrame;
+
+/* One compile-cache slot: a byte-identical (source, source name) pair maps
+   straight to its compiled tree, which the GC marks as a root while the
+   entry lives.  Entries are kept most-recently-used first. */
+typedef struct {
+  char *source;        /* owned copy of the source text */
+  size_t source_len;
+  char *source_name;   /* owned; part of the key, since spans record it */
+  unsigned long hash;
+  fe_Object *code;
+} fe_CompileCacheEntry;
+
+/* One import-resolution slot: a (importing directory, module lookup name)
+   pair maps to the canonical path the search produced, so a spec that was
+   resolved once skips the per-candidate filesystem probes entirely. */
+typedef struct {
+  char *dir;       /* owned; top source dir at resolution time ("" at top level) */
+  char *name;      /* owned module lookup name ("pkg/mod") */
+  char *resolved;  /* owned canonical path */
+  unsigned long hash;
+} fe_ModuleResolution;
+
 struct fe_Context {
   fe_Handlers handlers;
   fe_Object *gcstack[GCSTACKSIZE];
   int gcstack_idx;
   fe_Object *objects;
   int object_count;
+  fe_ObjectChunk *chunks;  /* Growable arena: extra regions, newest first */
+  int chunk_object_count;  /* Total slots across all extra chunks */
+  int arena_growable;      /* Allocate chunks on demand instead of failing */
   fe_Object *calllist;
   fe_Object *freelist;
   fe_Object *modulestack;
@@ -142,12 +247,14 @@ struct fe_Context {
   char **import_paths;
   int import_path_count;
   int import_path_capacity;
+  int module_cache_enabled; /* Load `<path>c` precompiled caches when valid */
   char **source_dirs;
   int source_dir_count;
   int source_dir_capacity;
   char **source_buffers;
   int source_buffer_count;
   int source_buffer_capacity;
+  fe_MappedSource *mapped_sources;
   char **loading_modules;
   int loading_module_count;
   int loading_module_capacity;
@@ -156,6 +263,14 @@ struct fe_Context {
   fe_Object **loaded_module_values;
   int loaded_module_count;
   int loaded_module_value_capacity;
+  int *loaded_module_index;    /* open-addressed: slot -> array index + 1, 0 = empty */
+  int loaded_module_index_capacity;
+  fe_ModuleResolution *module_resolutions; /* (dir, spec) -> canonical path */
+  int module_resolution_count;
+  int module_resolution_capacity;
+  fe_CompileCacheEntry *compile_cache_entries; /* fex_do_string source → tree */
+  int compile_cache_count;
+  int compile_cache_limit;  /* Max entries; 0 = compile caching disabled */
   size_t step_limit;
   size_t steps_executed;
   uint64_t timeout_ms;
@@ -177,6 +292,18 @@ struct fe_Context {
   size_t bytes_since_gc;   /* String bytes allocated since last GC */
   size_t byte_threshold;   /* Trigger next GC when bytes_since_gc exceeds this */
   size_t gc_runs;
+  int gc_mode;             /* FE_GC_FULL or FE_GC_INCREMENTAL */
+  int gc_sweep_active;     /* A deferred sweep is in progress */
+  int gc_sweep_cursor;     /* Next slot the deferred sweep visits */
+  fe_ObjectChunk *gc_sweep_chunk; /* Region being swept; NULL = embedded arena */
+  int gc_sweep_live;       /* Survivors counted by the deferred sweep */
+  uint64_t gc_pause_us_last;
+  uint64_t gc_pause_us_max;
+  int gc_threshold_fixed;  /* Non-zero: user-pinned allocation trigger */
+  int gc_defer_depth;      /* >0: threshold-triggered collection suspended */
+  size_t gc_reclaimed_last;   /* Objects reclaimed by the last completed cycle */
+  size_t gc_reclaimed_total;
+  size_t gc_sweep_reclaimed;  /* Running reclaim count of the deferred sweep */
   size_t object_allocations_total;
   size_t base_memory_bytes;
   size_t memory_limit;
@@ -196,6 +323,28 @@ struct fe_Context {
   void *span_state;
   /* Per-context scratch temp allocations owned by fex.c */
   void *temp_allocs;
+  /* Per-context open file handles owned by fex_builtins.c */
+  void *file_state;
+  /* Per-context string builders owned by fex_builtins.c */
+  void *builder_state;
+  /* Per-context async child processes owned by fex_builtins.c */
+  void *process_state;
+  /* Bytecode runs currently executing (frames live on the C stack) */
+  fe_CodeRun *code_runs;
+  /* Resumable evaluation cursor (fe_eval_begin/fe_eval_resume); NULL when
+     no staged program is pending */
+  fe_Object *resume_forms;
+  fe_Object *resume_result;
+  /* --- Profiler fields (fe_profile_start/stop/report) --- */
+  int profiling;
+  int profile_depth;
+  fe_ProfileFrame *profile_stack;
+  fe_ProfileEntry **profile_buckets;
+  /* Hash index over interned symbols; symlist stays the GC root */
+  fe_Object **symtab;
+  int symtab_capacity;
+  int symtab_count;
+  int symlist_len;
 #ifdef FE_OPT_NO_MALLOC_STRINGS
   uint8_t *str_base;
   uint8_t *str_end;
@@ -207,16 +356,18 @@ static fe_Object nil = {{ NULL }, { NULL }, (FE_TNIL << 2 | 1)};
 
 /* Special symbols are now stored per-context in fe_Context. */
 
-#define MAP_EMPTY 0
-#define MAP_USED 1
-#define MAP_TOMBSTONE 2
 #define TIMEOUT_CHECK_INTERVAL 64
 
 static fe_Map* mapdata(fe_Object *obj);
 static fe_Object* normalize_map_key(fe_Context *ctx, fe_Object *key);
-static int map_find_slot(fe_Context *ctx, fe_Map *map, fe_Object *key, int *found);
+static int map_iter_next(fe_Map *map, int *pos, fe_Object **out_key,
+                         fe_Object **out_value);
 static fe_Object* object(fe_Context *ctx);
 static void tracked_free(fe_Context *ctx, void *ptr);
+static void code_abandon_runs(fe_Context *ctx);
+static void code_mark_runs(fe_Context *ctx);
+static void gc_sweep_step(fe_Context *ctx, int max_slots);
+static void collectgarbage(fe_Context *ctx);
 
 static int memory_would_exceed_limit(fe_Context *ctx, size_t extra) {
   if (ctx->memory_limit == 0) {
@@ -353,6 +504,10 @@ static fe_Map* mapdata(fe_Object *obj) {
   return (fe_Map*)obj->cdr.p;
 }
 
+static fe_Array* arraydata(fe_Object *obj) {
+  return (fe_Array*)obj->cdr.p;
+}
+
 static void analyze(fe_Context *ctx, fe_Object *node, fe_Object *bound, fe_Object **free_vars) {
   /* Base case: atom. If it's a symbol not in our bound list, it's free. */
   if (type(node) != FE_TPAIR) {
@@ -451,6 +606,30 @@ void fe_ctx_set_span_state(fe_Context *ctx, void *state) {
   ctx->span_state = state;
 }
 
+void *fe_ctx_file_state(fe_Context *ctx) {
+  return ctx->file_state;
+}
+
+void fe_ctx_set_file_state(fe_Context *ctx, void *state) {
+  ctx->file_state = state;
+}
+
+void *fe_ctx_builder_state(fe_Context *ctx) {
+  return ctx->builder_state;
+}
+
+void fe_ctx_set_builder_state(fe_Context *ctx, void *state) {
+  ctx->builder_state = state;
+}
+
+void *fe_ctx_process_state(fe_Context *ctx) {
+  return ctx->process_state;
+}
+
+void fe_ctx_set_process_state(fe_Context *ctx, void *state) {
+  ctx->process_state = state;
+}
+
 void *fe_ctx_temp_allocs(fe_Context *ctx) {
   return ctx->temp_allocs;
 }
@@ -475,17 +654,86 @@ void fe_ctx_memory_error(fe_Context *ctx, const char *fallback_msg) {
   memory_error(ctx, fallback_msg);
 }
 
+static void map_free_payload(fe_Context *ctx, fe_Map *map) {
+  tracked_free(ctx, map->keys);
+  tracked_free(ctx, map->values);
+  tracked_free(ctx, map->hashes);
+  tracked_free(ctx, map->old_keys);
+  tracked_free(ctx, map->old_values);
+  tracked_free(ctx, map->old_hashes);
+  tracked_free(ctx, map);
+}
+
+/* Frees a map object's tracked payload ahead of the GC sweep. Used by the
+   compiler for scratch maps whose accounting must be released the moment
+   the compile scope exits; the emptied object sweeps as a no-op later. */
+void fe_ctx_map_release(fe_Context *ctx, fe_Object *map_obj) {
+  fe_Map *map;
+  if (!map_obj || type(map_obj) != FE_TMAP) { return; }
+  map = mapdata(map_obj);
+  if (!map) { return; }
+  map_free_payload(ctx, map);
+  map_obj->cdr.p = NULL;
+}
+
+/* Whether `obj` points into the object arena: the embedded fe_open()
+   region (the common case, checked first) or any on-demand chunk. */
+static int arena_contains(fe_Context *ctx, const fe_Object *obj) {
+  fe_ObjectChunk *chunk;
+  if (obj >= ctx->objects && obj < ctx->objects + ctx->object_count) {
+    return 1;
+  }
+  for (chunk = ctx->chunks; chunk; chunk = chunk->next) {
+    if (obj >= chunk->objects && obj < chunk->objects + chunk->count) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
 int fe_ctx_object_is_live(fe_Context *ctx, const fe_Object *obj) {
   if (!obj || FE_IS_FIXNUM(obj) || FE_IS_BOOLEAN(obj) || obj == &nil) {
     return 0;
   }
-  if (obj < ctx->objects || obj >= ctx->objects + ctx->object_count) {
+  if (!arena_contains(ctx, obj)) {
     return 0;
   }
   return type((fe_Object*)obj) != FE_TFREE;
 }
 
 
+/* -------------------------------------------------------------------------
+ * Bytes slice views
+ *
+ * A FE_TBYTES object normally stores its length as a fixnum in the car and
+ * its data (slab chain or malloc buffer) in the cdr.  A slice view instead
+ * stores the owning bytes object in the car - distinguishable because an
+ * object pointer never has the fixnum tag bit - and an (offset . length)
+ * fixnum pair in the cdr.  Slicing is O(1) and copies no data; views always
+ * reference a non-view owner, so chains never form.  All data access goes
+ * through bytes_resolve(), the GC marks the owner through the view's car,
+ * and the sweep frees no storage for views.
+ * ---------------------------------------------------------------------- */
+
+static int bytes_is_view(fe_Object *obj) {
+  /* only meaningful for FE_TBYTES objects */
+  return !FE_IS_FIXNUM(car(obj));
+}
+
+/* Resolves a bytes object to the object owning its storage; *base receives
+   the view's offset into the owner (0 for plain bytes) and *len the
+   addressable length. */
+static fe_Object* bytes_resolve(fe_Object *obj, size_t *base, size_t *len) {
+  if (bytes_is_view(obj)) {
+    *base = (size_t)FE_UNBOX_FIXNUM(car(cdr(obj)));
+    *len = (size_t)FE_UNBOX_FIXNUM(cdr(cdr(obj)));
+    return car(obj);
+  }
+  *base = 0;
+  *len = (size_t)FE_STR_LEN(obj);
+  return obj;
+}
+
 static uint64_t current_time_ms(void) {
 #ifdef _WIN32
   return (uint64_t)GetTickCount64();
@@ -496,6 +744,224 @@ static uint64_t current_time_ms(void) {
 #endif
 }
 
+/* Microsecond clock for GC pause measurement; pauses are far shorter than
+   the millisecond granularity of current_time_ms(). */
+static uint64_t current_time_us(void) {
+#ifdef _WIN32
+  return (uint64_t)GetTickCount64() * 1000u;
+#else
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return (uint64_t)tv.tv_sec * 1000000u + (uint64_t)tv.tv_usec;
+#endif
+}
+
+
+/*
+ * Call-counting profiler. While active, eval() brackets every FE_TFUNC and
+ * FE_TCFUNC call with profile_enter()/profile_leave(); rows aggregate call
+ * counts plus inclusive/exclusive wall time and step counts per callee.
+ */
+
+static unsigned profile_bucket(fe_Object *key) {
+  return (unsigned)(((uintptr_t)key >> 4) % FE_PROFILE_BUCKETS);
+}
+
+static fe_ProfileEntry* profile_entry(fe_Context *ctx, fe_Object *key) {
+  unsigned bucket = profile_bucket(key);
+  fe_ProfileEntry *entry;
+
+  for (entry = ctx->profile_buckets[bucket]; entry; entry = entry->next) {
+    if (entry->key == key) { return entry; }
+  }
+  entry = tracked_alloc(ctx, sizeof(*entry));
+  if (!entry) { return NULL; }  /* never raise from inside the profiler */
+  memset(entry, 0, sizeof(*entry));
+  entry->key = key;
+  entry->next = ctx->profile_buckets[bucket];
+  ctx->profile_buckets[bucket] = entry;
+  return entry;
+}
+
+static void profile_enter(fe_Context *ctx, fe_Object *key) {
+  fe_ProfileFrame *frame;
+
+  if (ctx->profile_depth >= FE_PROFILE_MAX_DEPTH) {
+    /* Keep depth balanced with profile_leave(), but record nothing. */
+    ctx->profile_depth++;
+    return;
+  }
+  frame = &ctx->profile_stack[ctx->profile_depth++];
+  frame->key = key;
+  frame->start_us = current_time_us();
+  frame->start_steps = ctx->steps_executed;
+  frame->child_us = 0;
+  frame->child_steps = 0;
+}
+
+static void profile_leave(fe_Context *ctx) {
+  fe_ProfileFrame *frame;
+  fe_ProfileEntry *entry;
+  uint64_t incl_us, excl_us;
+  size_t incl_steps, excl_steps;
+
+  if (ctx->profile_depth <= 0) { return; }
+  ctx->profile_depth--;
+  if (ctx->profile_depth >= FE_PROFILE_MAX_DEPTH) { return; }
+
+  frame = &ctx->profile_stack[ctx->profile_depth];
+  incl_us = current_time_us() - frame->start_us;
+  incl_steps = ctx->steps_executed - frame->start_steps;
+  excl_us = incl_us > frame->child_us ? incl_us - frame->child_us : 0;
+  excl_steps = incl_steps > frame->child_steps
+      ? incl_steps - frame->child_steps : 0;
+
+  entry = profile_entry(ctx, frame->key);
+  if (entry) {
+    entry->calls++;
+    entry->incl_us += incl_us;
+    entry->excl_us += excl_us;
+    entry->incl_steps += incl_steps;
+    entry->excl_steps += excl_steps;
+  }
+  if (ctx->profile_depth > 0) {
+    fe_ProfileFrame *parent = &ctx->profile_stack[ctx->profile_depth - 1];
+    parent->child_us += incl_us;
+    parent->child_steps += incl_steps;
+  }
+}
+
+/* Rows and in-flight frames key on heap objects (interned symbols stay
+   alive through symlist, but anonymous call-form pairs have no other
+   root). Marking them keeps a collected callee's slot from being recycled
+   into another callee, which would silently merge two rows and let
+   fe_profile_report() print the wrong label. Called from collectgarbage()
+   while the row table exists - the report may run after fe_profile_stop(). */
+static void profile_mark_keys(fe_Context *ctx) {
+  int i, depth;
+  if (ctx->profile_buckets == NULL) { return; }
+  for (i = 0; i < FE_PROFILE_BUCKETS; i++) {
+    fe_ProfileEntry *entry;
+    for (entry = ctx->profile_buckets[i]; entry; entry = entry->next) {
+      fe_mark(ctx, entry->key);
+    }
+  }
+  depth = ctx->profile_depth < FE_PROFILE_MAX_DEPTH
+      ? ctx->profile_depth : FE_PROFILE_MAX_DEPTH;
+  for (i = 0; i < depth; i++) {
+    fe_mark(ctx, ctx->profile_stack[i].key);
+  }
+}
+
+static void profile_clear(fe_Context *ctx) {
+  int i;
+  if (ctx->profile_buckets) {
+    for (i = 0; i < FE_PROFILE_BUCKETS; i++) {
+      while (ctx->profile_buckets[i]) {
+        fe_ProfileEntry *entry = ctx->profile_buckets[i];
+        ctx->profile_buckets[i] = entry->next;
+        tracked_free(ctx, entry);
+      }
+    }
+    tracked_free(ctx, ctx->profile_buckets);
+    ctx->profile_buckets = NULL;
+  }
+  tracked_free(ctx, ctx->profile_stack);
+  ctx->profile_stack = NULL;
+  ctx->profile_depth = 0;
+  ctx->profiling = 0;
+}
+
+void fe_profile_start(fe_Context *ctx) {
+  profile_clear(ctx);
+  ctx->profile_stack =
+      tracked_alloc(ctx, FE_PROFILE_MAX_DEPTH * sizeof(fe_ProfileFrame));
+  ctx->profile_buckets =
+      tracked_alloc(ctx, FE_PROFILE_BUCKETS * sizeof(fe_ProfileEntry*));
+  if (!ctx->profile_stack || !ctx->profile_buckets) {
+    profile_clear(ctx);
+    fe_error(ctx, "out of memory (profiler)");
+  }
+  memset(ctx->profile_buckets, 0,
+      FE_PROFILE_BUCKETS * sizeof(fe_ProfileEntry*));
+  ctx->profiling = 1;
+}
+
+void fe_profile_stop(fe_Context *ctx) {
+  ctx->profiling = 0;
+  ctx->profile_depth = 0;
+}
+
+/* Resolves a profiler row key to a printable label. Symbol keys print
+   their name; anonymous call forms fall back to the recorded source span
+   when spans are enabled. */
+static void profile_entry_label(fe_Context *ctx, fe_Object *key,
+                                char *buf, size_t size) {
+  if (type(key) == FE_TSYMBOL) {
+    fe_tostring(ctx, key, buf, (int)size);
+    return;
+  }
+  {
+    const FexSpan *span = fex_lookup_span(ctx, key);
+    if (span && span->source_name) {
+      snprintf(buf, size, "<fn@%s:%d>", span->source_name, span->start_line);
+      return;
+    }
+  }
+  snprintf(buf, size, "<anonymous fn>");
+}
+
+static int profile_compare_excl_us(const void *a, const void *b) {
+  const fe_ProfileEntry *ea = *(const fe_ProfileEntry* const*)a;
+  const fe_ProfileEntry *eb = *(const fe_ProfileEntry* const*)b;
+  if (ea->excl_us != eb->excl_us) { return ea->excl_us < eb->excl_us ? 1 : -1; }
+  if (ea->calls != eb->calls) { return ea->calls < eb->calls ? 1 : -1; }
+  return 0;
+}
+
+void fe_profile_report(fe_Context *ctx, FILE *fp) {
+  fe_ProfileEntry **rows;
+  size_t count = 0, i;
+  int bucket;
+
+  if (!ctx->profile_buckets) { return; }
+  for (bucket = 0; bucket < FE_PROFILE_BUCKETS; bucket++) {
+    fe_ProfileEntry *entry;
+    for (entry = ctx->profile_buckets[bucket]; entry; entry = entry->next) {
+      count++;
+    }
+  }
+  if (count == 0) {
+    fprintf(fp, "profile: no calls recorded\n");
+    return;
+  }
+  rows = tracked_alloc(ctx, count * sizeof(*rows));
+  if (!rows) { return; }
+  i = 0;
+  for (bucket = 0; bucket < FE_PROFILE_BUCKETS; bucket++) {
+    fe_ProfileEntry *entry;
+    for (entry = ctx->profile_buckets[bucket]; entry; entry = entry->next) {
+      rows[i++] = entry;
+    }
+  }
+  qsort(rows, count, sizeof(*rows), profile_compare_excl_us);
+
+  fprintf(fp, "%-32s %10s %12s %12s %14s %14s\n",
+      "function", "calls", "excl ms", "incl ms", "excl steps", "incl steps");
+  for (i = 0; i < count; i++) {
+    char label[64];
+    profile_entry_label(ctx, rows[i]->key, label, sizeof(label));
+    fprintf(fp, "%-32s %10lu %12.3f %12.3f %14lu %14lu\n",
+        label,
+        (unsigned long)rows[i]->calls,
+        (double)rows[i]->excl_us / 1000.0,
+        (double)rows[i]->incl_us / 1000.0,
+        (unsigned long)rows[i]->excl_steps,
+        (unsigned long)rows[i]->incl_steps);
+  }
+  tracked_free(ctx, rows);
+}
+
 
 void fe_set_step_limit(fe_Context *ctx, size_t max_steps) {
   ctx->step_limit = max_steps;
@@ -542,11 +1008,15 @@ void fe_get_stats(fe_Context *ctx, fe_Stats *out_stats) {
   out_stats->memory_used = ctx->memory_used;
   out_stats->peak_memory_used = ctx->peak_memory_used;
   out_stats->base_memory_bytes = ctx->base_memory_bytes;
-  out_stats->object_capacity = (size_t)ctx->object_count;
+  out_stats->object_capacity = (size_t)ctx->object_count + (size_t)ctx->chunk_object_count;
   out_stats->live_objects = (size_t)((ctx->live_count > 0) ? ctx->live_count : 0);
   out_stats->object_allocations_total = ctx->object_allocations_total;
   out_stats->allocs_since_gc = (size_t)((ctx->allocs_since_gc > 0) ? ctx->allocs_since_gc : 0);
   out_stats->gc_runs = ctx->gc_runs;
+  out_stats->gc_pause_us_last = (size_t)ctx->gc_pause_us_last;
+  out_stats->gc_pause_us_max = (size_t)ctx->gc_pause_us_max;
+  out_stats->gc_reclaimed_last = ctx->gc_reclaimed_last;
+  out_stats->gc_reclaimed_total = ctx->gc_reclaimed_total;
 }
 
 
@@ -567,6 +1037,89 @@ uint64_t fe_get_timeout_ms(fe_Context *ctx) {
 }
 
 
+void fe_set_gc_mode(fe_Context *ctx, int mode) {
+  if (mode != FE_GC_INCREMENTAL) { mode = FE_GC_FULL; }
+  if (mode == FE_GC_FULL && ctx->gc_sweep_active) {
+    /* Leaving incremental mode: finish the deferred sweep so full
+       collections start from a clean arena. */
+    gc_sweep_step(ctx, INT_MAX);
+  }
+  ctx->gc_mode = mode;
+}
+
+
+int fe_get_gc_mode(fe_Context *ctx) {
+  return ctx->gc_mode;
+}
+
+
+void fe_set_gc_threshold(fe_Context *ctx, size_t allocs) {
+  if (allocs == 0) {
+    /* Back to the adaptive policy, re-derived from the current live set. */
+    ctx->gc_threshold_fixed = 0;
+    ctx->gc_threshold = ctx->live_count * GC_GROWTH_FACTOR;
+    if (ctx->gc_threshold < GC_MIN_THRESHOLD) {
+      ctx->gc_threshold = GC_MIN_THRESHOLD;
+    }
+    return;
+  }
+  if (allocs > (size_t)INT_MAX) { allocs = (size_t)INT_MAX; }
+  ctx->gc_threshold_fixed = (int)allocs;
+  ctx->gc_threshold = (int)allocs;
+}
+
+
+size_t fe_get_gc_threshold(fe_Context *ctx) {
+  return (size_t)ctx->gc_threshold;
+}
+
+
+void fe_set_gc_byte_threshold(fe_Context *ctx, size_t bytes) {
+  if (bytes == 0) {
+    /* Restore the fe_open() default: a third of the embedded arena. */
+    bytes = (size_t)ctx->object_count * sizeof(fe_Object) / 3;
+  }
+  ctx->byte_threshold = bytes;
+}
+
+
+size_t fe_get_gc_byte_threshold(fe_Context *ctx) {
+  return ctx->byte_threshold;
+}
+
+
+void fe_gc(fe_Context *ctx) {
+  collectgarbage(ctx);
+}
+
+
+void fe_gc_defer(fe_Context *ctx) {
+  ctx->gc_defer_depth++;
+}
+
+
+void fe_gc_undefer(fe_Context *ctx) {
+  if (ctx->gc_defer_depth > 0) { ctx->gc_defer_depth--; }
+}
+
+
+int fe_gc_deferred(fe_Context *ctx) {
+  return ctx->gc_defer_depth > 0;
+}
+
+
+void fe_set_arena_growable(fe_Context *ctx, int enabled) {
+  /* Disabling only stops further growth; chunks already added stay in
+     place since live objects may reside in them. */
+  ctx->arena_growable = (enabled != 0);
+}
+
+
+int fe_get_arena_growable(fe_Context *ctx) {
+  return ctx->arena_growable;
+}
+
+
 void fe_set_interrupt_handler(fe_Context *ctx, fe_InterruptFn fn,
                               void *udata, size_t check_interval_steps) {
   ctx->interrupt_handler = fn;
@@ -802,15 +1355,58 @@ static int ensure_object_array_capacity(fe_Context *ctx, fe_Object ***items,
   return 1;
 }
 
-static int module_cache_find_index(fe_Context *ctx, const char *path) {
+static unsigned long hash_cstring(const char *str);
+
+#define MODULE_INDEX_MIN_CAPACITY 16
+
+/* The loaded-module arrays are looked up by canonical path on every
+   import, so they carry an open-addressed index alongside (same scheme
+   as the symbol table: power-of-two capacity, linear probing, rebuilt
+   on growth).  Slots store array index + 1 so zeroed memory is empty. */
+static void module_index_insert(fe_Context *ctx, int array_index) {
+  unsigned long mask = (unsigned long)ctx->loaded_module_index_capacity - 1;
+  unsigned long i = hash_cstring(ctx->loaded_modules[array_index]) & mask;
+  while (ctx->loaded_module_index[i] != 0) { i = (i + 1) & mask; }
+  ctx->loaded_module_index[i] = array_index + 1;
+}
+
+/* Ensures the index can hold `needed` entries below 3/4 load, rehashing
+   every loaded module into the grown table.  Returns 0 on OOM. */
+static int module_index_reserve(fe_Context *ctx, int needed) {
+  int new_capacity;
+  int *grown;
   int i;
-  size_t poll_countdown = FE_IO_ABORT_CHECK_INTERVAL;
+
+  if (ctx->loaded_module_index != NULL &&
+      needed <= (ctx->loaded_module_index_capacity / 4) * 3) {
+    return 1;
+  }
+  new_capacity = ctx->loaded_module_index_capacity
+      ? ctx->loaded_module_index_capacity * 2 : MODULE_INDEX_MIN_CAPACITY;
+  while (needed > (new_capacity / 4) * 3) {
+    new_capacity *= 2;
+  }
+  grown = tracked_alloc(ctx, sizeof(int) * (size_t)new_capacity);
+  if (!grown) return 0;
+  memset(grown, 0, sizeof(int) * (size_t)new_capacity);
+  tracked_free(ctx, ctx->loaded_module_index);
+  ctx->loaded_module_index = grown;
+  ctx->loaded_module_index_capacity = new_capacity;
   for (i = 0; i < ctx->loaded_module_count; i++) {
-    const char *abort_msg = poll_io_abort(ctx, &poll_countdown);
-    if (abort_msg != NULL) {
-      fe_error(ctx, abort_msg);
-    }
-    if (strcmp(ctx->loaded_modules[i], path) == 0) return i;
+    module_index_insert(ctx, i);
+  }
+  return 1;
+}
+
+static int module_cache_find_index(fe_Context *ctx, const char *path) {
+  unsigned long mask, i;
+  if (ctx->loaded_module_index == NULL) return -1;
+  mask = (unsigned long)ctx->loaded_module_index_capacity - 1;
+  i = hash_cstring(path) & mask;
+  while (ctx->loaded_module_index[i] != 0) {
+    int index = ctx->loaded_module_index[i] - 1;
+    if (strcmp(ctx->loaded_modules[index], path) == 0) return index;
+    i = (i + 1) & mask;
   }
   return -1;
 }
@@ -831,9 +1427,13 @@ static int module_cache_push_owned(fe_Context *ctx, char *path, fe_Object *value
                                     &ctx->loaded_module_value_capacity, needed)) {
     return 0;
   }
+  if (!module_index_reserve(ctx, needed)) {
+    return 0;
+  }
   ctx->loaded_modules[ctx->loaded_module_count] = path;
   ctx->loaded_module_values[ctx->loaded_module_count] = value;
   ctx->loaded_module_count++;
+  module_index_insert(ctx, ctx->loaded_module_count - 1);
   return 1;
 }
 
@@ -843,6 +1443,9 @@ static void module_cache_clear(fe_Context *ctx) {
   tracked_free(ctx, ctx->loaded_module_values);
   ctx->loaded_module_values = NULL;
   ctx->loaded_module_value_capacity = 0;
+  tracked_free(ctx, ctx->loaded_module_index);
+  ctx->loaded_module_index = NULL;
+  ctx->loaded_module_index_capacity = 0;
 }
 
 static int is_path_separator(char chr) {
@@ -1239,6 +1842,105 @@ static char* read_text_file(fe_Context *ctx, const char *path) {
   return buffer;
 }
 
+/* Map a large source file read-only instead of copying it through stdio.
+   The lexer needs NUL-terminated input, so a file whose size is an exact
+   multiple of the page size is declined (the zero fill between EOF and the
+   end of the last page is what terminates the mapping); callers fall back
+   to read_text_file() on any NULL return.  Mappings are kept until
+   fe_close() — span excerpts may point into them, and the pages are
+   shared between contexts mapping the same file. */
+static const char* map_text_file(fe_Context *ctx, const char *path,
+                                 size_t *out_len) {
+  fe_MappedSource *node;
+  void *addr;
+  size_t len, page_size;
+#ifdef _WIN32
+  SYSTEM_INFO info;
+  HANDLE file, mapping;
+  LARGE_INTEGER file_size;
+  wchar_t *wide_path;
+
+  wide_path = utf8_to_wide_tracked(ctx, path);
+  if (!wide_path) return NULL;
+  file = CreateFileW(wide_path, GENERIC_READ, FILE_SHARE_READ, NULL,
+                     OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+  tracked_free(ctx, wide_path);
+  if (file == INVALID_HANDLE_VALUE) return NULL;
+  if (!GetFileSizeEx(file, &file_size) ||
+      (ULONGLONG)file_size.QuadPart > (SIZE_MAX / 2)) {
+    CloseHandle(file);
+    return NULL;
+  }
+  len = (size_t)file_size.QuadPart;
+  GetSystemInfo(&info);
+  page_size = info.dwPageSize;
+  if (len < FE_MMAP_SOURCE_MIN || len % page_size == 0) {
+    CloseHandle(file);
+    return NULL;
+  }
+  mapping = CreateFileMappingW(file, NULL, PAGE_READONLY, 0, 0, NULL);
+  CloseHandle(file);
+  if (!mapping) return NULL;
+  addr = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  CloseHandle(mapping);
+  if (!addr) return NULL;
+#else
+  struct stat st;
+  long page_query;
+  int fd;
+
+  fd = open(path, O_RDONLY);
+  if (fd < 0) return NULL;
+  if (fstat(fd, &st) != 0 || st.st_size < 0 ||
+      (uintmax_t)st.st_size > (SIZE_MAX / 2)) {
+    close(fd);
+    return NULL;
+  }
+  len = (size_t)st.st_size;
+  page_query = sysconf(_SC_PAGESIZE);
+  page_size = (page_query > 0) ? (size_t)page_query : 4096;
+  if (len < FE_MMAP_SOURCE_MIN || len % page_size == 0) {
+    close(fd);
+    return NULL;
+  }
+  addr = mmap(NULL, len, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (addr == MAP_FAILED) return NULL;
+#endif
+
+  /* Only the list node is tracked: the mapped bytes are file-backed,
+     read-only, and shared, so they do not count against the context's
+     memory limit the way a heap copy would. */
+  node = tracked_alloc(ctx, sizeof(*node));
+  if (!node) {
+#ifdef _WIN32
+    UnmapViewOfFile(addr);
+#else
+    munmap(addr, len);
+#endif
+    return NULL;
+  }
+  node->addr = addr;
+  node->len = len;
+  node->next = ctx->mapped_sources;
+  ctx->mapped_sources = node;
+  if (out_len) { *out_len = len; }
+  return (const char*)addr;
+}
+
+static void unmap_sources(fe_Context *ctx) {
+  while (ctx->mapped_sources) {
+    fe_MappedSource *node = ctx->mapped_sources;
+    ctx->mapped_sources = node->next;
+#ifdef _WIN32
+    UnmapViewOfFile(node->addr);
+#else
+    munmap(node->addr, node->len);
+#endif
+    tracked_free(ctx, node);
+  }
+}
+
 static int push_source_dir_from_file(fe_Context *ctx, const char *path) {
   char *normalized_path = normalize_existing_path(ctx, path);
   char *dir = path_dirname_copy(ctx, normalized_path ? normalized_path : path);
@@ -1284,6 +1986,115 @@ static char* format_search_paths(fe_Context *ctx, char **items, int count) {
   return buf;
 }
 
+/* ----------------------------------------------------------------------
+ * Import-resolution cache.
+ *
+ * Resolving a module spec stats every candidate file under the importing
+ * directory and each search path, so a spec that is imported from many
+ * modules pays the full probe sequence each time.  Successful lookups are
+ * remembered per (importing directory, lookup name) pair — the directory
+ * is part of the key because it is the first base searched — and repeat
+ * imports skip the filesystem entirely.  Only hits are cached: a missing
+ * module may legitimately appear later.  The cache is dropped whenever
+ * the search inputs change (import paths edited, working directory
+ * changed), since those invalidate prior answers wholesale.
+ * ---------------------------------------------------------------------- */
+
+/* FNV-1a over the importing directory and the module lookup name. */
+static unsigned long module_resolution_hash(const char *dir, const char *name) {
+#if ULONG_MAX > 0xFFFFFFFFu
+  unsigned long hash = 14695981039346656037UL;
+  #define FNV_PRIME 1099511628211UL
+#else
+  unsigned long hash = 2166136261u;
+  #define FNV_PRIME 16777619u
+#endif
+  const unsigned char *p;
+  for (p = (const unsigned char*)dir; *p; p++) {
+    hash ^= *p;
+    hash *= FNV_PRIME;
+  }
+  hash ^= '\n';  /* separator so shifting bytes between the two parts rehashes */
+  hash *= FNV_PRIME;
+  for (p = (const unsigned char*)name; *p; p++) {
+    hash ^= *p;
+    hash *= FNV_PRIME;
+  }
+#undef FNV_PRIME
+  return hash;
+}
+
+static const char* module_resolution_dir(fe_Context *ctx) {
+  return ctx->source_dir_count > 0
+      ? ctx->source_dirs[ctx->source_dir_count - 1] : "";
+}
+
+static void module_resolution_clear(fe_Context *ctx) {
+  int i;
+  for (i = 0; i < ctx->module_resolution_count; i++) {
+    tracked_free(ctx, ctx->module_resolutions[i].dir);
+    tracked_free(ctx, ctx->module_resolutions[i].name);
+    tracked_free(ctx, ctx->module_resolutions[i].resolved);
+  }
+  tracked_free(ctx, ctx->module_resolutions);
+  ctx->module_resolutions = NULL;
+  ctx->module_resolution_count = 0;
+  ctx->module_resolution_capacity = 0;
+}
+
+/* Exposed for builtins whose side effects change what a search would
+   find (currently chdir: relative bases resolve against the cwd). */
+void fe_ctx_module_resolution_invalidate(fe_Context *ctx) {
+  module_resolution_clear(ctx);
+}
+
+/* Returns an owned copy of the cached canonical path, or NULL on a miss.
+   Lookups are a linear scan with a hash prefilter, like the compile
+   cache: the entry count tracks the distinct specs a program imports. */
+static char* module_resolution_get(fe_Context *ctx, const char *name) {
+  const char *dir = module_resolution_dir(ctx);
+  unsigned long hash = module_resolution_hash(dir, name);
+  int i;
+  for (i = 0; i < ctx->module_resolution_count; i++) {
+    fe_ModuleResolution *entry = &ctx->module_resolutions[i];
+    if (entry->hash == hash && strcmp(entry->name, name) == 0 &&
+        strcmp(entry->dir, dir) == 0) {
+      return dup_cstring(ctx, entry->resolved);
+    }
+  }
+  return NULL;
+}
+
+/* Best-effort insertion; on OOM the caller keeps its resolved path and
+   the next import simply probes the filesystem again. */
+static void module_resolution_put(fe_Context *ctx, const char *name,
+                                  const char *resolved) {
+  const char *dir = module_resolution_dir(ctx);
+  fe_ModuleResolution entry;
+
+  if (ctx->module_resolution_count == ctx->module_resolution_capacity) {
+    int new_capacity = ctx->module_resolution_capacity
+        ? ctx->module_resolution_capacity * 2 : 8;
+    fe_ModuleResolution *grown = tracked_realloc(ctx, ctx->module_resolutions,
+        sizeof(entry) * (size_t)new_capacity);
+    if (!grown) return;
+    ctx->module_resolutions = grown;
+    ctx->module_resolution_capacity = new_capacity;
+  }
+
+  entry.dir = dup_cstring(ctx, dir);
+  entry.name = dup_cstring(ctx, name);
+  entry.resolved = dup_cstring(ctx, resolved);
+  if (!entry.dir || !entry.name || !entry.resolved) {
+    tracked_free(ctx, entry.dir);
+    tracked_free(ctx, entry.name);
+    tracked_free(ctx, entry.resolved);
+    return;
+  }
+  entry.hash = module_resolution_hash(dir, name);
+  ctx->module_resolutions[ctx->module_resolution_count++] = entry;
+}
+
 static int try_resolve_module_candidate(fe_Context *ctx, const char *candidate,
                                         char ***searched, int *searched_count,
                                         int *searched_capacity,
@@ -1351,6 +2162,9 @@ static char* resolve_module_file(fe_Context *ctx, const char *module_name,
 
   if (searched_paths) *searched_paths = NULL;
 
+  resolved = module_resolution_get(ctx, module_name);
+  if (resolved) return resolved;
+
   if (ctx->source_dir_count > 0) {
     status = try_resolve_module_under_base(ctx,
                                            ctx->source_dirs[ctx->source_dir_count - 1],
@@ -1389,11 +2203,13 @@ done:
   return resolved;
 
 resolved:
+  module_resolution_put(ctx, module_name, resolved);
   string_array_clear(ctx, &searched, &searched_count, &searched_capacity);
   return resolved;
 }
 
 void fex_clear_import_paths(fe_Context *ctx) {
+  module_resolution_clear(ctx);
   string_array_clear(ctx, &ctx->import_paths, &ctx->import_path_count, &ctx->import_path_capacity);
 }
 
@@ -1410,6 +2226,9 @@ int fex_add_import_path(fe_Context *ctx, const char *path) {
     tracked_free(ctx, normalized);
     return 0;
   }
+  /* A new search path changes the probe order, so prior resolutions may
+     no longer match what a fresh search would return. */
+  module_resolution_clear(ctx);
   return 1;
 }
 
@@ -1426,44 +2245,634 @@ void fex_reset_import_state(fe_Context *ctx) {
   ctx->modulestack = &nil;
 }
 
-static fe_Object* do_file_common(fe_Context *ctx, const char *path,
-                                 fe_Object *implicit_exports) {
-  char *source;
-  fe_Object *result;
-  int pushed_module = 0;
-
-  if (!push_source_dir_from_file(ctx, path)) {
-    memory_error(ctx, "out of memory (source path)");
+/* -------------------------------------------------------------------------
+ * Precompiled module cache
+ *
+ * `fex_compile_file` serializes the compiled form of a source file to a
+ * sibling cache file (`foo.fex` -> `foo.fexc`), keyed by the source's
+ * mtime and size.  When loading a file, `do_file_common` consults the
+ * cache first and evaluates the stored tree directly, skipping the parse
+ * and compile passes.  A missing, stale, or corrupt cache silently falls
+ * back to compiling the source, so caches never change behavior - only
+ * startup cost.  Cache-loaded code carries no source spans, so runtime
+ * diagnostics from it omit line/column details.
+ *
+ * The format is native-endian and records the word and number sizes it
+ * was written with; a cache from a different machine layout is treated
+ * as stale.
+ * ------------------------------------------------------------------------- */
+
+#define MODULE_CACHE_VERSION   1u
+#define MODULE_CACHE_LAYOUT    0x01020304u
+/* Matches the default read/eval nesting limits: anything the compiler can
+ * produce fits, and the loader never outgrows the GC stack. */
+#define MODULE_CACHE_MAX_DEPTH 512
+
+/* Serialized value tags.  Pairs are written as 'P' <car> <cdr>, with runs
+ * along the cdr handled iteratively on both sides so long program bodies
+ * do not recurse. */
+enum {
+  MODULE_CACHE_TAG_NIL    = 'N',
+  MODULE_CACHE_TAG_TRUE   = 'T',
+  MODULE_CACHE_TAG_FALSE  = 'F',
+  MODULE_CACHE_TAG_FIXNUM = 'I',
+  MODULE_CACHE_TAG_NUMBER = 'D',
+  MODULE_CACHE_TAG_STRING = 'S',
+  MODULE_CACHE_TAG_BYTES  = 'B',
+  MODULE_CACHE_TAG_SYMBOL = 'Y',
+  MODULE_CACHE_TAG_PAIR   = 'P'
+};
+
+static FILE* module_cache_fopen(fe_Context *ctx, const char *path, int writing) {
+#ifdef _WIN32
+  FILE *fp;
+  wchar_t *wide_path = utf8_to_wide_tracked(ctx, path);
+  if (!wide_path) return NULL;
+  fp = _wfopen(wide_path, writing ? L"wb" : L"rb");
+  tracked_free(ctx, wide_path);
+  return fp;
+#else
+  unused(ctx);
+  return fopen(path, writing ? "wb" : "rb");
+#endif
+}
+
+static void module_cache_remove(fe_Context *ctx, const char *path) {
+#ifdef _WIN32
+  wchar_t *wide_path = utf8_to_wide_tracked(ctx, path);
+  if (!wide_path) return;
+  _wremove(wide_path);
+  tracked_free(ctx, wide_path);
+#else
+  unused(ctx);
+  remove(path);
+#endif
+}
+
+static int module_cache_stat_source(fe_Context *ctx, const char *path,
+                                    uint64_t *mtime, uint64_t *size) {
+#ifdef _WIN32
+  struct _stat64 st;
+  int rc;
+  wchar_t *wide_path = utf8_to_wide_tracked(ctx, path);
+  if (!wide_path) return 0;
+  rc = _wstat64(wide_path, &st);
+  tracked_free(ctx, wide_path);
+  if (rc != 0) return 0;
+  *mtime = (uint64_t)st.st_mtime;
+  *size = (uint64_t)st.st_size;
+#else
+  struct stat st;
+  unused(ctx);
+  if (stat(path, &st) != 0) return 0;
+  *mtime = (uint64_t)st.st_mtime;
+  *size = (uint64_t)st.st_size;
+#endif
+  return 1;
+}
+
+/* "<path>c" - the cache for foo.fex sits next to it as foo.fexc.  Caller
+ * frees the result via tracked_free. */
+static char* module_cache_path(fe_Context *ctx, const char *path) {
+  size_t len = strlen(path);
+  char *cache_path = tracked_alloc(ctx, len + 2);
+  if (!cache_path) return NULL;
+  memcpy(cache_path, path, len);
+  cache_path[len] = 'c';
+  cache_path[len + 1] = '\0';
+  return cache_path;
+}
+
+static int module_cache_write_header(FILE *fp, uint64_t mtime, uint64_t size) {
+  uint32_t version = MODULE_CACHE_VERSION;
+  uint32_t layout = MODULE_CACHE_LAYOUT;
+  uint8_t num_size = (uint8_t)sizeof(fe_Number);
+  uint8_t ptr_size = (uint8_t)sizeof(intptr_t);
+  uint8_t pad[2] = { 0, 0 };
+  return fwrite("FEXC", 1, 4, fp) == 4 &&
+         fwrite(&version, sizeof(version), 1, fp) == 1 &&
+         fwrite(&layout, sizeof(layout), 1, fp) == 1 &&
+         fwrite(&num_size, 1, 1, fp) == 1 &&
+         fwrite(&ptr_size, 1, 1, fp) == 1 &&
+         fwrite(pad, 1, 2, fp) == 2 &&
+         fwrite(&mtime, sizeof(mtime), 1, fp) == 1 &&
+         fwrite(&size, sizeof(size), 1, fp) == 1;
+}
+
+static int module_cache_check_header(FILE *fp, uint64_t mtime, uint64_t size) {
+  char magic[4];
+  uint32_t version, layout;
+  uint8_t num_size, ptr_size, pad[2];
+  uint64_t stored_mtime, stored_size;
+  if (fread(magic, 1, 4, fp) != 4 || memcmp(magic, "FEXC", 4) != 0) return 0;
+  if (fread(&version, sizeof(version), 1, fp) != 1 ||
+      version != MODULE_CACHE_VERSION) return 0;
+  if (fread(&layout, sizeof(layout), 1, fp) != 1 ||
+      layout != MODULE_CACHE_LAYOUT) return 0;
+  if (fread(&num_size, 1, 1, fp) != 1 || num_size != sizeof(fe_Number)) return 0;
+  if (fread(&ptr_size, 1, 1, fp) != 1 || ptr_size != sizeof(intptr_t)) return 0;
+  if (fread(pad, 1, 2, fp) != 2) return 0;
+  if (fread(&stored_mtime, sizeof(stored_mtime), 1, fp) != 1 ||
+      stored_mtime != mtime) return 0;
+  if (fread(&stored_size, sizeof(stored_size), 1, fp) != 1 ||
+      stored_size != size) return 0;
+  return 1;
+}
+
+/* Writes a length-prefixed string/bytes/symbol-name payload. */
+static int module_cache_write_str(fe_Context *ctx, FILE *fp, fe_Object *obj) {
+  size_t len;
+  uint32_t len32;
+  unused(ctx);
+  if (type(obj) == FE_TBYTES && bytes_is_view(obj)) {
+    /* Slice views serialize as plain bytes of their visible range. */
+    size_t off = 0;
+    len = fe_byteslen(ctx, obj);
+    if (len > (size_t)INT32_MAX) return 0;
+    len32 = (uint32_t)len;
+    if (fwrite(&len32, sizeof(len32), 1, fp) != 1) return 0;
+    while (off < len) {
+      unsigned char buf[256];
+      size_t n = len - off < sizeof(buf) ? len - off : sizeof(buf);
+      fe_bytescopy(ctx, obj, off, buf, n);
+      if (fwrite(buf, 1, n, fp) != n) return 0;
+      off += n;
+    }
+    return 1;
+  }
+  len = (size_t)FE_STR_LEN(obj);
+  if (len > (size_t)INT32_MAX) return 0;
+  len32 = (uint32_t)len;
+  if (fwrite(&len32, sizeof(len32), 1, fp) != 1) return 0;
+#ifdef FE_OPT_NO_MALLOC_STRINGS
+  {
+    size_t remaining = len;
+    uint32_t offset = obj->cdr.u32;
+    while (offset != FE_SLAB_NULL && remaining > 0) {
+      fe_Slab *slab = (fe_Slab*)(ctx->str_base + offset);
+      size_t to_write = (remaining > FE_SLAB_DATA_SIZE) ? FE_SLAB_DATA_SIZE : remaining;
+      if (fwrite(slab->data, 1, to_write, fp) != to_write) return 0;
+      remaining -= to_write;
+      offset = slab->next;
+    }
+    if (remaining > 0) return 0;
   }
+#else
+  if (len > 0 && fwrite(FE_STR_DATA(ctx, obj), 1, len, fp) != len) return 0;
+#endif
+  return 1;
+}
 
-  source = read_text_file(ctx, path);
-  if (!source) {
-    pop_source_dir(ctx);
-    if (ctx->alloc_failure_active) {
-      memory_error(ctx, "out of memory (source file)");
+static int module_cache_write_value(fe_Context *ctx, FILE *fp, fe_Object *obj,
+                                    int depth) {
+  if (depth > MODULE_CACHE_MAX_DEPTH) return 0;
+  for (;;) {
+    if (FE_IS_FIXNUM(obj)) {
+      int64_t v = (int64_t)FE_UNBOX_FIXNUM(obj);
+      if (fputc(MODULE_CACHE_TAG_FIXNUM, fp) == EOF) return 0;
+      return fwrite(&v, sizeof(v), 1, fp) == 1;
     }
-    if (fex_try_is_active()) {
-      fex_try_raise(FEX_STATUS_IO_ERROR, path, 0, 0, "could not open input file");
+    switch (type(obj)) {
+      case FE_TNIL:
+        return fputc(MODULE_CACHE_TAG_NIL, fp) != EOF;
+      case FE_TBOOLEAN:
+        return fputc(obj == FE_TRUE ? MODULE_CACHE_TAG_TRUE
+                                    : MODULE_CACHE_TAG_FALSE, fp) != EOF;
+      case FE_TNUMBER: {
+        fe_Number n = number(obj);
+        if (fputc(MODULE_CACHE_TAG_NUMBER, fp) == EOF) return 0;
+        return fwrite(&n, sizeof(n), 1, fp) == 1;
+      }
+      case FE_TSTRING:
+        if (fputc(MODULE_CACHE_TAG_STRING, fp) == EOF) return 0;
+        return module_cache_write_str(ctx, fp, obj);
+      case FE_TBYTES:
+        if (fputc(MODULE_CACHE_TAG_BYTES, fp) == EOF) return 0;
+        return module_cache_write_str(ctx, fp, obj);
+      case FE_TSYMBOL:
+        if (fputc(MODULE_CACHE_TAG_SYMBOL, fp) == EOF) return 0;
+        return module_cache_write_str(ctx, fp, car(cdr(obj)));
+      case FE_TPAIR:
+        if (fputc(MODULE_CACHE_TAG_PAIR, fp) == EOF) return 0;
+        if (!module_cache_write_value(ctx, fp, car(obj), depth + 1)) return 0;
+        /* continue along the cdr chain without recursing */
+        obj = cdr(obj);
+        break;
+      default:
+        /* Functions, pointers, maps etc. never appear in compiled output;
+         * refuse to cache rather than mis-serialize. */
+        return 0;
+    }
+  }
+}
+
+typedef struct {
+  const unsigned char *p;
+  const unsigned char *end;
+} ModuleCacheCursor;
+
+static int module_cache_read_raw(ModuleCacheCursor *c, void *dst, size_t n) {
+  if ((size_t)(c->end - c->p) < n) return 0;
+  memcpy(dst, c->p, n);
+  c->p += n;
+  return 1;
+}
+
+static fe_Object* module_cache_read_atom(fe_Context *ctx, ModuleCacheCursor *c,
+                                         int tag) {
+  switch (tag) {
+    case MODULE_CACHE_TAG_NIL:   return &nil;
+    case MODULE_CACHE_TAG_TRUE:  return FE_TRUE;
+    case MODULE_CACHE_TAG_FALSE: return FE_FALSE;
+
+    case MODULE_CACHE_TAG_FIXNUM: {
+      int64_t v;
+      if (!module_cache_read_raw(c, &v, sizeof(v))) return NULL;
+      if (v >= (int64_t)(INTPTR_MIN >> 1) && v <= (int64_t)(INTPTR_MAX >> 1)) {
+        return FE_FIXNUM((intptr_t)v);
+      }
+      return fe_number(ctx, (fe_Number)v);
+    }
+
+    case MODULE_CACHE_TAG_NUMBER: {
+      fe_Number n;
+      if (!module_cache_read_raw(c, &n, sizeof(n))) return NULL;
+      return fe_number(ctx, n);
+    }
+
+    case MODULE_CACHE_TAG_STRING:
+    case MODULE_CACHE_TAG_BYTES: {
+      uint32_t len;
+      fe_Object *obj;
+      if (!module_cache_read_raw(c, &len, sizeof(len))) return NULL;
+      if ((size_t)(c->end - c->p) < len) return NULL;
+      obj = (tag == MODULE_CACHE_TAG_STRING)
+          ? fe_string(ctx, (const char*)c->p, len)
+          : fe_bytes(ctx, c->p, len);
+      c->p += len;
+      return obj;
+    }
+
+    case MODULE_CACHE_TAG_SYMBOL: {
+      uint32_t len;
+      char *name;
+      fe_Object *sym;
+      if (!module_cache_read_raw(c, &len, sizeof(len))) return NULL;
+      if (len == 0 || (size_t)(c->end - c->p) < len) return NULL;
+      if (memchr(c->p, '\0', len) != NULL) return NULL;
+      name = tracked_alloc(ctx, (size_t)len + 1);
+      if (!name) return NULL;
+      memcpy(name, c->p, len);
+      name[len] = '\0';
+      c->p += len;
+      sym = fe_symbol(ctx, name);
+      tracked_free(ctx, name);
+      return sym;
+    }
+
+    default:
+      return NULL;
+  }
+}
+
+/* Returns the deserialized value, or NULL on a truncated/corrupt payload.
+ * On NULL the caller is expected to unwind the GC stack to its own save
+ * point; partially built structures are then simply collected. */
+static fe_Object* module_cache_read_value(fe_Context *ctx, ModuleCacheCursor *c,
+                                          int depth) {
+  unsigned char tag;
+  fe_Object *head, *tail;
+  if (depth > MODULE_CACHE_MAX_DEPTH) return NULL;
+  if (!module_cache_read_raw(c, &tag, 1)) return NULL;
+  if (tag != MODULE_CACHE_TAG_PAIR) {
+    return module_cache_read_atom(ctx, c, tag);
+  }
+  /* Rebuild the cdr chain iteratively; only car subtrees recurse.  The
+   * chain head stays on the GC stack, so conses and atoms can be popped
+   * as soon as they are linked in. */
+  head = fe_cons(ctx, &nil, &nil);
+  tail = head;
+  for (;;) {
+    int gc = fe_savegc(ctx);
+    fe_Object *v = module_cache_read_value(ctx, c, depth + 1);
+    if (!v) return NULL;
+    car(tail) = v;
+    fe_restoregc(ctx, gc);
+    if (!module_cache_read_raw(c, &tag, 1)) return NULL;
+    if (tag == MODULE_CACHE_TAG_PAIR) {
+      fe_Object *next;
+      gc = fe_savegc(ctx);
+      next = fe_cons(ctx, &nil, &nil);
+      cdr(tail) = next;
+      fe_restoregc(ctx, gc);
+      tail = next;
+    } else {
+      gc = fe_savegc(ctx);
+      v = module_cache_read_atom(ctx, c, tag);
+      if (!v) return NULL;
+      cdr(tail) = v;
+      fe_restoregc(ctx, gc);
+      return head;
     }
+  }
+}
+
+/* Loads the cache for `path` if present and still valid.  On success the
+ * compiled tree is returned rooted once on the GC stack; on any miss the
+ * GC stack is left as found and NULL is returned. */
+static fe_Object* module_cache_load(fe_Context *ctx, const char *path) {
+  uint64_t mtime, source_size;
+  char *cache_path;
+  FILE *fp;
+  long header_end, file_end;
+  size_t payload_size;
+  unsigned char *payload;
+  ModuleCacheCursor c;
+  fe_Object *code;
+  int gc_save = fe_savegc(ctx);
+
+  if (!module_cache_stat_source(ctx, path, &mtime, &source_size)) return NULL;
+  cache_path = module_cache_path(ctx, path);
+  if (!cache_path) return NULL;
+  fp = module_cache_fopen(ctx, cache_path, 0);
+  tracked_free(ctx, cache_path);
+  if (!fp) return NULL;
+  if (!module_cache_check_header(fp, mtime, source_size)) {
+    fclose(fp);
     return NULL;
   }
-  if (!string_array_push_owned(ctx, &ctx->source_buffers, &ctx->source_buffer_count,
-                               &ctx->source_buffer_capacity, source)) {
-    pop_source_dir(ctx);
-    tracked_free(ctx, source);
+  header_end = ftell(fp);
+  if (header_end < 0 || fseek(fp, 0L, SEEK_END) != 0) { fclose(fp); return NULL; }
+  file_end = ftell(fp);
+  if (file_end <= header_end || fseek(fp, header_end, SEEK_SET) != 0) {
+    fclose(fp);
+    return NULL;
+  }
+  payload_size = (size_t)(file_end - header_end);
+  payload = tracked_alloc(ctx, payload_size);
+  if (!payload) { fclose(fp); return NULL; }
+  if (fread(payload, 1, payload_size, fp) != payload_size) {
+    tracked_free(ctx, payload);
+    fclose(fp);
+    return NULL;
+  }
+  fclose(fp);
+
+  c.p = payload;
+  c.end = payload + payload_size;
+  code = module_cache_read_value(ctx, &c, 0);
+  if (code && c.p != c.end) { code = NULL; } /* trailing garbage */
+  tracked_free(ctx, payload);
+  fe_restoregc(ctx, gc_save);
+  if (!code) return NULL;
+  fe_pushgc(ctx, code);
+  return code;
+}
+
+static int module_cache_store(fe_Context *ctx, const char *path, fe_Object *code) {
+  uint64_t mtime, source_size;
+  char *cache_path;
+  FILE *fp;
+  int ok;
+
+  if (!module_cache_stat_source(ctx, path, &mtime, &source_size)) return 0;
+  cache_path = module_cache_path(ctx, path);
+  if (!cache_path) return 0;
+  fp = module_cache_fopen(ctx, cache_path, 1);
+  if (!fp) {
+    tracked_free(ctx, cache_path);
+    return 0;
+  }
+  ok = module_cache_write_header(fp, mtime, source_size) &&
+       module_cache_write_value(ctx, fp, code, 0);
+  if (fclose(fp) != 0) ok = 0;
+  if (!ok) module_cache_remove(ctx, cache_path);
+  tracked_free(ctx, cache_path);
+  return ok;
+}
+
+void fex_set_module_cache(fe_Context *ctx, int enabled) {
+  ctx->module_cache_enabled = (enabled != 0);
+}
+
+int fex_get_module_cache(fe_Context *ctx) {
+  return ctx->module_cache_enabled;
+}
+
+/* ----------------------------------------------------------------------
+ * In-memory compile cache for fex_do_string.
+ *
+ * Embeddings that evaluate a small set of recurring snippets pay the full
+ * lex/parse cost on every call.  When enabled, byte-identical source maps
+ * straight to its previously compiled tree, which the GC treats as a root
+ * for as long as the entry lives.  The cache is opt-in and bounded: the
+ * entry array holds at most compile_cache_limit slots, kept in
+ * most-recently-used order, and insertion evicts the tail.  Lookups are a
+ * linear scan with a hash prefilter, which is fine at the small sizes the
+ * bound implies.
+ * ---------------------------------------------------------------------- */
+
+/* FNV-1a over the source bytes and the source name. */
+static unsigned long compile_cache_hash(const char *source, size_t len,
+                                        const char *source_name) {
+#if ULONG_MAX > 0xFFFFFFFFu
+  unsigned long hash = 14695981039346656037UL;
+  #define FNV_PRIME 1099511628211UL
+#else
+  unsigned long hash = 2166136261u;
+  #define FNV_PRIME 16777619u
+#endif
+  const unsigned char *p = (const unsigned char*)source;
+  size_t i;
+  for (i = 0; i < len; i++) {
+    hash ^= p[i];
+    hash *= FNV_PRIME;
+  }
+  for (p = (const unsigned char*)source_name; *p; p++) {
+    hash ^= *p;
+    hash *= FNV_PRIME;
+  }
+#undef FNV_PRIME
+  return hash;
+}
+
+static void compile_cache_free_entry(fe_Context *ctx, fe_CompileCacheEntry *entry) {
+  tracked_free(ctx, entry->source);
+  tracked_free(ctx, entry->source_name);
+}
+
+static void compile_cache_clear(fe_Context *ctx) {
+  int i;
+  for (i = 0; i < ctx->compile_cache_count; i++) {
+    compile_cache_free_entry(ctx, &ctx->compile_cache_entries[i]);
+  }
+  tracked_free(ctx, ctx->compile_cache_entries);
+  ctx->compile_cache_entries = NULL;
+  ctx->compile_cache_count = 0;
+}
+
+fe_Object *fe_ctx_compile_cache_get(fe_Context *ctx, const char *source,
+                                    const char *source_name) {
+  size_t len;
+  unsigned long hash;
+  int i;
+
+  if (ctx->compile_cache_limit == 0 || ctx->compile_cache_count == 0) {
+    return NULL;
+  }
+  len = strlen(source);
+  hash = compile_cache_hash(source, len, source_name);
+  for (i = 0; i < ctx->compile_cache_count; i++) {
+    fe_CompileCacheEntry *entry = &ctx->compile_cache_entries[i];
+    if (entry->hash == hash && entry->source_len == len &&
+        strcmp(entry->source_name, source_name) == 0 &&
+        memcmp(entry->source, source, len) == 0) {
+      fe_CompileCacheEntry hit = *entry;
+      memmove(&ctx->compile_cache_entries[1], &ctx->compile_cache_entries[0],
+              sizeof(hit) * (size_t)i);
+      ctx->compile_cache_entries[0] = hit;
+      return hit.code;
+    }
+  }
+  return NULL;
+}
+
+void fe_ctx_compile_cache_put(fe_Context *ctx, const char *source,
+                              const char *source_name, fe_Object *code) {
+  fe_CompileCacheEntry entry;
+  size_t len;
+  size_t name_len;
+
+  /* Immediates and nil are not worth a slot (and fe_mark must only see
+     heap objects), so cache real trees only. */
+  if (ctx->compile_cache_limit == 0 || code == NULL ||
+      FE_IS_FIXNUM(code) || FE_IS_BOOLEAN(code) || code == &nil) {
+    return;
+  }
+  if (ctx->compile_cache_entries == NULL) {
+    ctx->compile_cache_entries = tracked_alloc(ctx,
+        sizeof(entry) * (size_t)ctx->compile_cache_limit);
+    if (!ctx->compile_cache_entries) {
+      return;  /* caching is best-effort; the caller keeps its tree */
+    }
+  }
+
+  len = strlen(source);
+  name_len = strlen(source_name);
+  entry.source = tracked_alloc(ctx, len + 1);
+  entry.source_name = tracked_alloc(ctx, name_len + 1);
+  if (!entry.source || !entry.source_name) {
+    tracked_free(ctx, entry.source);
+    tracked_free(ctx, entry.source_name);
+    return;
+  }
+  memcpy(entry.source, source, len + 1);
+  memcpy(entry.source_name, source_name, name_len + 1);
+  entry.source_len = len;
+  entry.hash = compile_cache_hash(source, len, source_name);
+  entry.code = code;
+
+  if (ctx->compile_cache_count == ctx->compile_cache_limit) {
+    compile_cache_free_entry(ctx,
+        &ctx->compile_cache_entries[ctx->compile_cache_count - 1]);
+    ctx->compile_cache_count--;
+  }
+  memmove(&ctx->compile_cache_entries[1], &ctx->compile_cache_entries[0],
+          sizeof(entry) * (size_t)ctx->compile_cache_count);
+  ctx->compile_cache_entries[0] = entry;
+  ctx->compile_cache_count++;
+}
+
+void fex_set_compile_cache(fe_Context *ctx, int max_entries) {
+  if (max_entries < 0) {
+    max_entries = 0;
+  }
+  /* Resizing drops the whole table rather than picking survivors (the
+     entry array is sized to the bound); evaluations repopulate it. */
+  if (max_entries != ctx->compile_cache_limit) {
+    compile_cache_clear(ctx);
+  }
+  ctx->compile_cache_limit = max_entries;
+}
+
+int fex_get_compile_cache(fe_Context *ctx) {
+  return ctx->compile_cache_limit;
+}
+
+void fex_clear_compile_cache(fe_Context *ctx) {
+  compile_cache_clear(ctx);
+}
+
+static fe_Object* do_file_common(fe_Context *ctx, const char *path,
+                                 fe_Object *implicit_exports) {
+  char *source = NULL;
+  const char *mapped;
+  size_t mapped_len = 0;
+  fe_Object *result;
+  int pushed_module = 0;
+
+  if (!push_source_dir_from_file(ctx, path)) {
     memory_error(ctx, "out of memory (source path)");
   }
 
+  /* A valid precompiled cache skips the read/parse/compile passes
+   * entirely; any miss falls through to the source below. */
+  if (ctx->module_cache_enabled) {
+    int gc_save = fe_savegc(ctx);
+    fe_Object *code = module_cache_load(ctx, path);
+    if (code) {
+      if (implicit_exports != NULL && type(implicit_exports) == FE_TMAP) {
+        ctx->modulestack = fe_cons(ctx, implicit_exports, ctx->modulestack);
+        pushed_module = 1;
+      }
+      result = fe_eval(ctx, code);
+      if (pushed_module) {
+        ctx->modulestack = cdr(ctx->modulestack);
+      }
+      fe_restoregc(ctx, gc_save);
+      pop_source_dir(ctx);
+      return result;
+    }
+    fe_restoregc(ctx, gc_save);
+  }
+
+  /* Large files are mapped read-only (shared pages, no heap copy); the
+     mapping stays until fe_close(), so spans can point straight into it. */
+  mapped = map_text_file(ctx, path, &mapped_len);
+  if (mapped) {
+    fex_span_adopt_source(ctx, mapped, mapped_len);
+  } else {
+    source = read_text_file(ctx, path);
+    if (!source) {
+      pop_source_dir(ctx);
+      if (ctx->alloc_failure_active) {
+        memory_error(ctx, "out of memory (source file)");
+      }
+      if (fex_try_is_active()) {
+        fex_try_raise(FEX_STATUS_IO_ERROR, path, 0, 0, "could not open input file");
+      }
+      return NULL;
+    }
+    if (!string_array_push_owned(ctx, &ctx->source_buffers, &ctx->source_buffer_count,
+                                 &ctx->source_buffer_capacity, source)) {
+      pop_source_dir(ctx);
+      tracked_free(ctx, source);
+      memory_error(ctx, "out of memory (source path)");
+    }
+  }
+
   if (implicit_exports != NULL && type(implicit_exports) == FE_TMAP) {
     ctx->modulestack = fe_cons(ctx, implicit_exports, ctx->modulestack);
     pushed_module = 1;
   }
 
-  result = fex_do_string_named(ctx, source, path);
+  result = fex_do_string_named(ctx, mapped ? mapped : source, path);
   if (pushed_module) {
     ctx->modulestack = cdr(ctx->modulestack);
   }
-  string_array_pop(ctx, ctx->source_buffers, &ctx->source_buffer_count);
+  if (!mapped) {
+    string_array_pop(ctx, ctx->source_buffers, &ctx->source_buffer_count);
+  }
   pop_source_dir(ctx);
   return result;
 }
@@ -1482,14 +2891,83 @@ fe_Object* fex_do_file(fe_Context *ctx, const char *path) {
   return do_file_common(ctx, path, NULL);
 }
 
+static fe_Object* compile_file_runner(fe_Context *ctx, const void *path_arg,
+                                      const void *unused_arg) {
+  const char *path = path_arg;
+  char *source = NULL;
+  const char *mapped;
+  size_t mapped_len = 0;
+  fe_Object *code;
+  int gc_save;
+  int stored = 0;
+  unused(unused_arg);
+
+  if (!push_source_dir_from_file(ctx, path)) {
+    memory_error(ctx, "out of memory (source path)");
+  }
+
+  mapped = map_text_file(ctx, path, &mapped_len);
+  if (mapped) {
+    fex_span_adopt_source(ctx, mapped, mapped_len);
+  } else {
+    source = read_text_file(ctx, path);
+    if (!source) {
+      pop_source_dir(ctx);
+      if (ctx->alloc_failure_active) {
+        memory_error(ctx, "out of memory (source file)");
+      }
+      if (fex_try_is_active()) {
+        fex_try_raise(FEX_STATUS_IO_ERROR, path, 0, 0, "could not open input file");
+      }
+      return NULL;
+    }
+    if (!string_array_push_owned(ctx, &ctx->source_buffers, &ctx->source_buffer_count,
+                                 &ctx->source_buffer_capacity, source)) {
+      pop_source_dir(ctx);
+      tracked_free(ctx, source);
+      memory_error(ctx, "out of memory (source path)");
+    }
+  }
+
+  gc_save = fe_savegc(ctx);
+  code = fex_compile_named(ctx, mapped ? mapped : source, path);
+  if (code) {
+    stored = module_cache_store(ctx, path, code);
+  }
+  fe_restoregc(ctx, gc_save);
+  if (!mapped) {
+    string_array_pop(ctx, ctx->source_buffers, &ctx->source_buffer_count);
+  }
+  pop_source_dir(ctx);
+
+  if (code && !stored && fex_try_is_active()) {
+    fex_try_raise(FEX_STATUS_IO_ERROR, path, 0, 0, "could not write module cache");
+  }
+  return (code && stored) ? FE_TRUE : NULL;
+}
+
+int fex_compile_file(fe_Context *ctx, const char *path) {
+  return compile_file_runner(ctx, path, NULL) != NULL;
+}
+
+FexStatus fex_try_compile_file(fe_Context *ctx, const char *path,
+                               FexError *out_error) {
+  return fex_try_run_internal(ctx, NULL, out_error, compile_file_runner, path,
+                              NULL, path ? path : "<string>", 0);
+}
+
 
 void fe_error(fe_Context *ctx, const char *msg) {
   fe_Object *cl = ctx->calllist;
   /* reset context state */
   ctx->calllist = &nil;
+  code_abandon_runs(ctx);
+  ctx->resume_forms = NULL;   /* a staged resumable program is abandoned */
+  ctx->resume_result = NULL;
   ctx->eval_depth = 0;
   ctx->current_eval_depth = 0;
   ctx->current_read_depth = 0;
+  ctx->profile_depth = 0;  /* frames above the longjmp are abandoned */
   if (ctx->timeout_ms > 0) {
     ctx->timeout_countdown = TIMEOUT_CHECK_INTERVAL;
   }
@@ -1558,7 +3036,9 @@ fe_Number fe_num_value(fe_Object *o)
     }
 }
 
-fe_Object *fe_make_number(fe_Context *ctx, fe_Number v)
+/* Returns the fixnum immediate for v, or NULL when v is non-integral or
+   out of fixnum range and needs a boxed double. */
+static fe_Object *number_as_fixnum(fe_Number v)
 {
     /* 1. Is it an integer?  (Avoids FP rounding issues.)             */
     fe_Number iv = (fe_Number)(intptr_t)v;
@@ -1570,6 +3050,13 @@ fe_Object *fe_make_number(fe_Context *ctx, fe_Number v)
             return FE_FIXNUM(i);
         }
     }
+    return NULL;
+}
+
+fe_Object *fe_make_number(fe_Context *ctx, fe_Number v)
+{
+    fe_Object *imm = number_as_fixnum(v);
+    if (imm) { return imm; }
     /* Fallback: allocate the boxed double. */
     return fe_number(ctx, v);
 }
@@ -1624,7 +3111,7 @@ enter:
         if (FE_IS_FIXNUM(obj) || FE_IS_BOOLEAN(obj) || isnil(obj)) goto pop;
 
         /* 1. Do not mark rogue pointers that don't belong to us. */
-        if (obj < ctx->objects || obj >= ctx->objects + ctx->object_count)
+        if (!arena_contains(ctx, obj))
             goto pop;
 
         /* 2. Already marked?  Done. */
@@ -1649,29 +3136,55 @@ enter:
             obj = cdr(obj);
             continue;
 
-        case FE_TSTRING:
         case FE_TBYTES:
+            if (bytes_is_view(obj)) {
+                /* owner in the car, (offset . length) pair in the cdr */
+                if (sp < MARK_STACK_SIZE) {
+                    stack[sp++] = car(obj);
+                } else {
+                    fe_mark(ctx, car(obj));
+                }
+                obj = cdr(obj);
+                continue;
+            }
+            /* fall-through */
+        case FE_TSTRING:
             goto pop;
 
         case FE_TPTR:
+            /* cdr holds a raw user pointer, not a map payload; only the
+               optional handler knows how to mark through it. */
             if (ctx->handlers.mark) ctx->handlers.mark(ctx, obj);
-            /* fall-through */
+            goto pop;
+
         case FE_TMAP: {
             fe_Map *map = mapdata(obj);
-            int i;
+            int pos = 0;
+            fe_Object *key, *value;
             if (!map) goto pop;
-            for (i = 0; i < map->capacity; i++) {
-              if (map->states[i] == MAP_USED) {
+            while (map_iter_next(map, &pos, &key, &value)) {
                 if (sp < MARK_STACK_SIZE) {
-                    stack[sp++] = map->keys[i];
+                    stack[sp++] = key;
                 } else {
-                    fe_mark(ctx, map->keys[i]);
+                    fe_mark(ctx, key);
                 }
                 if (sp < MARK_STACK_SIZE) {
-                    stack[sp++] = map->values[i];
+                    stack[sp++] = value;
                 } else {
-                    fe_mark(ctx, map->values[i]);
+                    fe_mark(ctx, value);
                 }
+            }
+            goto pop;
+        }
+        case FE_TARRAY: {
+            fe_Array *arr = arraydata(obj);
+            int i;
+            if (!arr) goto pop;
+            for (i = 0; i < arr->count; i++) {
+              if (sp < MARK_STACK_SIZE) {
+                  stack[sp++] = arr->items[i];
+              } else {
+                  fe_mark(ctx, arr->items[i]);
               }
             }
             goto pop;
@@ -1703,51 +3216,180 @@ static void str_free_chain(fe_Context *ctx, uint32_t offset) {
 #endif
 
 
-static void collectgarbage(fe_Context *ctx) {
-  int i;
-  int live = 0; /* Counter for live objects */
-  /* mark */
-  for (i = 0; i < ctx->gcstack_idx; i++) {
-    if (!FE_IS_FIXNUM(ctx->gcstack[i]) && ctx->gcstack[i] != &nil) {
-      fe_mark(ctx, ctx->gcstack[i]);
-    }
-  }
-  fe_mark(ctx, ctx->modulestack);
-  fe_mark(ctx, ctx->symlist);
-  for (i = 0; i < ctx->loaded_module_count; i++) {
-    fe_mark(ctx, ctx->loaded_module_values[i]);
-  }
-  /* sweep and unmark */
-  for (i = 0; i < ctx->object_count; i++) {
-    fe_Object *obj = &ctx->objects[i];
-    if (type(obj) == FE_TFREE) { continue; }
-    if (~tag(obj) & GCMARKBIT) {
+/* Release an unmarked object's external resources and return its slot to
+   the freelist. Shared by the full sweep and the deferred sweep. */
+static void free_object(fe_Context *ctx, fe_Object *obj) {
+  /* Slice views own no storage; their data belongs to the owner object. */
+  int is_bytes_view = type(obj) == FE_TBYTES && bytes_is_view(obj);
 #ifdef FE_OPT_NO_MALLOC_STRINGS
-      if (type(obj) == FE_TSTRING || type(obj) == FE_TBYTES) {
-        str_free_chain(ctx, obj->cdr.u32);
-      }
+  if ((type(obj) == FE_TSTRING || type(obj) == FE_TBYTES) && !is_bytes_view) {
+    str_free_chain(ctx, obj->cdr.u32);
+  }
 #else
-      if ((type(obj)==FE_TSTRING || type(obj)==FE_TBYTES) && FE_STR_DATA(ctx, obj)) {
-          tracked_free(ctx, FE_STR_DATA(ctx, obj));
-      }
+  if ((type(obj)==FE_TSTRING || type(obj)==FE_TBYTES) && !is_bytes_view &&
+      FE_STR_DATA(ctx, obj)) {
+      tracked_free(ctx, FE_STR_DATA(ctx, obj));
+  }
 #endif
-      if (type(obj) == FE_TMAP && mapdata(obj)) {
-        fe_Map *map = mapdata(obj);
-        tracked_free(ctx, map->keys);
-        tracked_free(ctx, map->values);
-        tracked_free(ctx, map->states);
-        tracked_free(ctx, map);
+  if (type(obj) == FE_TMAP && mapdata(obj)) {
+    map_free_payload(ctx, mapdata(obj));
+  }
+  if (type(obj) == FE_TARRAY && arraydata(obj)) {
+    fe_Array *arr = arraydata(obj);
+    tracked_free(ctx, arr->items);
+    tracked_free(ctx, arr);
+  }
+  if (type(obj) == FE_TPTR && ctx->handlers.gc) {
+    ctx->handlers.gc(ctx, obj);
+  }
+  settype(obj, FE_TFREE);
+  cdr(obj) = ctx->freelist;
+  ctx->freelist = obj;
+}
+
+/* Advance the deferred sweep by up to `max_slots` arena slots.  An object
+   that was unreachable at mark time cannot become reachable again, so
+   freeing it late is safe; survivors get their mark bit cleared in
+   passing.  The freelist was dropped when the cycle started and is
+   rebuilt here, which keeps every slot the allocator can hand out behind
+   the cursor and out of the sweep's path. */
+static void gc_sweep_step(fe_Context *ctx, int max_slots) {
+  if (!ctx->gc_sweep_active) { return; }
+  for (;;) {
+    fe_Object *slots;
+    int count;
+    if (ctx->gc_sweep_chunk) {
+      slots = ctx->gc_sweep_chunk->objects;
+      count = ctx->gc_sweep_chunk->count;
+    } else {
+      slots = ctx->objects;
+      count = ctx->object_count;
+    }
+    while (ctx->gc_sweep_cursor < count) {
+      fe_Object *obj;
+      if (max_slots <= 0) { return; }
+      max_slots--;
+      obj = &slots[ctx->gc_sweep_cursor++];
+      if (type(obj) == FE_TFREE) {
+        /* Already free before the cycle started; relink it. */
+        cdr(obj) = ctx->freelist;
+        ctx->freelist = obj;
+        continue;
       }
-      if (type(obj) == FE_TPTR && ctx->handlers.gc) {
-        ctx->handlers.gc(ctx, obj);
+      if (~tag(obj) & GCMARKBIT) {
+        free_object(ctx, obj);
+        ctx->gc_sweep_reclaimed++;
+      } else {
+        tag(obj) &= ~GCMARKBIT;
+        ctx->gc_sweep_live++;
+      }
+    }
+    /* Region finished; move to the next one (embedded arena first, then
+       the chunk list), or wrap up the cycle when none remain. */
+    ctx->gc_sweep_cursor = 0;
+    ctx->gc_sweep_chunk = ctx->gc_sweep_chunk ? ctx->gc_sweep_chunk->next
+                                              : ctx->chunks;
+    if (ctx->gc_sweep_chunk == NULL) {
+      ctx->gc_sweep_active = 0;
+      ctx->live_count = ctx->gc_sweep_live;
+      ctx->gc_reclaimed_last = ctx->gc_sweep_reclaimed;
+      ctx->gc_reclaimed_total += ctx->gc_sweep_reclaimed;
+      ctx->gc_sweep_reclaimed = 0;
+      if (ctx->gc_threshold_fixed > 0) {
+        ctx->gc_threshold = ctx->gc_threshold_fixed;
+      } else {
+        ctx->gc_threshold = ctx->live_count * GC_GROWTH_FACTOR;
+        if (ctx->gc_threshold < GC_MIN_THRESHOLD) {
+          ctx->gc_threshold = GC_MIN_THRESHOLD;
+        }
+      }
+      fex_span_prune(ctx);
+      return;
+    }
+  }
+}
+
+static void gc_note_pause(fe_Context *ctx, uint64_t start_us) {
+  uint64_t pause = current_time_us() - start_us;
+  ctx->gc_pause_us_last = pause;
+  if (pause > ctx->gc_pause_us_max) { ctx->gc_pause_us_max = pause; }
+}
+
+static void collectgarbage(fe_Context *ctx) {
+  int i;
+  int live = 0; /* Counter for live objects */
+  size_t reclaimed = 0;
+  fe_ObjectChunk *chunk;
+  fe_Object *slots;
+  int count;
+  uint64_t pause_start = current_time_us();
+
+  /* A deferred sweep from the previous cycle must finish before marking
+     again: unswept survivors still carry their mark bit. */
+  if (ctx->gc_sweep_active) {
+    gc_sweep_step(ctx, INT_MAX);
+  }
+
+  /* mark */
+  for (i = 0; i < ctx->gcstack_idx; i++) {
+    if (!FE_IS_FIXNUM(ctx->gcstack[i]) && ctx->gcstack[i] != &nil) {
+      fe_mark(ctx, ctx->gcstack[i]);
+    }
+  }
+  fe_mark(ctx, ctx->modulestack);
+  fe_mark(ctx, ctx->symlist);
+  for (i = 0; i < ctx->loaded_module_count; i++) {
+    fe_mark(ctx, ctx->loaded_module_values[i]);
+  }
+  for (i = 0; i < ctx->compile_cache_count; i++) {
+    fe_mark(ctx, ctx->compile_cache_entries[i].code);
+  }
+  if (ctx->resume_forms != NULL) {
+    fe_mark(ctx, ctx->resume_forms);
+  }
+  if (ctx->resume_result != NULL && !FE_IS_FIXNUM(ctx->resume_result) &&
+      !FE_IS_BOOLEAN(ctx->resume_result) && ctx->resume_result != &nil) {
+    fe_mark(ctx, ctx->resume_result);
+  }
+  code_mark_runs(ctx);
+  profile_mark_keys(ctx);
+
+  if (ctx->gc_mode == FE_GC_INCREMENTAL) {
+    /* Defer the sweep: object() reclaims slots in slices as allocation
+       demands them, so this pause covers the mark phase only. */
+    ctx->freelist = &nil;
+    ctx->gc_sweep_active = 1;
+    ctx->gc_sweep_cursor = 0;
+    ctx->gc_sweep_chunk = NULL;
+    ctx->gc_sweep_live = 0;
+    ctx->gc_sweep_reclaimed = 0;
+    ctx->allocs_since_gc = 0;
+    ctx->bytes_since_gc = 0;
+    ctx->gc_runs++;
+    gc_note_pause(ctx, pause_start);
+    return;
+  }
+
+  /* sweep and unmark: the embedded arena, then every on-demand chunk */
+  chunk = NULL;
+  slots = ctx->objects;
+  count = ctx->object_count;
+  for (;;) {
+    for (i = 0; i < count; i++) {
+      fe_Object *obj = &slots[i];
+      if (type(obj) == FE_TFREE) { continue; }
+      if (~tag(obj) & GCMARKBIT) {
+        free_object(ctx, obj);
+        reclaimed++;
+      } else {
+        tag(obj) &= ~GCMARKBIT;
+        live++; /* This object is alive */
       }
-      settype(obj, FE_TFREE);
-      cdr(obj) = ctx->freelist;
-      ctx->freelist = obj;
-    } else {
-      tag(obj) &= ~GCMARKBIT;
-      live++; /* This object is alive */
     }
+    chunk = chunk ? chunk->next : ctx->chunks;
+    if (!chunk) { break; }
+    slots = chunk->objects;
+    count = chunk->count;
   }
 
   fex_span_prune(ctx);
@@ -1756,11 +3398,18 @@ static void collectgarbage(fe_Context *ctx) {
   ctx->live_count = live;
   ctx->allocs_since_gc = 0;
   ctx->bytes_since_gc = 0;
-  ctx->gc_threshold = ctx->live_count * GC_GROWTH_FACTOR;
-  if (ctx->gc_threshold < GC_MIN_THRESHOLD) {
-    ctx->gc_threshold = GC_MIN_THRESHOLD;
+  ctx->gc_reclaimed_last = reclaimed;
+  ctx->gc_reclaimed_total += reclaimed;
+  if (ctx->gc_threshold_fixed > 0) {
+    ctx->gc_threshold = ctx->gc_threshold_fixed;
+  } else {
+    ctx->gc_threshold = ctx->live_count * GC_GROWTH_FACTOR;
+    if (ctx->gc_threshold < GC_MIN_THRESHOLD) {
+      ctx->gc_threshold = GC_MIN_THRESHOLD;
+    }
   }
   ctx->gc_runs++;
+  gc_note_pause(ctx, pause_start);
 }
 
 /* -------------------------------------------------------------------------
@@ -1806,6 +3455,22 @@ static int equal(fe_Context *ctx, fe_Object *a, fe_Object *b) {
   if (type(a) != type(b)) { return 0; }
   if (type(a) == FE_TNUMBER) { return nval(a) == nval(b); }
   if (type(a) == FE_TSTRING || type(a) == FE_TBYTES) {
+    if (type(a) == FE_TBYTES && (bytes_is_view(a) || bytes_is_view(b))) {
+      /* Views may start mid-slab, so compare through fe_bytescopy. */
+      size_t base, len_a, len_b, off = 0;
+      bytes_resolve(a, &base, &len_a);
+      bytes_resolve(b, &base, &len_b);
+      if (len_a != len_b) return 0;
+      while (off < len_a) {
+        char buf_a[128], buf_b[128];
+        size_t n = len_a - off < sizeof(buf_a) ? len_a - off : sizeof(buf_a);
+        fe_bytescopy(ctx, a, off, buf_a, n);
+        fe_bytescopy(ctx, b, off, buf_b, n);
+        if (memcmp(buf_a, buf_b, n) != 0) return 0;
+        off += n;
+      }
+      return 1;
+    }
     if (FE_STR_LEN(a) != FE_STR_LEN(b)) return 0;
 #ifdef FE_OPT_NO_MALLOC_STRINGS
     return equal_slab(ctx, a, b);
@@ -1847,6 +3512,40 @@ static int streq(fe_Context *ctx, fe_Object *obj, const char *str) {
 #endif
 }
 
+/* Lexicographic byte order between two string objects for the sort
+   builtins (fex_internal.h); walks slab chunks in place so no copy is
+   made. Returns -1, 0, or 1. */
+int fe_ctx_string_compare(fe_Context *ctx, fe_Object *a, fe_Object *b) {
+  size_t len_a = FE_STR_LEN(a);
+  size_t len_b = FE_STR_LEN(b);
+  size_t min_len = len_a < len_b ? len_a : len_b;
+  int cmp = 0;
+  if (a != b && min_len > 0) {
+#ifdef FE_OPT_NO_MALLOC_STRINGS
+    uint32_t offset_a = a->cdr.u32;
+    uint32_t offset_b = b->cdr.u32;
+    size_t remaining = min_len;
+    while (remaining > 0) {
+      fe_Slab *slab_a = (fe_Slab*)(ctx->str_base + offset_a);
+      fe_Slab *slab_b = (fe_Slab*)(ctx->str_base + offset_b);
+      size_t to_cmp = (remaining > FE_SLAB_DATA_SIZE) ? FE_SLAB_DATA_SIZE : remaining;
+      cmp = memcmp(slab_a->data, slab_b->data, to_cmp);
+      if (cmp != 0) { break; }
+      remaining -= to_cmp;
+      if (remaining > 0) {
+        offset_a = slab_a->next;
+        offset_b = slab_b->next;
+      }
+    }
+#else
+    cmp = memcmp(FE_STR_DATA(ctx, a), FE_STR_DATA(ctx, b), min_len);
+#endif
+  }
+  if (cmp != 0) { return cmp < 0 ? -1 : 1; }
+  if (len_a != len_b) { return len_a < len_b ? -1 : 1; }
+  return 0;
+}
+
 int fe_symbol_name_eq(fe_Context *ctx, fe_Object *sym, const char *str) {
   (void)ctx;
   if (type(sym) != FE_TSYMBOL) { return 0; }
@@ -1854,13 +3553,30 @@ int fe_symbol_name_eq(fe_Context *ctx, fe_Object *sym, const char *str) {
 }
 
 static fe_Object* normalize_map_key(fe_Context *ctx, fe_Object *key) {
+  if (FE_IS_FIXNUM(key)) {
+    return key;
+  }
   if (type(key) == FE_TSYMBOL) {
     return car(cdr(key));
   }
   if (type(key) == FE_TSTRING) {
     return key;
   }
-  fe_error(ctx, "map keys must be strings or symbols");
+  if (type(key) == FE_TNUMBER) {
+    /* Boxed doubles holding an integral value normalize to the fixnum
+       immediate, so 5 and 5.0 address the same slot. Mirrors the range
+       check in fe_make_number without allocating. */
+    fe_Number v = nval(key);
+    fe_Number iv = (fe_Number)(intptr_t)v;
+    if (v == iv) {
+      intptr_t i = (intptr_t)iv;
+      intptr_t shr = i >> (8*sizeof(intptr_t)-2);
+      if (shr == 0 || shr == -1) {
+        return FE_FIXNUM(i);
+      }
+    }
+  }
+  fe_error(ctx, "map keys must be strings, symbols, or integers");
   return &nil;
 }
 
@@ -1908,131 +3624,255 @@ static unsigned long hash_string_obj(fe_Context *ctx, fe_Object *obj) {
   return hash;
 }
 
+/* Fixnum keys hash straight from the immediate's tagged bits with a
+   Fibonacci multiply; no slab walk and no allocation. */
+static unsigned long hash_fixnum_key(fe_Object *key) {
+#if ULONG_MAX > 0xFFFFFFFFu
+  return (unsigned long)((uintptr_t)key * 11400714819323198485UL);
+#else
+  return (unsigned long)((uintptr_t)key * 2654435761u);
+#endif
+}
+
+static unsigned long map_key_hash(fe_Context *ctx, fe_Object *key) {
+  return FE_IS_FIXNUM(key) ? hash_fixnum_key(key) : hash_string_obj(ctx, key);
+}
+
+/* How far the entry in `slot` sits from its home slot. */
+static int map_probe_distance(unsigned long hash, int slot, int capacity) {
+  int mask = capacity - 1;
+  return (slot - (int)(hash & (unsigned long)mask) + capacity) & mask;
+}
+
+static int map_alloc_table(fe_Context *ctx, int capacity, fe_Object ***out_keys,
+                           fe_Object ***out_values,
+                           unsigned long **out_hashes) {
+  fe_Object **keys = tracked_alloc(ctx, sizeof(fe_Object*) * (size_t)capacity);
+  fe_Object **values = tracked_alloc(ctx, sizeof(fe_Object*) * (size_t)capacity);
+  unsigned long *hashes = tracked_alloc(ctx, sizeof(unsigned long) * (size_t)capacity);
+  if (!keys || !values || !hashes) {
+    tracked_free(ctx, keys);
+    tracked_free(ctx, values);
+    tracked_free(ctx, hashes);
+    return 0;
+  }
+  memset(keys, 0, sizeof(fe_Object*) * (size_t)capacity);
+  memset(values, 0, sizeof(fe_Object*) * (size_t)capacity);
+  memset(hashes, 0, sizeof(unsigned long) * (size_t)capacity);
+  *out_keys = keys;
+  *out_values = values;
+  *out_hashes = hashes;
+  return 1;
+}
+
 static fe_Map* map_alloc(fe_Context *ctx, int capacity) {
-  fe_Map *map;
-  map = tracked_alloc(ctx, sizeof(*map));
+  fe_Map *map = tracked_alloc(ctx, sizeof(*map));
   if (!map) {
     return NULL;
   }
-  map->count = 0;
-  map->used = 0;
+  memset(map, 0, sizeof(*map));
   map->capacity = capacity;
-  map->keys = tracked_alloc(ctx, sizeof(fe_Object*) * (size_t)capacity);
-  map->values = tracked_alloc(ctx, sizeof(fe_Object*) * (size_t)capacity);
-  map->states = tracked_alloc(ctx, sizeof(unsigned char) * (size_t)capacity);
-  if (!map->keys || !map->values || !map->states) {
-    tracked_free(ctx, map->keys);
-    tracked_free(ctx, map->values);
-    tracked_free(ctx, map->states);
+  if (!map_alloc_table(ctx, capacity, &map->keys, &map->values, &map->hashes)) {
     tracked_free(ctx, map);
     return NULL;
   }
-  memset(map->keys, 0, sizeof(fe_Object*) * capacity);
-  memset(map->values, 0, sizeof(fe_Object*) * capacity);
-  memset(map->states, 0, sizeof(unsigned char) * capacity);
   return map;
 }
 
-static int map_resize(fe_Context *ctx, fe_Map *map, int capacity) {
-  fe_Map *grown;
-  int i;
+/* Find `key` in one table, or -1. The cached hash makes the usual miss a
+   single integer compare per slot, and the robin-hood invariant bounds the
+   probe: once the resident entry sits closer to its home than the key
+   would, the key cannot be further along the chain. */
+static int map_table_find(fe_Context *ctx, fe_Object **keys,
+                          unsigned long *hashes, int capacity,
+                          fe_Object *key, unsigned long hash) {
+  int mask, slot, dist;
   size_t poll_countdown = FE_IO_ABORT_CHECK_INTERVAL;
 
-  grown = map_alloc(ctx, capacity);
-  if (!grown) {
-    return 0;
+  if (capacity <= 0) {
+    return -1;
   }
-
-  for (i = 0; i < map->capacity; i++) {
-    int found;
-    int slot;
+  mask = capacity - 1;
+  slot = (int)(hash & (unsigned long)mask);
+  for (dist = 0; dist <= mask; dist++) {
     const char *abort_msg = poll_io_abort(ctx, &poll_countdown);
     if (abort_msg != NULL) {
       fe_error(ctx, abort_msg);
     }
-    if (map->states[i] != MAP_USED) {
-      continue;
+    if (!keys[slot]) {
+      return -1;
     }
-    slot = map_find_slot(ctx, grown, map->keys[i], &found);
-    if (slot < 0) {
-      tracked_free(ctx, grown->keys);
-      tracked_free(ctx, grown->values);
-      tracked_free(ctx, grown->states);
-      tracked_free(ctx, grown);
-      return 0;
+    if (map_probe_distance(hashes[slot], slot, capacity) < dist) {
+      return -1;
+    }
+    /* Fixnum keys compare by identity: normalize_map_key() guarantees a
+       numeric key is always stored as its fixnum immediate. */
+    if (hashes[slot] == hash &&
+        (FE_IS_FIXNUM(key) ? keys[slot] == key : equal(ctx, keys[slot], key))) {
+      return slot;
     }
-    grown->states[slot] = MAP_USED;
-    grown->keys[slot] = map->keys[i];
-    grown->values[slot] = map->values[i];
-    grown->count++;
-    grown->used++;
+    slot = (slot + 1) & mask;
   }
+  return -1;
+}
 
-  tracked_free(ctx, map->keys);
-  tracked_free(ctx, map->values);
-  tracked_free(ctx, map->states);
-  map->keys = grown->keys;
-  map->values = grown->values;
-  map->states = grown->states;
-  map->count = grown->count;
-  map->used = grown->used;
-  map->capacity = grown->capacity;
-  tracked_free(ctx, grown);
-  return 1;
+/* Robin-hood insert of a key known to be absent; the table has room. A
+   rich entry (closer to home than the one being carried) is displaced and
+   the displaced entry carries on, which keeps probe sequences short. */
+static void map_table_insert(fe_Object **keys, fe_Object **values,
+                             unsigned long *hashes, int capacity,
+                             fe_Object *key, fe_Object *value,
+                             unsigned long hash) {
+  int mask = capacity - 1;
+  int slot = (int)(hash & (unsigned long)mask);
+  int dist = 0;
+  while (keys[slot]) {
+    int resident = map_probe_distance(hashes[slot], slot, capacity);
+    if (resident < dist) {
+      fe_Object *swap_key = keys[slot];
+      fe_Object *swap_value = values[slot];
+      unsigned long swap_hash = hashes[slot];
+      keys[slot] = key;
+      values[slot] = value;
+      hashes[slot] = hash;
+      key = swap_key;
+      value = swap_value;
+      hash = swap_hash;
+      dist = resident;
+    }
+    slot = (slot + 1) & mask;
+    dist++;
+  }
+  keys[slot] = key;
+  values[slot] = value;
+  hashes[slot] = hash;
 }
 
-static int map_ensure_capacity(fe_Context *ctx, fe_Map *map) {
-  int min_capacity = 8;
-  int target = map->capacity;
-  if (target < min_capacity) {
-    target = min_capacity;
+/* Backward-shift deletion: the cluster after `slot` moves one slot toward
+   home until an empty slot or a home-positioned entry, so no tombstones
+   accumulate and probe distances only shrink. */
+static void map_table_remove(fe_Object **keys, fe_Object **values,
+                             unsigned long *hashes, int capacity, int slot) {
+  int mask = capacity - 1;
+  for (;;) {
+    int next = (slot + 1) & mask;
+    if (!keys[next] || map_probe_distance(hashes[next], next, capacity) == 0) {
+      keys[slot] = NULL;
+      values[slot] = NULL;
+      return;
+    }
+    keys[slot] = keys[next];
+    values[slot] = values[next];
+    hashes[slot] = hashes[next];
+    slot = next;
   }
-  if ((map->used + 1) * 4 < target * 3) {
-    return 1;
+}
+
+static void map_drop_old_table(fe_Context *ctx, fe_Map *map) {
+  tracked_free(ctx, map->old_keys);
+  tracked_free(ctx, map->old_values);
+  tracked_free(ctx, map->old_hashes);
+  map->old_keys = NULL;
+  map->old_values = NULL;
+  map->old_hashes = NULL;
+  map->old_capacity = 0;
+  map->old_cursor = 0;
+  map->old_count = 0;
+}
+
+/* Old slots examined per map operation while a growth is draining. */
+#define MAP_MIGRATE_STEP 16
+
+/* Move a bounded batch of entries out of the draining table. Migrated
+   slots become ghosts (value NULLed, key and hash kept) so the old
+   table's probe chains stay intact for keys that have not moved yet. */
+static void map_migrate_step(fe_Context *ctx, fe_Map *map, int budget) {
+  if (!map->old_keys) {
+    return;
   }
-  while ((map->used + 1) * 4 >= target * 3) {
-    target *= 2;
+  while (budget-- > 0 && map->old_cursor < map->old_capacity &&
+         map->old_count > 0) {
+    int i = map->old_cursor++;
+    if (map->old_keys[i] && map->old_values[i]) {
+      map_table_insert(map->keys, map->values, map->hashes, map->capacity,
+                       map->old_keys[i], map->old_values[i],
+                       map->old_hashes[i]);
+      map->old_values[i] = NULL;
+      map->old_count--;
+    }
+  }
+  if (map->old_count == 0 || map->old_cursor >= map->old_capacity) {
+    map_drop_old_table(ctx, map);
   }
-  return map_resize(ctx, map, target);
 }
 
-static int map_find_slot(fe_Context *ctx, fe_Map *map, fe_Object *key, int *found) {
-  unsigned long hash;
-  int index;
-  int first_tombstone = -1;
-  int steps;
-  size_t poll_countdown = FE_IO_ABORT_CHECK_INTERVAL;
+/* Swap in a table sized for the next load-factor window and leave the
+   current arrays behind to drain; cached hashes mean migration never
+   re-hashes a key. */
+static int map_begin_growth(fe_Context *ctx, fe_Map *map) {
+  fe_Object **keys, **values;
+  unsigned long *hashes;
+  int target = map->capacity * 2;
 
-  *found = 0;
-  if (map->capacity <= 0) {
-    return -1;
+  /* A growth arriving while the previous one is still draining would
+     stack tables; finish the drain instead. The per-operation steps
+     retire an old table long before the doubled capacity refills, so
+     this backstop does not run in practice. */
+  while (map->old_keys) {
+    map_migrate_step(ctx, map, map->old_capacity);
+  }
+  while ((map->count + 1) * 4 >= target * 3) {
+    target *= 2;
   }
+  if (!map_alloc_table(ctx, target, &keys, &values, &hashes)) {
+    return 0;
+  }
+  map->old_keys = map->keys;
+  map->old_values = map->values;
+  map->old_hashes = map->hashes;
+  map->old_capacity = map->capacity;
+  map->old_cursor = 0;
+  map->old_count = map->count;
+  map->keys = keys;
+  map->values = values;
+  map->hashes = hashes;
+  map->capacity = target;
+  return 1;
+}
 
-  hash = hash_string_obj(ctx, key);
-  index = (int)(hash % (unsigned long)map->capacity);
+static int map_ensure_capacity(fe_Context *ctx, fe_Map *map) {
+  if ((map->count + 1) * 4 < map->capacity * 3) {
+    return 1;
+  }
+  return map_begin_growth(ctx, map);
+}
 
-  for (steps = 0; steps < map->capacity; steps++) {
-    int slot = (index + steps) % map->capacity;
-    const char *abort_msg = poll_io_abort(ctx, &poll_countdown);
-    if (abort_msg != NULL) {
-      fe_error(ctx, abort_msg);
-    }
-    if (map->states[slot] == MAP_EMPTY) {
-      return (first_tombstone >= 0) ? first_tombstone : slot;
-    }
-    if (map->states[slot] == MAP_TOMBSTONE) {
-      if (first_tombstone < 0) {
-        first_tombstone = slot;
-      }
-      continue;
+/* Walk every live entry: the active table first, then whatever has not
+   yet drained out of the old one.  `pos` starts at 0. */
+static int map_iter_next(fe_Map *map, int *pos, fe_Object **out_key,
+                         fe_Object **out_value) {
+  int i = *pos;
+  while (i < map->capacity) {
+    if (map->keys[i]) {
+      *out_key = map->keys[i];
+      *out_value = map->values[i];
+      *pos = i + 1;
+      return 1;
     }
-    if (equal(ctx, map->keys[slot], key)) {
-      *found = 1;
-      return slot;
+    i++;
+  }
+  while (i < map->capacity + map->old_capacity) {
+    int j = i - map->capacity;
+    if (map->old_keys[j] && map->old_values[j]) {
+      *out_key = map->old_keys[j];
+      *out_value = map->old_values[j];
+      *pos = i + 1;
+      return 1;
     }
+    i++;
   }
-
-  return first_tombstone;
+  *pos = i;
+  return 0;
 }
 
 fe_Object* fe_map(fe_Context *ctx) {
@@ -2049,12 +3889,12 @@ fe_Object* fe_map(fe_Context *ctx) {
 
 int fe_map_set(fe_Context *ctx, fe_Object *map_obj, fe_Object *key, fe_Object *value) {
   fe_Map *map;
-  int found;
+  unsigned long hash;
   int slot;
 
   checktype(ctx, map_obj, FE_TMAP);
   key = normalize_map_key(ctx, key);
-  if (type(key) != FE_TSTRING) {
+  if (!FE_IS_FIXNUM(key) && type(key) != FE_TSTRING) {
     return 0;
   }
 
@@ -2062,72 +3902,115 @@ int fe_map_set(fe_Context *ctx, fe_Object *map_obj, fe_Object *key, fe_Object *v
   if (!map_ensure_capacity(ctx, map)) {
     memory_error(ctx, "out of memory (map)");
   }
+  hash = map_key_hash(ctx, key);
+  map_migrate_step(ctx, map, MAP_MIGRATE_STEP);
 
-  slot = map_find_slot(ctx, map, key, &found);
-  if (slot < 0) {
-    memory_error(ctx, "out of memory (map)");
+  slot = map_table_find(ctx, map->keys, map->hashes, map->capacity, key, hash);
+  if (slot >= 0) {
+    map->values[slot] = value;
+    return 1;
   }
-  if (!found) {
-    if (map->states[slot] == MAP_EMPTY) {
-      map->used++;
+  if (map->old_keys) {
+    slot = map_table_find(ctx, map->old_keys, map->old_hashes,
+                          map->old_capacity, key, hash);
+    if (slot >= 0 && map->old_values[slot]) {
+      /* An updated key migrates on the spot, keeping the active table
+         authoritative for everything touched since the growth. */
+      map->old_values[slot] = NULL;
+      map->old_count--;
+      map_table_insert(map->keys, map->values, map->hashes, map->capacity,
+                       key, value, hash);
+      return 1;
     }
-    map->states[slot] = MAP_USED;
-    map->keys[slot] = key;
-    map->count++;
   }
-  map->values[slot] = value;
+  map_table_insert(map->keys, map->values, map->hashes, map->capacity,
+                   key, value, hash);
+  map->count++;
   return 1;
 }
 
 int fe_map_has(fe_Context *ctx, fe_Object *map_obj, fe_Object *key) {
   fe_Map *map;
-  int found;
+  unsigned long hash;
+  int slot;
   checktype(ctx, map_obj, FE_TMAP);
   key = normalize_map_key(ctx, key);
-  if (type(key) != FE_TSTRING) {
+  if (!FE_IS_FIXNUM(key) && type(key) != FE_TSTRING) {
     return 0;
   }
   map = mapdata(map_obj);
-  map_find_slot(ctx, map, key, &found);
-  return found;
+  hash = map_key_hash(ctx, key);
+  map_migrate_step(ctx, map, MAP_MIGRATE_STEP);
+  if (map_table_find(ctx, map->keys, map->hashes, map->capacity, key, hash) >= 0) {
+    return 1;
+  }
+  if (map->old_keys) {
+    slot = map_table_find(ctx, map->old_keys, map->old_hashes,
+                          map->old_capacity, key, hash);
+    return slot >= 0 && map->old_values[slot] != NULL;
+  }
+  return 0;
 }
 
 fe_Object* fe_map_get(fe_Context *ctx, fe_Object *map_obj, fe_Object *key) {
   fe_Map *map;
-  int found;
+  unsigned long hash;
   int slot;
   checktype(ctx, map_obj, FE_TMAP);
   key = normalize_map_key(ctx, key);
-  if (type(key) != FE_TSTRING) {
+  if (!FE_IS_FIXNUM(key) && type(key) != FE_TSTRING) {
     return &nil;
   }
   map = mapdata(map_obj);
-  slot = map_find_slot(ctx, map, key, &found);
-  if (!found || slot < 0) {
-    return &nil;
+  hash = map_key_hash(ctx, key);
+  map_migrate_step(ctx, map, MAP_MIGRATE_STEP);
+  slot = map_table_find(ctx, map->keys, map->hashes, map->capacity, key, hash);
+  if (slot >= 0) {
+    return map->values[slot];
+  }
+  if (map->old_keys) {
+    slot = map_table_find(ctx, map->old_keys, map->old_hashes,
+                          map->old_capacity, key, hash);
+    if (slot >= 0 && map->old_values[slot]) {
+      return map->old_values[slot];
+    }
   }
-  return map->values[slot];
+  return &nil;
 }
 
 int fe_map_delete(fe_Context *ctx, fe_Object *map_obj, fe_Object *key) {
   fe_Map *map;
-  int found;
+  unsigned long hash;
   int slot;
   checktype(ctx, map_obj, FE_TMAP);
   key = normalize_map_key(ctx, key);
-  if (type(key) != FE_TSTRING) {
+  if (!FE_IS_FIXNUM(key) && type(key) != FE_TSTRING) {
     return 0;
   }
   map = mapdata(map_obj);
-  slot = map_find_slot(ctx, map, key, &found);
-  if (!found || slot < 0) {
-    return 0;
+  hash = map_key_hash(ctx, key);
+  map_migrate_step(ctx, map, MAP_MIGRATE_STEP);
+  slot = map_table_find(ctx, map->keys, map->hashes, map->capacity, key, hash);
+  if (slot >= 0) {
+    map_table_remove(map->keys, map->values, map->hashes, map->capacity, slot);
+    map->count--;
+    return 1;
   }
-  map->states[slot] = MAP_TOMBSTONE;
-  map->keys[slot] = NULL;
-  map->values[slot] = NULL;
-  map->count--;
-  return 1;
+  if (map->old_keys) {
+    slot = map_table_find(ctx, map->old_keys, map->old_hashes,
+                          map->old_capacity, key, hash);
+    if (slot >= 0 && map->old_values[slot]) {
+      /* Ghost the slot like a migration would; the chain stays intact. */
+      map->old_values[slot] = NULL;
+      map->old_count--;
+      map->count--;
+      if (map->old_count == 0) {
+        map_drop_old_table(ctx, map);
+      }
+      return 1;
+    }
+  }
+  return 0;
 }
 
 int fe_map_count(fe_Context *ctx, fe_Object *map_obj) {
@@ -2148,33 +4031,172 @@ fe_Object* fe_map_keys(fe_Context *ctx, fe_Object *map_obj) {
   fe_pushgc(ctx, map_obj);
   fe_pushgc(ctx, result);
   map = mapdata(map_obj);
-  for (i = map->capacity - 1; i >= 0; i--) {
-    const char *abort_msg = poll_io_abort(ctx, &poll_countdown);
-    if (abort_msg != NULL) {
-      fe_error(ctx, abort_msg);
-    }
-    if (map->states[i] == MAP_USED) {
+  i = 0;
+  {
+    fe_Object *key, *value;
+    while (map_iter_next(map, &i, &key, &value)) {
+      const char *abort_msg = poll_io_abort(ctx, &poll_countdown);
+      if (abort_msg != NULL) {
+        fe_error(ctx, abort_msg);
+      }
       fe_restoregc(ctx, gc_save);
       fe_pushgc(ctx, map_obj);
       fe_pushgc(ctx, result);
-      result = fe_cons(ctx, map->keys[i], result);
+      result = fe_cons(ctx, key, result);
     }
   }
   fe_restoregc(ctx, gc_save);
   return result;
 }
 
+static fe_Array* array_alloc(fe_Context *ctx, int capacity) {
+  fe_Array *arr;
+  arr = tracked_alloc(ctx, sizeof(*arr));
+  if (!arr) {
+    return NULL;
+  }
+  arr->count = 0;
+  arr->capacity = capacity;
+  arr->items = tracked_alloc(ctx, sizeof(fe_Object*) * (size_t)capacity);
+  if (!arr->items) {
+    tracked_free(ctx, arr);
+    return NULL;
+  }
+  return arr;
+}
+
+fe_Object* fe_array(fe_Context *ctx) {
+  fe_Object *obj = object(ctx);
+  fe_Array *arr = array_alloc(ctx, 8);
+  if (!arr) {
+    memory_error(ctx, "out of memory (array)");
+  }
+  settype(obj, FE_TARRAY);
+  car(obj) = &nil;
+  obj->cdr.p = arr;
+  return obj;
+}
+
+int fe_array_count(fe_Context *ctx, fe_Object *arr_obj) {
+  checktype(ctx, arr_obj, FE_TARRAY);
+  return arraydata(arr_obj)->count;
+}
+
+void fe_array_push(fe_Context *ctx, fe_Object *arr_obj, fe_Object *value) {
+  fe_Array *arr;
+  checktype(ctx, arr_obj, FE_TARRAY);
+  arr = arraydata(arr_obj);
+  if (arr->count == arr->capacity) {
+    int grown_capacity = arr->capacity * 2;
+    fe_Object **grown;
+    if (grown_capacity <= arr->capacity) {
+      memory_error(ctx, "out of memory (array)");
+    }
+    grown = tracked_realloc(ctx, arr->items,
+                            sizeof(fe_Object*) * (size_t)grown_capacity);
+    if (!grown) {
+      memory_error(ctx, "out of memory (array)");
+    }
+    arr->items = grown;
+    arr->capacity = grown_capacity;
+  }
+  arr->items[arr->count++] = value;
+}
+
+fe_Object* fe_array_get(fe_Context *ctx, fe_Object *arr_obj, int index) {
+  fe_Array *arr;
+  checktype(ctx, arr_obj, FE_TARRAY);
+  arr = arraydata(arr_obj);
+  if (index < 0 || index >= arr->count) {
+    return &nil;
+  }
+  return arr->items[index];
+}
+
+int fe_array_set(fe_Context *ctx, fe_Object *arr_obj, int index, fe_Object *value) {
+  fe_Array *arr;
+  checktype(ctx, arr_obj, FE_TARRAY);
+  arr = arraydata(arr_obj);
+  if (index < 0 || index >= arr->count) {
+    return 0;
+  }
+  arr->items[index] = value;
+  return 1;
+}
+
+
+/* Add an object chunk to the growable arena and link its slots onto the
+   freelist.  Tries to double the current capacity, falling back to a
+   minimum-sized chunk when the memory limit leaves less headroom; both
+   allocations go through tracked_alloc() so fe_set_memory_limit() caps
+   growth.  Must not be called while a deferred sweep is active: the
+   sweep would visit the fresh FE_TFREE slots and relink them a second
+   time.  Returns non-zero on success. */
+static int arena_add_chunk(fe_Context *ctx) {
+  int total = ctx->object_count + ctx->chunk_object_count;
+  int grow = (total <= INT_MAX / 2) ? total : 0;
+  fe_ObjectChunk *chunk;
+  int i;
+
+  if (grow < GC_MIN_THRESHOLD) { grow = GC_MIN_THRESHOLD; }
+  chunk = tracked_alloc(ctx, sizeof(*chunk));
+  if (!chunk) { return 0; }
+  chunk->objects = tracked_alloc(ctx, (size_t)grow * sizeof(fe_Object));
+  if (!chunk->objects && grow > GC_MIN_THRESHOLD) {
+    grow = GC_MIN_THRESHOLD;
+    chunk->objects = tracked_alloc(ctx, (size_t)grow * sizeof(fe_Object));
+  }
+  if (!chunk->objects) {
+    tracked_free(ctx, chunk);
+    return 0;
+  }
+  chunk->count = grow;
+  chunk->next = ctx->chunks;
+  ctx->chunks = chunk;
+  ctx->chunk_object_count += grow;
+  for (i = 0; i < grow; i++) {
+    fe_Object *obj = &chunk->objects[i];
+    settype(obj, FE_TFREE);
+    cdr(obj) = ctx->freelist;
+    ctx->freelist = obj;
+  }
+  return 1;
+}
 
 static fe_Object* object(fe_Context *ctx) {
   fe_Object *obj;
 
   /* --- GC trigger logic --- */
   /* Trigger GC if object count or byte count exceeds the threshold,
-   * or as a fallback if the freelist is empty. */
-  if (ctx->allocs_since_gc >= ctx->gc_threshold ||
-      ctx->bytes_since_gc >= ctx->byte_threshold ||
-      isnil(ctx->freelist)) {
+   * or as a fallback if the freelist is empty. fe_gc_defer() suspends
+   * only the threshold triggers; the empty-freelist fallback below still
+   * collects so a deferred burst cannot exhaust the arena outright. */
+  if (ctx->gc_defer_depth == 0 &&
+      (ctx->allocs_since_gc >= ctx->gc_threshold ||
+       ctx->bytes_since_gc >= ctx->byte_threshold)) {
     collectgarbage(ctx);
+  } else if (ctx->gc_sweep_active) {
+    /* Incremental mode: pay for this allocation with a sweep slice. */
+    gc_sweep_step(ctx, GC_SWEEP_SLICE);
+  }
+  while (isnil(ctx->freelist) && ctx->gc_sweep_active) {
+    gc_sweep_step(ctx, GC_SWEEP_SLICE);
+  }
+  if (isnil(ctx->freelist)) {
+    collectgarbage(ctx);
+    while (isnil(ctx->freelist) && ctx->gc_sweep_active) {
+      gc_sweep_step(ctx, GC_SWEEP_SLICE);
+    }
+    /* Growable mode: add a chunk instead of failing, and also when the
+       arena is over half full after collecting, so a nearly-full arena
+       does not degenerate into a full collection per allocation.  The
+       loops above drained the deferred sweep before the freelist could
+       come up empty, so no sweep is active here. */
+    if (ctx->arena_growable && !ctx->gc_sweep_active &&
+        (isnil(ctx->freelist) ||
+         ctx->live_count > (ctx->object_count + ctx->chunk_object_count) / 2)) {
+      arena_add_chunk(ctx);
+    }
     if (isnil(ctx->freelist)) { fe_error(ctx, "out of memory"); }
   }
 
@@ -2326,18 +4348,136 @@ fe_Object* fe_bytes_raw(fe_Context *ctx, size_t len, unsigned char fill_byte)
     return make_data_obj(ctx, FE_TBYTES, NULL, len, (char)fill_byte);
 }
 
+fe_Object* fe_bytes_slice(fe_Context *ctx, fe_Object *obj, size_t offset, size_t len)
+{
+    fe_Object *owner, *range, *view;
+    size_t base, total;
+    int gc = fe_savegc(ctx);
+
+    owner = bytes_resolve(checktype(ctx, obj, FE_TBYTES), &base, &total);
+    if (offset > total) { offset = total; }
+    if (len > total - offset) { len = total - offset; }
+
+    range = fe_cons(ctx, FE_FIXNUM((intptr_t)(base + offset)),
+                         FE_FIXNUM((intptr_t)len));
+    view = object(ctx);
+    settype(view, FE_TBYTES);
+    car(view) = owner;
+    cdr(view) = range;
+    fe_restoregc(ctx, gc);
+    fe_pushgc(ctx, view);
+    return view;
+}
+
+/* -------------------------------------------------------------------------
+ * Symbol interning
+ *
+ * Symbols live on ctx->symlist, which the GC marks as a root, so interned
+ * symbols are never collected.  Lookup goes through an open-addressing
+ * hash index (insert-only, power-of-two capacity, linear probing) instead
+ * of scanning the symlist cons chain on every fe_symbol() call.
+ *
+ * The index is built lazily once the symbol count passes a threshold:
+ * fe_open() must not make tracked allocations (and a handful of symbols
+ * scan quickly anyway), so small contexts keep the plain list walk.
+ * ---------------------------------------------------------------------- */
+
+#define SYMTAB_MIN_CAPACITY 64
+#define SYMTAB_BUILD_THRESHOLD 48
+
+/* FNV-1a over a C string; must match hash_string_obj so lookups by name
+   and by string object agree. */
+static unsigned long hash_cstring(const char *str) {
+#if ULONG_MAX > 0xFFFFFFFFu
+  unsigned long hash = 14695981039346656037UL;
+  #define FNV_PRIME 1099511628211UL
+#else
+  unsigned long hash = 2166136261u;
+  #define FNV_PRIME 16777619u
+#endif
+  const unsigned char *p = (const unsigned char*)str;
+  while (*p) {
+    hash ^= *p++;
+    hash *= FNV_PRIME;
+  }
+#undef FNV_PRIME
+  return hash;
+}
+
+static void symtab_insert(fe_Context *ctx, fe_Object *sym, unsigned long hash);
+
+static void symtab_grow(fe_Context *ctx) {
+  fe_Object **old = ctx->symtab;
+  int old_capacity = ctx->symtab_capacity;
+  int new_capacity = old_capacity ? old_capacity * 2 : SYMTAB_MIN_CAPACITY;
+  fe_Object **grown;
+  int i;
+
+  grown = tracked_alloc(ctx, sizeof(*grown) * (size_t)new_capacity);
+  if (!grown) { memory_error(ctx, "out of memory (symbol table)"); }
+  memset(grown, 0, sizeof(*grown) * (size_t)new_capacity);
+  ctx->symtab = grown;
+  ctx->symtab_capacity = new_capacity;
+  ctx->symtab_count = 0;
+  for (i = 0; i < old_capacity; i++) {
+    if (old[i] != NULL) {
+      symtab_insert(ctx, old[i], hash_string_obj(ctx, car(cdr(old[i]))));
+    }
+  }
+  tracked_free(ctx, old);
+}
+
+static void symtab_insert(fe_Context *ctx, fe_Object *sym, unsigned long hash) {
+  unsigned long mask, i;
+  if (ctx->symtab_count + 1 > (ctx->symtab_capacity / 4) * 3) {
+    symtab_grow(ctx);
+  }
+  mask = (unsigned long)ctx->symtab_capacity - 1;
+  i = hash & mask;
+  while (ctx->symtab[i] != NULL) { i = (i + 1) & mask; }
+  ctx->symtab[i] = sym;
+  ctx->symtab_count++;
+}
+
+/* Index every symbol already on the symlist; called once the list walk
+   stops being cheap. */
+static void symtab_build(fe_Context *ctx) {
+  fe_Object *obj;
+  for (obj = ctx->symlist; !isnil(obj); obj = cdr(obj)) {
+    symtab_insert(ctx, car(obj), hash_string_obj(ctx, car(cdr(car(obj)))));
+  }
+}
+
 static fe_Object* fe_symbol_from_string_obj(fe_Context *ctx, fe_Object *name_obj) {
   fe_Object *obj;
+  unsigned long hash;
   int gc_save;
 
   checktype(ctx, name_obj, FE_TSTRING);
   gc_save = fe_savegc(ctx);
   fe_pushgc(ctx, name_obj);
 
-  for (obj = ctx->symlist; !isnil(obj); obj = cdr(obj)) {
-    if (equal(ctx, car(cdr(car(obj))), name_obj)) {
-      fe_restoregc(ctx, gc_save);
-      return car(obj);
+  hash = hash_string_obj(ctx, name_obj);
+  if (ctx->symtab_capacity > 0) {
+    unsigned long mask = (unsigned long)ctx->symtab_capacity - 1;
+    unsigned long i = hash & mask;
+    const char *abort_msg = poll_eval_abort(ctx, 0);
+    if (abort_msg != NULL) {
+      fe_error(ctx, abort_msg);
+    }
+    while (ctx->symtab[i] != NULL) {
+      if (equal(ctx, car(cdr(ctx->symtab[i])), name_obj)) {
+        fe_restoregc(ctx, gc_save);
+        return ctx->symtab[i];
+      }
+      i = (i + 1) & mask;
+    }
+  } else {
+    for (obj = ctx->symlist; !isnil(obj); obj = cdr(obj)) {
+      if (equal(ctx, car(cdr(car(obj))), name_obj)) {
+        fe_restoregc(ctx, gc_save);
+        return car(obj);
+      }
     }
   }
 
@@ -2345,6 +4485,12 @@ static fe_Object* fe_symbol_from_string_obj(fe_Context *ctx, fe_Object *name_obj
   settype(obj, FE_TSYMBOL);
   cdr(obj) = fe_cons(ctx, name_obj, &nil);
   ctx->symlist = fe_cons(ctx, obj, ctx->symlist);
+  ctx->symlist_len++;
+  if (ctx->symtab_capacity > 0) {
+    symtab_insert(ctx, obj, hash);
+  } else if (ctx->symlist_len >= SYMTAB_BUILD_THRESHOLD) {
+    symtab_build(ctx);
+  }
   fe_restoregc(ctx, gc_save);
   return obj;
 }
@@ -2352,22 +4498,45 @@ static fe_Object* fe_symbol_from_string_obj(fe_Context *ctx, fe_Object *name_obj
 
 fe_Object* fe_symbol(fe_Context *ctx, const char *name) {
   fe_Object *obj;
-  size_t poll_countdown = FE_IO_ABORT_CHECK_INTERVAL;
-  /* try to find in symlist */
-  for (obj = ctx->symlist; !isnil(obj); obj = cdr(obj)) {
-    const char *abort_msg = poll_io_abort(ctx, &poll_countdown);
+  unsigned long hash = hash_cstring(name);
+
+  if (ctx->symtab_capacity > 0) {
+    unsigned long mask = (unsigned long)ctx->symtab_capacity - 1;
+    unsigned long i = hash & mask;
+    /* the list walk polled per element; keep interning interruptible */
+    const char *abort_msg = poll_eval_abort(ctx, 0);
     if (abort_msg != NULL) {
       fe_error(ctx, abort_msg);
     }
-    if (streq(ctx, car(cdr(car(obj))), name)) {
-      return car(obj);
+    while (ctx->symtab[i] != NULL) {
+      if (streq(ctx, car(cdr(ctx->symtab[i])), name)) {
+        return ctx->symtab[i];
+      }
+      i = (i + 1) & mask;
+    }
+  } else {
+    size_t poll_countdown = FE_IO_ABORT_CHECK_INTERVAL;
+    for (obj = ctx->symlist; !isnil(obj); obj = cdr(obj)) {
+      const char *abort_msg = poll_io_abort(ctx, &poll_countdown);
+      if (abort_msg != NULL) {
+        fe_error(ctx, abort_msg);
+      }
+      if (streq(ctx, car(cdr(car(obj))), name)) {
+        return car(obj);
+      }
     }
   }
-  /* create new object, push to symlist and return */
+  /* create new object, push to symlist and index it */
   obj = object(ctx);
   settype(obj, FE_TSYMBOL);
   cdr(obj) = fe_cons(ctx, fe_string(ctx, name, strlen(name)), &nil);
   ctx->symlist = fe_cons(ctx, obj, ctx->symlist);
+  ctx->symlist_len++;
+  if (ctx->symtab_capacity > 0) {
+    symtab_insert(ctx, obj, hash);
+  } else if (ctx->symlist_len >= SYMTAB_BUILD_THRESHOLD) {
+    symtab_build(ctx);
+  }
   return obj;
 }
 
@@ -2413,82 +4582,201 @@ fe_Object** fe_cdr_ptr(fe_Context *ctx, fe_Object *obj) {
   return &cdr(checktype(ctx, obj, FE_TPAIR));
 }
 
-static void write_checked(fe_Context *ctx, fe_WriteFn fn, void *udata, char chr,
-                          size_t *countdown) {
-  const char *abort_msg = poll_io_abort(ctx, countdown);
+/* Output sink for the writer below: either a legacy per-character
+ * callback, or a block callback fed from a stack buffer so large values
+ * flush in chunks instead of one callback per byte. */
+#define FE_WRITE_BUFFER_SIZE 512
+
+typedef struct {
+  fe_WriteFn chr_fn;        /* per-character sink (legacy fe_write path) */
+  fe_WriteBlockFn block_fn; /* block sink; batched through buf */
+  void *udata;
+  size_t len;
+  size_t poll_countdown;
+  char buf[FE_WRITE_BUFFER_SIZE];
+} fe_Writer;
+
+static void writer_init(fe_Writer *w, fe_WriteFn chr_fn,
+                        fe_WriteBlockFn block_fn, void *udata) {
+  w->chr_fn = chr_fn;
+  w->block_fn = block_fn;
+  w->udata = udata;
+  w->len = 0;
+  w->poll_countdown = FE_IO_ABORT_CHECK_INTERVAL;
+}
+
+static void writer_flush(fe_Context *ctx, fe_Writer *w) {
+  if (w->block_fn && w->len > 0) {
+    w->block_fn(ctx, w->udata, w->buf, w->len);
+    w->len = 0;
+  }
+}
+
+/* Keeps the per-character abort cadence: every emitted byte counts
+ * against the countdown even when bytes land in one block. Flushes
+ * before raising so already-produced output is not lost. */
+static void writer_poll(fe_Context *ctx, fe_Writer *w, size_t emitted) {
+  const char *abort_msg;
+  if (w->poll_countdown > emitted) {
+    w->poll_countdown -= emitted;
+    return;
+  }
+  w->poll_countdown = FE_IO_ABORT_CHECK_INTERVAL;
+  abort_msg = fe_poll_abort(ctx);
   if (abort_msg != NULL) {
+    writer_flush(ctx, w);
     fe_error(ctx, abort_msg);
   }
-  fn(ctx, udata, chr);
 }
 
-static void writestr(fe_Context *ctx, fe_WriteFn fn, void *udata, const char *s,
-                     size_t *countdown) {
-  while (*s) {
-    write_checked(ctx, fn, udata, *s++, countdown);
+static void writer_write(fe_Context *ctx, fe_Writer *w, const char *s, size_t n) {
+  writer_poll(ctx, w, n);
+  if (w->block_fn) {
+    if (n >= FE_WRITE_BUFFER_SIZE) {
+      /* Oversized payloads bypass the buffer entirely. */
+      writer_flush(ctx, w);
+      w->block_fn(ctx, w->udata, s, n);
+      return;
+    }
+    if (w->len + n > FE_WRITE_BUFFER_SIZE) {
+      writer_flush(ctx, w);
+    }
+    memcpy(w->buf + w->len, s, n);
+    w->len += n;
+  } else {
+    size_t i;
+    for (i = 0; i < n; i++) {
+      w->chr_fn(ctx, w->udata, s[i]);
+    }
+  }
+}
+
+static void writer_putc(fe_Context *ctx, fe_Writer *w, char chr) {
+  writer_write(ctx, w, &chr, 1);
+}
+
+static void writer_puts(fe_Context *ctx, fe_Writer *w, const char *s) {
+  writer_write(ctx, w, s, strlen(s));
+}
+
+/*
+ * Fast number formatting. Fixnums are emitted two digits per step from a
+ * lookup table instead of going through snprintf; number-heavy output
+ * spends most of its time here. Boxed doubles use the shortest decimal
+ * form that parses back to exactly the same value, found by escalating
+ * %g precision from the 15 digits that suffice for almost every double
+ * to the 17 that always round-trip.
+ */
+
+static const char digit_pairs[] =
+  "00010203040506070809"
+  "10111213141516171819"
+  "20212223242526272829"
+  "30313233343536373839"
+  "40414243444546474849"
+  "50515253545556575859"
+  "60616263646566676869"
+  "70717273747576777879"
+  "80818283848586878889"
+  "90919293949596979899";
+
+size_t fe_format_fixnum(char *buf, intptr_t value) {
+  char tmp[24];
+  char *p = tmp + sizeof(tmp);
+  /* negate via unsigned magnitude so INTPTR_MIN stays defined */
+  uintptr_t mag = (value < 0) ? ~(uintptr_t)value + 1u : (uintptr_t)value;
+  size_t len;
+
+  while (mag >= 100) {
+    const char *pair = digit_pairs + (mag % 100) * 2;
+    *--p = pair[1];
+    *--p = pair[0];
+    mag /= 100;
+  }
+  if (mag >= 10) {
+    const char *pair = digit_pairs + mag * 2;
+    *--p = pair[1];
+    *--p = pair[0];
+  } else {
+    *--p = (char)('0' + (int)mag);
+  }
+  if (value < 0) { *--p = '-'; }
+  len = (size_t)(tmp + sizeof(tmp) - p);
+  memcpy(buf, p, len);
+  buf[len] = '\0';
+  return len;
+}
+
+size_t fe_format_double(char *buf, size_t cap, double value) {
+  int prec, n;
+  for (prec = 15; prec < 17; prec++) {
+    n = snprintf(buf, cap, "%.*g", prec, value);
+    if (n > 0 && (size_t)n < cap && strtod(buf, NULL) == value) {
+      return (size_t)n;
+    }
   }
+  n = snprintf(buf, cap, "%.17g", value);
+  return (n > 0 && (size_t)n < cap) ? (size_t)n : 0;
 }
 
-static void write_hex_byte(fe_Context *ctx, fe_WriteFn fn, void *udata,
-                           unsigned char byte, size_t *countdown) {
+static void write_hex_byte(fe_Context *ctx, fe_Writer *w, unsigned char byte) {
   static const char hexdigits[] = "0123456789abcdef";
-  write_checked(ctx, fn, udata, hexdigits[(byte >> 4) & 0x0f], countdown);
-  write_checked(ctx, fn, udata, hexdigits[byte & 0x0f], countdown);
+  char pair[2];
+  pair[0] = hexdigits[(byte >> 4) & 0x0f];
+  pair[1] = hexdigits[byte & 0x0f];
+  writer_write(ctx, w, pair, 2);
 }
 
-void fe_write(fe_Context *ctx, fe_Object *obj, fe_WriteFn fn, void *udata, int qt) {
+static void write_obj(fe_Context *ctx, fe_Writer *w, fe_Object *obj, int qt) {
   char buf[32];
-  size_t poll_countdown = FE_IO_ABORT_CHECK_INTERVAL;
-  const char *abort_msg;
 
   switch (type(obj)) {
     case FE_TNIL:
-      writestr(ctx, fn, udata, "nil", &poll_countdown);
+      writer_puts(ctx, w, "nil");
       break;
 
     case FE_TBOOLEAN:
-      writestr(ctx, fn, udata, (obj == FE_TRUE) ? "true" : "false", &poll_countdown);
+      writer_puts(ctx, w, (obj == FE_TRUE) ? "true" : "false");
       break;
 
-    case FE_TNUMBER:
+    case FE_TNUMBER: {
+      size_t len;
       if (FE_IS_FIXNUM(obj)) {
-          snprintf(buf, sizeof(buf), "%" PRIdMAX, (intmax_t)FE_UNBOX_FIXNUM(obj));
+          len = fe_format_fixnum(buf, FE_UNBOX_FIXNUM(obj));
       } else {
-          snprintf(buf, sizeof(buf), "%.7g", number(obj));
+          len = fe_format_double(buf, sizeof(buf), number(obj));
       }
-      writestr(ctx, fn, udata, buf, &poll_countdown);
+      writer_write(ctx, w, buf, len);
       break;
+    }
 
     case FE_TPAIR:
       if (car(obj) == ctx->frame_sym) {
-        writestr(ctx, fn, udata, "[env frame]", &poll_countdown);
+        writer_puts(ctx, w, "[env frame]");
         break;
       }
 
-      write_checked(ctx, fn, udata, '(', &poll_countdown);
+      writer_putc(ctx, w, '(');
       for (;;) {
-        abort_msg = poll_io_abort(ctx, &poll_countdown);
-        if (abort_msg != NULL) {
-          fe_error(ctx, abort_msg);
-        }
-        fe_write(ctx, car(obj), fn, udata, 1);
+        writer_poll(ctx, w, 1);
+        write_obj(ctx, w, car(obj), 1);
         obj = cdr(obj);
         if (type(obj) != FE_TPAIR) { break; }
-        write_checked(ctx, fn, udata, ' ', &poll_countdown);
+        writer_putc(ctx, w, ' ');
       }
       if (!isnil(obj)) {
-        writestr(ctx, fn, udata, " . ", &poll_countdown);
-        fe_write(ctx, obj, fn, udata, 1);
+        writer_puts(ctx, w, " . ");
+        write_obj(ctx, w, obj, 1);
       }
-      write_checked(ctx, fn, udata, ')', &poll_countdown);
+      writer_putc(ctx, w, ')');
       break;
 
     case FE_TSYMBOL:
-      fe_write(ctx, car(cdr(obj)), fn, udata, 0);
+      write_obj(ctx, w, car(cdr(obj)), 0);
       break;
 
     case FE_TSTRING:
-      if (qt) write_checked(ctx, fn, udata, '"', &poll_countdown);
+      if (qt) writer_putc(ctx, w, '"');
 #ifdef FE_OPT_NO_MALLOC_STRINGS
       {
           size_t len = FE_STR_LEN(obj);
@@ -2498,12 +4786,16 @@ void fe_write(fe_Context *ctx, fe_Object *obj, fe_WriteFn fn, void *udata, int q
               while (offset != FE_SLAB_NULL && remaining > 0) {
                   fe_Slab *slab = (fe_Slab*)(ctx->str_base + offset);
                   size_t to_write = (remaining > FE_SLAB_DATA_SIZE) ? FE_SLAB_DATA_SIZE : remaining;
-                  size_t i;
+                  size_t i, run = 0;
+                  /* emit unescaped runs in one go, breaking only on quotes */
                   for (i = 0; i < to_write; i++) {
-                      char c = slab->data[i];
-                      if (qt && c == '"') write_checked(ctx, fn, udata, '\\', &poll_countdown);
-                      write_checked(ctx, fn, udata, c, &poll_countdown);
+                      if (qt && slab->data[i] == '"') {
+                          if (i > run) writer_write(ctx, w, slab->data + run, i - run);
+                          writer_write(ctx, w, "\\\"", 2);
+                          run = i + 1;
+                      }
                   }
+                  if (to_write > run) writer_write(ctx, w, slab->data + run, to_write - run);
                   remaining -= to_write;
                   offset = slab->next;
               }
@@ -2513,111 +4805,134 @@ void fe_write(fe_Context *ctx, fe_Object *obj, fe_WriteFn fn, void *udata, int q
       {
           const char *p = FE_STR_DATA(ctx, obj);
           size_t len = FE_STR_LEN(obj);
-          size_t i;
+          size_t i, run = 0;
+          /* emit unescaped runs in one go, breaking only on quotes */
           for (i = 0; i < len; i++) {
-              if (qt && p[i] == '"') write_checked(ctx, fn, udata, '\\', &poll_countdown);
-              write_checked(ctx, fn, udata, p[i], &poll_countdown);
+              if (qt && p[i] == '"') {
+                  if (i > run) writer_write(ctx, w, p + run, i - run);
+                  writer_write(ctx, w, "\\\"", 2);
+                  run = i + 1;
+              }
           }
+          if (len > run) writer_write(ctx, w, p + run, len - run);
       }
 #endif
-      if (qt) write_checked(ctx, fn, udata, '"', &poll_countdown);
+      if (qt) writer_putc(ctx, w, '"');
       break;
 
     case FE_TBYTES:
-      writestr(ctx, fn, udata, "#bytes[", &poll_countdown);
-#ifdef FE_OPT_NO_MALLOC_STRINGS
+      writer_puts(ctx, w, "#bytes[");
       {
-          size_t len = FE_STR_LEN(obj);
-          if (len > 0) {
-              uint32_t offset = obj->cdr.u32;
-              size_t remaining = len;
-              int first = 1;
-              while (offset != FE_SLAB_NULL && remaining > 0) {
-                  fe_Slab *slab = (fe_Slab*)(ctx->str_base + offset);
-                  size_t to_write = (remaining > FE_SLAB_DATA_SIZE) ? FE_SLAB_DATA_SIZE : remaining;
-                  size_t i;
-                  for (i = 0; i < to_write; i++) {
-                      if (!first) write_checked(ctx, fn, udata, ' ', &poll_countdown);
-                      write_hex_byte(ctx, fn, udata, (unsigned char)slab->data[i], &poll_countdown);
-                      first = 0;
-                  }
-                  remaining -= to_write;
-                  offset = slab->next;
+          /* Copy through fe_bytescopy so slice views print transparently. */
+          size_t len = fe_byteslen(ctx, obj);
+          size_t off = 0;
+          while (off < len) {
+              unsigned char buf[128];
+              size_t n = len - off < sizeof(buf) ? len - off : sizeof(buf);
+              size_t i;
+              fe_bytescopy(ctx, obj, off, buf, n);
+              for (i = 0; i < n; i++) {
+                  if (off + i > 0) writer_putc(ctx, w, ' ');
+                  write_hex_byte(ctx, w, buf[i]);
               }
+              off += n;
           }
       }
-#else
-      {
-          size_t len = FE_STR_LEN(obj);
-          size_t i;
-          const unsigned char *p = (const unsigned char*)FE_STR_DATA(ctx, obj);
-          for (i = 0; i < len; i++) {
-              if (i > 0) write_checked(ctx, fn, udata, ' ', &poll_countdown);
-              write_hex_byte(ctx, fn, udata, p[i], &poll_countdown);
-          }
-      }
-#endif
-      write_checked(ctx, fn, udata, ']', &poll_countdown);
+      writer_putc(ctx, w, ']');
       break;
 
     case FE_TMAP: {
       fe_Map *map = mapdata(obj);
-      int i;
       int first = 1;
-      write_checked(ctx, fn, udata, '{', &poll_countdown);
+      writer_putc(ctx, w, '{');
       if (map) {
-        for (i = 0; i < map->capacity; i++) {
-          abort_msg = poll_io_abort(ctx, &poll_countdown);
-          if (abort_msg != NULL) {
-            fe_error(ctx, abort_msg);
-          }
-          if (map->states[i] != MAP_USED) {
-            continue;
-          }
+        int pos = 0;
+        fe_Object *key, *value;
+        while (map_iter_next(map, &pos, &key, &value)) {
+          writer_poll(ctx, w, 1);
           if (!first) {
-            writestr(ctx, fn, udata, ", ", &poll_countdown);
+            writer_puts(ctx, w, ", ");
           }
-          fe_write(ctx, map->keys[i], fn, udata, 1);
-          writestr(ctx, fn, udata, ": ", &poll_countdown);
-          fe_write(ctx, map->values[i], fn, udata, 1);
+          write_obj(ctx, w, key, 1);
+          writer_puts(ctx, w, ": ");
+          write_obj(ctx, w, value, 1);
           first = 0;
         }
       }
-      write_checked(ctx, fn, udata, '}', &poll_countdown);
+      writer_putc(ctx, w, '}');
+      break;
+    }
+
+    case FE_TARRAY: {
+      fe_Array *arr = arraydata(obj);
+      int i;
+      writer_putc(ctx, w, '[');
+      if (arr) {
+        for (i = 0; i < arr->count; i++) {
+          writer_poll(ctx, w, 1);
+          if (i > 0) {
+            writer_puts(ctx, w, ", ");
+          }
+          write_obj(ctx, w, arr->items[i], 1);
+        }
+      }
+      writer_putc(ctx, w, ']');
       break;
     }
 
     default:
       snprintf(buf, sizeof(buf), "[%s %p]", typenames[type(obj)], (void*) obj);
-      writestr(ctx, fn, udata, buf, &poll_countdown);
+      writer_puts(ctx, w, buf);
       break;
   }
 }
 
 
-static void writefp(fe_Context *ctx, void *udata, char chr) {
+void fe_write(fe_Context *ctx, fe_Object *obj, fe_WriteFn fn, void *udata, int qt) {
+  fe_Writer w;
+  writer_init(&w, fn, NULL, udata);
+  write_obj(ctx, &w, obj, qt);
+}
+
+void fe_write_block(fe_Context *ctx, fe_Object *obj, fe_WriteBlockFn fn,
+                    void *udata, int qt) {
+  fe_Writer w;
+  writer_init(&w, NULL, fn, udata);
+  write_obj(ctx, &w, obj, qt);
+  writer_flush(ctx, &w);
+}
+
+
+static void writefp_block(fe_Context *ctx, void *udata, const char *buf,
+                          size_t len) {
   unused(ctx);
-  fputc(chr, udata);
+  fwrite(buf, 1, len, udata);
 }
 
 void fe_writefp(fe_Context *ctx, fe_Object *obj, FILE *fp) {
-  fe_write(ctx, obj, writefp, fp, 0);
+  fe_write_block(ctx, obj, writefp_block, fp, 0);
 }
 
 
 typedef struct { char *p; int n; } CharPtrInt;
 
-static void writebuf(fe_Context *ctx, void *udata, char chr) {
+static void writebuf_block(fe_Context *ctx, void *udata, const char *buf,
+                           size_t len) {
   CharPtrInt *x = udata;
+  size_t n;
   unused(ctx);
-  if (x->n) { *x->p++ = chr; x->n--; }
+  if (x->n <= 0) return;
+  n = (len < (size_t)x->n) ? len : (size_t)x->n;
+  memcpy(x->p, buf, n);
+  x->p += n;
+  x->n -= (int)n;
 }
 
 int fe_tostring(fe_Context *ctx, fe_Object *obj, char *dst, int size) {
   CharPtrInt x;
   x.p = dst;
   x.n = size - 1;
-  fe_write(ctx, obj, writebuf, &x, 0);
+  fe_write_block(ctx, obj, writebuf_block, &x, 0);
   *x.p = '\0';
   return size - x.n - 1;
 }
@@ -2653,23 +4968,25 @@ int fe_string_contains_nul(fe_Context *ctx, fe_Object *obj)
 
 size_t fe_byteslen(fe_Context *ctx, fe_Object *obj)
 {
+  size_t base, len;
   unused(ctx);
-  return FE_STR_LEN(checktype(ctx, obj, FE_TBYTES));
+  bytes_resolve(checktype(ctx, obj, FE_TBYTES), &base, &len);
+  return len;
 }
 
 size_t fe_bytescopy(fe_Context *ctx, fe_Object *obj, size_t offset, void *dst, size_t size)
 {
-  size_t len;
+  size_t base, len;
   unsigned char *out;
 
-  obj = checktype(ctx, obj, FE_TBYTES);
-  len = FE_STR_LEN(obj);
+  obj = bytes_resolve(checktype(ctx, obj, FE_TBYTES), &base, &len);
   if (offset >= len || size == 0) {
     return 0;
   }
   if (size > len - offset) {
     size = len - offset;
   }
+  offset += base;
   out = (unsigned char*)dst;
 
 #ifdef FE_OPT_NO_MALLOC_STRINGS
@@ -2735,8 +5052,22 @@ static int find_assoc_binding(fe_Object *sym, fe_Object *env, fe_Object **bindin
   return 1;
 }
 
+/* Every environment binding keyed by a symbol passes through here so the
+   symbol's shadow bit stays in sync with getbound()'s fast path. */
+static void mark_symbol_shadowed(fe_Object *sym) {
+  if (!FE_IS_FIXNUM(sym) && !FE_IS_BOOLEAN(sym) && !isnil(sym)) {
+    tag(sym) |= SYMSHADOWBIT;
+  }
+}
+
 static fe_Object* getbound(fe_Context *ctx, fe_Object *sym, fe_Object *env) {
   fe_Object *p;
+  /* A symbol that has never been a local binding key can only resolve to
+     its global cell, so skip the locals/upvalues walk entirely.  Builtin
+     and primitive names hit this path on nearly every call. */
+  if (!(tag(sym) & SYMSHADOWBIT)) {
+    return cdr(sym);
+  }
   /* Check for new closure environment frame */
   if (type(env) == FE_TPAIR && car(env) == ctx->frame_sym) {
     fe_Object *locals = car(cdr(env));
@@ -3007,6 +5338,7 @@ static fe_Object* argstoenv(fe_Context *ctx, fe_Object *prm, fe_Object *arg, fe_
       fe_pushgc(ctx, prm);
       fe_pushgc(ctx, arg);
       fe_pushgc(ctx, env);
+      mark_symbol_shadowed(prm);
       binding = fe_cons(ctx, prm, arg);
       fe_restoregc(ctx, save);
       fe_pushgc(ctx, env);
@@ -3020,6 +5352,7 @@ static fe_Object* argstoenv(fe_Context *ctx, fe_Object *prm, fe_Object *arg, fe_
       fe_pushgc(ctx, prm);
       fe_pushgc(ctx, arg);
       fe_pushgc(ctx, env);
+      mark_symbol_shadowed(car(prm));
       binding = fe_cons(ctx, car(prm), fe_car(ctx, arg));
       fe_restoregc(ctx, save);
       fe_pushgc(ctx, prm);
@@ -3193,154 +5526,1075 @@ static fe_Object* import_module_spec(fe_Context *ctx, char *module_spec,
         tracked_free(ctx, module_spec);
         memory_error(ctx, "out of memory (module prefix)");
       }
-      (void)import_module_spec(ctx, prefix_spec, 1);
-    }
-  }
+      (void)import_module_spec(ctx, prefix_spec, 1);
+    }
+  }
+
+  module_path = resolve_module_file(ctx, lookup_name, optional ? NULL : &searched_paths);
+  if (!module_path) {
+    module_obj = resolve_imported_module_value(ctx, module_spec, segments,
+                                               segment_count, NULL);
+    if (type(module_obj) == FE_TMAP) {
+      bind_imported_module(ctx, module_spec, segments, segment_count,
+                           is_relative, module_obj);
+      tracked_free(ctx, lookup_name);
+      tracked_free(ctx, searched_paths);
+      string_array_clear(ctx, &segments, &segment_count, &segment_capacity);
+      fe_restoregc(ctx, gc_save);
+      tracked_free(ctx, module_spec);
+      return module_obj;
+    }
+
+    tracked_free(ctx, lookup_name);
+    if (optional) {
+      tracked_free(ctx, searched_paths);
+      string_array_clear(ctx, &segments, &segment_count, &segment_capacity);
+      fe_restoregc(ctx, gc_save);
+      tracked_free(ctx, module_spec);
+      return NULL;
+    }
+
+    if (searched_paths && ctx->alloc_failure_active) {
+      tracked_free(ctx, searched_paths);
+    }
+    if (ctx->alloc_failure_active) {
+      string_array_clear(ctx, &segments, &segment_count, &segment_capacity);
+      tracked_free(ctx, module_spec);
+      memory_error(ctx, "out of memory (module path)");
+    }
+    append_module_search_error(error_buf, sizeof(error_buf), module_spec,
+                               searched_paths);
+    tracked_free(ctx, searched_paths);
+    string_array_clear(ctx, &segments, &segment_count, &segment_capacity);
+    tracked_free(ctx, module_spec);
+    fe_error(ctx, error_buf);
+  }
+  tracked_free(ctx, lookup_name);
+
+  module_obj = module_cache_get(ctx, module_path);
+  if (type(module_obj) == FE_TMAP) {
+    tracked_free(ctx, module_path);
+    bind_imported_module(ctx, module_spec, segments, segment_count,
+                         is_relative, module_obj);
+    string_array_clear(ctx, &segments, &segment_count, &segment_capacity);
+    fe_restoregc(ctx, gc_save);
+    tracked_free(ctx, module_spec);
+    return module_obj;
+  }
+
+  if (string_array_contains(ctx, ctx->loading_modules, ctx->loading_module_count, module_path)) {
+    tracked_free(ctx, module_path);
+    string_array_clear(ctx, &segments, &segment_count, &segment_capacity);
+    fe_restoregc(ctx, gc_save);
+    snprintf(error_buf, sizeof(error_buf), "cyclic import detected for module '%s'", module_spec);
+    tracked_free(ctx, module_spec);
+    fe_error(ctx, error_buf);
+  }
+
+  if (!string_array_push_copy(ctx, &ctx->loading_modules, &ctx->loading_module_count,
+                              &ctx->loading_module_capacity, module_path)) {
+    tracked_free(ctx, module_path);
+    string_array_clear(ctx, &segments, &segment_count, &segment_capacity);
+    fe_restoregc(ctx, gc_save);
+    tracked_free(ctx, module_spec);
+    memory_error(ctx, "out of memory (import state)");
+  }
+
+  implicit_exports = fe_map(ctx);
+  fe_pushgc(ctx, implicit_exports);
+  import_status = fex_try_run_internal(ctx, &result, &import_error,
+                                       try_import_file_runner,
+                                       module_path, implicit_exports,
+                                       module_path, 0);
+  if (import_status == FEX_STATUS_OK && result != NULL) {
+    fe_pushgc(ctx, result);
+  }
+
+  if (import_status != FEX_STATUS_OK) {
+    string_array_pop(ctx, ctx->loading_modules, &ctx->loading_module_count);
+    tracked_free(ctx, module_path);
+    string_array_clear(ctx, &segments, &segment_count, &segment_capacity);
+    fe_restoregc(ctx, gc_save);
+    tracked_free(ctx, module_spec);
+    if (fex_try_is_active()) {
+      fex_try_raise_error(&import_error);
+    }
+    fe_error(ctx, import_error.message);
+  }
+
+  if (result == NULL) {
+    string_array_pop(ctx, ctx->loading_modules, &ctx->loading_module_count);
+    tracked_free(ctx, module_path);
+    string_array_clear(ctx, &segments, &segment_count, &segment_capacity);
+    fe_restoregc(ctx, gc_save);
+    tracked_free(ctx, module_spec);
+    fe_error(ctx, "failed to import module");
+  }
+
+  string_array_pop(ctx, ctx->loading_modules, &ctx->loading_module_count);
+  if (fe_map_count(ctx, implicit_exports) > 0) {
+    module_obj = implicit_exports;
+  } else {
+    module_obj = resolve_imported_module_value(ctx, module_spec, segments,
+                                               segment_count, NULL);
+    if (type(module_obj) != FE_TMAP) {
+      module_obj = implicit_exports;
+    }
+  }
+  fe_pushgc(ctx, module_obj);
+
+  if (type(module_obj) != FE_TMAP) {
+    tracked_free(ctx, module_path);
+    string_array_clear(ctx, &segments, &segment_count, &segment_capacity);
+    fe_restoregc(ctx, gc_save);
+    snprintf(error_buf, sizeof(error_buf), "module '%s' did not produce a module value", module_spec);
+    tracked_free(ctx, module_spec);
+    fe_error(ctx, error_buf);
+  }
+
+  bind_imported_module(ctx, module_spec, segments, segment_count,
+                       is_relative, module_obj);
+
+  if (!module_cache_push_owned(ctx, module_path, module_obj)) {
+    tracked_free(ctx, module_path);
+    string_array_clear(ctx, &segments, &segment_count, &segment_capacity);
+    fe_restoregc(ctx, gc_save);
+    tracked_free(ctx, module_spec);
+    memory_error(ctx, "out of memory (module cache)");
+  }
+  module_path = NULL;
+  tracked_free(ctx, module_path);
+  string_array_clear(ctx, &segments, &segment_count, &segment_capacity);
+  fe_restoregc(ctx, gc_save);
+  tracked_free(ctx, module_spec);
+
+  return module_obj;
+}
+
+static fe_Object* import_module(fe_Context *ctx, fe_Object *spec_obj) {
+  char *module_spec = import_spec_to_cstring(ctx, spec_obj);
+  return import_module_spec(ctx, module_spec, 0);
+}
+
+
+/* -------------------------------------------------------------------------
+ * Bytecode fast path
+ *
+ * `while` loops dominate the cost of the tree-walking evaluator: every
+ * iteration re-traverses the cons cells of the condition and body and
+ * re-dispatches through eval().  When a loop is evaluated we first try to
+ * compile its condition and body into a flat instruction stream and run
+ * that instead.  Only a conservative subset of forms compiles (literals,
+ * variables, and the fixed primitives handled below); anything else makes
+ * the compiler bail out so the loop falls back to the tree walker and
+ * semantics are unchanged.
+ *
+ * Primitive names can be rebound at run time, so every compiled call site
+ * starts with a guard instruction that re-resolves the head symbol in the
+ * current environment; if it no longer names the expected primitive, that
+ * sub-expression is evaluated through the tree walker instead.
+ *
+ * Variable references are resolved at compile time where possible: a
+ * symbol that no `let` inside the region can rebind always denotes the
+ * same binding pair, so its lookup is a pointer load instead of a
+ * getbound() scan.  Guard fallbacks that extend the environment void
+ * those resolutions for the rest of the run (see OP_GETBOUND).
+ *
+ * Run frames live on the C stack and are linked through ctx->code_runs so
+ * the GC can mark in-flight values and fe_error() can release the
+ * instruction buffers when it unwinds.
+ * ---------------------------------------------------------------------- */
+
+enum {
+  OP_CONST,       /* push operand                                         */
+  OP_GETVAR,      /* push value bound to operand symbol                   */
+  OP_SETVAR,      /* pop value, assign to operand symbol, push nil        */
+  OP_GETBOUND,    /* push value of the binding resolved at compile time   */
+  OP_SETBOUND,    /* pop value into the resolved binding, push nil        */
+  OP_GLOBALLET,   /* pop value, bind operand symbol globally, push value  */
+  OP_LETPUSH,     /* extend env with (operand . nil); push the binding    */
+  OP_LETBIND,     /* pop value and binding; fill binding; push value      */
+  OP_POP,         /* pop and discard                                      */
+  OP_ENVSAVE,     /* push current env                                     */
+  OP_ENVRESTORE,  /* pop value, pop saved env into env, push value back   */
+  OP_ENVDROP,     /* pop saved env into env                               */
+  OP_JUMP,        /* unconditional jump to target                         */
+  OP_JFALSE,      /* pop; jump to target when falsy                       */
+  OP_JFALSE_KEEP, /* peek; jump when falsy keeping value, else pop        */
+  OP_JTRUE_KEEP,  /* peek; jump when truthy keeping value, else pop       */
+  OP_LOOP,        /* loop head: eval budget check                         */
+  OP_GUARD,       /* verify head symbol still names the expected prim     */
+  OP_CHECKRET,    /* peek; stop the run when value is a return sentinel   */
+  OP_CAR, OP_CDR, OP_CONS, OP_SETCAR, OP_SETCDR,
+  OP_NOT, OP_IS, OP_ATOM,
+  OP_LT, OP_LTE, OP_GT, OP_GTE,
+  OP_ADD, OP_SUB, OP_MUL, OP_DIV,
+  OP_NUM1, OP_NEG /* single-operand numeric normalization / negation      */
+};
+
+/* How a `let` encountered during compilation must behave, mirroring the
+   newenv threading of eval(): argument positions evaluate with a NULL
+   newenv (a let there becomes a global binding), while loop/do bodies
+   thread the environment and a let extends it. */
+enum { CODE_LET_GLOBAL, CODE_LET_LOCAL };
+
+#define CODE_COMPILE_MAX_DEPTH 128
+
+typedef struct {
+  uint8_t op;
+  uint8_t prim;      /* OP_GUARD: expected primitive                      */
+  uint8_t mode;      /* OP_GUARD: thread env through the fallback eval    */
+  int32_t target;    /* jump target / guard resume instruction index      */
+  fe_Object *operand;
+  fe_Object *cache;  /* OP_GETBOUND/OP_SETBOUND: resolved binding pair    */
+} fe_Instr;
+
+struct fe_CodeRun {
+  fe_Instr *instrs;
+  int count;
+  int capacity;
+  fe_Object **stack;
+  /* Parallel to stack: nonzero marks a boxed double this run allocated
+     whose only reference is that slot, so the numeric ops may mutate it
+     in place instead of boxing a fresh intermediate. */
+  unsigned char *owned;
+  int top;
+  int stack_capacity;
+  fe_Object *env;
+  fe_Object *let_syms;  /* symbols a `let` in the region may rebind       */
+  int resolved_valid;   /* compile-time bindings still authoritative      */
+  fe_CodeRun *next;
+};
+
+static void code_abandon_runs(fe_Context *ctx) {
+  fe_CodeRun *run = ctx->code_runs;
+  while (run != NULL) {
+    fe_CodeRun *next = run->next;
+    tracked_free(ctx, run->instrs);
+    tracked_free(ctx, run->stack);
+    tracked_free(ctx, run->owned);
+    run->instrs = NULL;
+    run->stack = NULL;
+    run->owned = NULL;
+    run = next;
+  }
+  ctx->code_runs = NULL;
+}
+
+static void code_mark_runs(fe_Context *ctx) {
+  fe_CodeRun *run;
+  int i;
+  for (run = ctx->code_runs; run != NULL; run = run->next) {
+    for (i = 0; i < run->top; i++) {
+      fe_Object *v = run->stack[i];
+      if (!FE_IS_FIXNUM(v) && !FE_IS_BOOLEAN(v) && v != &nil) {
+        fe_mark(ctx, v);
+      }
+    }
+    if (run->env != &nil) { fe_mark(ctx, run->env); }
+    if (run->let_syms != NULL && run->let_syms != &nil) {
+      fe_mark(ctx, run->let_syms);
+    }
+  }
+}
+
+static int code_emit(fe_Context *ctx, fe_CodeRun *run, int op, int prim,
+                     fe_Object *operand) {
+  if (run->count == run->capacity) {
+    int new_capacity = run->capacity ? run->capacity * 2 : 32;
+    fe_Instr *grown = tracked_realloc(ctx, run->instrs,
+                                      (size_t)new_capacity * sizeof(fe_Instr));
+    if (!grown) { return -1; }
+    run->instrs = grown;
+    run->capacity = new_capacity;
+  }
+  run->instrs[run->count].op = (uint8_t)op;
+  run->instrs[run->count].prim = (uint8_t)prim;
+  run->instrs[run->count].mode = 0;
+  run->instrs[run->count].target = -1;
+  run->instrs[run->count].operand = operand;
+  run->instrs[run->count].cache = NULL;
+  return run->count++;
+}
+
+static void code_push(fe_Context *ctx, fe_CodeRun *run, fe_Object *v) {
+  if (run->top == run->stack_capacity) {
+    int new_capacity = run->stack_capacity ? run->stack_capacity * 2 : 32;
+    fe_Object **grown = tracked_realloc(ctx, run->stack,
+                                        (size_t)new_capacity * sizeof(*grown));
+    unsigned char *grown_owned;
+    if (!grown) { memory_error(ctx, "out of memory (bytecode stack)"); }
+    run->stack = grown;
+    grown_owned = tracked_realloc(ctx, run->owned,
+                                  (size_t)new_capacity * sizeof(*grown_owned));
+    if (!grown_owned) { memory_error(ctx, "out of memory (bytecode stack)"); }
+    run->owned = grown_owned;
+    run->stack_capacity = new_capacity;
+  }
+  run->owned[run->top] = 0;
+  run->stack[run->top++] = v;
+}
+
+/* Push a numeric result, recycling `scratch` (an owned boxed double the
+   caller just popped) when the value cannot be a fixnum immediate. */
+static void code_push_number(fe_Context *ctx, fe_CodeRun *run, fe_Number x,
+                             fe_Object *scratch) {
+  fe_Object *imm = number_as_fixnum(x);
+  if (imm) {
+    code_push(ctx, run, imm);
+    return;
+  }
+  if (scratch) {
+    scratch->cdr.n = x;
+    code_push(ctx, run, scratch);
+  } else {
+    code_push(ctx, run, fe_number(ctx, x));
+  }
+  run->owned[run->top - 1] = 1;
+}
+
+static int code_compile(fe_Context *ctx, fe_CodeRun *run, fe_Object *obj,
+                        fe_Object *env, int let_ctx, int depth);
+
+/* Resolve a candidate primitive call at compile time. Returns the prim id,
+   or -1 when the head is not a symbol currently bound to a primitive. */
+static int code_resolve_prim(fe_Context *ctx, fe_Object *obj, fe_Object *env) {
+  fe_Object *fn;
+  if (type(obj) != FE_TPAIR || type(car(obj)) != FE_TSYMBOL) { return -1; }
+  fn = cdr(getbound(ctx, car(obj), env));
+  if (type(fn) != FE_TPRIM) { return -1; }
+  return prim(fn);
+}
+
+/* Collect every symbol that a `let` anywhere in the region can rebind.
+   Lookups for those symbols must stay dynamic: a binding created on one
+   iteration shadows compile-time resolution on the next.  Everything else
+   resolves to a stable binding pair when compilation starts, so the
+   compiler can address it directly (see OP_GETBOUND).  Returns zero when
+   the region is too deep to walk; the caller then bails out entirely. */
+static int code_let_targets(fe_Context *ctx, fe_CodeRun *run, fe_Object *obj,
+                            fe_Object *env, int depth) {
+  fe_Object *it;
+  int p;
+  if (depth > CODE_COMPILE_MAX_DEPTH) { return 0; }
+  if (type(obj) != FE_TPAIR) { return 1; }
+  p = code_resolve_prim(ctx, obj, env);
+  if (p == P_QUOTE) { return 1; }
+  if (p == P_LET && type(cdr(obj)) == FE_TPAIR &&
+      type(car(cdr(obj))) == FE_TSYMBOL &&
+      !list_has(run->let_syms, car(cdr(obj)))) {
+    /* `run` is linked into ctx->code_runs, so let_syms survives a GC
+       triggered by this cons. */
+    run->let_syms = fe_cons(ctx, car(cdr(obj)), run->let_syms);
+  }
+  for (it = obj; type(it) == FE_TPAIR; it = cdr(it)) {
+    if (!code_let_targets(ctx, run, car(it), env, depth + 1)) { return 0; }
+  }
+  return 1;
+}
+
+/* Does evaluating `obj` in trampolined tail position reach a direct `let`?
+   Such a let extends the caller's environment past the enclosing `do`
+   scope; the compiler only models that for a let that is itself the tail
+   expression, so anything deeper forces a bail-out. */
+static int code_tail_lets(fe_Context *ctx, fe_Object *obj, fe_Object *env,
+                          int depth) {
+  int p = code_resolve_prim(ctx, obj, env);
+  if (depth > CODE_COMPILE_MAX_DEPTH) { return 1; }
+  switch (p) {
+    case P_LET:
+      return 1;
+    case P_DO: {
+      fe_Object *it = cdr(obj);
+      while (type(it) == FE_TPAIR && !isnil(cdr(it))) { it = cdr(it); }
+      return type(it) == FE_TPAIR &&
+             code_tail_lets(ctx, car(it), env, depth + 1);
+    }
+    case P_IF: {
+      fe_Object *it = cdr(obj);
+      while (type(it) == FE_TPAIR) {
+        if (code_tail_lets(ctx, car(it), env, depth + 1)) { return 1; }
+        it = cdr(it);
+      }
+      return 0;
+    }
+    default:
+      return 0;
+  }
+}
+
+/* Compile a `do`/`while` body: each expression in sequence, keeping only
+   the last value. Return sentinels short-circuit exactly as in eval(). */
+static int code_compile_seq(fe_Context *ctx, fe_CodeRun *run, fe_Object *body,
+                            fe_Object *env, int let_ctx, int depth) {
+  if (isnil(body)) {
+    return code_emit(ctx, run, OP_CONST, 0, &nil) >= 0;
+  }
+  while (!isnil(body)) {
+    if (type(body) != FE_TPAIR) { return 0; }
+    if (!code_compile(ctx, run, car(body), env, let_ctx, depth)) { return 0; }
+    if (!isnil(cdr(body))) {
+      if (code_emit(ctx, run, OP_CHECKRET, 0, NULL) < 0) { return 0; }
+      if (code_emit(ctx, run, OP_POP, 0, NULL) < 0) { return 0; }
+    }
+    body = cdr(body);
+  }
+  return 1;
+}
+
+static int code_compile_prim(fe_Context *ctx, fe_CodeRun *run, int p,
+                             fe_Object *arg, fe_Object *env, int let_ctx,
+                             int depth) {
+  switch (p) {
+    case P_QUOTE:
+      if (type(arg) != FE_TPAIR) { return 0; }
+      return code_emit(ctx, run, OP_CONST, 0, car(arg)) >= 0;
+
+    case P_SET: {
+      int i;
+      if (type(arg) != FE_TPAIR || type(car(arg)) != FE_TSYMBOL) { return 0; }
+      if (type(cdr(arg)) != FE_TPAIR) { return 0; }
+      if (!code_compile(ctx, run, car(cdr(arg)), env, CODE_LET_GLOBAL,
+                        depth)) { return 0; }
+      i = code_emit(ctx, run, OP_SETVAR, 0, car(arg));
+      if (i < 0) { return 0; }
+      if (!list_has(run->let_syms, car(arg))) {
+        run->instrs[i].op = OP_SETBOUND;
+        run->instrs[i].cache = getbound(ctx, car(arg), env);
+      }
+      return 1;
+    }
+
+    case P_LET: {
+      if (type(arg) != FE_TPAIR || type(car(arg)) != FE_TSYMBOL) { return 0; }
+      if (type(cdr(arg)) != FE_TPAIR) { return 0; }
+      if (let_ctx == CODE_LET_GLOBAL) {
+        if (!code_compile(ctx, run, car(cdr(arg)), env, CODE_LET_GLOBAL,
+                          depth)) { return 0; }
+        return code_emit(ctx, run, OP_GLOBALLET, 0, car(arg)) >= 0;
+      }
+      /* letrec ordering: the placeholder binding is visible while the
+         value expression evaluates, as in the P_LET clause of eval(). */
+      if (code_emit(ctx, run, OP_LETPUSH, 0, car(arg)) < 0) { return 0; }
+      if (!code_compile(ctx, run, car(cdr(arg)), env, CODE_LET_GLOBAL,
+                        depth)) { return 0; }
+      return code_emit(ctx, run, OP_LETBIND, 0, NULL) >= 0;
+    }
+
+    case P_DO: {
+      fe_Object *it = arg;
+      fe_Object *tail;
+      if (isnil(arg)) {
+        return code_emit(ctx, run, OP_CONST, 0, &nil) >= 0;
+      }
+      if (code_emit(ctx, run, OP_ENVSAVE, 0, NULL) < 0) { return 0; }
+      while (type(it) == FE_TPAIR && !isnil(cdr(it))) {
+        if (!code_compile(ctx, run, car(it), env, CODE_LET_LOCAL, depth)) {
+          return 0;
+        }
+        if (code_emit(ctx, run, OP_CHECKRET, 0, NULL) < 0) { return 0; }
+        if (code_emit(ctx, run, OP_POP, 0, NULL) < 0) { return 0; }
+        it = cdr(it);
+      }
+      if (type(it) != FE_TPAIR) { return 0; }
+      tail = car(it);
+      if (code_resolve_prim(ctx, tail, env) == P_LET) {
+        /* A tail let escapes the do scope into the caller's environment
+           (the trampoline threads newenv through), so bind it after
+           dropping the do-local bindings. */
+        if (let_ctx == CODE_LET_LOCAL) {
+          if (code_emit(ctx, run, OP_ENVDROP, 0, NULL) < 0) { return 0; }
+          return code_compile(ctx, run, tail, env, CODE_LET_LOCAL, depth);
+        }
+        if (!code_compile(ctx, run, tail, env, CODE_LET_GLOBAL, depth)) {
+          return 0;
+        }
+        return code_emit(ctx, run, OP_ENVRESTORE, 0, NULL) >= 0;
+      }
+      if (let_ctx == CODE_LET_LOCAL &&
+          code_tail_lets(ctx, tail, env, depth)) {
+        return 0;
+      }
+      if (!code_compile(ctx, run, tail, env, let_ctx, depth)) { return 0; }
+      return code_emit(ctx, run, OP_ENVRESTORE, 0, NULL) >= 0;
+    }
+
+    case P_IF: {
+      int end_chain = -1;
+      int has_tail = 0;
+      while (!isnil(arg)) {
+        int jf, je;
+        if (type(arg) != FE_TPAIR) { return 0; }
+        if (isnil(cdr(arg))) {
+          /* trailing expression acts as the else branch */
+          if (!code_compile(ctx, run, car(arg), env, let_ctx, depth)) {
+            return 0;
+          }
+          has_tail = 1;
+          break;
+        }
+        if (type(cdr(arg)) != FE_TPAIR) { return 0; }
+        if (!code_compile(ctx, run, car(arg), env, CODE_LET_GLOBAL, depth)) {
+          return 0;
+        }
+        jf = code_emit(ctx, run, OP_JFALSE, 0, NULL);
+        if (jf < 0) { return 0; }
+        if (!code_compile(ctx, run, car(cdr(arg)), env, let_ctx, depth)) {
+          return 0;
+        }
+        je = code_emit(ctx, run, OP_JUMP, 0, NULL);
+        if (je < 0) { return 0; }
+        run->instrs[je].target = end_chain;
+        end_chain = je;
+        run->instrs[jf].target = run->count;
+        arg = cdr(cdr(arg));
+      }
+      if (!has_tail && code_emit(ctx, run, OP_CONST, 0, &nil) < 0) {
+        return 0;
+      }
+      while (end_chain >= 0) {
+        int prev = run->instrs[end_chain].target;
+        run->instrs[end_chain].target = run->count;
+        end_chain = prev;
+      }
+      return 1;
+    }
+
+    case P_WHILE: {
+      int loop_top, jf, jb;
+      if (type(arg) != FE_TPAIR) { return 0; }
+      /* The loop value is the last body expression of the final
+         iteration, or nil when the loop never runs. */
+      if (code_emit(ctx, run, OP_CONST, 0, &nil) < 0) { return 0; }
+      loop_top = run->count;
+      if (code_emit(ctx, run, OP_LOOP, 0, NULL) < 0) { return 0; }
+      if (!code_compile(ctx, run, car(arg), env, CODE_LET_GLOBAL, depth)) {
+        return 0;
+      }
+      jf = code_emit(ctx, run, OP_JFALSE, 0, NULL);
+      if (jf < 0) { return 0; }
+      if (code_emit(ctx, run, OP_POP, 0, NULL) < 0) { return 0; }
+      if (!code_compile_seq(ctx, run, cdr(arg), env, CODE_LET_LOCAL, depth)) {
+        return 0;
+      }
+      if (code_emit(ctx, run, OP_CHECKRET, 0, NULL) < 0) { return 0; }
+      jb = code_emit(ctx, run, OP_JUMP, 0, NULL);
+      if (jb < 0) { return 0; }
+      run->instrs[jb].target = loop_top;
+      run->instrs[jf].target = run->count;
+      return 1;
+    }
+
+    case P_AND: case P_OR: {
+      int end_chain = -1;
+      int keep_op = (p == P_AND) ? OP_JFALSE_KEEP : OP_JTRUE_KEEP;
+      if (isnil(arg)) {
+        return code_emit(ctx, run, OP_CONST, 0, &nil) >= 0;
+      }
+      while (!isnil(arg)) {
+        if (type(arg) != FE_TPAIR) { return 0; }
+        if (!code_compile(ctx, run, car(arg), env, CODE_LET_GLOBAL, depth)) {
+          return 0;
+        }
+        if (!isnil(cdr(arg))) {
+          int j = code_emit(ctx, run, keep_op, 0, NULL);
+          if (j < 0) { return 0; }
+          run->instrs[j].target = end_chain;
+          end_chain = j;
+        }
+        arg = cdr(arg);
+      }
+      while (end_chain >= 0) {
+        int prev = run->instrs[end_chain].target;
+        run->instrs[end_chain].target = run->count;
+        end_chain = prev;
+      }
+      return 1;
+    }
+
+    case P_CAR: case P_CDR: case P_NOT: case P_ATOM: {
+      int op = (p == P_CAR) ? OP_CAR :
+               (p == P_CDR) ? OP_CDR :
+               (p == P_NOT) ? OP_NOT : OP_ATOM;
+      if (type(arg) != FE_TPAIR) { return 0; }
+      if (!code_compile(ctx, run, car(arg), env, CODE_LET_GLOBAL, depth)) {
+        return 0;
+      }
+      return code_emit(ctx, run, op, 0, NULL) >= 0;
+    }
+
+    case P_CONS: case P_IS: case P_SETCAR: case P_SETCDR:
+    case P_LT: case P_LTE: case P_GT: case P_GTE: {
+      int op = (p == P_CONS)   ? OP_CONS :
+               (p == P_IS)     ? OP_IS :
+               (p == P_SETCAR) ? OP_SETCAR :
+               (p == P_SETCDR) ? OP_SETCDR :
+               (p == P_LT)     ? OP_LT :
+               (p == P_LTE)    ? OP_LTE :
+               (p == P_GT)     ? OP_GT : OP_GTE;
+      if (type(arg) != FE_TPAIR || type(cdr(arg)) != FE_TPAIR) { return 0; }
+      if (!code_compile(ctx, run, car(arg), env, CODE_LET_GLOBAL, depth)) {
+        return 0;
+      }
+      if (!code_compile(ctx, run, car(cdr(arg)), env, CODE_LET_GLOBAL,
+                        depth)) { return 0; }
+      return code_emit(ctx, run, op, 0, NULL) >= 0;
+    }
+
+    case P_ADD: case P_MUL: case P_DIV: {
+      int op = (p == P_ADD) ? OP_ADD : (p == P_MUL) ? OP_MUL : OP_DIV;
+      if (type(arg) != FE_TPAIR) { return 0; }
+      if (!code_compile(ctx, run, car(arg), env, CODE_LET_GLOBAL, depth)) {
+        return 0;
+      }
+      if (isnil(cdr(arg))) {
+        return code_emit(ctx, run, OP_NUM1, 0, NULL) >= 0;
+      }
+      for (arg = cdr(arg); !isnil(arg); arg = cdr(arg)) {
+        if (type(arg) != FE_TPAIR) { return 0; }
+        if (!code_compile(ctx, run, car(arg), env, CODE_LET_GLOBAL, depth)) {
+          return 0;
+        }
+        if (code_emit(ctx, run, op, 0, NULL) < 0) { return 0; }
+      }
+      return 1;
+    }
+
+    case P_SUB: {
+      if (isnil(arg)) {
+        return code_emit(ctx, run, OP_CONST, 0, FE_FIXNUM(0)) >= 0;
+      }
+      if (type(arg) != FE_TPAIR) { return 0; }
+      if (!code_compile(ctx, run, car(arg), env, CODE_LET_GLOBAL, depth)) {
+        return 0;
+      }
+      if (isnil(cdr(arg))) {
+        return code_emit(ctx, run, OP_NEG, 0, NULL) >= 0;
+      }
+      for (arg = cdr(arg); !isnil(arg); arg = cdr(arg)) {
+        if (type(arg) != FE_TPAIR) { return 0; }
+        if (!code_compile(ctx, run, car(arg), env, CODE_LET_GLOBAL, depth)) {
+          return 0;
+        }
+        if (code_emit(ctx, run, OP_SUB, 0, NULL) < 0) { return 0; }
+      }
+      return 1;
+    }
+
+    default:
+      return 0;
+  }
+}
+
+static int code_compile(fe_Context *ctx, fe_CodeRun *run, fe_Object *obj,
+                        fe_Object *env, int let_ctx, int depth) {
+  int p, guard;
+
+  if (depth > CODE_COMPILE_MAX_DEPTH) { return 0; }
+  if (type(obj) == FE_TSYMBOL) {
+    int i = code_emit(ctx, run, OP_GETVAR, 0, obj);
+    if (i < 0) { return 0; }
+    /* Lexical addressing: when no let in the region can rebind this
+       symbol, resolve its binding pair once instead of per execution. */
+    if (!list_has(run->let_syms, obj)) {
+      run->instrs[i].op = OP_GETBOUND;
+      run->instrs[i].cache = getbound(ctx, obj, env);
+    }
+    return 1;
+  }
+  if (type(obj) != FE_TPAIR) {
+    return code_emit(ctx, run, OP_CONST, 0, obj) >= 0;
+  }
+
+  p = code_resolve_prim(ctx, obj, env);
+  if (p < 0) { return 0; }
+
+  guard = code_emit(ctx, run, OP_GUARD, p, obj);
+  if (guard < 0) { return 0; }
+  run->instrs[guard].mode = (let_ctx == CODE_LET_LOCAL);
+  if (!code_compile_prim(ctx, run, p, cdr(obj), env, let_ctx, depth + 1)) {
+    return 0;
+  }
+  run->instrs[guard].target = run->count;
+  return 1;
+}
+
+/* Raise `msg` from the compiled op at `ip`. The tree walker pushes a
+   calllist frame per form it evaluates, so fe_error reports the failing
+   sub-expression and its span; compiled ops have no such frames. Rebuild
+   them here from the OP_GUARD instructions whose region encloses ip
+   (every compiled pair is bracketed by its guard and the guard's resume
+   target). The interpreter pops the frames of do and if before
+   trampolining into a tail sub-expression, so guards whose child region
+   is in tail position are skipped to match. The frame cells live on this
+   C stack frame, which - like eval()'s - stays valid while the error
+   handler walks the list. */
+static void code_raise(fe_Context *ctx, fe_CodeRun *run, int ip,
+                       const char *msg) {
+  fe_Object frames[CODE_COMPILE_MAX_DEPTH];
+  int guards[CODE_COMPILE_MAX_DEPTH];
+  int depth = 0, i;
+
+  for (i = 0; i < ip && depth < CODE_COMPILE_MAX_DEPTH; i++) {
+    if (run->instrs[i].op == OP_GUARD && run->instrs[i].target > ip) {
+      guards[depth++] = i;
+    }
+  }
+  for (i = 0; i < depth; i++) {
+    if (i + 1 < depth &&
+        (run->instrs[guards[i]].prim == P_DO ||
+         run->instrs[guards[i]].prim == P_IF)) {
+      /* Child regions in tail position: sharing the parent's end (do
+         tail lets, else branches), jumping straight to it (then
+         branches), or separated only by the do scope's OP_ENVRESTORE. */
+      int outer_end = run->instrs[guards[i]].target;
+      int inner_end = run->instrs[guards[i + 1]].target;
+      if (inner_end == outer_end ||
+          (run->instrs[inner_end].op == OP_JUMP &&
+           run->instrs[inner_end].target == outer_end) ||
+          (run->instrs[inner_end].op == OP_ENVRESTORE &&
+           inner_end + 1 == outer_end)) {
+        continue;
+      }
+    }
+    tag(&frames[i]) = 0;
+    car(&frames[i]) = run->instrs[guards[i]].operand;
+    cdr(&frames[i]) = ctx->calllist;
+    ctx->calllist = &frames[i];
+  }
+  fe_error(ctx, msg);
+}
+
+/* checktype/checknum twins for compiled ops: same messages, but raised
+   through code_raise so the enclosing source forms are reported. */
+static fe_Object* code_checktype(fe_Context *ctx, fe_CodeRun *run, int ip,
+                                 fe_Object *obj, int expected) {
+  char buf[64];
+  if (expected == FE_TNUMBER && FE_IS_FIXNUM(obj)) { return obj; }
+  if (type(obj) != expected) {
+    snprintf(buf, sizeof(buf), "expected %s, got %s",
+            typenames[expected],
+            FE_IS_FIXNUM(obj) ? "number" : typenames[type(obj)]);
+    code_raise(ctx, run, ip, buf);
+  }
+  return obj;
+}
+
+static fe_Object* code_checknum(fe_Context *ctx, fe_CodeRun *run, int ip,
+                                fe_Object *obj) {
+  if (FE_IS_FIXNUM(obj)) { return obj; }
+  return code_checktype(ctx, run, ip, obj, FE_TNUMBER);
+}
+
+#define code_arith(op) { \
+    fe_Object *vb_ = run->stack[--run->top]; \
+    fe_Object *scratch_ = run->owned[run->top] ? vb_ : NULL; \
+    fe_Object *va_ = run->stack[--run->top]; \
+    fe_Number x_; \
+    if (run->owned[run->top]) { scratch_ = va_; } \
+    x_ = nval(code_checknum(ctx, run, ip, va_)); \
+    x_ = x_ op nval(code_checknum(ctx, run, ip, vb_)); \
+    code_push_number(ctx, run, x_, scratch_); \
+  }
+
+#define code_numcmp(op) { \
+    fe_Object *vb_ = run->stack[--run->top]; \
+    fe_Object *va_ = run->stack[--run->top]; \
+    code_checknum(ctx, run, ip, va_); \
+    code_checknum(ctx, run, ip, vb_); \
+    code_push(ctx, run, fe_bool(ctx, nval(va_) op nval(vb_))); \
+  }
+
+static fe_Object* code_exec(fe_Context *ctx, fe_CodeRun *run) {
+  int ip = 0;
+  int gc_base = fe_savegc(ctx);
+
+  while (ip < run->count) {
+    fe_Instr *in = &run->instrs[ip];
+
+    /* Allocating instructions leave fresh objects on the gcstack; values
+       the run still needs live on run->stack, which the GC marks through
+       ctx->code_runs, so the gcstack can be trimmed every dispatch. */
+    fe_restoregc(ctx, gc_base);
+
+    switch (in->op) {
+      case OP_CONST:
+        code_push(ctx, run, in->operand);
+        break;
+
+      case OP_GETVAR:
+        code_push(ctx, run, cdr(getbound(ctx, in->operand, run->env)));
+        break;
+
+      case OP_SETVAR:
+        cdr(getbound(ctx, in->operand, run->env)) = run->stack[--run->top];
+        code_push(ctx, run, &nil);
+        break;
+
+      /* A guard fallback that extended the environment clears
+         resolved_valid; the cached pair may then be shadowed, so fall
+         back to a dynamic lookup of the operand symbol. */
+      case OP_GETBOUND:
+        code_push(ctx, run, cdr(run->resolved_valid
+                                    ? in->cache
+                                    : getbound(ctx, in->operand, run->env)));
+        break;
+
+      case OP_SETBOUND:
+        cdr(run->resolved_valid ? in->cache
+                                : getbound(ctx, in->operand, run->env)) =
+            run->stack[--run->top];
+        code_push(ctx, run, &nil);
+        break;
+
+      case OP_GLOBALLET: {
+        fe_Object *v = run->stack[run->top - 1];
+        fe_set(ctx, in->operand, v);
+        run->owned[run->top - 1] = 0;  /* now referenced by the binding */
+        break;
+      }
+
+      case OP_LETPUSH: {
+        int s = fe_savegc(ctx);
+        fe_Object *binding;
+        mark_symbol_shadowed(in->operand);
+        binding = fe_cons(ctx, in->operand, &nil);
+        code_push(ctx, run, binding);
+        if (type(run->env) == FE_TPAIR && car(run->env) == ctx->frame_sym) {
+          fe_Object *locals = car(cdr(run->env));
+          fe_Object *upvals = cdr(cdr(run->env));
+          fe_Object *new_locals = fe_cons(ctx, binding, locals);
+          fe_Object *new_env;
+          fe_pushgc(ctx, new_locals);
+          new_env = fe_cons(ctx, new_locals, upvals);
+          fe_pushgc(ctx, new_env);
+          run->env = fe_cons(ctx, ctx->frame_sym, new_env);
+        } else {
+          run->env = fe_cons(ctx, binding, run->env);
+        }
+        fe_restoregc(ctx, s);
+        break;
+      }
+
+      case OP_LETBIND: {
+        fe_Object *v = run->stack[--run->top];
+        fe_Object *binding = run->stack[--run->top];
+        cdr(binding) = v;
+        code_push(ctx, run, v);
+        break;
+      }
+
+      case OP_POP:
+        run->top--;
+        break;
+
+      case OP_ENVSAVE:
+        code_push(ctx, run, run->env);
+        break;
+
+      case OP_ENVRESTORE: {
+        fe_Object *v = run->stack[--run->top];
+        run->env = run->stack[--run->top];
+        code_push(ctx, run, v);
+        break;
+      }
+
+      case OP_ENVDROP:
+        run->env = run->stack[--run->top];
+        break;
+
+      case OP_JUMP:
+        ip = in->target;
+        continue;
+
+      case OP_JFALSE:
+        if (!fe_truthy(run->stack[--run->top])) { ip = in->target; continue; }
+        break;
+
+      case OP_JFALSE_KEEP:
+        if (!fe_truthy(run->stack[run->top - 1])) { ip = in->target; continue; }
+        run->top--;
+        break;
+
+      case OP_JTRUE_KEEP:
+        if (fe_truthy(run->stack[run->top - 1])) { ip = in->target; continue; }
+        run->top--;
+        break;
+
+      case OP_LOOP:
+        check_eval_budget(ctx);
+        break;
+
+      case OP_GUARD: {
+        fe_Object *expr = in->operand;
+        check_eval_budget(ctx);
+        if (type(car(expr)) == FE_TSYMBOL) {
+          fe_Object *bound = cdr(getbound(ctx, car(expr), run->env));
+          if (type(bound) == FE_TPRIM && prim(bound) == (char)in->prim) {
+            break;
+          }
+        }
+        /* Head symbol no longer names the compiled primitive: evaluate
+           this sub-expression through the tree walker and resume after
+           its compiled code. */
+        {
+          int s = fe_savegc(ctx);
+          fe_Object *prev_env = run->env;
+          fe_Object *res = eval(ctx, expr, run->env,
+                                in->mode ? &run->env : NULL);
+          fe_restoregc(ctx, s);
+          if (run->env != prev_env) {
+            /* The fallback may have introduced bindings the compiler
+               never saw; stop trusting compile-time resolutions. */
+            run->resolved_valid = 0;
+          }
+          code_push(ctx, run, res);
+        }
+        ip = in->target;
+        continue;
+      }
+
+      case OP_CHECKRET:
+        if (is_return_obj(ctx, run->stack[run->top - 1])) {
+          return run->stack[run->top - 1];
+        }
+        break;
+
+      case OP_CAR: {
+        fe_Object *v = run->stack[run->top - 1];
+        run->stack[run->top - 1] =
+            isnil(v) ? v : car(code_checktype(ctx, run, ip, v, FE_TPAIR));
+        run->owned[run->top - 1] = 0;
+        break;
+      }
 
-  module_path = resolve_module_file(ctx, lookup_name, optional ? NULL : &searched_paths);
-  if (!module_path) {
-    module_obj = resolve_imported_module_value(ctx, module_spec, segments,
-                                               segment_count, NULL);
-    if (type(module_obj) == FE_TMAP) {
-      bind_imported_module(ctx, module_spec, segments, segment_count,
-                           is_relative, module_obj);
-      tracked_free(ctx, lookup_name);
-      tracked_free(ctx, searched_paths);
-      string_array_clear(ctx, &segments, &segment_count, &segment_capacity);
-      fe_restoregc(ctx, gc_save);
-      tracked_free(ctx, module_spec);
-      return module_obj;
-    }
+      case OP_CDR: {
+        fe_Object *v = run->stack[run->top - 1];
+        run->stack[run->top - 1] =
+            isnil(v) ? v : cdr(code_checktype(ctx, run, ip, v, FE_TPAIR));
+        run->owned[run->top - 1] = 0;
+        break;
+      }
 
-    tracked_free(ctx, lookup_name);
-    if (optional) {
-      tracked_free(ctx, searched_paths);
-      string_array_clear(ctx, &segments, &segment_count, &segment_capacity);
-      fe_restoregc(ctx, gc_save);
-      tracked_free(ctx, module_spec);
-      return NULL;
-    }
+      case OP_CONS: {
+        fe_Object *pair = fe_cons(ctx, run->stack[run->top - 2],
+                                  run->stack[run->top - 1]);
+        run->top -= 2;
+        code_push(ctx, run, pair);
+        break;
+      }
 
-    if (searched_paths && ctx->alloc_failure_active) {
-      tracked_free(ctx, searched_paths);
-    }
-    if (ctx->alloc_failure_active) {
-      string_array_clear(ctx, &segments, &segment_count, &segment_capacity);
-      tracked_free(ctx, module_spec);
-      memory_error(ctx, "out of memory (module path)");
-    }
-    append_module_search_error(error_buf, sizeof(error_buf), module_spec,
-                               searched_paths);
-    tracked_free(ctx, searched_paths);
-    string_array_clear(ctx, &segments, &segment_count, &segment_capacity);
-    tracked_free(ctx, module_spec);
-    fe_error(ctx, error_buf);
-  }
-  tracked_free(ctx, lookup_name);
+      case OP_SETCAR: {
+        fe_Object *v = run->stack[--run->top];
+        car(code_checktype(ctx, run, ip, run->stack[--run->top],
+                           FE_TPAIR)) = v;
+        code_push(ctx, run, &nil);
+        break;
+      }
 
-  module_obj = module_cache_get(ctx, module_path);
-  if (type(module_obj) == FE_TMAP) {
-    tracked_free(ctx, module_path);
-    bind_imported_module(ctx, module_spec, segments, segment_count,
-                         is_relative, module_obj);
-    string_array_clear(ctx, &segments, &segment_count, &segment_capacity);
-    fe_restoregc(ctx, gc_save);
-    tracked_free(ctx, module_spec);
-    return module_obj;
-  }
+      case OP_SETCDR: {
+        fe_Object *v = run->stack[--run->top];
+        cdr(code_checktype(ctx, run, ip, run->stack[--run->top],
+                           FE_TPAIR)) = v;
+        code_push(ctx, run, &nil);
+        break;
+      }
 
-  if (string_array_contains(ctx, ctx->loading_modules, ctx->loading_module_count, module_path)) {
-    tracked_free(ctx, module_path);
-    string_array_clear(ctx, &segments, &segment_count, &segment_capacity);
-    fe_restoregc(ctx, gc_save);
-    snprintf(error_buf, sizeof(error_buf), "cyclic import detected for module '%s'", module_spec);
-    tracked_free(ctx, module_spec);
-    fe_error(ctx, error_buf);
-  }
+      case OP_NOT:
+        run->stack[run->top - 1] =
+            fe_bool(ctx, !fe_truthy(run->stack[run->top - 1]));
+        run->owned[run->top - 1] = 0;
+        break;
 
-  if (!string_array_push_copy(ctx, &ctx->loading_modules, &ctx->loading_module_count,
-                              &ctx->loading_module_capacity, module_path)) {
-    tracked_free(ctx, module_path);
-    string_array_clear(ctx, &segments, &segment_count, &segment_capacity);
-    fe_restoregc(ctx, gc_save);
-    tracked_free(ctx, module_spec);
-    memory_error(ctx, "out of memory (import state)");
-  }
+      case OP_IS: {
+        fe_Object *vb = run->stack[--run->top];
+        fe_Object *va = run->stack[--run->top];
+        code_push(ctx, run, fe_bool(ctx, equal(ctx, va, vb)));
+        break;
+      }
 
-  implicit_exports = fe_map(ctx);
-  fe_pushgc(ctx, implicit_exports);
-  import_status = fex_try_run_internal(ctx, &result, &import_error,
-                                       try_import_file_runner,
-                                       module_path, implicit_exports,
-                                       module_path, 0);
-  if (import_status == FEX_STATUS_OK && result != NULL) {
-    fe_pushgc(ctx, result);
-  }
+      case OP_ATOM:
+        run->stack[run->top - 1] =
+            fe_bool(ctx, type(run->stack[run->top - 1]) != FE_TPAIR);
+        run->owned[run->top - 1] = 0;
+        break;
 
-  if (import_status != FEX_STATUS_OK) {
-    string_array_pop(ctx, ctx->loading_modules, &ctx->loading_module_count);
-    tracked_free(ctx, module_path);
-    string_array_clear(ctx, &segments, &segment_count, &segment_capacity);
-    fe_restoregc(ctx, gc_save);
-    tracked_free(ctx, module_spec);
-    if (fex_try_is_active()) {
-      fex_try_raise_error(&import_error);
-    }
-    fe_error(ctx, import_error.message);
-  }
+      case OP_LT:  code_numcmp(<);  break;
+      case OP_LTE: code_numcmp(<=); break;
+      case OP_GT:  code_numcmp(>);  break;
+      case OP_GTE: code_numcmp(>=); break;
+
+      case OP_ADD: code_arith(+); break;
+      case OP_SUB: code_arith(-); break;
+      case OP_MUL: code_arith(*); break;
+
+      case OP_DIV: {
+        fe_Object *vb = run->stack[--run->top];
+        fe_Object *scratch = run->owned[run->top] ? vb : NULL;
+        fe_Object *va = run->stack[--run->top];
+        fe_Number x, d;
+        if (run->owned[run->top]) { scratch = va; }
+        x = nval(code_checknum(ctx, run, ip, va));
+        d = nval(code_checknum(ctx, run, ip, vb));
+        if (d == 0) { code_raise(ctx, run, ip, "division by zero"); }
+        code_push_number(ctx, run, x / d, scratch);
+        break;
+      }
 
-  if (result == NULL) {
-    string_array_pop(ctx, ctx->loading_modules, &ctx->loading_module_count);
-    tracked_free(ctx, module_path);
-    string_array_clear(ctx, &segments, &segment_count, &segment_capacity);
-    fe_restoregc(ctx, gc_save);
-    tracked_free(ctx, module_spec);
-    fe_error(ctx, "failed to import module");
-  }
+      case OP_NUM1: {
+        fe_Object *v = run->stack[--run->top];
+        fe_Object *scratch = run->owned[run->top] ? v : NULL;
+        code_push_number(ctx, run, nval(code_checknum(ctx, run, ip, v)),
+                         scratch);
+        break;
+      }
 
-  string_array_pop(ctx, ctx->loading_modules, &ctx->loading_module_count);
-  if (fe_map_count(ctx, implicit_exports) > 0) {
-    module_obj = implicit_exports;
-  } else {
-    module_obj = resolve_imported_module_value(ctx, module_spec, segments,
-                                               segment_count, NULL);
-    if (type(module_obj) != FE_TMAP) {
-      module_obj = implicit_exports;
+      case OP_NEG: {
+        fe_Object *v = run->stack[--run->top];
+        fe_Object *scratch = run->owned[run->top] ? v : NULL;
+        code_push_number(ctx, run, -nval(code_checknum(ctx, run, ip, v)),
+                         scratch);
+        break;
+      }
     }
+    ip++;
   }
-  fe_pushgc(ctx, module_obj);
 
-  if (type(module_obj) != FE_TMAP) {
-    tracked_free(ctx, module_path);
-    string_array_clear(ctx, &segments, &segment_count, &segment_capacity);
-    fe_restoregc(ctx, gc_save);
-    snprintf(error_buf, sizeof(error_buf), "module '%s' did not produce a module value", module_spec);
-    tracked_free(ctx, module_spec);
-    fe_error(ctx, error_buf);
-  }
+  return run->top > 0 ? run->stack[run->top - 1] : &nil;
+}
 
-  bind_imported_module(ctx, module_spec, segments, segment_count,
-                       is_relative, module_obj);
+/* Entry point from the P_WHILE clause of eval(). `arg` is the (cond . body)
+   list of the loop. Returns non-zero when the loop was compiled and run,
+   leaving the loop's value in *out_res; zero means the caller must fall
+   back to the tree walker. */
+static int code_try_while(fe_Context *ctx, fe_Object *arg, fe_Object *env,
+                          fe_Object **out_res) {
+  fe_CodeRun run;
+  fe_Object *res;
 
-  if (!module_cache_push_owned(ctx, module_path, module_obj)) {
-    tracked_free(ctx, module_path);
-    string_array_clear(ctx, &segments, &segment_count, &segment_capacity);
-    fe_restoregc(ctx, gc_save);
-    tracked_free(ctx, module_spec);
-    memory_error(ctx, "out of memory (module cache)");
-  }
-  module_path = NULL;
-  tracked_free(ctx, module_path);
-  string_array_clear(ctx, &segments, &segment_count, &segment_capacity);
-  fe_restoregc(ctx, gc_save);
-  tracked_free(ctx, module_spec);
+  if (type(arg) != FE_TPAIR) { return 0; }
 
-  return module_obj;
-}
+  memset(&run, 0, sizeof(run));
+  run.env = env;
+  run.let_syms = &nil;
+  run.resolved_valid = 1;
+  run.next = ctx->code_runs;
+  ctx->code_runs = &run;
 
-static fe_Object* import_module(fe_Context *ctx, fe_Object *spec_obj) {
-  char *module_spec = import_spec_to_cstring(ctx, spec_obj);
-  return import_module_spec(ctx, module_spec, 0);
+  if (!code_let_targets(ctx, &run, arg, env, 0) ||
+      !code_compile_prim(ctx, &run, P_WHILE, arg, env, CODE_LET_LOCAL, 0)) {
+    ctx->code_runs = run.next;
+    tracked_free(ctx, run.instrs);
+    return 0;
+  }
+
+  res = code_exec(ctx, &run);
+  ctx->code_runs = run.next;
+  tracked_free(ctx, run.instrs);
+  tracked_free(ctx, run.stack);
+  tracked_free(ctx, run.owned);
+  *out_res = res;
+  return 1;
 }
 
 
@@ -3349,6 +6603,7 @@ static fe_Object* eval(fe_Context *ctx, fe_Object *obj, fe_Object *env, fe_Objec
   fe_Object cl, *va, *vb;
   int n, gc;
   int in_func_tail = 0;
+  int prof_opened = 0;  /* profiler frames this invocation must close */
 
 tail_call:
   /* If we're in a function's tail position and the expression to evaluate
@@ -3365,8 +6620,18 @@ tail_call:
   }
   ctx->current_eval_depth++;
 
-  if (type(obj) == FE_TSYMBOL) { ctx->current_eval_depth--; return cdr(getbound(ctx, obj, env)); }
-  if (type(obj) != FE_TPAIR) { ctx->current_eval_depth--; return obj; }
+  /* A trampolined body can end on a bare symbol or constant, so these
+     early exits must also close any profiler frames opened below. */
+  if (type(obj) == FE_TSYMBOL) {
+    ctx->current_eval_depth--;
+    while (prof_opened > 0) { profile_leave(ctx); prof_opened--; }
+    return cdr(getbound(ctx, obj, env));
+  }
+  if (type(obj) != FE_TPAIR) {
+    ctx->current_eval_depth--;
+    while (prof_opened > 0) { profile_leave(ctx); prof_opened--; }
+    return obj;
+  }
 
   /* Call stack frames are synthetic pair cells that live on the C stack. */
   tag(&cl) = 0;
@@ -3525,7 +6790,9 @@ tail_call:
             /* Implement `letrec` semantics for local bindings to allow recursion.
                A new binding is created with a nil placeholder, the value is evaluated
                in this new environment, and then the binding is updated. */
-            fe_Object *binding = fe_cons(ctx, sym, &nil);
+            fe_Object *binding;
+            mark_symbol_shadowed(sym);
+            binding = fe_cons(ctx, sym, &nil);
 
             fe_Object *new_frame_env;
             if (type(*newenv) == FE_TPAIR && car(*newenv) == ctx->frame_sym) {
@@ -3640,6 +6907,9 @@ tail_call:
         }
 
         case P_WHILE: {
+          /* Bytecode fast path: loops built only from compilable forms run
+             as a flat instruction stream (see code_try_while above). */
+          if (code_try_while(ctx, arg, env, &res)) { break; }
           fe_Object *cond_expr = fe_nextarg(ctx, &arg);
           n = fe_savegc(ctx);
           while (fe_truthy(eval(ctx, cond_expr, env, NULL))) {
@@ -3792,11 +7062,21 @@ tail_call:
     case FE_TCFUNC:
       arg = evallist(ctx, arg, env);
       fe_pushgc(ctx, arg);
+      if (ctx->profiling) {
+        profile_enter(ctx, type(car(obj)) == FE_TSYMBOL ? car(obj) : obj);
+        prof_opened++;
+      }
       res = cfunc(fn)(ctx, arg);
       break;
 
     case FE_TFUNC: {
       arg = evallist(ctx, arg, env);
+      if (ctx->profiling) {
+        /* A tail call re-enters this switch in the same C frame, so one
+           invocation may open several frames; all close at the epilogue. */
+        profile_enter(ctx, type(car(obj)) == FE_TSYMBOL ? car(obj) : obj);
+        prof_opened++;
+      }
 
       fe_Object *fn_guts = cdr(fn);         /* (def_env free_vars params . body) */
       fe_Object *def_env = car(fn_guts);
@@ -3918,6 +7198,7 @@ tail_call:
       fe_restoregc(ctx, gc);
       ctx->calllist = cdr(&cl);
       ctx->current_eval_depth--;
+      while (prof_opened > 0) { profile_leave(ctx); prof_opened--; }
       return eval(ctx, obj, env, NULL);
     }
 
@@ -3925,6 +7206,7 @@ tail_call:
       fe_error(ctx, "tried to call non-callable value");
   }
 
+  while (prof_opened > 0) { profile_leave(ctx); prof_opened--; }
   fe_restoregc(ctx, gc);
   fe_pushgc(ctx, res);
   ctx->calllist = cdr(&cl);
@@ -3948,6 +7230,62 @@ fe_Object* fe_eval(fe_Context *ctx, fe_Object *obj) {
 }
 
 
+/* Resumable evaluation. The staged program lives in ctx->resume_forms (the
+   list of top-level forms still to run) and ctx->resume_result (the value
+   of the last completed form); both are marked as GC roots while a program
+   is pending. The evaluator's frames live on the C stack, so suspension
+   can only happen between forms - each fe_eval_resume() slice evaluates
+   whole forms until the quota of budget steps is spent. */
+
+void fe_eval_begin(fe_Context *ctx, fe_Object *obj) {
+  if (ctx->resume_forms != NULL) {
+    fe_error(ctx, "resumable evaluation already in progress");
+  }
+  if (type(obj) == FE_TPAIR && car(obj) == ctx->do_sym) {
+    ctx->resume_forms = cdr(obj);
+  } else {
+    ctx->resume_forms = fe_cons(ctx, obj, &nil);
+  }
+  ctx->resume_result = &nil;
+}
+
+
+int fe_eval_resume(fe_Context *ctx, size_t step_quota, fe_Object **out_result) {
+  fe_Object *res;
+  size_t goal;
+
+  if (ctx->resume_forms == NULL) {
+    fe_error(ctx, "no resumable evaluation in progress");
+  }
+  begin_eval_run(ctx);
+  goal = (step_quota > 0) ? ctx->steps_executed + step_quota : 0;
+  while (!isnil(ctx->resume_forms)) {
+    fe_Object *form = car(ctx->resume_forms);
+    int gc = fe_savegc(ctx);
+    ctx->resume_result = eval(ctx, form, &nil, NULL);
+    ctx->resume_forms = cdr(ctx->resume_forms);
+    fe_restoregc(ctx, gc);
+    if (goal > 0 && ctx->steps_executed >= goal && !isnil(ctx->resume_forms)) {
+      end_eval_run(ctx);
+      return 1;
+    }
+  }
+  end_eval_run(ctx);
+  res = ctx->resume_result;
+  ctx->resume_forms = NULL;
+  ctx->resume_result = NULL;
+  fe_pushgc(ctx, res);
+  if (out_result != NULL) { *out_result = res; }
+  return 0;
+}
+
+
+void fe_eval_abort(fe_Context *ctx) {
+  ctx->resume_forms = NULL;
+  ctx->resume_result = NULL;
+}
+
+
 fe_Context* fe_open(void *ptr, size_t size) {
   int i, save;
   fe_Context *ctx;
@@ -4009,6 +7347,11 @@ fe_Context* fe_open(void *ptr, size_t size) {
   ctx->bytes_since_gc = 0;
   ctx->byte_threshold = (size_t)ctx->object_count * sizeof(fe_Object) / 3;
   ctx->gc_runs = 0;
+  ctx->gc_threshold_fixed = 0;
+  ctx->gc_defer_depth = 0;
+  ctx->gc_reclaimed_last = 0;
+  ctx->gc_reclaimed_total = 0;
+  ctx->gc_sweep_reclaimed = 0;
   ctx->object_allocations_total = 0;
 
   /* init recursion depth limits */
@@ -4023,6 +7366,10 @@ fe_Context* fe_open(void *ptr, size_t size) {
   ctx->modulestack = &nil;
   ctx->symlist = &nil;
 
+  /* Loading precompiled module caches is passive (a cache file must exist
+   * and match its source), so it defaults to on; writes stay explicit. */
+  ctx->module_cache_enabled = 1;
+
   /* populate freelist */
   for (i = 0; i < ctx->object_count; i++) {
     fe_Object *obj = &ctx->objects[i];
@@ -4058,18 +7405,378 @@ fe_Context* fe_open(void *ptr, size_t size) {
 }
 
 
+/*
+ * Context cloning. A fully initialized context (builtins registered,
+ * prelude evaluated) can serve as a template: fe_clone() copies its pool
+ * with one memcpy, relocates the object pointers by the pool delta, and
+ * duplicates the handful of heap-allocated side structures (maps, arrays,
+ * symbol index, module bookkeeping). That skips per-symbol registration
+ * and prelude compilation entirely, so spinning up short-lived contexts
+ * costs a copy instead of a full fex_init().
+ */
+
+/* Relocates one object pointer after the pool memcpy: pointers into the
+   source pool shift by the delta; fixnum/boolean immediates, the static
+   nil, and anything outside the pool pass through unchanged. */
+static fe_Object* clone_reloc(fe_Object *obj, const char *src_base,
+                              size_t pool_size, ptrdiff_t delta) {
+  if (obj == NULL || FE_IS_FIXNUM(obj) || FE_IS_BOOLEAN(obj)) { return obj; }
+  if ((uintptr_t)obj - (uintptr_t)src_base < (uintptr_t)pool_size) {
+    return (fe_Object*)((char*)obj + delta);
+  }
+  return obj;
+}
+
+static fe_Map* clone_map_data(fe_Context *dst, fe_Map *src_map,
+                              const char *src_base, size_t pool_size,
+                              ptrdiff_t delta) {
+  fe_Map *map = map_alloc(dst, src_map->capacity);
+  int i;
+  if (!map) { return NULL; }
+  map->count = src_map->count;
+  memcpy(map->hashes, src_map->hashes,
+         sizeof(unsigned long) * (size_t)src_map->capacity);
+  for (i = 0; i < src_map->capacity; i++) {
+    map->keys[i] = clone_reloc(src_map->keys[i], src_base, pool_size, delta);
+    map->values[i] = clone_reloc(src_map->values[i], src_base, pool_size, delta);
+  }
+  if (src_map->old_keys) {
+    if (!map_alloc_table(dst, src_map->old_capacity, &map->old_keys,
+                         &map->old_values, &map->old_hashes)) {
+      map_free_payload(dst, map);
+      return NULL;
+    }
+    map->old_capacity = src_map->old_capacity;
+    map->old_cursor = src_map->old_cursor;
+    map->old_count = src_map->old_count;
+    memcpy(map->old_hashes, src_map->old_hashes,
+           sizeof(unsigned long) * (size_t)src_map->old_capacity);
+    for (i = 0; i < src_map->old_capacity; i++) {
+      map->old_keys[i] = clone_reloc(src_map->old_keys[i], src_base,
+                                     pool_size, delta);
+      map->old_values[i] = clone_reloc(src_map->old_values[i], src_base,
+                                       pool_size, delta);
+    }
+  }
+  return map;
+}
+
+static fe_Array* clone_array_data(fe_Context *dst, fe_Array *src_arr,
+                                  const char *src_base, size_t pool_size,
+                                  ptrdiff_t delta) {
+  fe_Array *arr = array_alloc(dst, src_arr->capacity);
+  int i;
+  if (!arr) { return NULL; }
+  arr->count = src_arr->count;
+  for (i = 0; i < src_arr->count; i++) {
+    arr->items[i] = clone_reloc(src_arr->items[i], src_base, pool_size, delta);
+  }
+  return arr;
+}
+
+static int clone_string_array(fe_Context *dst, char **src_arr, int count,
+                              char ***out_arr, int *out_count, int *out_cap) {
+  char **arr;
+  int i;
+  *out_arr = NULL;
+  *out_count = 0;
+  *out_cap = 0;
+  if (count <= 0) { return 1; }
+  arr = tracked_alloc(dst, sizeof(char*) * (size_t)count);
+  if (!arr) { return 0; }
+  for (i = 0; i < count; i++) {
+    arr[i] = dup_cstring(dst, src_arr[i]);
+    if (src_arr[i] && !arr[i]) {
+      while (i-- > 0) { tracked_free(dst, arr[i]); }
+      tracked_free(dst, arr);
+      return 0;
+    }
+  }
+  *out_arr = arr;
+  *out_count = count;
+  *out_cap = count;
+  return 1;
+}
+
+/* Frees the side structures of arena slots [0, done) on a clone that
+   failed part-way through its deep-copy pass. */
+static void clone_abandon(fe_Context *dst, int done) {
+  int i;
+  for (i = 0; i < done; i++) {
+    fe_Object *obj = &dst->objects[i];
+    if (type(obj) == FE_TMAP && mapdata(obj)) {
+      map_free_payload(dst, mapdata(obj));
+    } else if (type(obj) == FE_TARRAY && arraydata(obj)) {
+      fe_Array *arr = arraydata(obj);
+      tracked_free(dst, arr->items);
+      tracked_free(dst, arr);
+    }
+#ifndef FE_OPT_NO_MALLOC_STRINGS
+    else if ((type(obj) == FE_TSTRING ||
+              (type(obj) == FE_TBYTES && !bytes_is_view(obj))) &&
+             FE_STR_DATA(dst, obj)) {
+      tracked_free(dst, FE_STR_DATA(dst, obj));
+    }
+#endif
+  }
+  tracked_free(dst, dst->symtab);
+  string_array_clear(dst, &dst->import_paths, &dst->import_path_count,
+                     &dst->import_path_capacity);
+  string_array_clear(dst, &dst->source_dirs, &dst->source_dir_count,
+                     &dst->source_dir_capacity);
+  string_array_clear(dst, &dst->loading_modules, &dst->loading_module_count,
+                     &dst->loading_module_capacity);
+  module_cache_clear(dst);
+}
+
+fe_Context* fe_clone(fe_Context *src, void *ptr, size_t size) {
+  const char *src_base = (const char*)src;
+  size_t pool_size = src->base_memory_bytes;
+  fe_Context *dst;
+  ptrdiff_t delta;
+  int i;
+
+  if (!ptr || size < pool_size) { return NULL; }
+  /* The template must be quiescent and self-contained: no evaluation in
+     flight, no on-demand arena chunks, no open file handles or string
+     builders, and no foreign-pointer objects whose ownership cannot be
+     duplicated. */
+  if (!isnil(src->calllist) || src->code_runs != NULL) { return NULL; }
+  if (src->resume_forms != NULL) { return NULL; }
+  if (src->chunks != NULL) { return NULL; }
+  if (fe_ctx_file_state(src) != NULL) { return NULL; }
+  if (fe_ctx_builder_state(src) != NULL) { return NULL; }
+  for (i = 0; i < src->object_count; i++) {
+    if (type(&src->objects[i]) == FE_TPTR) { return NULL; }
+  }
+
+  memcpy(ptr, src, pool_size);
+  dst = ptr;
+  delta = (char*)ptr - (char*)src;
+
+  /* Pool-internal layout pointers. */
+  dst->objects = (fe_Object*)((char*)src->objects + delta);
+#ifdef FE_OPT_NO_MALLOC_STRINGS
+  dst->str_base = src->str_base + delta;
+  dst->str_end = src->str_end + delta;
+#endif
+
+  /* Rooted object references held by the context itself. */
+  for (i = 0; i < dst->gcstack_idx; i++) {
+    dst->gcstack[i] = clone_reloc(dst->gcstack[i], src_base, pool_size, delta);
+  }
+  dst->calllist = &nil;
+  dst->freelist = clone_reloc(dst->freelist, src_base, pool_size, delta);
+  dst->modulestack = clone_reloc(dst->modulestack, src_base, pool_size, delta);
+  dst->symlist = clone_reloc(dst->symlist, src_base, pool_size, delta);
+  dst->t = clone_reloc(dst->t, src_base, pool_size, delta);
+  dst->return_sym = clone_reloc(dst->return_sym, src_base, pool_size, delta);
+  dst->frame_sym = clone_reloc(dst->frame_sym, src_base, pool_size, delta);
+  dst->do_sym = clone_reloc(dst->do_sym, src_base, pool_size, delta);
+  dst->let_sym = clone_reloc(dst->let_sym, src_base, pool_size, delta);
+  dst->quote_sym = clone_reloc(dst->quote_sym, src_base, pool_size, delta);
+  dst->fn_sym = clone_reloc(dst->fn_sym, src_base, pool_size, delta);
+  dst->mac_sym = clone_reloc(dst->mac_sym, src_base, pool_size, delta);
+
+  /* Detach every heap-allocated structure the memcpy still shares with
+     the template, then rebuild them against the clone. Span records and
+     retained source buffers are intentionally dropped: they only feed
+     diagnostics for code compiled before the fork. */
+  dst->symtab = NULL;
+  dst->import_paths = NULL;
+  dst->import_path_count = 0;
+  dst->import_path_capacity = 0;
+  dst->source_dirs = NULL;
+  dst->source_dir_count = 0;
+  dst->source_dir_capacity = 0;
+  dst->source_buffers = NULL;
+  dst->source_buffer_count = 0;
+  dst->source_buffer_capacity = 0;
+  dst->mapped_sources = NULL; /* mappings stay owned by the template */
+  dst->loading_modules = NULL;
+  dst->loading_module_count = 0;
+  dst->loading_module_capacity = 0;
+  dst->loaded_modules = NULL;
+  dst->loaded_module_count = 0;
+  dst->loaded_module_path_capacity = 0;
+  dst->loaded_module_values = NULL;
+  dst->loaded_module_value_capacity = 0;
+  dst->loaded_module_index = NULL;
+  dst->loaded_module_index_capacity = 0;
+  dst->module_resolutions = NULL;  /* resolution cache starts cold */
+  dst->module_resolution_count = 0;
+  dst->module_resolution_capacity = 0;
+  dst->compile_cache_entries = NULL;  /* limit carries over; entries do not */
+  dst->compile_cache_count = 0;
+  dst->span_state = NULL;
+  dst->temp_allocs = NULL;
+  dst->file_state = NULL;
+  dst->builder_state = NULL;
+  dst->process_state = NULL;
+  dst->code_runs = NULL;
+  dst->resume_forms = NULL;
+  dst->resume_result = NULL;
+  dst->profiling = 0;
+  dst->profile_depth = 0;
+  dst->profile_stack = NULL;
+  dst->profile_buckets = NULL;
+  dst->base_memory_bytes = pool_size;
+  dst->memory_used = pool_size;
+  dst->peak_memory_used = pool_size;
+
+  /* Deep-copy pass over the arena: fix car/cdr pointers and duplicate
+     per-object heap payloads. Numbers, prims, and cfuncs carry no object
+     pointers; string payloads live in the pool under slab mode. */
+  for (i = 0; i < dst->object_count; i++) {
+    fe_Object *obj = &dst->objects[i];
+    switch (type(obj)) {
+      case FE_TNUMBER:
+      case FE_TPRIM:
+      case FE_TCFUNC:
+        break;
+      case FE_TBYTES:
+        if (bytes_is_view(obj)) {
+          /* owner pointer and (offset . length) pair both live in-pool */
+          obj->car.o = clone_reloc(obj->car.o, src_base, pool_size, delta);
+          obj->cdr.o = clone_reloc(obj->cdr.o, src_base, pool_size, delta);
+          break;
+        }
+        /* fall-through */
+      case FE_TSTRING:
+#ifndef FE_OPT_NO_MALLOC_STRINGS
+        if (obj->cdr.s) {
+          size_t len = (size_t)FE_STR_LEN(obj);
+          char *copy = tracked_alloc(dst, len + 1);
+          if (!copy) { goto fail; }
+          memcpy(copy, obj->cdr.s, len);
+          copy[len] = '\0';
+          obj->cdr.s = copy;
+        }
+#endif
+        break;
+      case FE_TMAP: {
+        fe_Map *map = mapdata(obj);
+        obj->car.o = clone_reloc(obj->car.o, src_base, pool_size, delta);
+        if (map) {
+          fe_Map *copy = clone_map_data(dst, map, src_base, pool_size, delta);
+          if (!copy) { goto fail; }
+          obj->cdr.p = copy;
+        }
+        break;
+      }
+      case FE_TARRAY: {
+        fe_Array *arr = arraydata(obj);
+        obj->car.o = clone_reloc(obj->car.o, src_base, pool_size, delta);
+        if (arr) {
+          fe_Array *copy = clone_array_data(dst, arr, src_base, pool_size, delta);
+          if (!copy) { goto fail; }
+          obj->cdr.p = copy;
+        }
+        break;
+      }
+      default:
+        obj->car.o = clone_reloc(obj->car.o, src_base, pool_size, delta);
+        obj->cdr.o = clone_reloc(obj->cdr.o, src_base, pool_size, delta);
+        break;
+    }
+    continue;
+fail:
+    clone_abandon(dst, i);
+    return NULL;
+  }
+
+  /* Rebuild the symbol hash index over the relocated symlist. */
+  if (src->symtab && src->symtab_capacity > 0) {
+    dst->symtab = tracked_alloc(dst,
+        sizeof(fe_Object*) * (size_t)src->symtab_capacity);
+    if (!dst->symtab) {
+      clone_abandon(dst, dst->object_count);
+      return NULL;
+    }
+    for (i = 0; i < src->symtab_capacity; i++) {
+      dst->symtab[i] =
+          clone_reloc(src->symtab[i], src_base, pool_size, delta);
+    }
+  }
+
+  /* Import/module bookkeeping strings. */
+  if (!clone_string_array(dst, src->import_paths, src->import_path_count,
+          &dst->import_paths, &dst->import_path_count,
+          &dst->import_path_capacity) ||
+      !clone_string_array(dst, src->source_dirs, src->source_dir_count,
+          &dst->source_dirs, &dst->source_dir_count,
+          &dst->source_dir_capacity) ||
+      !clone_string_array(dst, src->loading_modules, src->loading_module_count,
+          &dst->loading_modules, &dst->loading_module_count,
+          &dst->loading_module_capacity) ||
+      !clone_string_array(dst, src->loaded_modules, src->loaded_module_count,
+          &dst->loaded_modules, &dst->loaded_module_count,
+          &dst->loaded_module_path_capacity)) {
+    clone_abandon(dst, dst->object_count);
+    return NULL;
+  }
+  if (src->loaded_module_values && src->loaded_module_count > 0) {
+    dst->loaded_module_values = tracked_alloc(dst,
+        sizeof(fe_Object*) * (size_t)src->loaded_module_count);
+    if (!dst->loaded_module_values) {
+      clone_abandon(dst, dst->object_count);
+      return NULL;
+    }
+    dst->loaded_module_value_capacity = src->loaded_module_count;
+    for (i = 0; i < src->loaded_module_count; i++) {
+      dst->loaded_module_values[i] =
+          clone_reloc(src->loaded_module_values[i], src_base, pool_size, delta);
+    }
+  }
+  if (dst->loaded_module_count > 0 &&
+      !module_index_reserve(dst, dst->loaded_module_count)) {
+    clone_abandon(dst, dst->object_count);
+    return NULL;
+  }
+
+  /* Fresh (empty) span state, preserving the enabled flag. */
+  fex_span_init(dst);
+  fex_span_set_enabled(dst, fex_span_is_enabled(src));
+  fex_span_set_calls_only(dst, fex_span_is_calls_only(src));
+
+  return dst;
+}
+
 void fe_close(fe_Context *ctx) {
+  profile_clear(ctx);
   fex_temp_cleanup_all(ctx);
   fex_span_cleanup(ctx);
+  fex_file_cleanup(ctx);
+  fex_builder_cleanup(ctx);
+  fex_process_cleanup(ctx);
   string_array_clear(ctx, &ctx->import_paths, &ctx->import_path_count, &ctx->import_path_capacity);
   string_array_clear(ctx, &ctx->source_dirs, &ctx->source_dir_count, &ctx->source_dir_capacity);
   string_array_clear(ctx, &ctx->source_buffers, &ctx->source_buffer_count, &ctx->source_buffer_capacity);
   string_array_clear(ctx, &ctx->loading_modules, &ctx->loading_module_count, &ctx->loading_module_capacity);
   module_cache_clear(ctx);
+  module_resolution_clear(ctx);
+  compile_cache_clear(ctx);
   /* clear gcstack and symlist; makes all objects unreachable */
   ctx->gcstack_idx = 0;
   ctx->symlist = &nil;
+  tracked_free(ctx, ctx->symtab);
+  ctx->symtab = NULL;
+  ctx->symtab_capacity = 0;
+  ctx->symtab_count = 0;
+  ctx->symlist_len = 0;
+  /* The final collection must free everything now, not lazily. */
+  ctx->gc_mode = FE_GC_FULL;
   collectgarbage(ctx);
+  /* Release on-demand arena chunks; every object in them is free now. */
+  while (ctx->chunks) {
+    fe_ObjectChunk *chunk = ctx->chunks;
+    ctx->chunks = chunk->next;
+    tracked_free(ctx, chunk->objects);
+    tracked_free(ctx, chunk);
+  }
+  ctx->chunk_object_count = 0;
+  /* Last: span records referencing mapped sources are gone by now. */
+  unmap_sources(ctx);
 }
 
 
@@ -32,6 +32,7 @@ typedef struct fe_Context fe_Context;
 typedef fe_Object* (*fe_CFunc)(fe_Context *ctx, fe_Object *args);
 typedef void (*fe_ErrorFn)(fe_Context *ctx, const char *err, fe_Object *cl);
 typedef void (*fe_WriteFn)(fe_Context *ctx, void *udata, char chr);
+typedef void (*fe_WriteBlockFn)(fe_Context *ctx, void *udata, const char *buf, size_t len);
 typedef char (*fe_ReadFn)(fe_Context *ctx, void *udata);
 typedef int (*fe_InterruptFn)(fe_Context *ctx, void *udata);
 typedef struct { fe_ErrorFn error; fe_CFunc mark, gc; } fe_Handlers;
@@ -48,8 +49,18 @@ typedef struct {
   size_t object_allocations_total;
   size_t allocs_since_gc;
   size_t gc_runs;
+  size_t gc_pause_us_last;  /* duration of the last collectgarbage() pause */
+  size_t gc_pause_us_max;   /* longest collectgarbage() pause so far */
+  size_t gc_reclaimed_last; /* objects reclaimed by the last completed cycle */
+  size_t gc_reclaimed_total;
 } fe_Stats;
 
+/* GC modes for fe_set_gc_mode(). FE_GC_FULL (the default) marks and sweeps
+ * the whole arena in one pause. FE_GC_INCREMENTAL pauses only for the mark
+ * phase and spreads the sweep across later allocations, bounding pause
+ * times on large arenas. */
+enum { FE_GC_FULL, FE_GC_INCREMENTAL };
+
 /**********************************
  *  Immediate representations
  **********************************/
@@ -82,18 +93,53 @@ fe_Number fe_num_value(fe_Object *o);
 
 enum {
   FE_TPAIR, FE_TFREE, FE_TNIL, FE_TNUMBER, FE_TSYMBOL, FE_TSTRING, FE_TBYTES,
-  FE_TFUNC, FE_TMACRO, FE_TPRIM, FE_TCFUNC, FE_TPTR, FE_TMAP,
+  FE_TFUNC, FE_TMACRO, FE_TPRIM, FE_TCFUNC, FE_TPTR, FE_TMAP, FE_TARRAY,
   FE_TBOOLEAN
 };
 
 fe_Context* fe_open(void *ptr, size_t size);
 void fe_close(fe_Context *ctx);
+/* Clones a fully initialized context into a caller-provided region of at
+ * least the template's fe_open() size: one memcpy of the pool, pointer
+ * relocation, and duplication of heap side structures, skipping builtin
+ * registration and prelude compilation. The template must be quiescent —
+ * no evaluation in flight, no on-demand arena chunks, no open file
+ * handles, and no ptr objects — or NULL is returned. Span records and
+ * retained source text do not carry over to the clone. */
+fe_Context* fe_clone(fe_Context *src, void *ptr, size_t size);
 fe_Handlers* fe_handlers(fe_Context *ctx);
 void fe_set_step_limit(fe_Context *ctx, size_t max_steps);
 size_t fe_get_step_limit(fe_Context *ctx);
 size_t fe_get_steps_executed(fe_Context *ctx);
 void fe_set_memory_limit(fe_Context *ctx, size_t max_bytes);
 size_t fe_get_memory_limit(fe_Context *ctx);
+void fe_set_gc_mode(fe_Context *ctx, int mode);
+int fe_get_gc_mode(fe_Context *ctx);
+/* GC pacing. By default the allocation-count trigger adapts after every
+ * collection (surviving objects times a growth factor) and the byte trigger
+ * is fixed at fe_open() time. fe_set_gc_threshold() pins the allocation
+ * trigger to `allocs` (0 restores the adaptive policy); the byte setter
+ * replaces the string-byte trigger (0 restores the fe_open() default).
+ * Getters return the trigger currently in force. */
+void fe_set_gc_threshold(fe_Context *ctx, size_t allocs);
+size_t fe_get_gc_threshold(fe_Context *ctx);
+void fe_set_gc_byte_threshold(fe_Context *ctx, size_t bytes);
+size_t fe_get_gc_byte_threshold(fe_Context *ctx);
+/* Collects immediately, even while collection is deferred. Under
+ * FE_GC_INCREMENTAL this pays the mark pause now and defers the sweep as
+ * usual. */
+void fe_gc(fe_Context *ctx);
+/* Suspends threshold-triggered collection around a known allocation burst.
+ * Calls nest: collection resumes once every fe_gc_defer() has been paired
+ * with an fe_gc_undefer(). An exhausted arena still collects regardless. */
+void fe_gc_defer(fe_Context *ctx);
+void fe_gc_undefer(fe_Context *ctx);
+int fe_gc_deferred(fe_Context *ctx);
+/* Growable arena: when enabled, the context allocates extra object chunks on
+ * demand (subject to fe_set_memory_limit) instead of raising "out of memory"
+ * when the fixed fe_open() region fills up. Off by default. */
+void fe_set_arena_growable(fe_Context *ctx, int enabled);
+int fe_get_arena_growable(fe_Context *ctx);
 size_t fe_get_memory_used(fe_Context *ctx);
 size_t fe_get_peak_memory_used(fe_Context *ctx);
 void fe_get_stats(fe_Context *ctx, fe_Stats *out_stats);
@@ -102,6 +148,15 @@ uint64_t fe_get_timeout_ms(fe_Context *ctx);
 void fe_set_interrupt_handler(fe_Context *ctx, fe_InterruptFn fn,
                               void *udata, size_t check_interval_steps);
 const char* fe_poll_abort(fe_Context *ctx);
+/* Call-counting profiler. fe_profile_start() begins (or restarts) profiling:
+ * every function and cfunc call is counted and timed, attributed to the
+ * callee's name (or to its source span for anonymous functions when spans
+ * are enabled). fe_profile_report() prints per-function call counts with
+ * inclusive/exclusive wall time and step counts, sorted by exclusive time.
+ * The `fex` CLI exposes this as --profile. */
+void fe_profile_start(fe_Context *ctx);
+void fe_profile_stop(fe_Context *ctx);
+void fe_profile_report(fe_Context *ctx, FILE *fp);
 void fe_set_eval_depth_limit(fe_Context *ctx, int max_depth);
 int fe_get_eval_depth_limit(fe_Context *ctx);
 void fe_set_read_depth_limit(fe_Context *ctx, int max_depth);
@@ -123,6 +178,10 @@ fe_Object* fe_string(fe_Context *ctx, const char *str, size_t len);
 fe_Object* fe_string_raw(fe_Context *ctx, size_t len, char fill_char);
 fe_Object* fe_bytes(fe_Context *ctx, const void *data, size_t len);
 fe_Object* fe_bytes_raw(fe_Context *ctx, size_t len, unsigned char fill_byte);
+/* O(1) slice view over a bytes object: no data is copied and the view keeps
+ * the owning bytes object alive. offset/len are clamped to the source range.
+ * Transparent to fe_byteslen/fe_bytescopy and the bytes builtins. */
+fe_Object* fe_bytes_slice(fe_Context *ctx, fe_Object *obj, size_t offset, size_t len);
 fe_Object* fe_symbol(fe_Context *ctx, const char *name);
 int fe_symbol_name_eq(fe_Context *ctx, fe_Object *sym, const char *str);
 fe_Object* fe_cfunc(fe_Context *ctx, fe_CFunc fn);
@@ -134,11 +193,21 @@ fe_Object* fe_map_get(fe_Context *ctx, fe_Object *map, fe_Object *key);
 int fe_map_delete(fe_Context *ctx, fe_Object *map, fe_Object *key);
 int fe_map_count(fe_Context *ctx, fe_Object *map);
 fe_Object* fe_map_keys(fe_Context *ctx, fe_Object *map);
+/* Contiguous arrays: O(1) indexing, amortized O(1) push. fe_array_get returns
+ * nil and fe_array_set returns 0 when the index is out of range. */
+fe_Object* fe_array(fe_Context *ctx);
+int fe_array_count(fe_Context *ctx, fe_Object *arr);
+void fe_array_push(fe_Context *ctx, fe_Object *arr, fe_Object *value);
+fe_Object* fe_array_get(fe_Context *ctx, fe_Object *arr, int index);
+int fe_array_set(fe_Context *ctx, fe_Object *arr, int index, fe_Object *value);
 fe_Object* fe_list(fe_Context *ctx, fe_Object **objs, int n);
 fe_Object* fe_car(fe_Context *ctx, fe_Object *obj);
 fe_Object* fe_cdr(fe_Context *ctx, fe_Object *obj);
 fe_Object** fe_cdr_ptr(fe_Context *ctx, fe_Object *obj);
 void fe_write(fe_Context *ctx, fe_Object *obj, fe_WriteFn fn, void *udata, int qt); /* qt: print with string quotes on/off */
+/* Like fe_write, but the sink receives batched chunks instead of one call
+ * per character; prefer it for large values. fe_writefp uses it. */
+void fe_write_block(fe_Context *ctx, fe_Object *obj, fe_WriteBlockFn fn, void *udata, int qt);
 void fe_writefp(fe_Context *ctx, fe_Object *obj, FILE *fp);
 int fe_tostring(fe_Context *ctx, fe_Object *obj, char *dst, int size);
 size_t fe_strlen(fe_Context *ctx, fe_Object *obj);/* caller must ensure obj is a string */
@@ -152,4 +221,17 @@ fe_Object* fe_read(fe_Context *ctx, fe_ReadFn fn, void *udata);
 fe_Object* fe_readfp(fe_Context *ctx, FILE *fp);
 fe_Object* fe_eval(fe_Context *ctx, fe_Object *obj);
 
+/* Resumable evaluation for cooperative scheduling. fe_eval_begin() stages a
+ * program - a (do ...) form or any single expression - without running it;
+ * fe_eval_resume() then evaluates its top-level forms until the program
+ * finishes (returns 0, final value in *out_result) or the step quota for
+ * the slice is exhausted (returns 1, call again later). Suspension points
+ * sit between top-level forms: an individual form always runs to
+ * completion, bounded only by the step, timeout, and interrupt limits.
+ * A quota of 0 runs without suspending. Errors discard the staged program,
+ * as does fe_eval_abort(). */
+void fe_eval_begin(fe_Context *ctx, fe_Object *obj);
+int fe_eval_resume(fe_Context *ctx, size_t step_quota, fe_Object **out_result);
+void fe_eval_abort(fe_Context *ctx);
+
 #endif
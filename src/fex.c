@@ -31,147 +31,206 @@
 #include "fex_internal.h"
 #include "fex_span.h"
 
+/* Scratch memory is bump-allocated from large arena blocks hanging off the
+   context's temp slot. Callers never free individual allocations; instead a
+   mark captures the arena position and a rollback discards everything bumped
+   after it. Compile scopes and try scopes each hold a mark, so both normal
+   exit and longjmp unwinding restore tracked memory to where it started. */
+
+#define FEX_TEMP_BLOCK_SIZE 8192u
+#define FEX_TEMP_ALIGN(n) (((n) + (sizeof(size_t) - 1)) & ~(sizeof(size_t) - 1))
+
+typedef struct FexTempBlock {
+    struct FexTempBlock *next;   /* older block, or NULL */
+    size_t used;
+    size_t cap;
+    size_t last_off;             /* offset of the newest allocation's header,
+                                    or (size_t)-1 when it cannot be popped */
+    /* payload bytes follow the header */
+} FexTempBlock;
+
+typedef struct FexTempArena {
+    FexTempBlock *blocks;        /* newest block first */
+} FexTempArena;
+
+typedef struct FexTempMark {
+    FexTempBlock *block;
+    size_t used;
+} FexTempMark;
+
 typedef struct FexTryScope {
     jmp_buf env;
     FexError *error;
-    struct FexTempAlloc *temps;
+    FexTempMark temps;
     const char *source_name;
     struct FexTryScope *previous;
 } FexTryScope;
 
 static FEX_THREAD_LOCAL FexTryScope *g_try_scope = NULL;
 
-typedef struct FexTempAlloc {
-    struct FexTempAlloc *previous;
-    struct FexTempAlloc *next;
-    FexTryScope *owner;
-} FexTempAlloc;
-
-static FexTempAlloc *fex_temp_head(fe_Context *ctx) {
-    return (FexTempAlloc*)fe_ctx_temp_allocs(ctx);
+static FexTempArena *fex_temp_arena(fe_Context *ctx) {
+    return (FexTempArena*)fe_ctx_temp_allocs(ctx);
 }
 
-static void fex_temp_set_head(fe_Context *ctx, FexTempAlloc *node) {
-    fe_ctx_set_temp_allocs(ctx, node);
+static char *fex_temp_block_payload(FexTempBlock *block) {
+    return (char*)(block + 1);
 }
 
-static void fex_temp_link(fe_Context *ctx, FexTempAlloc *node) {
-    node->previous = NULL;
-    node->next = fex_temp_head(ctx);
-    if (node->next) {
-        node->next->previous = node;
-    }
-    fex_temp_set_head(ctx, node);
+static void fex_temp_mark(fe_Context *ctx, FexTempMark *mark) {
+    FexTempArena *arena = fex_temp_arena(ctx);
+    mark->block = arena ? arena->blocks : NULL;
+    mark->used = mark->block ? mark->block->used : 0;
 }
 
-static void fex_temp_unlink(fe_Context *ctx, FexTempAlloc *node) {
-    if (!node) {
+/* Discard every allocation bumped after `mark`, freeing whole blocks as they
+   empty. Rolling back to a mark taken before the arena existed releases the
+   arena itself, so memory accounting returns to its pre-scope level. */
+static void fex_temp_rollback(fe_Context *ctx, FexTempMark *mark) {
+    FexTempArena *arena = fex_temp_arena(ctx);
+    FexTempBlock *block;
+
+    if (!arena) {
         return;
     }
-    if (node->previous) {
-        node->previous->next = node->next;
-    } else {
-        fex_temp_set_head(ctx, node->next);
+
+    /* A mark whose block is no longer in the arena is stale (the arena was
+       torn down during error unwinding); treat it as the empty position. */
+    if (mark->block) {
+        for (block = arena->blocks; block && block != mark->block; block = block->next) {}
+        if (!block) {
+            mark->block = NULL;
+            mark->used = 0;
+        }
     }
-    if (node->next) {
-        node->next->previous = node->previous;
+
+    while (arena->blocks && arena->blocks != mark->block) {
+        block = arena->blocks;
+        arena->blocks = block->next;
+        fe_ctx_tracked_free(ctx, block);
+    }
+    if (arena->blocks) {
+        arena->blocks->used = mark->used;
+        arena->blocks->last_off = (size_t)-1;
+    } else {
+        fe_ctx_tracked_free(ctx, arena);
+        fe_ctx_set_temp_allocs(ctx, NULL);
     }
-    node->previous = NULL;
-    node->next = NULL;
-    node->owner = NULL;
 }
 
 static void fex_try_scope_free_temps(fe_Context *ctx, FexTryScope *scope) {
-    FexTempAlloc *node;
-    FexTempAlloc *next;
-
     if (!scope) {
         return;
     }
-
-    node = fex_temp_head(ctx);
-    while (node) {
-        next = node->next;
-        if (node->owner == scope) {
-            fex_temp_unlink(ctx, node);
-            fe_ctx_tracked_free(ctx, node);
-        }
-        node = next;
-    }
-    scope->temps = NULL;
+    fex_temp_rollback(ctx, &scope->temps);
 }
 
 void fex_temp_cleanup_all(fe_Context *ctx) {
-    FexTempAlloc *node = fex_temp_head(ctx);
-    while (node) {
-        FexTempAlloc *next = node->next;
-        fe_ctx_tracked_free(ctx, node);
-        node = next;
+    FexTempArena *arena = fex_temp_arena(ctx);
+    if (!arena) {
+        return;
+    }
+    while (arena->blocks) {
+        FexTempBlock *next = arena->blocks->next;
+        fe_ctx_tracked_free(ctx, arena->blocks);
+        arena->blocks = next;
     }
-    fex_temp_set_head(ctx, NULL);
+    fe_ctx_tracked_free(ctx, arena);
+    fe_ctx_set_temp_allocs(ctx, NULL);
 }
 
+/* Each allocation carries a size_t header recording its requested size, so
+   realloc knows how much to copy when it has to migrate. */
 static void *fex_temp_alloc(fe_Context *ctx, size_t size) {
-    FexTempAlloc *node;
-    size_t total = sizeof(*node) + (size > 0 ? size : 1);
-
-    node = (FexTempAlloc*)fe_ctx_tracked_alloc(ctx, total);
-    if (!node) {
-        fe_ctx_memory_error(ctx, "out of memory");
-        return NULL;
+    FexTempArena *arena = fex_temp_arena(ctx);
+    FexTempBlock *block;
+    size_t need = FEX_TEMP_ALIGN(sizeof(size_t) + (size > 0 ? size : 1));
+    size_t *header;
+
+    if (!arena) {
+        arena = (FexTempArena*)fe_ctx_tracked_alloc(ctx, sizeof(*arena));
+        if (!arena) {
+            fe_ctx_memory_error(ctx, "out of memory");
+            return NULL;
+        }
+        arena->blocks = NULL;
+        fe_ctx_set_temp_allocs(ctx, arena);
     }
 
-    node->owner = g_try_scope;
-    fex_temp_link(ctx, node);
-    if (g_try_scope) {
-        g_try_scope->temps = node;
+    block = arena->blocks;
+    if (!block || block->cap - block->used < need) {
+        size_t cap = need > FEX_TEMP_BLOCK_SIZE ? need : FEX_TEMP_BLOCK_SIZE;
+        block = (FexTempBlock*)fe_ctx_tracked_alloc(ctx, sizeof(*block) + cap);
+        if (!block) {
+            fe_ctx_memory_error(ctx, "out of memory");
+            return NULL;
+        }
+        block->next = arena->blocks;
+        block->used = 0;
+        block->cap = cap;
+        block->last_off = (size_t)-1;
+        arena->blocks = block;
     }
-    return node + 1;
+
+    header = (size_t*)(fex_temp_block_payload(block) + block->used);
+    *header = size;
+    block->last_off = block->used;
+    block->used += need;
+    return header + 1;
 }
 
 static void *fex_temp_realloc(fe_Context *ctx, void *ptr, size_t size) {
-    FexTempAlloc *node;
-    FexTempAlloc *grown;
-    FexTryScope *owner;
+    FexTempArena *arena = fex_temp_arena(ctx);
+    FexTempBlock *block;
+    size_t *header;
+    size_t old_size;
+    void *grown;
 
     if (!ptr) {
         return fex_temp_alloc(ctx, size);
     }
 
-    node = ((FexTempAlloc*)ptr) - 1;
-    owner = node->owner;
-    grown = (FexTempAlloc*)fe_ctx_tracked_realloc(ctx, node, sizeof(*node) + (size > 0 ? size : 1));
-    if (!grown) {
-        fe_ctx_memory_error(ctx, "out of memory");
-        return NULL;
+    header = ((size_t*)ptr) - 1;
+    old_size = *header;
+    if (size <= old_size) {
+        return ptr;
     }
 
-    if (grown->previous) {
-        grown->previous->next = grown;
-    } else {
-        fex_temp_set_head(ctx, grown);
-    }
-    if (grown->next) {
-        grown->next->previous = grown;
-    }
-    grown->owner = owner;
-    if (owner && owner->temps == node) {
-        owner->temps = grown;
+    /* The newest allocation can grow in place by bumping further. */
+    block = arena ? arena->blocks : NULL;
+    if (block && block->last_off != (size_t)-1 &&
+        ptr == (void*)(fex_temp_block_payload(block) + block->last_off + sizeof(size_t))) {
+        size_t need = FEX_TEMP_ALIGN(sizeof(size_t) + size);
+        if (block->cap - block->last_off >= need) {
+            block->used = block->last_off + need;
+            *header = size;
+            return ptr;
+        }
     }
 
-    return grown + 1;
+    grown = fex_temp_alloc(ctx, size);
+    if (!grown) {
+        return NULL;
+    }
+    memcpy(grown, ptr, old_size);
+    return grown;
 }
 
+/* Only the newest allocation can actually be returned to the arena; anything
+   else stays bumped until the owning scope rolls back. */
 static void fex_temp_free(fe_Context *ctx, void *ptr) {
-    FexTempAlloc *node;
+    FexTempArena *arena = fex_temp_arena(ctx);
+    FexTempBlock *block;
 
-    if (!ptr) {
+    if (!ptr || !arena) {
         return;
     }
 
-    node = ((FexTempAlloc*)ptr) - 1;
-    fex_temp_unlink(ctx, node);
-    fe_ctx_tracked_free(ctx, node);
+    block = arena->blocks;
+    if (block && block->last_off != (size_t)-1 &&
+        ptr == (void*)(fex_temp_block_payload(block) + block->last_off + sizeof(size_t))) {
+        block->used = block->last_off;
+        block->last_off = (size_t)-1;
+    }
 }
 
 static void copy_string(char *dst, size_t dst_size, const char *src) {
@@ -695,8 +754,10 @@ void fex_init_with_builtins(fe_Context *ctx, FexConfig config,
         builtins = FEX_BUILTINS_ALL;
     }
 
-    /* Configure spans */
-    fex_span_set_enabled(ctx, config & FEX_CONFIG_ENABLE_SPANS);
+    /* Configure spans; calls-only granularity implies recording. */
+    fex_span_set_enabled(ctx, config &
+        (FEX_CONFIG_ENABLE_SPANS | FEX_CONFIG_SPANS_CALLS_ONLY));
+    fex_span_set_calls_only(ctx, config & FEX_CONFIG_SPANS_CALLS_ONLY);
 
     /* Save/restore GC stack to avoid leaking the symbol object. */
     int gc_save = fe_savegc(ctx);
@@ -1012,6 +1073,8 @@ struct Parser {
 struct FexCompileState {
     Lexer lexer;
     Parser parser;
+    fe_Object *literals;   /* string-literal intern map, or NULL */
+    FexTempMark temp_mark; /* scratch arena position at scope entry */
     struct FexCompileState *previous;
 };
 
@@ -1048,6 +1111,8 @@ static FexCompileState *enter_compile_scope(fe_Context *ctx, const char *source,
         return NULL;
     }
 
+    scope->literals = NULL;
+    fex_temp_mark(ctx, &scope->temp_mark);
     scope->previous = g_compile_state;
     g_compile_state = scope;
 
@@ -1066,6 +1131,18 @@ static void leave_compile_scope(FexCompileState *scope) {
     if (!scope) {
         return;
     }
+    /* Release the literal table's tracked payload now rather than at the
+       next sweep: direct compiles must leave memory accounting where they
+       found it. Interned strings live on through the AST. */
+    if (scope->literals) {
+        fe_ctx_map_release(scope->parser.ctx, scope->literals);
+        scope->literals = NULL;
+    }
+    fex_temp_rollback(scope->parser.ctx, &scope->temp_mark);
+    /* The span recorder caches a pointer to the source buffer being
+       compiled; invalidate it so a later buffer reusing the same address
+       cannot alias this unit's retained text. */
+    fex_span_source_done(scope->parser.ctx);
     g_compile_state = scope->previous;
     fe_ctx_tracked_free(scope->parser.ctx, scope);
 }
@@ -1210,9 +1287,50 @@ static fe_Object* symbol_from_token(Token *token) {
     return fe_symbol(P.ctx, buffer);
 }
 
+/* Compile-time constant folding: arithmetic and comparison nodes whose
+   operands are both numeric literals collapse to their result object at
+   parse time, mirroring the runtime P_ADD..P_DIV and P_LT..P_GTE
+   semantics (fe_make_number boxes or unboxes exactly as eval would).
+   Division by a literal zero is left in the tree so the runtime error
+   fires where the user wrote it. Returns NULL when the node must be
+   built normally. */
+static fe_Object* fold_binary(const char* op, fe_Object* left, fe_Object* right) {
+    fe_Context *c = P.ctx;
+    fe_Number a, b;
+    if (op[0] != '+' && op[0] != '-' && op[0] != '*' && op[0] != '/' &&
+        op[0] != '<' && op[0] != '>') {
+        return NULL;
+    }
+    if (op[1] != '\0' && !(op[1] == '=' && op[2] == '\0')) {
+        return NULL;
+    }
+    if (fe_type(c, left) != FE_TNUMBER || fe_type(c, right) != FE_TNUMBER) {
+        return NULL;
+    }
+    a = fe_num_value(left);
+    b = fe_num_value(right);
+    switch (op[0]) {
+        case '+': return fe_make_number(c, a + b);
+        case '-': return fe_make_number(c, a - b);
+        case '*': return fe_make_number(c, a * b);
+        case '/': return b == 0 ? NULL : fe_make_number(c, a / b);
+        case '<': return fe_bool(c, op[1] == '=' ? a <= b : a < b);
+        case '>': return fe_bool(c, op[1] == '=' ? a >= b : a > b);
+    }
+    return NULL;
+}
+
 static fe_Object* make_unary(const char* op, fe_Object* right) {
     fe_Context *c = P.ctx;
-    int guard = fe_savegc(c);
+    int guard;
+    if (op[0] == '-' && op[1] == '\0' &&
+        fe_type(c, right) == FE_TNUMBER) {
+        return fe_make_number(c, -fe_num_value(right));
+    }
+    if (strcmp(op, "not") == 0 && FE_IS_BOOLEAN(right)) {
+        return fe_bool(c, !FE_IS_TRUE(right));
+    }
+    guard = fe_savegc(c);
     fe_pushgc(c, right);                     /* protect operand  */
     fe_Object *op_s = fe_symbol(c, op);      /* intern is GC-safe anyway */
     fe_pushgc(c, op_s);
@@ -1224,7 +1342,10 @@ static fe_Object* make_unary(const char* op, fe_Object* right) {
 
 static fe_Object* make_binary(const char* op, fe_Object* left, fe_Object* right) {
     fe_Context *c = P.ctx;
-    int guard = fe_savegc(c);
+    int guard;
+    fe_Object *folded = fold_binary(op, left, right);
+    if (folded) { return folded; }
+    guard = fe_savegc(c);
     fe_pushgc(c, left);  fe_pushgc(c, right);           /* protect args   */
     fe_Object *op_s = fe_symbol(c, op);  fe_pushgc(c, op_s);
 
@@ -1619,6 +1740,21 @@ static fe_Object* parse_string_literal(int as_symbol) {
         result = fe_symbol(P.ctx, buf);
     } else {
         result = fe_string(P.ctx, buf, out);
+        if (g_compile_state->literals) {
+            fe_Object *interned;
+            int guard = fe_savegc(P.ctx);
+            fe_pushgc(P.ctx, result);
+            interned = fe_map_get(P.ctx, g_compile_state->literals, result);
+            fe_restoregc(P.ctx, guard);
+            if (fe_type(P.ctx, interned) == FE_TSTRING) {
+                /* Reuse the first occurrence (and its recorded span). */
+                if (heap_buf) {
+                    fex_temp_free(P.ctx, heap_buf);
+                }
+                return interned;
+            }
+            fe_map_set(P.ctx, g_compile_state->literals, result, result);
+        }
     }
     fex_record_span(P.ctx, result, L.source, L.source_name,
                     P.previous.line, P.previous.column,
@@ -2041,6 +2177,7 @@ fe_Object* fex_compile_named(fe_Context *ctx, const char *source,
     fe_Object* nil_obj = fex_nil(ctx);
     fe_Object *program;
     int count = 0;
+    int gc_entry;
     int gc_base;
     fe_Object *head;
     fe_Object **tail;
@@ -2055,6 +2192,12 @@ fe_Object* fex_compile_named(fe_Context *ctx, const char *source,
 
     head = nil_obj;
     tail = &head;
+    /* Shared string-literal table for this compile: repeated quoted
+       literals resolve to one object. Rooted below gc_base so the
+       per-statement restores in the loop keep it alive. */
+    gc_entry = fe_savegc(ctx);
+    scope->literals = fe_map(ctx);
+    fe_pushgc(ctx, scope->literals);
     gc_base = fe_savegc(ctx);
 
     while (!parser_match(TOKEN_EOF)) {
@@ -2072,7 +2215,7 @@ fe_Object* fex_compile_named(fe_Context *ctx, const char *source,
     }
 
     if (P.had_error || L.had_error) {
-        fe_restoregc(ctx, gc_base);
+        fe_restoregc(ctx, gc_entry);
         leave_compile_scope(scope);
         return NULL;
     }
@@ -2098,7 +2241,10 @@ fe_Object* fex_compile_named(fe_Context *ctx, const char *source,
     }
 
     /* hand the finished AST back still rooted - caller pushes it again
-       immediately, and later pops the whole frame, so no leak occurs.   */
+       immediately, and later pops the whole frame, so no leak occurs.
+       The literal table is dropped here; interned strings stay reachable
+       through the AST. */
+    fe_restoregc(ctx, gc_entry);
     fe_pushgc(ctx, program);
     leave_compile_scope(scope);
     return program;
@@ -2111,10 +2257,16 @@ fe_Object* fex_compile(fe_Context *ctx, const char *source) {
 fe_Object* fex_do_string_named(fe_Context *ctx, const char *source,
                                const char *source_name) {
     int gc_save = fe_savegc(ctx);
-    fe_Object* code = fex_compile_named(ctx, source, source_name);
+    /* Recurring snippets skip the lexer/parser entirely when the compile
+       cache holds their tree (see fex_set_compile_cache). */
+    fe_Object* code = fe_ctx_compile_cache_get(ctx, source, source_name);
     if (!code) {
-        fe_restoregc(ctx, gc_save);
-        return NULL;
+        code = fex_compile_named(ctx, source, source_name);
+        if (!code) {
+            fe_restoregc(ctx, gc_save);
+            return NULL;
+        }
+        fe_ctx_compile_cache_put(ctx, source, source_name, code);
     }
     fe_pushgc(ctx, code);
     fe_Object *res = fe_eval(ctx, code);
@@ -2144,7 +2296,7 @@ FexStatus fex_try_run_internal(fe_Context *ctx, fe_Object **out_result,
     fex_error_clear(out_error);
 
     scope.error = out_error;
-    scope.temps = NULL;
+    fex_temp_mark(ctx, &scope.temps);
     scope.source_name = source_name ? source_name : "<string>";
     scope.previous = g_try_scope;
     g_try_scope = &scope;
@@ -33,6 +33,9 @@ typedef enum {
     FEX_CONFIG_NONE = 0,
     FEX_CONFIG_ENABLE_SPANS = 1 << 0,
     FEX_CONFIG_ENABLE_EXTENDED_BUILTINS = 1 << 1,
+    /* Record spans for call forms only (implies span recording); cheaper
+       than FEX_CONFIG_ENABLE_SPANS while keeping call-site diagnostics. */
+    FEX_CONFIG_SPANS_CALLS_ONLY = 1 << 2,
 } FexConfig;
 
 typedef enum {
@@ -145,6 +148,51 @@ fe_Object* fex_do_file(fe_Context *ctx, const char *path);
 FexStatus fex_try_do_file(fe_Context *ctx, const char *path,
                           fe_Object **out_result, FexError *out_error);
 
+/*
+ * On-disk precompiled module cache.  When enabled (the default),
+ * `fex_do_file` and file imports look for `<path>c` next to the source
+ * (e.g. `foo.fexc` beside `foo.fex`) and evaluate the cached compiled
+ * form instead of reading and compiling the source, as long as the
+ * cache's recorded mtime and size still match the file.  A stale or
+ * corrupt cache is silently ignored.  Caches are only ever written by
+ * `fex_compile_file`; note that cache-loaded code carries no source
+ * spans, so runtime diagnostics from it omit line/column details.
+ */
+void fex_set_module_cache(fe_Context *ctx, int enabled);
+int fex_get_module_cache(fe_Context *ctx);
+
+/*
+ * Bounds the in-memory compile cache consulted by `fex_do_string` and the
+ * `fex_try_do_string` family.  While enabled, evaluating byte-identical
+ * source (under the same source name) reuses the previously compiled tree
+ * instead of re-running the lexer and parser; the cached trees are pinned
+ * against garbage collection for as long as their entries live.  The cache
+ * holds at most `max_entries` snippets, evicting the least recently used
+ * one on overflow.  Passing 0 (the default) disables caching and drops any
+ * existing entries, as does changing the bound.  Note that macros expand
+ * in place, so a cached tree carries its expansions forward to later runs.
+ */
+void fex_set_compile_cache(fe_Context *ctx, int max_entries);
+int fex_get_compile_cache(fe_Context *ctx);
+
+/*
+ * Drops every compile-cache entry without changing the configured bound.
+ */
+void fex_clear_compile_cache(fe_Context *ctx);
+
+/*
+ * Compiles a source file and writes its module cache without evaluating
+ * it.  Returns non-zero on success.
+ */
+int fex_compile_file(fe_Context *ctx, const char *path);
+
+/*
+ * Like `fex_compile_file`, but reports I/O and compile errors through a
+ * structured error instead of terminating the process.
+ */
+FexStatus fex_try_compile_file(fe_Context *ctx, const char *path,
+                               FexError *out_error);
+
 /*
  * Adds an import search path for file-based `import` resolution.
  * Returns non-zero on success.
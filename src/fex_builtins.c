@@ -53,6 +53,7 @@
 #include <unistd.h>
 #include <errno.h>
 #include <fcntl.h>
+#include <pthread.h>
 #include <signal.h>
 #include <sys/select.h>
 #include <sys/stat.h>
@@ -310,9 +311,13 @@ static int buf_append_mem_polling(fe_Context *ctx, TextBuffer *buf,
     return 1;
 }
 
+#ifdef _WIN32
+/* Only the Windows listdir pattern builder appends C strings these days;
+   everything else knows its lengths and goes through buf_append_mem. */
 static int buf_append_str(TextBuffer *buf, const char *str) {
     return buf_append_mem(buf, str, strlen(str));
 }
+#endif
 
 static int buf_append_char(TextBuffer *buf, char chr) {
     if (!buf_reserve(buf, 1)) {
@@ -632,6 +637,15 @@ static unsigned char* bytes_to_buffer(fe_Context *ctx, fe_Object *bytes_obj, con
     return buffer;
 }
 
+/* Accepts a bytes or string argument and returns a contiguous copy of its
+ * payload. The caller releases the buffer with builtin_free. */
+static unsigned char* bytes_or_string_buffer(fe_Context *ctx, fe_Object *obj, const char *func_name, size_t *out_len) {
+    if (fe_type(ctx, obj) == FE_TSTRING) {
+        return (unsigned char*)string_to_buffer(ctx, obj, func_name, out_len);
+    }
+    return bytes_to_buffer(ctx, obj, func_name, out_len);
+}
+
 static fe_Object* string_to_bytes(fe_Context *ctx, fe_Object *str_obj, const char *func_name) {
     size_t len;
     char *buffer;
@@ -698,23 +712,67 @@ static int bytes_contains_byte(const char *set, size_t set_len, unsigned char va
     return 0;
 }
 
-static int bytes_contains_sequence(const char *haystack, size_t haystack_len,
-                                   const char *needle, size_t needle_len) {
-    size_t i;
+/* SWAR helpers for the bulk bytes builtins: classify eight bytes per
+ * iteration, the same zero-in-word technique as the JSON scanner further
+ * down. bytes_swar_eq sets 0x80 in every byte position equal to chr. */
+#define BYTES_SWAR_ONES  ((uint64_t)0x0101010101010101u)
+#define BYTES_SWAR_HIGHS ((uint64_t)0x8080808080808080u)
+
+static uint64_t bytes_swar_load(const unsigned char *p) {
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static uint64_t bytes_swar_eq(uint64_t v, unsigned char chr) {
+    uint64_t x = v ^ (BYTES_SWAR_ONES * chr);
+    return (x - BYTES_SWAR_ONES) & ~x & BYTES_SWAR_HIGHS;
+}
+
+/* Substring search: SWAR scan for the needle's first byte, memcmp to
+ * confirm a candidate. Returns the match offset or (size_t)-1. */
+static size_t bytes_find_range(const unsigned char *hay, size_t hay_len,
+                               const unsigned char *needle, size_t needle_len,
+                               size_t start) {
+    size_t i = start;
+    size_t last;
+    unsigned char first;
 
     if (needle_len == 0) {
-        return 1;
+        return start <= hay_len ? start : (size_t)-1;
     }
-    if (needle_len > haystack_len) {
-        return 0;
+    if (needle_len > hay_len || start > hay_len - needle_len) {
+        return (size_t)-1;
     }
+    last = hay_len - needle_len;   /* last candidate position */
+    first = needle[0];
 
-    for (i = 0; i + needle_len <= haystack_len; i++) {
-        if (memcmp(haystack + i, needle, needle_len) == 0) {
-            return 1;
+    while (i <= last) {
+        /* Skip whole blocks with no first-byte hit. */
+        while (i + 8 <= hay_len &&
+               bytes_swar_eq(bytes_swar_load(hay + i), first) == 0) {
+            i += 8;
+        }
+        for (; i <= last && (i & 7u) != 0; i++) {
+            if (hay[i] == first &&
+                memcmp(hay + i, needle, needle_len) == 0) {
+                return i;
+            }
+        }
+        if (i > last) { break; }
+        if (hay[i] == first && memcmp(hay + i, needle, needle_len) == 0) {
+            return i;
         }
+        i++;
     }
-    return 0;
+    return (size_t)-1;
+}
+
+static int bytes_contains_sequence(const char *haystack, size_t haystack_len,
+                                   const char *needle, size_t needle_len) {
+    return bytes_find_range((const unsigned char*)haystack, haystack_len,
+                            (const unsigned char*)needle, needle_len,
+                            0) != (size_t)-1;
 }
 
 static int is_path_separator_char(char chr) {
@@ -1413,6 +1471,176 @@ static fe_Object* builtin_string_concat(fe_Context *ctx, fe_Object *args) {
     return obj;
 }
 
+/*
+ * String builders.  A builder is an FE_TPTR object whose pointer refers
+ * to a FexStrBuilder node in the per-context registry hanging off
+ * fe_ctx_builder_state().  Builders are validated against the registry
+ * on every use, the buffer grows geometrically through the tracked
+ * allocator so looped appends stay linear and count against the context
+ * memory limit, sbfree() hands the buffer back early (mirroring
+ * fclose() for file handles), and fex_builder_cleanup() releases
+ * whatever is left when the context shuts down.
+ */
+typedef struct FexStrBuilder {
+    char *data;              /* tracked allocation, geometric growth */
+    size_t len;
+    size_t cap;
+    int released;            /* sbfree() ran; the node stays as a tombstone */
+    struct FexStrBuilder *next;
+} FexStrBuilder;
+
+static FexStrBuilder* builder_from_obj(fe_Context *ctx, fe_Object *obj,
+                                       const char *func_name) {
+    FexStrBuilder *builder;
+    void *ptr;
+    char message[64];
+
+    if (fe_type(ctx, obj) != FE_TPTR) {
+        snprintf(message, sizeof(message), "%s: expected a string builder", func_name);
+        fe_error(ctx, message);
+        return NULL;
+    }
+    ptr = fe_toptr(ctx, obj);
+    for (builder = (FexStrBuilder*)fe_ctx_builder_state(ctx); builder;
+         builder = builder->next) {
+        if (builder == ptr) {
+            if (builder->released) {
+                snprintf(message, sizeof(message),
+                         "%s: string builder is freed", func_name);
+                fe_error(ctx, message);
+                return NULL;
+            }
+            return builder;
+        }
+    }
+    snprintf(message, sizeof(message), "%s: invalid string builder", func_name);
+    fe_error(ctx, message);
+    return NULL;
+}
+
+void fex_builder_cleanup(fe_Context *ctx) {
+    FexStrBuilder *builder = (FexStrBuilder*)fe_ctx_builder_state(ctx);
+    while (builder) {
+        FexStrBuilder *next = builder->next;
+        tracked_builtin_free(ctx, builder->data);
+        tracked_builtin_free(ctx, builder);
+        builder = next;
+    }
+    fe_ctx_set_builder_state(ctx, NULL);
+}
+
+static int builder_reserve(fe_Context *ctx, FexStrBuilder *builder, size_t extra) {
+    size_t needed;
+    size_t new_cap;
+    char *new_data;
+
+    needed = builder->len + extra + 1;
+    if (needed <= builder->cap) {
+        return 1;
+    }
+    new_cap = (builder->cap > 0) ? builder->cap : 64;
+    while (new_cap < needed) {
+        new_cap *= 2;
+    }
+    new_data = (char*)fe_ctx_tracked_realloc(ctx, builder->data, new_cap);
+    if (!new_data) {
+        return 0;
+    }
+    builder->data = new_data;
+    builder->cap = new_cap;
+    return 1;
+}
+
+static fe_Object* builtin_sb_new(fe_Context *ctx, fe_Object *args) {
+    FexStrBuilder *builder;
+
+    FEX_CHECK_NO_ARGS(ctx, args, "sbnew");
+    builder = (FexStrBuilder*)tracked_builtin_alloc(ctx, sizeof(*builder));
+    if (!builder) {
+        fe_ctx_memory_error(ctx, "sbnew: out of memory");
+        return fe_nil(ctx);
+    }
+    builder->data = NULL;
+    builder->len = 0;
+    builder->cap = 0;
+    builder->released = 0;
+    builder->next = (FexStrBuilder*)fe_ctx_builder_state(ctx);
+    fe_ctx_set_builder_state(ctx, builder);
+    return fe_ptr(ctx, builder);
+}
+
+static fe_Object* builtin_sb_append(fe_Context *ctx, fe_Object *args) {
+    fe_Object *builder_obj;
+    FexStrBuilder *builder;
+    size_t poll_countdown = FEX_BUILTIN_ABORT_CHECK_INTERVAL;
+    const char *abort_error = NULL;
+
+    FEX_CHECK_ARGS(ctx, args, 2, "sbappend");
+    builder_obj = fe_nextarg(ctx, &args);
+    builder = builder_from_obj(ctx, builder_obj, "sbappend");
+    if (!builder) return fe_nil(ctx);
+
+    while (!fe_isnil(ctx, args)) {
+        fe_Object *arg = fe_nextarg(ctx, &args);
+
+        abort_error = builtin_poll_abort(ctx, &poll_countdown);
+        if (abort_error != NULL) {
+            fe_error(ctx, abort_error);
+            return fe_nil(ctx);
+        }
+
+        if (fe_type(ctx, arg) == FE_TSTRING) {
+            /* Write the string straight into the reserved tail: no
+               intermediate copy, so each append is O(its length). */
+            size_t len = fe_strlen(ctx, arg);
+            if (!builder_reserve(ctx, builder, len)) {
+                fe_ctx_memory_error(ctx, "sbappend: out of memory");
+                return fe_nil(ctx);
+            }
+            fe_tostring(ctx, arg, builder->data + builder->len, (int)(len + 1));
+            builder->len += len;
+        } else {
+            char stack_buffer[1024];
+            size_t len = (size_t)fe_tostring(ctx, arg, stack_buffer, sizeof(stack_buffer));
+            if (!builder_reserve(ctx, builder, len)) {
+                fe_ctx_memory_error(ctx, "sbappend: out of memory");
+                return fe_nil(ctx);
+            }
+            memcpy(builder->data + builder->len, stack_buffer, len);
+            builder->len += len;
+            builder->data[builder->len] = '\0';
+        }
+    }
+    return builder_obj;
+}
+
+static fe_Object* builtin_sb_tostring(fe_Context *ctx, fe_Object *args) {
+    FexStrBuilder *builder;
+
+    FEX_CHECK_ARGS(ctx, args, 1, "sbtostring");
+    builder = builder_from_obj(ctx, fe_nextarg(ctx, &args), "sbtostring");
+    if (!builder) return fe_nil(ctx);
+    return fe_string(ctx, builder->data ? builder->data : "", builder->len);
+}
+
+static fe_Object* builtin_sb_free(fe_Context *ctx, fe_Object *args) {
+    FexStrBuilder *builder;
+
+    FEX_CHECK_ARGS(ctx, args, 1, "sbfree");
+    builder = builder_from_obj(ctx, fe_nextarg(ctx, &args), "sbfree");
+    if (!builder) return fe_nil(ctx);
+    /* Like fclose(), the registry node stays behind as a tombstone so a
+       stale handle reports a clean error instead of aliasing a builder
+       that later reuses the address; only the buffer is returned to the
+       tracked allocator. */
+    tracked_builtin_free(ctx, builder->data);
+    builder->data = NULL;
+    builder->len = 0;
+    builder->cap = 0;
+    builder->released = 1;
+    return fe_bool(ctx, 1);
+}
+
 static fe_Object* builtin_string_substring(fe_Context *ctx, fe_Object *args) {
     FEX_CHECK_ARGS(ctx, args, 2, "substring");
     fe_Object *str = fe_nextarg(ctx, &args);
@@ -1694,9 +1922,6 @@ static fe_Object* builtin_bytes_slice(fe_Context *ctx, fe_Object *args) {
     size_t len;
     int start;
     int end;
-    size_t slice_len;
-    unsigned char *buffer;
-    fe_Object *result;
 
     FEX_CHECK_ARGS(ctx, args, 2, "byteslice");
     bytes_obj = fe_nextarg(ctx, &args);
@@ -1716,18 +1941,234 @@ static fe_Object* builtin_bytes_slice(fe_Context *ctx, fe_Object *args) {
         return fe_bytes(ctx, "", 0);
     }
 
-    slice_len = (size_t)(end - start);
-    buffer = builtin_alloc(ctx, slice_len > 0 ? slice_len : 1);
+    /* Zero-copy: the slice is a view referencing the source bytes. */
+    return fe_bytes_slice(ctx, bytes_obj, (size_t)start, (size_t)(end - start));
+}
+
+static fe_Object* builtin_bytes_find(fe_Context *ctx, fe_Object *args) {
+    fe_Object *hay_obj;
+    fe_Object *needle_obj;
+    fe_Object *start_obj;
+    unsigned char *hay;
+    unsigned char *needle;
+    size_t hay_len;
+    size_t needle_len;
+    size_t found;
+    int start = 0;
+
+    FEX_CHECK_ARGS(ctx, args, 2, "bytesfind");
+    hay_obj = fe_nextarg(ctx, &args);
+    needle_obj = fe_nextarg(ctx, &args);
+    start_obj = fe_isnil(ctx, args) ? fe_nil(ctx) : fe_nextarg(ctx, &args);
+    FEX_CHECK_TYPE(ctx, hay_obj, FE_TBYTES, "bytesfind");
+    if (!fe_isnil(ctx, start_obj)) {
+        FEX_CHECK_TYPE(ctx, start_obj, FE_TNUMBER, "bytesfind");
+        start = (int)fe_tonumber(ctx, start_obj);
+        if (start < 0) start = 0;
+    }
+
+    hay = bytes_to_buffer(ctx, hay_obj, "bytesfind", &hay_len);
+    if (!hay) {
+        return fe_nil(ctx);
+    }
+    needle = bytes_or_string_buffer(ctx, needle_obj, "bytesfind", &needle_len);
+    if (!needle) {
+        builtin_free(ctx, hay);
+        return fe_nil(ctx);
+    }
+
+    found = bytes_find_range(hay, hay_len, needle, needle_len, (size_t)start);
+    builtin_free(ctx, needle);
+    builtin_free(ctx, hay);
+    return fe_make_number(ctx, found == (size_t)-1 ? (fe_Number)-1 : (fe_Number)found);
+}
+
+static fe_Object* builtin_bytes_count(fe_Context *ctx, fe_Object *args) {
+    fe_Object *hay_obj;
+    fe_Object *needle_obj;
+    unsigned char *hay;
+    unsigned char *needle;
+    size_t hay_len;
+    size_t needle_len;
+    size_t pos = 0;
+    size_t count = 0;
+
+    FEX_CHECK_ARGS(ctx, args, 2, "bytescount");
+    hay_obj = fe_nextarg(ctx, &args);
+    needle_obj = fe_nextarg(ctx, &args);
+    FEX_CHECK_TYPE(ctx, hay_obj, FE_TBYTES, "bytescount");
+
+    hay = bytes_to_buffer(ctx, hay_obj, "bytescount", &hay_len);
+    if (!hay) {
+        return fe_nil(ctx);
+    }
+    needle = bytes_or_string_buffer(ctx, needle_obj, "bytescount", &needle_len);
+    if (!needle) {
+        builtin_free(ctx, hay);
+        return fe_nil(ctx);
+    }
+    if (needle_len == 0) {
+        builtin_free(ctx, needle);
+        builtin_free(ctx, hay);
+        fe_error(ctx, "bytescount: needle cannot be empty");
+        return fe_nil(ctx);
+    }
+
+    /* Non-overlapping occurrences. */
+    while (pos + needle_len <= hay_len) {
+        size_t found = bytes_find_range(hay, hay_len, needle, needle_len, pos);
+        if (found == (size_t)-1) {
+            break;
+        }
+        count++;
+        pos = found + needle_len;
+    }
+    builtin_free(ctx, needle);
+    builtin_free(ctx, hay);
+    return fe_make_number(ctx, (fe_Number)count);
+}
+
+static fe_Object* builtin_bytes_fill(fe_Context *ctx, fe_Object *args) {
+    fe_Object *bytes_obj;
+    fe_Object *value_obj;
+    fe_Object *start_obj;
+    fe_Object *end_obj;
+    fe_Object *result;
+    unsigned char *buffer;
+    size_t len;
+    int value;
+    int start;
+    int end;
+
+    FEX_CHECK_ARGS(ctx, args, 2, "bytesfill");
+    bytes_obj = fe_nextarg(ctx, &args);
+    value_obj = fe_nextarg(ctx, &args);
+    start_obj = fe_isnil(ctx, args) ? fe_nil(ctx) : fe_nextarg(ctx, &args);
+    end_obj = fe_isnil(ctx, args) ? fe_nil(ctx) : fe_nextarg(ctx, &args);
+    FEX_CHECK_TYPE(ctx, bytes_obj, FE_TBYTES, "bytesfill");
+    FEX_CHECK_TYPE(ctx, value_obj, FE_TNUMBER, "bytesfill");
+    value = (int)fe_tonumber(ctx, value_obj);
+    if (value < 0 || value > 255) {
+        fe_error(ctx, "bytesfill: value must be between 0 and 255");
+        return fe_nil(ctx);
+    }
+
+    len = fe_byteslen(ctx, bytes_obj);
+    start = 0;
+    end = (int)len;
+    if (!fe_isnil(ctx, start_obj)) {
+        FEX_CHECK_TYPE(ctx, start_obj, FE_TNUMBER, "bytesfill");
+        start = (int)fe_tonumber(ctx, start_obj);
+    }
+    if (!fe_isnil(ctx, end_obj)) {
+        FEX_CHECK_TYPE(ctx, end_obj, FE_TNUMBER, "bytesfill");
+        end = (int)fe_tonumber(ctx, end_obj);
+    }
+    if (start < 0) start = 0;
+    if (end > (int)len) end = (int)len;
+
+    buffer = bytes_to_buffer(ctx, bytes_obj, "bytesfill", &len);
     if (!buffer) {
-        fe_error(ctx, "byteslice: out of memory");
         return fe_nil(ctx);
     }
-    fe_bytescopy(ctx, bytes_obj, (size_t)start, buffer, slice_len);
-    result = fe_bytes(ctx, buffer, slice_len);
+
+    /* Bytes are immutable: the filled range goes into a fresh copy. */
+    if (start < end) {
+        memset(buffer + start, value, (size_t)(end - start));
+    }
+    result = fe_bytes(ctx, (const char*)buffer, len);
     builtin_free(ctx, buffer);
     return result;
 }
 
+static fe_Object* builtin_bytes_compare(fe_Context *ctx, fe_Object *args) {
+    fe_Object *a_obj;
+    fe_Object *b_obj;
+    unsigned char *a;
+    unsigned char *b;
+    size_t a_len;
+    size_t b_len;
+    size_t common;
+    int order;
+
+    FEX_CHECK_ARGS(ctx, args, 2, "bytescompare");
+    a_obj = fe_nextarg(ctx, &args);
+    b_obj = fe_nextarg(ctx, &args);
+    FEX_CHECK_TYPE(ctx, a_obj, FE_TBYTES, "bytescompare");
+    FEX_CHECK_TYPE(ctx, b_obj, FE_TBYTES, "bytescompare");
+
+    a = bytes_to_buffer(ctx, a_obj, "bytescompare", &a_len);
+    if (!a) {
+        return fe_nil(ctx);
+    }
+    b = bytes_to_buffer(ctx, b_obj, "bytescompare", &b_len);
+    if (!b) {
+        builtin_free(ctx, a);
+        return fe_nil(ctx);
+    }
+
+    common = a_len < b_len ? a_len : b_len;
+    order = common > 0 ? memcmp(a, b, common) : 0;
+    if (order == 0) {
+        order = a_len < b_len ? -1 : (a_len > b_len ? 1 : 0);
+    }
+    builtin_free(ctx, b);
+    builtin_free(ctx, a);
+    return fe_make_number(ctx, (fe_Number)(order < 0 ? -1 : (order > 0 ? 1 : 0)));
+}
+
+static fe_Object* builtin_bytes_xor(fe_Context *ctx, fe_Object *args) {
+    fe_Object *data_obj;
+    fe_Object *key_obj;
+    fe_Object *result;
+    unsigned char *data;
+    unsigned char *key;
+    size_t data_len;
+    size_t key_len;
+    size_t i;
+
+    FEX_CHECK_ARGS(ctx, args, 2, "bytesxor");
+    data_obj = fe_nextarg(ctx, &args);
+    key_obj = fe_nextarg(ctx, &args);
+    FEX_CHECK_TYPE(ctx, data_obj, FE_TBYTES, "bytesxor");
+
+    data = bytes_to_buffer(ctx, data_obj, "bytesxor", &data_len);
+    if (!data) {
+        return fe_nil(ctx);
+    }
+    key = bytes_or_string_buffer(ctx, key_obj, "bytesxor", &key_len);
+    if (!key) {
+        builtin_free(ctx, data);
+        return fe_nil(ctx);
+    }
+    if (key_len == 0) {
+        builtin_free(ctx, key);
+        builtin_free(ctx, data);
+        fe_error(ctx, "bytesxor: key cannot be empty");
+        return fe_nil(ctx);
+    }
+
+    if (key_len == 1) {
+        /* Single-byte keys take the word-at-a-time path. */
+        uint64_t mask = BYTES_SWAR_ONES * key[0];
+        for (i = 0; i + 8 <= data_len; i += 8) {
+            uint64_t v = bytes_swar_load(data + i) ^ mask;
+            memcpy(data + i, &v, sizeof(v));
+        }
+        for (; i < data_len; i++) {
+            data[i] ^= key[0];
+        }
+    } else {
+        for (i = 0; i < data_len; i++) {
+            data[i] ^= key[i % key_len];
+        }
+    }
+    result = fe_bytes(ctx, (const char*)data, data_len);
+    builtin_free(ctx, key);
+    builtin_free(ctx, data);
+    return result;
+}
+
 /*
 ================================================================================
 |                              LIST FUNCTIONS                                 |
@@ -1740,6 +2181,9 @@ static fe_Object* builtin_list_length(fe_Context *ctx, fe_Object *args) {
     int count = 0;
     size_t poll_countdown = FEX_BUILTIN_ABORT_CHECK_INTERVAL;
     const char *abort_error;
+    if (fe_type(ctx, list) == FE_TARRAY) {
+        return fe_make_number(ctx, (fe_Number)fe_array_count(ctx, list));
+    }
     FEX_CHECK_TYPE(ctx, list, FE_TPAIR, "contains");
 
     while (!fe_isnil(ctx, list)) {
@@ -1764,6 +2208,10 @@ static fe_Object* builtin_list_nth(fe_Context *ctx, fe_Object *args) {
     int index = (int)fe_tonumber(ctx, index_obj);
     int i;
 
+    /* Arrays index in O(1); lists keep the O(n) walk below. */
+    if (fe_type(ctx, list) == FE_TARRAY) {
+        return fe_array_get(ctx, list, index);
+    }
     FEX_CHECK_TYPE(ctx, list, FE_TPAIR, "nth");
 
     for (i = 0; i < index && !fe_isnil(ctx, list); i++) {
@@ -1848,6 +2296,214 @@ static fe_Object* builtin_list_reverse(fe_Context *ctx, fe_Object *args) {
     return result;
 }
 
+/* Calls a script comparator with (a, b); the sign of its numeric result
+   orders the pair. The call expression is rebuilt per comparison and the
+   GC stack restored afterwards so O(n log n) comparisons cannot overflow
+   it. */
+static int sort_call_comparator(fe_Context *ctx, fe_Object *cmp,
+                                fe_Object *a, fe_Object *b,
+                                const char *func_name) {
+    int gc_save = fe_savegc(ctx);
+    fe_Object *call_expr;
+    fe_Object *result;
+    fe_Number n;
+    char msg[96];
+
+    call_expr = fe_cons(ctx, cmp, fe_cons(ctx, a, fe_cons(ctx, b, fe_nil(ctx))));
+    result = fe_eval(ctx, call_expr);
+    if (fe_type(ctx, result) != FE_TNUMBER) {
+        snprintf(msg, sizeof(msg), "%s: comparator must return a number", func_name);
+        fe_error(ctx, msg);
+        return 0;
+    }
+    n = fe_tonumber(ctx, result);
+    fe_restoregc(ctx, gc_save);
+    return n < 0 ? -1 : (n > 0 ? 1 : 0);
+}
+
+/* Native ordering for numbers and strings; everything else needs a
+   comparator. */
+static int sort_compare(fe_Context *ctx, fe_Object *cmp,
+                        fe_Object *a, fe_Object *b, const char *func_name) {
+    int type_a, type_b;
+    char msg[96];
+
+    if (!fe_isnil(ctx, cmp)) {
+        return sort_call_comparator(ctx, cmp, a, b, func_name);
+    }
+    type_a = fe_type(ctx, a);
+    type_b = fe_type(ctx, b);
+    if (type_a == FE_TNUMBER && type_b == FE_TNUMBER) {
+        fe_Number num_a = fe_tonumber(ctx, a);
+        fe_Number num_b = fe_tonumber(ctx, b);
+        return num_a < num_b ? -1 : (num_a > num_b ? 1 : 0);
+    }
+    if (type_a == FE_TSTRING && type_b == FE_TSTRING) {
+        return fe_ctx_string_compare(ctx, a, b);
+    }
+    snprintf(msg, sizeof(msg), "%s: values are not comparable without a comparator", func_name);
+    fe_error(ctx, msg);
+    return 0;
+}
+
+/* Stable bottom-up merge sort over the array object, in place. The
+   scratch array is GC-managed, so a comparator that errors out mid-sort
+   unwinds without leaking native memory, and every element stays
+   reachable while script comparisons run. */
+static void sort_array_in_place(fe_Context *ctx, fe_Object *arr,
+                                fe_Object *cmp, const char *func_name) {
+    int count = fe_array_count(ctx, arr);
+    size_t poll_countdown = FEX_BUILTIN_ABORT_CHECK_INTERVAL;
+    const char *abort_error;
+    fe_Object *scratch;
+    fe_Object *from, *to, *swap;
+    int gc_save;
+    int width, i;
+
+    if (count < 2) {
+        return;
+    }
+    gc_save = fe_savegc(ctx);
+    fe_pushgc(ctx, arr);
+    fe_pushgc(ctx, cmp);
+    scratch = fe_array(ctx);
+    for (i = 0; i < count; i++) {
+        fe_array_push(ctx, scratch, fe_nil(ctx));
+    }
+
+    from = arr;
+    to = scratch;
+    for (width = 1; width < count; width *= 2) {
+        for (i = 0; i < count; i += 2 * width) {
+            int mid = (i + width < count) ? i + width : count;
+            int end = (i + 2 * width < count) ? i + 2 * width : count;
+            int left = i, right = mid, out = i;
+            while (left < mid || right < end) {
+                abort_error = builtin_poll_abort(ctx, &poll_countdown);
+                if (abort_error != NULL) {
+                    fe_error(ctx, abort_error);
+                    return;
+                }
+                if (right >= end ||
+                    (left < mid &&
+                     sort_compare(ctx, cmp, fe_array_get(ctx, from, left),
+                                  fe_array_get(ctx, from, right), func_name) <= 0)) {
+                    fe_array_set(ctx, to, out++, fe_array_get(ctx, from, left++));
+                } else {
+                    fe_array_set(ctx, to, out++, fe_array_get(ctx, from, right++));
+                }
+            }
+        }
+        swap = from;
+        from = to;
+        to = swap;
+    }
+
+    if (from != arr) {
+        for (i = 0; i < count; i++) {
+            fe_array_set(ctx, arr, i, fe_array_get(ctx, from, i));
+        }
+    }
+    fe_restoregc(ctx, gc_save);
+}
+
+/* Copies a list into a fresh array so the merge sort has O(1) indexed
+   access; the caller rebuilds the list afterwards. */
+static fe_Object* sort_list_to_array(fe_Context *ctx, fe_Object *list) {
+    fe_Object *arr;
+    size_t poll_countdown = FEX_BUILTIN_ABORT_CHECK_INTERVAL;
+    const char *abort_error;
+    int gc_save = fe_savegc(ctx);
+
+    fe_pushgc(ctx, list);
+    arr = fe_array(ctx);
+    while (!fe_isnil(ctx, list)) {
+        abort_error = builtin_poll_abort(ctx, &poll_countdown);
+        if (abort_error != NULL) {
+            fe_error(ctx, abort_error);
+            return fe_nil(ctx);
+        }
+        fe_array_push(ctx, arr, fe_car(ctx, list));
+        list = fe_cdr(ctx, list);
+    }
+    fe_restoregc(ctx, gc_save);
+    fe_pushgc(ctx, arr);
+    return arr;
+}
+
+static fe_Object* builtin_sort(fe_Context *ctx, fe_Object *args) {
+    FEX_CHECK_ARGS(ctx, args, 1, "sort");
+    fe_Object *seq = fe_nextarg(ctx, &args);
+    fe_Object *cmp = fe_isnil(ctx, args) ? fe_nil(ctx) : fe_nextarg(ctx, &args);
+    fe_Object *arr;
+    fe_Object *result;
+    int gc_save;
+    int i;
+
+    /* Arrays sort in place and come back directly. */
+    if (fe_type(ctx, seq) == FE_TARRAY) {
+        sort_array_in_place(ctx, seq, cmp, "sort");
+        return seq;
+    }
+    FEX_CHECK_TYPE(ctx, seq, FE_TPAIR, "sort");
+
+    gc_save = fe_savegc(ctx);
+    fe_pushgc(ctx, cmp);
+    arr = sort_list_to_array(ctx, seq);
+    sort_array_in_place(ctx, arr, cmp, "sort");
+
+    result = fe_nil(ctx);
+    for (i = fe_array_count(ctx, arr) - 1; i >= 0; i--) {
+        fe_restoregc(ctx, gc_save);
+        fe_pushgc(ctx, arr);
+        fe_pushgc(ctx, result);
+        result = fe_cons(ctx, fe_array_get(ctx, arr, i), result);
+    }
+    fe_restoregc(ctx, gc_save);
+    fe_pushgc(ctx, result);
+    return result;
+}
+
+static fe_Object* builtin_binary_search(fe_Context *ctx, fe_Object *args) {
+    FEX_CHECK_ARGS(ctx, args, 2, "binarysearch");
+    fe_Object *seq = fe_nextarg(ctx, &args);
+    fe_Object *value = fe_nextarg(ctx, &args);
+    fe_Object *cmp = fe_isnil(ctx, args) ? fe_nil(ctx) : fe_nextarg(ctx, &args);
+    fe_Object *arr = seq;
+    int gc_save = fe_savegc(ctx);
+    int low = 0, high, count;
+
+    fe_pushgc(ctx, value);
+    fe_pushgc(ctx, cmp);
+    if (fe_type(ctx, seq) != FE_TARRAY) {
+        FEX_CHECK_TYPE(ctx, seq, FE_TPAIR, "binarysearch");
+        arr = sort_list_to_array(ctx, seq);
+    } else {
+        fe_pushgc(ctx, arr);
+    }
+
+    /* Leftmost match, so duplicates report their first index. */
+    count = fe_array_count(ctx, arr);
+    high = count;
+    while (low < high) {
+        int mid = low + (high - low) / 2;
+        if (sort_compare(ctx, cmp, fe_array_get(ctx, arr, mid), value,
+                         "binarysearch") < 0) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    if (low < count &&
+        sort_compare(ctx, cmp, fe_array_get(ctx, arr, low), value,
+                     "binarysearch") == 0) {
+        fe_restoregc(ctx, gc_save);
+        return fe_make_number(ctx, (fe_Number)low);
+    }
+    fe_restoregc(ctx, gc_save);
+    return fe_nil(ctx);
+}
+
 static fe_Object* builtin_map(fe_Context *ctx, fe_Object *args) {
     FEX_CHECK_ARGS(ctx, args, 2, "map");
     fe_Object *func = fe_nextarg(ctx, &args);
@@ -2010,35 +2666,212 @@ static fe_Object* builtin_map_count(fe_Context *ctx, fe_Object *args) {
     return fe_make_number(ctx, (fe_Number)fe_map_count(ctx, map));
 }
 
-/*
-================================================================================
+static fe_Object* builtin_make_array(fe_Context *ctx, fe_Object *args) {
+    fe_Object *arr = fe_array(ctx);
+    size_t poll_countdown = FEX_BUILTIN_ABORT_CHECK_INTERVAL;
+    const char *abort_error;
+
+    while (!fe_isnil(ctx, args)) {
+        abort_error = builtin_poll_abort(ctx, &poll_countdown);
+        if (abort_error != NULL) {
+            fe_error(ctx, abort_error);
+            return fe_nil(ctx);
+        }
+        fe_array_push(ctx, arr, fe_nextarg(ctx, &args));
+    }
+
+    return arr;
+}
+
+static fe_Object* builtin_array_push(fe_Context *ctx, fe_Object *args) {
+    FEX_CHECK_ARGS(ctx, args, 2, "push");
+    fe_Object *arr = fe_nextarg(ctx, &args);
+    fe_Object *value = fe_nextarg(ctx, &args);
+    FEX_CHECK_TYPE(ctx, arr, FE_TARRAY, "push");
+    fe_array_push(ctx, arr, value);
+    return arr;
+}
+
+static fe_Object* builtin_array_set(fe_Context *ctx, fe_Object *args) {
+    FEX_CHECK_ARGS(ctx, args, 3, "setnth");
+    fe_Object *arr = fe_nextarg(ctx, &args);
+    fe_Object *index_obj = fe_nextarg(ctx, &args);
+    fe_Object *value = fe_nextarg(ctx, &args);
+    int index = (int)fe_tonumber(ctx, index_obj);
+    FEX_CHECK_TYPE(ctx, arr, FE_TARRAY, "setnth");
+    if (!fe_array_set(ctx, arr, index, value)) {
+        fe_error(ctx, "setnth: index out of range");
+        return fe_nil(ctx);
+    }
+    return arr;
+}
+
+static fe_Object* builtin_to_array(fe_Context *ctx, fe_Object *args) {
+    FEX_CHECK_ARGS(ctx, args, 1, "toarray");
+    fe_Object *list = fe_nextarg(ctx, &args);
+    fe_Object *arr;
+    size_t poll_countdown = FEX_BUILTIN_ABORT_CHECK_INTERVAL;
+    const char *abort_error;
+    int gc_save = fe_savegc(ctx);
+
+    fe_pushgc(ctx, list);
+    arr = fe_array(ctx);
+    while (!fe_isnil(ctx, list)) {
+        abort_error = builtin_poll_abort(ctx, &poll_countdown);
+        if (abort_error != NULL) {
+            fe_error(ctx, abort_error);
+            return fe_nil(ctx);
+        }
+        fe_array_push(ctx, arr, fe_car(ctx, list));
+        list = fe_cdr(ctx, list);
+    }
+    fe_restoregc(ctx, gc_save);
+    fe_pushgc(ctx, arr);
+    return arr;
+}
+
+static fe_Object* builtin_to_list(fe_Context *ctx, fe_Object *args) {
+    FEX_CHECK_ARGS(ctx, args, 1, "tolist");
+    fe_Object *arr = fe_nextarg(ctx, &args);
+    fe_Object *result = fe_nil(ctx);
+    size_t poll_countdown = FEX_BUILTIN_ABORT_CHECK_INTERVAL;
+    const char *abort_error;
+    int gc_save = fe_savegc(ctx);
+    int i;
+
+    FEX_CHECK_TYPE(ctx, arr, FE_TARRAY, "tolist");
+    fe_pushgc(ctx, arr);
+    for (i = fe_array_count(ctx, arr) - 1; i >= 0; i--) {
+        abort_error = builtin_poll_abort(ctx, &poll_countdown);
+        if (abort_error != NULL) {
+            fe_error(ctx, abort_error);
+            return fe_nil(ctx);
+        }
+        fe_restoregc(ctx, gc_save);
+        fe_pushgc(ctx, arr);
+        fe_pushgc(ctx, result);
+        result = fe_cons(ctx, fe_array_get(ctx, arr, i), result);
+    }
+    fe_restoregc(ctx, gc_save);
+    fe_pushgc(ctx, result);
+    return result;
+}
+
+/*
+================================================================================
 |                              JSON FUNCTIONS                                 |
 ================================================================================
 */
 
+/* The parser walks [current, end) and relies on *end always being '\0',
+ * so single-byte lookahead never needs a bounds check.  When `fp` is set
+ * the window is a sliding buffer refilled from the file, which lets
+ * `freadjson` parse documents much larger than the window. */
 typedef struct {
     fe_Context *ctx;
     const char *current;
+    const char *end;
     size_t poll_countdown;
+    FILE *fp;            /* NULL when parsing from memory */
+    char *window;        /* refill buffer (streaming only) */
+    size_t window_cap;
+    int eof;
 } JsonParser;
 
+/* Serialization state.  With `fp` set the writer runs in streaming mode:
+ * the TextBuffer acts as a fixed-size window that is spilled to the file
+ * whenever it fills, so huge documents never materialize in memory. */
 typedef struct {
     fe_Context *ctx;
     size_t poll_countdown;
+    FILE *fp;               /* NULL when building a string in memory */
+    size_t total_written;   /* bytes flushed to fp so far */
+    const char *func_name;  /* builtin name for error messages */
 } JsonWriter;
 
+#define JSON_STREAM_WINDOW_SIZE (64 * 1024)
+
+/* SWAR scanning: classify eight input bytes per iteration instead of
+ * one.  json_swar_eq/json_swar_lt set 0x80 in every byte position that
+ * matches; both are exact (no false positives) for the ranges used. */
+#define JSON_SWAR_ONES  ((uint64_t)0x0101010101010101u)
+#define JSON_SWAR_HIGHS ((uint64_t)0x8080808080808080u)
+
+static uint64_t json_swar_load(const char *p) {
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static uint64_t json_swar_eq(uint64_t v, unsigned char chr) {
+    uint64_t x = v ^ (JSON_SWAR_ONES * chr);
+    return (x - JSON_SWAR_ONES) & ~x & JSON_SWAR_HIGHS;
+}
+
+/* Bytes strictly below `bound`; requires bound <= 0x80. */
+static uint64_t json_swar_lt(uint64_t v, unsigned char bound) {
+    return (v - JSON_SWAR_ONES * bound) & ~v & JSON_SWAR_HIGHS;
+}
+
+/* Batched abort polling: charge several consumed bytes at once so bulk
+ * scanning keeps the same cadence as the old per-character checks. */
+static const char* json_poll(JsonParser *parser, size_t cost) {
+    if (parser->poll_countdown > cost) {
+        parser->poll_countdown -= cost;
+        return NULL;
+    }
+    parser->poll_countdown = FEX_BUILTIN_ABORT_CHECK_INTERVAL;
+    return fe_poll_abort(parser->ctx);
+}
+
+/* Slides the unconsumed tail to the window start and reads more input.
+ * Keeps the *end == '\0' invariant. */
+static void json_refill(JsonParser *parser) {
+    size_t tail, got;
+    if (!parser->fp || parser->eof) return;
+    tail = (size_t)(parser->end - parser->current);
+    memmove(parser->window, parser->current, tail);
+    got = fread(parser->window + tail, 1, parser->window_cap - tail - 1, parser->fp);
+    if (got == 0) parser->eof = 1;
+    parser->current = parser->window;
+    parser->end = parser->window + tail + got;
+    parser->window[tail + got] = '\0';
+}
+
+static void json_ensure(JsonParser *parser, size_t n) {
+    while ((size_t)(parser->end - parser->current) < n &&
+           parser->fp && !parser->eof) {
+        json_refill(parser);
+    }
+}
+
 static void json_skip_ws(JsonParser *parser) {
     const char *abort_error;
 
-    while (*parser->current &&
-           (*parser->current == ' ' || *parser->current == '\t' ||
-            *parser->current == '\n' || *parser->current == '\r')) {
-        abort_error = builtin_poll_abort(parser->ctx, &parser->poll_countdown);
+    for (;;) {
+        const char *p = parser->current;
+        while (parser->end - p >= 8) {
+            uint64_t v = json_swar_load(p);
+            uint64_t ws = json_swar_eq(v, ' ') | json_swar_eq(v, '\t') |
+                          json_swar_eq(v, '\n') | json_swar_eq(v, '\r');
+            if (ws != JSON_SWAR_HIGHS) break; /* a non-whitespace byte */
+            p += 8;
+        }
+        while (p < parser->end &&
+               (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')) {
+            p++;
+        }
+        abort_error = json_poll(parser, (size_t)(p - parser->current) + 1);
         if (abort_error != NULL) {
             fe_error(parser->ctx, abort_error);
             return;
         }
-        parser->current++;
+        parser->current = p;
+        if (p == parser->end && parser->fp && !parser->eof) {
+            json_refill(parser);
+            continue;
+        }
+        return;
     }
 }
 
@@ -2068,18 +2901,51 @@ static fe_Object* json_parse_string(JsonParser *parser) {
     }
     parser->current++;
 
-    while (*parser->current && *parser->current != '"') {
+    for (;;) {
         unsigned codepoint;
-        char chr = *parser->current++;
-
-        abort_error = builtin_poll_abort(parser->ctx, &parser->poll_countdown);
+        char chr;
+        /* Extend the span of plain characters (no quote, no backslash,
+         * no control byte) eight bytes at a time and append it in one
+         * go; escapes and boundaries drop to the scalar path below. */
+        const char *p = parser->current;
+        while (parser->end - p >= 8) {
+            uint64_t v = json_swar_load(p);
+            if ((json_swar_eq(v, '"') | json_swar_eq(v, '\\') |
+                 json_swar_lt(v, 0x20)) != 0) break;
+            p += 8;
+        }
+        while (p < parser->end && *p != '"' && *p != '\\' &&
+               (unsigned char)*p >= 0x20) {
+            p++;
+        }
+        abort_error = json_poll(parser, (size_t)(p - parser->current) + 1);
         if (abort_error != NULL) {
             buf_free(&buf);
             fe_error(parser->ctx, abort_error);
             return fe_nil(parser->ctx);
         }
-        if (chr == '\\') {
-            chr = *parser->current++;
+        if (p != parser->current) {
+            if (!buf_append_mem(&buf, parser->current, (size_t)(p - parser->current))) goto oom;
+            parser->current = p;
+        }
+        if (parser->current == parser->end) {
+            if (parser->fp && !parser->eof) {
+                json_refill(parser);
+                continue;
+            }
+            break; /* unterminated; reported below */
+        }
+        chr = *parser->current;
+        if (chr == '"') break;
+        if ((unsigned char)chr < 0x20) {
+            buf_free(&buf);
+            fe_error(parser->ctx, "parsejson: unescaped control character");
+            return fe_nil(parser->ctx);
+        }
+        parser->current++; /* consume the backslash */
+        json_ensure(parser, 1);
+        chr = *parser->current++;
+        {
             switch (chr) {
                 case '"': if (!buf_append_char(&buf, '"')) goto oom; break;
                 case '\\': if (!buf_append_char(&buf, '\\')) goto oom; break;
@@ -2090,6 +2956,12 @@ static fe_Object* json_parse_string(JsonParser *parser) {
                 case 'r': if (!buf_append_char(&buf, '\r')) goto oom; break;
                 case 't': if (!buf_append_char(&buf, '\t')) goto oom; break;
                 case 'u':
+                    json_ensure(parser, 4);
+                    if (parser->end - parser->current < 4) {
+                        buf_free(&buf);
+                        fe_error(parser->ctx, "parsejson: invalid unicode escape");
+                        return fe_nil(parser->ctx);
+                    }
                     hi = json_hex_value(parser->current[0]);
                     lo = json_hex_value(parser->current[1]);
                     hi2 = json_hex_value(parser->current[2]);
@@ -2113,17 +2985,10 @@ static fe_Object* json_parse_string(JsonParser *parser) {
                     fe_error(parser->ctx, "parsejson: invalid escape sequence");
                     return fe_nil(parser->ctx);
             }
-        } else {
-            if ((unsigned char)chr < 0x20) {
-                buf_free(&buf);
-                fe_error(parser->ctx, "parsejson: unescaped control character");
-                return fe_nil(parser->ctx);
-            }
-            if (!buf_append_char(&buf, chr)) goto oom;
         }
     }
 
-    if (*parser->current != '"') {
+    if (parser->current == parser->end || *parser->current != '"') {
         buf_free(&buf);
         fe_error(parser->ctx, "parsejson: unterminated string");
         return fe_nil(parser->ctx);
@@ -2141,7 +3006,27 @@ oom:
 
 static fe_Object* json_parse_number(JsonParser *parser) {
     char *endptr;
-    double value = strtod(parser->current, &endptr);
+    double value;
+
+    /* Streaming: strtod needs the whole token in the window, so refill
+     * until a terminator (or EOF) is visible. */
+    if (parser->fp) {
+        for (;;) {
+            const char *p = parser->current;
+            while (p < parser->end &&
+                   (*p == '-' || *p == '+' || *p == '.' || *p == 'e' ||
+                    *p == 'E' || (*p >= '0' && *p <= '9'))) {
+                p++;
+            }
+            if (p < parser->end || parser->eof) break;
+            if ((size_t)(parser->end - parser->current) >= parser->window_cap - 1) {
+                fe_error(parser->ctx, "parsejson: number too long");
+                return fe_nil(parser->ctx);
+            }
+            json_refill(parser);
+        }
+    }
+    value = strtod(parser->current, &endptr);
     if (endptr == parser->current) {
         fe_error(parser->ctx, "parsejson: invalid number");
         return fe_nil(parser->ctx);
@@ -2154,6 +3039,7 @@ static fe_Object* json_parse_array(JsonParser *parser) {
     fe_Object *result;
     fe_Object **tail;
     const char *abort_error;
+    int gc_save = fe_savegc(parser->ctx);
 
     parser->current++;
     json_skip_ws(parser);
@@ -2174,6 +3060,10 @@ static fe_Object* json_parse_array(JsonParser *parser) {
         }
         *tail = fe_cons(parser->ctx, item, fe_nil(parser->ctx));
         tail = fe_cdr_ptr(parser->ctx, *tail);
+        /* Keep only the list head rooted: element allocations would
+         * otherwise overflow the GC stack on large documents. */
+        fe_restoregc(parser->ctx, gc_save);
+        fe_pushgc(parser->ctx, result);
         json_skip_ws(parser);
         if (*parser->current == ']') {
             parser->current++;
@@ -2191,6 +3081,10 @@ static fe_Object* json_parse_array(JsonParser *parser) {
 static fe_Object* json_parse_object(JsonParser *parser) {
     fe_Object *map = fe_map(parser->ctx);
     const char *abort_error;
+    /* The map itself was pushed by its allocation; entries below are
+     * reachable through it, so their roots can be dropped per iteration
+     * to keep GC stack use bounded on large documents. */
+    int gc_save = fe_savegc(parser->ctx);
 
     parser->current++;
     json_skip_ws(parser);
@@ -2222,6 +3116,7 @@ static fe_Object* json_parse_object(JsonParser *parser) {
         json_skip_ws(parser);
         value = json_parse_value(parser);
         fe_map_set(parser->ctx, map, key, value);
+        fe_restoregc(parser->ctx, gc_save);
         json_skip_ws(parser);
         if (*parser->current == '}') {
             parser->current++;
@@ -2238,6 +3133,7 @@ static fe_Object* json_parse_object(JsonParser *parser) {
 
 static fe_Object* json_parse_value(JsonParser *parser) {
     json_skip_ws(parser);
+    json_ensure(parser, 8); /* literals compare against up to 5 bytes */
     switch (*parser->current) {
         case '"': return json_parse_string(parser);
         case '{': return json_parse_object(parser);
@@ -2288,49 +3184,132 @@ static int json_is_proper_list(fe_Context *ctx, fe_Object *obj) {
     return 1;
 }
 
+/* Batched abort polling for the writer, mirroring json_poll: charge a
+ * whole bulk-copied span at once instead of polling per character. */
+static const char* json_writer_poll(JsonWriter *writer, size_t cost) {
+    if (writer->poll_countdown > cost) {
+        writer->poll_countdown -= cost;
+        return NULL;
+    }
+    writer->poll_countdown = FEX_BUILTIN_ABORT_CHECK_INTERVAL;
+    return fe_poll_abort(writer->ctx);
+}
+
+/* Writes the buffered window to the destination file and resets it
+ * (capacity is kept so the window is reused).  Raises on write errors
+ * and aborts, matching the write loops of the file builtins. */
+static int json_writer_flush(JsonWriter *writer, TextBuffer *buf) {
+    size_t offset = 0;
+    size_t poll_countdown = 1;
+    const char *abort_error;
+
+    while (offset < buf->len) {
+        size_t chunk_size = buf->len - offset;
+        size_t written;
+        if (chunk_size > FEX_FILE_IO_CHUNK_SIZE) {
+            chunk_size = FEX_FILE_IO_CHUNK_SIZE;
+        }
+        abort_error = builtin_poll_abort(writer->ctx, &poll_countdown);
+        if (abort_error != NULL) {
+            fe_error(writer->ctx, abort_error);
+            return 0;
+        }
+        written = fwrite(buf->data + offset, 1, chunk_size, writer->fp);
+        offset += written;
+        writer->total_written += written;
+        if (written < chunk_size || ferror(writer->fp)) {
+            char msg[128];
+            snprintf(msg, sizeof(msg), "%s: error writing file", writer->func_name);
+            fe_error(writer->ctx, msg);
+            return 0;
+        }
+    }
+    buf->len = 0;
+    if (buf->data) {
+        buf->data[0] = '\0';
+    }
+    return 1;
+}
+
+/* All writer output funnels through json_emit so streaming mode can
+ * spill the window once it reaches JSON_STREAM_WINDOW_SIZE; in-memory
+ * mode just appends. */
+static int json_emit(JsonWriter *writer, TextBuffer *buf, const char *data, size_t len) {
+    if (!buf_append_mem(buf, data, len)) {
+        return 0;
+    }
+    if (writer->fp && buf->len >= JSON_STREAM_WINDOW_SIZE) {
+        return json_writer_flush(writer, buf);
+    }
+    return 1;
+}
+
+static int json_emit_char(JsonWriter *writer, TextBuffer *buf, char chr) {
+    return json_emit(writer, buf, &chr, 1);
+}
+
+/* Emits a JSON string literal.  Escape-free spans are located with the
+ * same SWAR classifier the parser uses and copied in one memcpy each,
+ * and the payload is reserved up front so the common escape-free case
+ * costs a single append with no realloc checks along the way. */
 static int json_write_string(JsonWriter *writer, fe_Object *obj, TextBuffer *buf) {
     char *text;
     size_t text_len;
     size_t i;
     const char *abort_error;
 
-    text = string_to_buffer(writer->ctx, obj, "tojson", &text_len);
+    text = string_to_buffer(writer->ctx, obj, writer->func_name, &text_len);
     if (!text) {
         return 0;
     }
-    if (!buf_append_char(buf, '"')) {
+    if (!buf_reserve(buf, text_len + 2) || !json_emit_char(writer, buf, '"')) {
         builtin_free(writer->ctx, text);
         return 0;
     }
-    for (i = 0; i < text_len; i++) {
-        unsigned char chr = (unsigned char)text[i];
-        abort_error = builtin_poll_abort(writer->ctx, &writer->poll_countdown);
+    i = 0;
+    while (i < text_len) {
+        size_t run = i;
+        unsigned char chr;
+        while (text_len - run >= 8) {
+            uint64_t v = json_swar_load(text + run);
+            if ((json_swar_eq(v, '"') | json_swar_eq(v, '\\') |
+                 json_swar_lt(v, 0x20)) != 0) break;
+            run += 8;
+        }
+        while (run < text_len && text[run] != '"' && text[run] != '\\' &&
+               (unsigned char)text[run] >= 0x20) {
+            run++;
+        }
+        abort_error = json_writer_poll(writer, (run - i) + 1);
         if (abort_error != NULL) {
             builtin_free(writer->ctx, text);
             fe_error(writer->ctx, abort_error);
             return 0;
         }
+        if (run > i) {
+            if (!json_emit(writer, buf, text + i, run - i)) goto fail;
+            i = run;
+        }
+        if (i == text_len) break;
+        chr = (unsigned char)text[i++];
         switch (chr) {
-            case '"': if (!buf_append_str(buf, "\\\"")) goto fail; break;
-            case '\\': if (!buf_append_str(buf, "\\\\")) goto fail; break;
-            case '\b': if (!buf_append_str(buf, "\\b")) goto fail; break;
-            case '\f': if (!buf_append_str(buf, "\\f")) goto fail; break;
-            case '\n': if (!buf_append_str(buf, "\\n")) goto fail; break;
-            case '\r': if (!buf_append_str(buf, "\\r")) goto fail; break;
-            case '\t': if (!buf_append_str(buf, "\\t")) goto fail; break;
-            default:
-                if (chr < 0x20) {
-                    char hexbuf[7];
-                    snprintf(hexbuf, sizeof(hexbuf),"\\u%04x", chr);
-                    if (!buf_append_str(buf, hexbuf)) goto fail;
-                } else if (!buf_append_char(buf, (char)chr)) {
-                    goto fail;
-                }
+            case '"': if (!json_emit(writer, buf, "\\\"", 2)) goto fail; break;
+            case '\\': if (!json_emit(writer, buf, "\\\\", 2)) goto fail; break;
+            case '\b': if (!json_emit(writer, buf, "\\b", 2)) goto fail; break;
+            case '\f': if (!json_emit(writer, buf, "\\f", 2)) goto fail; break;
+            case '\n': if (!json_emit(writer, buf, "\\n", 2)) goto fail; break;
+            case '\r': if (!json_emit(writer, buf, "\\r", 2)) goto fail; break;
+            case '\t': if (!json_emit(writer, buf, "\\t", 2)) goto fail; break;
+            default: {
+                char hexbuf[7];
+                snprintf(hexbuf, sizeof(hexbuf), "\\u%04x", chr);
+                if (!json_emit(writer, buf, hexbuf, 6)) goto fail;
                 break;
+            }
         }
     }
     builtin_free(writer->ctx, text);
-    return buf_append_char(buf, '"');
+    return json_emit_char(writer, buf, '"');
 
 fail:
     builtin_free(writer->ctx, text);
@@ -2341,60 +3320,89 @@ static int json_write_value(JsonWriter *writer, fe_Object *obj, TextBuffer *buf)
     char number_buf[64];
     switch (fe_type(writer->ctx, obj)) {
         case FE_TNIL:
-            return buf_append_str(buf, "null");
+            return json_emit(writer, buf, "null", 4);
         case FE_TBOOLEAN:
-            return buf_append_str(buf, (obj == fe_bool(writer->ctx, 1)) ? "true" : "false");
-        case FE_TNUMBER:
-            snprintf(number_buf, sizeof(number_buf),"%.15g", fe_tonumber(writer->ctx, obj));
-            return buf_append_str(buf, number_buf);
+            return (obj == fe_bool(writer->ctx, 1))
+                ? json_emit(writer, buf, "true", 4)
+                : json_emit(writer, buf, "false", 5);
+        case FE_TNUMBER: {
+            size_t number_len;
+            if (FE_IS_FIXNUM(obj)) {
+                number_len = fe_format_fixnum(number_buf, FE_UNBOX_FIXNUM(obj));
+            } else {
+                number_len = fe_format_double(number_buf, sizeof(number_buf),
+                                              fe_tonumber(writer->ctx, obj));
+            }
+            return json_emit(writer, buf, number_buf, number_len);
+        }
         case FE_TSTRING:
             return json_write_string(writer, obj, buf);
         case FE_TMAP: {
             fe_Object *keys = fe_map_keys(writer->ctx, obj);
             int first = 1;
-            if (!buf_append_char(buf, '{')) return 0;
+            if (!json_emit_char(writer, buf, '{')) return 0;
             while (!fe_isnil(writer->ctx, keys)) {
                 fe_Object *key = fe_car(writer->ctx, keys);
-                const char *abort_error = builtin_poll_abort(writer->ctx, &writer->poll_countdown);
+                const char *abort_error = json_writer_poll(writer, 1);
                 if (abort_error != NULL) {
                     fe_error(writer->ctx, abort_error);
                     return 0;
                 }
-                if (!first && !buf_append_char(buf, ',')) return 0;
+                if (!first && !json_emit_char(writer, buf, ',')) return 0;
                 if (!json_write_string(writer, key, buf)) return 0;
-                if (!buf_append_char(buf, ':')) return 0;
+                if (!json_emit_char(writer, buf, ':')) return 0;
                 if (!json_write_value(writer, fe_map_get(writer->ctx, obj, key), buf)) return 0;
                 first = 0;
                 keys = fe_cdr(writer->ctx, keys);
             }
-            return buf_append_char(buf, '}');
+            return json_emit_char(writer, buf, '}');
+        }
+        case FE_TARRAY: {
+            int i;
+            int count = fe_array_count(writer->ctx, obj);
+            if (!json_emit_char(writer, buf, '[')) return 0;
+            for (i = 0; i < count; i++) {
+                const char *abort_error = json_writer_poll(writer, 1);
+                if (abort_error != NULL) {
+                    fe_error(writer->ctx, abort_error);
+                    return 0;
+                }
+                if (i > 0 && !json_emit_char(writer, buf, ',')) return 0;
+                if (!json_write_value(writer, fe_array_get(writer->ctx, obj, i), buf)) return 0;
+            }
+            return json_emit_char(writer, buf, ']');
         }
         case FE_TPAIR: {
+            char msg[128];
             if (!json_is_proper_list(writer->ctx, obj)) {
-                fe_error(writer->ctx, "tojson: cannot serialize dotted pair");
+                snprintf(msg, sizeof(msg), "%s: cannot serialize dotted pair", writer->func_name);
+                fe_error(writer->ctx, msg);
                 return 0;
             }
-            if (!buf_append_char(buf, '[')) return 0;
+            if (!json_emit_char(writer, buf, '[')) return 0;
             {
                 int first = 1;
                 fe_Object *list = obj;
                 while (!fe_isnil(writer->ctx, list)) {
-                    const char *abort_error = builtin_poll_abort(writer->ctx, &writer->poll_countdown);
+                    const char *abort_error = json_writer_poll(writer, 1);
                     if (abort_error != NULL) {
                         fe_error(writer->ctx, abort_error);
                         return 0;
                     }
-                    if (!first && !buf_append_char(buf, ',')) return 0;
+                    if (!first && !json_emit_char(writer, buf, ',')) return 0;
                     if (!json_write_value(writer, fe_car(writer->ctx, list), buf)) return 0;
                     first = 0;
                     list = fe_cdr(writer->ctx, list);
                 }
             }
-            return buf_append_char(buf, ']');
+            return json_emit_char(writer, buf, ']');
         }
-        default:
-            fe_error(writer->ctx, "tojson: unsupported value type");
+        default: {
+            char msg[128];
+            snprintf(msg, sizeof(msg), "%s: unsupported value type", writer->func_name);
+            fe_error(writer->ctx, msg);
             return 0;
+        }
     }
 }
 
@@ -2413,7 +3421,12 @@ static fe_Object* builtin_parse_json(fe_Context *ctx, fe_Object *args) {
 
     parser.ctx = ctx;
     parser.current = text;
+    parser.end = text + strlen(text);
     parser.poll_countdown = FEX_BUILTIN_ABORT_CHECK_INTERVAL;
+    parser.fp = NULL;
+    parser.window = NULL;
+    parser.window_cap = 0;
+    parser.eof = 1;
     result = json_parse_value(&parser);
     json_skip_ws(&parser);
     if (*parser.current != '\0') {
@@ -2440,6 +3453,9 @@ static fe_Object* builtin_to_json(fe_Context *ctx, fe_Object *args) {
     buf.cap = 0;
     writer.ctx = ctx;
     writer.poll_countdown = FEX_BUILTIN_ABORT_CHECK_INTERVAL;
+    writer.fp = NULL;
+    writer.total_written = 0;
+    writer.func_name = "tojson";
     if (!json_write_value(&writer, value, &buf)) {
         buf_free(&buf);
         return fe_nil(ctx);
@@ -3120,113 +4136,444 @@ static fe_Object* builtin_write_bytes(fe_Context *ctx, fe_Object *args) {
     return fe_make_number(ctx, (fe_Number)total_written);
 }
 
-static fe_Object* builtin_read_json(fe_Context *ctx, fe_Object *args) {
-    fe_Object *filename_obj;
-    char *filename;
-    char *buffer;
-    JsonParser parser;
-    fe_Object *result;
+/*
+ * Buffered file handles.  A handle is an FE_TPTR object whose pointer
+ * refers to a FexFile node in the per-context registry hanging off
+ * fe_ctx_file_state().  Handles are validated against the registry on
+ * every use, closed nodes keep their slot (fp == NULL) so stale handles
+ * fail cleanly, and fex_file_cleanup() closes anything left open when
+ * the context shuts down.
+ */
+typedef struct FexFile {
+    FILE *fp;
+    struct FexFile *next;
+} FexFile;
 
-    FEX_CHECK_ARGS(ctx, args, 1, "readjson");
-    filename_obj = fe_nextarg(ctx, &args);
-    filename = string_to_cstr(ctx, filename_obj, "readjson");
-    if (!filename) return fe_nil(ctx);
+#ifdef _WIN32
+static const wchar_t* file_mode_string(const char *mode) {
+    if (strcmp(mode, "r") == 0)  return L"rb";
+    if (strcmp(mode, "w") == 0)  return L"wb";
+    if (strcmp(mode, "a") == 0)  return L"ab";
+    if (strcmp(mode, "r+") == 0) return L"rb+";
+    if (strcmp(mode, "w+") == 0) return L"wb+";
+    if (strcmp(mode, "a+") == 0) return L"ab+";
+    return NULL;
+}
+#else
+static const char* file_mode_string(const char *mode) {
+    if (strcmp(mode, "r") == 0)  return "rb";
+    if (strcmp(mode, "w") == 0)  return "wb";
+    if (strcmp(mode, "a") == 0)  return "ab";
+    if (strcmp(mode, "r+") == 0) return "rb+";
+    if (strcmp(mode, "w+") == 0) return "wb+";
+    if (strcmp(mode, "a+") == 0) return "ab+";
+    return NULL;
+}
+#endif
 
-    buffer = read_file_dynamic(ctx, filename, 256 * 1024, NULL, "readjson", filename);
-    builtin_free(ctx, filename);
-    if (!buffer) return fe_nil(ctx);
+static FexFile* file_from_obj(fe_Context *ctx, fe_Object *obj,
+                              const char *func_name) {
+    FexFile *file;
+    void *ptr;
+    char message[64];
 
-    parser.ctx = ctx;
-    parser.current = buffer;
-    parser.poll_countdown = FEX_BUILTIN_ABORT_CHECK_INTERVAL;
-    result = json_parse_value(&parser);
-    json_skip_ws(&parser);
-    if (*parser.current != '\0') {
-        tracked_builtin_free(ctx, buffer);
-        fe_error(ctx, "readjson: trailing characters");
-        return fe_nil(ctx);
+    if (fe_type(ctx, obj) != FE_TPTR) {
+        snprintf(message, sizeof(message), "%s: expected a file handle", func_name);
+        fe_error(ctx, message);
+        return NULL;
     }
-    tracked_builtin_free(ctx, buffer);
-    return result;
+    ptr = fe_toptr(ctx, obj);
+    for (file = (FexFile*)fe_ctx_file_state(ctx); file; file = file->next) {
+        if (file == ptr) {
+            if (!file->fp) {
+                snprintf(message, sizeof(message), "%s: file is closed", func_name);
+                fe_error(ctx, message);
+                return NULL;
+            }
+            return file;
+        }
+    }
+    snprintf(message, sizeof(message), "%s: invalid file handle", func_name);
+    fe_error(ctx, message);
+    return NULL;
 }
 
-static fe_Object* builtin_write_json(fe_Context *ctx, fe_Object *args) {
-    fe_Object *filename_obj;
-    fe_Object *value;
-    char *filename;
-    TextBuffer buf;
-    FILE *file;
-    size_t written;
-    size_t total_written;
-    size_t chunk_size;
-    size_t poll_countdown = 1;
-    const char *abort_error;
-    JsonWriter writer;
+void fex_file_cleanup(fe_Context *ctx) {
+    FexFile *file = (FexFile*)fe_ctx_file_state(ctx);
+    while (file) {
+        FexFile *next = file->next;
+        if (file->fp) {
+            fclose(file->fp);
+        }
+        tracked_builtin_free(ctx, file);
+        file = next;
+    }
+    fe_ctx_set_file_state(ctx, NULL);
+}
 
-    FEX_CHECK_ARGS(ctx, args, 2, "writejson");
-    filename_obj = fe_nextarg(ctx, &args);
-    value = fe_nextarg(ctx, &args);
+static fe_Object* builtin_file_open(fe_Context *ctx, fe_Object *args) {
+    fe_Object *filename_obj = fe_nextarg(ctx, &args);
+    char *filename = string_to_cstr(ctx, filename_obj, "fopen");
+    char *mode = NULL;
+    FILE *fp;
+    FexFile *file;
 
-    filename = string_to_cstr(ctx, filename_obj, "writejson");
     if (!filename) return fe_nil(ctx);
-
-    buf.ctx = NULL;
-    buf.data = NULL;
-    buf.len = 0;
-    buf.cap = 0;
-    writer.ctx = ctx;
-    writer.poll_countdown = FEX_BUILTIN_ABORT_CHECK_INTERVAL;
-    if (!json_write_value(&writer, value, &buf)) {
-        builtin_free(ctx, filename);
-        buf_free(&buf);
-        return fe_nil(ctx);
+    if (!fe_isnil(ctx, args)) {
+        mode = string_to_cstr(ctx, fe_nextarg(ctx, &args), "fopen");
+        if (!mode) {
+            builtin_free(ctx, filename);
+            return fe_nil(ctx);
+        }
     }
 
-    file = fopen_utf8(ctx, filename,
+    {
 #ifdef _WIN32
-        L"wb",
+        const wchar_t *open_mode = file_mode_string(mode ? mode : "r");
 #else
-        "wb",
+        const char *open_mode = file_mode_string(mode ? mode : "r");
 #endif
-        "writejson");
+        builtin_free(ctx, mode);
+        if (!open_mode) {
+            builtin_free(ctx, filename);
+            fe_error(ctx, "fopen: mode must be one of r, w, a, r+, w+, a+");
+            return fe_nil(ctx);
+        }
+        fp = fopen_utf8(ctx, filename, open_mode, "fopen");
+    }
+    builtin_free(ctx, filename);
+    if (!fp) {
+        return fe_nil(ctx);
+    }
+
+    file = tracked_builtin_alloc(ctx, sizeof(*file));
     if (!file) {
-        builtin_free(ctx, filename);
-        buf_free(&buf);
-        fe_error(ctx, "writejson: could not open file for writing");
+        fclose(fp);
+        fe_error(ctx, "fopen: out of memory");
         return fe_nil(ctx);
     }
+    file->fp = fp;
+    file->next = (FexFile*)fe_ctx_file_state(ctx);
+    fe_ctx_set_file_state(ctx, file);
+    return fe_ptr(ctx, file);
+}
 
-    total_written = 0;
-    while (total_written < buf.len) {
-        chunk_size = buf.len - total_written;
-        if (chunk_size > FEX_FILE_IO_CHUNK_SIZE) {
-            chunk_size = FEX_FILE_IO_CHUNK_SIZE;
-        }
+static fe_Object* builtin_file_read_line(fe_Context *ctx, fe_Object *args) {
+    FEX_CHECK_ARGS(ctx, args, 1, "freadline");
+    FexFile *file = file_from_obj(ctx, fe_nextarg(ctx, &args), "freadline");
+    TextBuffer buf;
+    size_t poll_countdown = FEX_BUILTIN_ABORT_CHECK_INTERVAL;
+    const char *abort_error;
+    fe_Object *result;
+    int chr;
+
+    if (!file) return fe_nil(ctx);
+
+    buf.ctx = ctx;
+    buf.data = NULL;
+    buf.len = 0;
+    buf.cap = 0;
+
+    while ((chr = fgetc(file->fp)) != EOF) {
         abort_error = builtin_poll_abort(ctx, &poll_countdown);
         if (abort_error != NULL) {
-            fclose(file);
-            builtin_free(ctx, filename);
             buf_free(&buf);
             fe_error(ctx, abort_error);
             return fe_nil(ctx);
         }
-        written = fwrite(buf.data + total_written, 1, chunk_size, file);
-        total_written += written;
-        if (written < chunk_size || ferror(file)) {
-            fclose(file);
-            builtin_free(ctx, filename);
+        if (chr == '\n') break;
+        if (!buf_append_char(&buf, (char)chr)) {
             buf_free(&buf);
-            fe_error(ctx, "writejson: error writing file");
+            fe_error(ctx, "freadline: out of memory");
             return fe_nil(ctx);
         }
     }
 
-    fclose(file);
-    builtin_free(ctx, filename);
+    if (chr == EOF && buf.len == 0) {
+        buf_free(&buf);
+        if (ferror(file->fp)) {
+            fe_error(ctx, "freadline: error reading file");
+        }
+        return fe_nil(ctx);
+    }
+
+    /* Drop a trailing carriage return from CRLF line endings. */
+    if (buf.len > 0 && buf.data[buf.len - 1] == '\r') {
+        buf.len--;
+    }
+    result = fe_string(ctx, buf.data ? buf.data : "", buf.len);
     buf_free(&buf);
+    return result;
+}
+
+static fe_Object* builtin_file_read_bytes(fe_Context *ctx, fe_Object *args) {
+    FEX_CHECK_ARGS(ctx, args, 2, "freadbytes");
+    FexFile *file = file_from_obj(ctx, fe_nextarg(ctx, &args), "freadbytes");
+    fe_Number count_num = fe_tonumber(ctx, fe_nextarg(ctx, &args));
+    unsigned char *buffer;
+    size_t count;
+    size_t bytes_read;
+    fe_Object *result;
+
+    if (!file) return fe_nil(ctx);
+    if (count_num < 0) {
+        fe_error(ctx, "freadbytes: count must not be negative");
+        return fe_nil(ctx);
+    }
+    count = (size_t)count_num;
+
+    buffer = builtin_alloc(ctx, count > 0 ? count : 1);
+    if (!buffer) {
+        fe_error(ctx, "freadbytes: out of memory");
+        return fe_nil(ctx);
+    }
+    bytes_read = fread(buffer, 1, count, file->fp);
+    if (bytes_read == 0) {
+        int read_error = ferror(file->fp);
+        builtin_free(ctx, buffer);
+        if (read_error) {
+            fe_error(ctx, "freadbytes: error reading file");
+        }
+        return fe_nil(ctx);
+    }
+    result = fe_bytes(ctx, buffer, bytes_read);
+    builtin_free(ctx, buffer);
+    return result;
+}
+
+static fe_Object* builtin_file_write(fe_Context *ctx, fe_Object *args) {
+    FEX_CHECK_ARGS(ctx, args, 2, "fwrite");
+    FexFile *file = file_from_obj(ctx, fe_nextarg(ctx, &args), "fwrite");
+    fe_Object *content_obj = fe_nextarg(ctx, &args);
+    unsigned char *content = NULL;
+    char *content_str = NULL;
+    size_t content_len;
+    size_t written;
+    size_t total_written;
+    size_t chunk_size;
+    size_t poll_countdown = 1;
+    const char *abort_error;
+
+    if (!file) return fe_nil(ctx);
+
+    if (fe_type(ctx, content_obj) == FE_TBYTES) {
+        content = bytes_to_buffer(ctx, content_obj, "fwrite", &content_len);
+        if (!content) return fe_nil(ctx);
+    } else {
+        content_str = string_to_cstr(ctx, content_obj, "fwrite");
+        if (!content_str) return fe_nil(ctx);
+        content = (unsigned char*)content_str;
+        content_len = strlen(content_str);
+    }
+
+    total_written = 0;
+    while (total_written < content_len) {
+        chunk_size = content_len - total_written;
+        if (chunk_size > FEX_FILE_IO_CHUNK_SIZE) {
+            chunk_size = FEX_FILE_IO_CHUNK_SIZE;
+        }
+        abort_error = builtin_poll_abort(ctx, &poll_countdown);
+        if (abort_error != NULL) {
+            builtin_free(ctx, content);
+            fe_error(ctx, abort_error);
+            return fe_nil(ctx);
+        }
+        written = fwrite(content + total_written, 1, chunk_size, file->fp);
+        total_written += written;
+        if (written < chunk_size || ferror(file->fp)) {
+            builtin_free(ctx, content);
+            fe_error(ctx, "fwrite: error writing file");
+            return fe_nil(ctx);
+        }
+    }
+
+    builtin_free(ctx, content);
     return fe_make_number(ctx, (fe_Number)total_written);
 }
 
+static fe_Object* builtin_file_close(fe_Context *ctx, fe_Object *args) {
+    FEX_CHECK_ARGS(ctx, args, 1, "fclose");
+    FexFile *file = file_from_obj(ctx, fe_nextarg(ctx, &args), "fclose");
+    int close_error;
+
+    if (!file) return fe_nil(ctx);
+    close_error = fclose(file->fp);
+    file->fp = NULL;
+    if (close_error != 0) {
+        fe_error(ctx, "fclose: error closing file");
+        return fe_nil(ctx);
+    }
+    return fe_bool(ctx, 1);
+}
+
+static fe_Object* builtin_read_json(fe_Context *ctx, fe_Object *args) {
+    fe_Object *filename_obj;
+    char *filename;
+    char *buffer;
+    size_t buffer_len;
+    JsonParser parser;
+    fe_Object *result;
+
+    FEX_CHECK_ARGS(ctx, args, 1, "readjson");
+    filename_obj = fe_nextarg(ctx, &args);
+    filename = string_to_cstr(ctx, filename_obj, "readjson");
+    if (!filename) return fe_nil(ctx);
+
+    buffer = read_file_dynamic(ctx, filename, 256 * 1024, &buffer_len, "readjson", filename);
+    builtin_free(ctx, filename);
+    if (!buffer) return fe_nil(ctx);
+
+    parser.ctx = ctx;
+    parser.current = buffer;
+    parser.end = buffer + buffer_len;
+    parser.poll_countdown = FEX_BUILTIN_ABORT_CHECK_INTERVAL;
+    parser.fp = NULL;
+    parser.window = NULL;
+    parser.window_cap = 0;
+    parser.eof = 1;
+    result = json_parse_value(&parser);
+    json_skip_ws(&parser);
+    if (*parser.current != '\0') {
+        tracked_builtin_free(ctx, buffer);
+        fe_error(ctx, "readjson: trailing characters");
+        return fe_nil(ctx);
+    }
+    tracked_builtin_free(ctx, buffer);
+    return result;
+}
+
+/* Parses a JSON document incrementally from an open file handle through
+ * a sliding window, so large documents never have to be materialized as
+ * a FeX string first.  Reads from the handle's current position and
+ * consumes the stream through the document (plus trailing whitespace). */
+static fe_Object* builtin_file_read_json(fe_Context *ctx, fe_Object *args) {
+    fe_Object *file_obj;
+    FexFile *file;
+    char *window;
+    JsonParser parser;
+    fe_Object *result;
+
+    FEX_CHECK_ARGS(ctx, args, 1, "freadjson");
+    file_obj = fe_nextarg(ctx, &args);
+    file = file_from_obj(ctx, file_obj, "freadjson");
+
+    window = (char*)tracked_builtin_alloc(ctx, JSON_STREAM_WINDOW_SIZE);
+    if (!window) {
+        fe_ctx_memory_error(ctx, "freadjson: out of memory");
+        return fe_nil(ctx);
+    }
+    window[0] = '\0';
+
+    parser.ctx = ctx;
+    parser.current = window;
+    parser.end = window;
+    parser.poll_countdown = FEX_BUILTIN_ABORT_CHECK_INTERVAL;
+    parser.fp = file->fp;
+    parser.window = window;
+    parser.window_cap = JSON_STREAM_WINDOW_SIZE;
+    parser.eof = 0;
+
+    result = json_parse_value(&parser);
+    json_skip_ws(&parser);
+    if (parser.current != parser.end) {
+        tracked_builtin_free(ctx, window);
+        fe_error(ctx, "freadjson: trailing characters");
+        return fe_nil(ctx);
+    }
+    tracked_builtin_free(ctx, window);
+    return result;
+}
+
+/* Serializes straight into the destination file through the writer's
+ * streaming window: only JSON_STREAM_WINDOW_SIZE bytes are ever buffered
+ * in memory, regardless of the document size. */
+static fe_Object* builtin_write_json(fe_Context *ctx, fe_Object *args) {
+    fe_Object *filename_obj;
+    fe_Object *value;
+    char *filename;
+    TextBuffer buf;
+    FILE *file;
+    JsonWriter writer;
+
+    FEX_CHECK_ARGS(ctx, args, 2, "writejson");
+    filename_obj = fe_nextarg(ctx, &args);
+    value = fe_nextarg(ctx, &args);
+
+    filename = string_to_cstr(ctx, filename_obj, "writejson");
+    if (!filename) return fe_nil(ctx);
+
+    file = fopen_utf8(ctx, filename,
+#ifdef _WIN32
+        L"wb",
+#else
+        "wb",
+#endif
+        "writejson");
+    builtin_free(ctx, filename);
+    if (!file) {
+        fe_error(ctx, "writejson: could not open file for writing");
+        return fe_nil(ctx);
+    }
+
+    buf.ctx = NULL;
+    buf.data = NULL;
+    buf.len = 0;
+    buf.cap = 0;
+    writer.ctx = ctx;
+    writer.poll_countdown = FEX_BUILTIN_ABORT_CHECK_INTERVAL;
+    writer.fp = file;
+    writer.total_written = 0;
+    writer.func_name = "writejson";
+    if (!json_write_value(&writer, value, &buf) ||
+        !json_writer_flush(&writer, &buf)) {
+        fclose(file);
+        buf_free(&buf);
+        return fe_nil(ctx);
+    }
+
+    buf_free(&buf);
+    if (fclose(file) != 0) {
+        fe_error(ctx, "writejson: error writing file");
+        return fe_nil(ctx);
+    }
+    return fe_make_number(ctx, (fe_Number)writer.total_written);
+}
+
+/* Streaming counterpart of freadjson: serializes a value directly to an
+ * open file handle at its current position, so huge documents never
+ * exist as a single FeX string.  Returns the number of bytes written. */
+static fe_Object* builtin_file_write_json(fe_Context *ctx, fe_Object *args) {
+    fe_Object *file_obj;
+    fe_Object *value;
+    FexFile *file;
+    TextBuffer buf;
+    JsonWriter writer;
+
+    FEX_CHECK_ARGS(ctx, args, 2, "fwritejson");
+    file_obj = fe_nextarg(ctx, &args);
+    value = fe_nextarg(ctx, &args);
+    file = file_from_obj(ctx, file_obj, "fwritejson");
+    if (!file) return fe_nil(ctx);
+
+    buf.ctx = NULL;
+    buf.data = NULL;
+    buf.len = 0;
+    buf.cap = 0;
+    writer.ctx = ctx;
+    writer.poll_countdown = FEX_BUILTIN_ABORT_CHECK_INTERVAL;
+    writer.fp = file->fp;
+    writer.total_written = 0;
+    writer.func_name = "fwritejson";
+    if (!json_write_value(&writer, value, &buf) ||
+        !json_writer_flush(&writer, &buf)) {
+        buf_free(&buf);
+        return fe_nil(ctx);
+    }
+
+    buf_free(&buf);
+    return fe_make_number(ctx, (fe_Number)writer.total_written);
+}
+
 static int count_list_length(fe_Context *ctx, fe_Object *list,
                              const char *func_name, const char *label) {
     int count = 0;
@@ -4760,369 +6107,1915 @@ static fe_Object* build_process_result(fe_Context *ctx,
 }
 
 /*
-================================================================================
-|                             SYSTEM FUNCTIONS                                |
-================================================================================
-*/
-
-static fe_Object* builtin_cwd(fe_Context *ctx, fe_Object *args) {
-    char *path;
-    fe_Object *result;
-
-    FEX_CHECK_NO_ARGS(ctx, args, "cwd");
-    path = current_working_directory_cstr(ctx);
-    if (!path) {
-        fe_error(ctx, "cwd: could not determine current directory");
-        return fe_nil(ctx);
+ * Async child processes.  processstart() spawns without waiting and
+ * returns an FE_TPTR handle whose pointer refers to a FexProcess node in
+ * the per-context registry hanging off fe_ctx_process_state(), mirroring
+ * the buffered file handles above.  processpoll()/processread() pump the
+ * capture pipes without blocking so several children can run
+ * concurrently; processwait() reaps the child and releases the native
+ * resources, after which the handle fails cleanly.  fex_process_cleanup()
+ * kills and reaps anything still running when the context shuts down.
+ *
+ * The max_stdout/max_stderr options bound the *unread* backlog per
+ * stream: a script that drains with processread() can stream any amount,
+ * while one that never reads gets the same "file too large" error as the
+ * synchronous runprocess() instead of a deadlocked child.
+ */
+typedef struct FexProcess {
+    ProcessCapturePipe stdin_pipe;
+    ProcessCapturePipe stdout_pipe;
+    ProcessCapturePipe stderr_pipe;
+    TextBuffer stdout_buf;
+    TextBuffer stderr_buf;
+    unsigned char *stdin_data;
+    size_t stdin_len;
+    size_t stdin_offset;
+    size_t max_stdout;
+    size_t max_stderr;
+    int stdout_overflow;
+    int stderr_overflow;
+    int stdin_open;
+    int stdout_open;
+    int stderr_open;
+    int stdout_captured;
+    int stderr_captured;
+    int finished;
+    int released;
+    int exit_code;
+#ifdef _WIN32
+    HANDLE process;
+    HANDLE stdin_thread;
+    ProcessInputWriter stdin_writer;
+#else
+    pid_t pid;
+#endif
+    struct FexProcess *next;
+} FexProcess;
+
+static FexProcess* process_from_obj(fe_Context *ctx, fe_Object *obj,
+                                    const char *func_name) {
+    FexProcess *proc;
+    void *ptr;
+    char message[64];
+
+    if (fe_type(ctx, obj) != FE_TPTR) {
+        snprintf(message, sizeof(message), "%s: expected a process handle", func_name);
+        fe_error(ctx, message);
+        return NULL;
     }
-
-    result = fe_string(ctx, path, strlen(path));
-    builtin_free(ctx, path);
-    return result;
+    ptr = fe_toptr(ctx, obj);
+    for (proc = (FexProcess*)fe_ctx_process_state(ctx); proc; proc = proc->next) {
+        if (proc == ptr) {
+            if (proc->released) {
+                snprintf(message, sizeof(message), "%s: process already waited", func_name);
+                fe_error(ctx, message);
+                return NULL;
+            }
+            return proc;
+        }
+    }
+    snprintf(message, sizeof(message), "%s: invalid process handle", func_name);
+    fe_error(ctx, message);
+    return NULL;
 }
 
-static fe_Object* builtin_chdir(fe_Context *ctx, fe_Object *args) {
-    fe_Object *path_obj;
-    char *path;
-    int ok;
-
-    FEX_CHECK_ARGS(ctx, args, 1, "chdir");
-    path_obj = fe_nextarg(ctx, &args);
-    path = string_to_cstr(ctx, path_obj, "chdir");
-    if (!path) {
-        return fe_nil(ctx);
+/* Kills an unreaped child and closes every native resource; the node
+   itself stays registered so stale handles keep failing cleanly. */
+static void release_process_resources(fe_Context *ctx, FexProcess *proc) {
+    if (proc->released) {
+        return;
     }
-
 #ifdef _WIN32
-    {
-        wchar_t *wide_path = utf8_to_wide_alloc(ctx, path, "chdir");
-        if (!wide_path) {
-            builtin_free(ctx, path);
-            return fe_nil(ctx);
-        }
-        ok = SetCurrentDirectoryW(wide_path) != 0;
-        builtin_free(ctx, wide_path);
+    if (proc->stdin_thread != NULL) {
+        WaitForSingleObject(proc->stdin_thread, INFINITE);
+        CloseHandle(proc->stdin_thread);
+        proc->stdin_thread = NULL;
+    }
+    if (!proc->finished && proc->process != NULL) {
+        terminate_windows_process(&proc->process);
+    } else if (proc->process != NULL) {
+        CloseHandle(proc->process);
+        proc->process = NULL;
     }
 #else
-    ok = chdir(path) == 0;
+    if (!proc->finished && proc->pid > 0) {
+        terminate_posix_process(&proc->pid);
+    }
 #endif
-    builtin_free(ctx, path);
+    destroy_process_capture_pipe(&proc->stdin_pipe);
+    destroy_process_capture_pipe(&proc->stdout_pipe);
+    destroy_process_capture_pipe(&proc->stderr_pipe);
+    buf_free(&proc->stdout_buf);
+    buf_free(&proc->stderr_buf);
+    builtin_free(ctx, proc->stdin_data);
+    proc->stdin_data = NULL;
+    proc->released = 1;
+}
+
+void fex_process_cleanup(fe_Context *ctx) {
+    FexProcess *proc = (FexProcess*)fe_ctx_process_state(ctx);
+    while (proc) {
+        FexProcess *next = proc->next;
+        release_process_resources(ctx, proc);
+        tracked_builtin_free(ctx, proc);
+        proc = next;
+    }
+    fe_ctx_set_process_state(ctx, NULL);
+}
+
+/* One non-blocking pass: feed pending stdin, drain whatever the capture
+   pipes hold (up to the backlog limits), and reap the child if it has
+   exited.  Returns 0 after raising an error. */
+static int pump_process(fe_Context *ctx, FexProcess *proc,
+                        const char *func_name) {
+    int made_progress = 0;
 
-    if (!ok) {
-        fe_error(ctx, "chdir: could not change directory");
-        return fe_nil(ctx);
+    if (proc->finished && !proc->stdin_open &&
+        !proc->stdout_open && !proc->stderr_open) {
+        return 1;
     }
-    return fe_bool(ctx, 1);
-}
-
-static fe_Object* builtin_get_env(fe_Context *ctx, fe_Object *args) {
-    fe_Object *name_obj;
-    char *name;
-    const char *value;
-    fe_Object *result;
 
-    FEX_CHECK_ARGS(ctx, args, 1, "getenv");
-    name_obj = fe_nextarg(ctx, &args);
-    name = string_to_cstr(ctx, name_obj, "getenv");
-    if (!name) {
+#ifdef _WIN32
+    if (!proc->finished) {
+        DWORD wait_result = WaitForSingleObject(proc->process, 0);
+        if (wait_result == WAIT_OBJECT_0) {
+            DWORD raw_exit_code = 0;
+            if (!GetExitCodeProcess(proc->process, &raw_exit_code)) {
+                char msg[96];
+                snprintf(msg, sizeof(msg), "%s: could not wait for process", func_name);
+                fe_error(ctx, msg);
+                return 0;
+            }
+            proc->exit_code = (int)raw_exit_code;
+            CloseHandle(proc->process);
+            proc->process = NULL;
+            proc->finished = 1;
+        } else if (wait_result != WAIT_TIMEOUT) {
+            char msg[96];
+            snprintf(msg, sizeof(msg), "%s: could not wait for process", func_name);
+            fe_error(ctx, msg);
+            return 0;
+        }
+    }
+    if (proc->stdin_open && proc->stdin_thread != NULL) {
+        if (WaitForSingleObject(proc->stdin_thread, 0) == WAIT_OBJECT_0) {
+            CloseHandle(proc->stdin_thread);
+            proc->stdin_thread = NULL;
+            proc->stdin_open = 0;
+            if (proc->stdin_writer.failed) {
+                char msg[96];
+                snprintf(msg, sizeof(msg), "%s: could not write stdin", func_name);
+                fe_error(ctx, msg);
+                return 0;
+            }
+        }
+    }
+    if (proc->stdout_open &&
+        !drain_windows_capture_pipe(ctx, &proc->stdout_pipe, &proc->stdout_buf,
+                                    proc->max_stdout, &proc->stdout_overflow,
+                                    func_name, proc->finished,
+                                    &proc->stdout_open, &made_progress)) {
+        return 0;
+    }
+    if (proc->stderr_open &&
+        !drain_windows_capture_pipe(ctx, &proc->stderr_pipe, &proc->stderr_buf,
+                                    proc->max_stderr, &proc->stderr_overflow,
+                                    func_name, proc->finished,
+                                    &proc->stderr_open, &made_progress)) {
+        return 0;
+    }
+#else
+    if (!proc->finished) {
+        int status = 0;
+        pid_t waited = waitpid(proc->pid, &status, WNOHANG);
+        if (waited == proc->pid) {
+            proc->exit_code = decode_process_exit_code(status);
+            proc->pid = -1;
+            proc->finished = 1;
+        } else if (waited < 0) {
+            char msg[96];
+            snprintf(msg, sizeof(msg), "%s: could not wait for process", func_name);
+            fe_error(ctx, msg);
+            return 0;
+        }
+    }
+    if (proc->stdin_open &&
+        !write_posix_input_pipe(ctx, &proc->stdin_pipe,
+                                proc->stdin_data ? proc->stdin_data : (const unsigned char*)"",
+                                proc->stdin_len, &proc->stdin_offset,
+                                func_name, &proc->stdin_open, &made_progress)) {
+        return 0;
+    }
+    if (proc->stdout_open &&
+        !drain_posix_capture_pipe(ctx, &proc->stdout_pipe, &proc->stdout_buf,
+                                  proc->max_stdout, &proc->stdout_overflow,
+                                  func_name, &proc->stdout_open,
+                                  &made_progress)) {
+        return 0;
+    }
+    if (proc->stderr_open &&
+        !drain_posix_capture_pipe(ctx, &proc->stderr_pipe, &proc->stderr_buf,
+                                  proc->max_stderr, &proc->stderr_overflow,
+                                  func_name, &proc->stderr_open,
+                                  &made_progress)) {
+        return 0;
+    }
+    /* After the child exits its pipe ends are closed, so the reads above
+       observe EOF and clear the open flags. */
+#endif
+
+    (void)made_progress;
+    return 1;
+}
+
+/* Spawns the child exactly like run_process_native() does but returns as
+   soon as it is running; the caller owns the registered FexProcess. */
+static FexProcess* start_process_async(fe_Context *ctx, CStringArray *argv,
+                                       ProcessOptions *options,
+                                       const char *func_name) {
+    FexProcess *proc;
+    TempRedirectFile stdout_redirect;
+    TempRedirectFile stderr_redirect;
+    char msg[96];
+
+    proc = tracked_builtin_alloc(ctx, sizeof(*proc));
+    if (!proc) {
+        snprintf(msg, sizeof(msg), "%s: out of memory", func_name);
+        fe_error(ctx, msg);
+        return NULL;
+    }
+    memset(proc, 0, sizeof(*proc));
+    init_process_capture_pipe(&proc->stdin_pipe);
+    init_process_capture_pipe(&proc->stdout_pipe);
+    init_process_capture_pipe(&proc->stderr_pipe);
+    init_temp_redirect_file(&stdout_redirect);
+    init_temp_redirect_file(&stderr_redirect);
+    proc->stdout_buf.ctx = NULL;
+    proc->stderr_buf.ctx = NULL;
+    proc->max_stdout = options->max_stdout;
+    proc->max_stderr = options->max_stderr;
+    proc->stdout_captured = (options->stdout_mode == PROCESS_STREAM_CAPTURE);
+    proc->stderr_captured = (options->stderr_mode == PROCESS_STREAM_CAPTURE);
+#ifdef _WIN32
+    proc->process = NULL;
+    proc->stdin_thread = NULL;
+    proc->stdin_writer.write_handle = INVALID_HANDLE_VALUE;
+#else
+    proc->pid = -1;
+#endif
+
+    /* The node owns the stdin bytes: they must stay alive until the pipe
+       pump (or the writer thread on Windows) has fed them to the child. */
+    proc->stdin_data = options->stdin_data;
+    proc->stdin_len = options->stdin_len;
+    options->stdin_data = NULL;
+    options->stdin_len = 0;
+
+    if (!create_process_input_pipe(ctx, &proc->stdin_pipe, func_name)) {
+        goto fail;
+    }
+    if (options->stdout_mode == PROCESS_STREAM_CAPTURE) {
+        if (!create_process_capture_pipe(ctx, &proc->stdout_pipe, func_name)) {
+            goto fail;
+        }
+    } else if (options->stdout_mode == PROCESS_STREAM_DISCARD) {
+        if (!open_null_redirect_file(ctx, &stdout_redirect, 1, func_name)) {
+            goto fail;
+        }
+    }
+    if (options->stderr_mode == PROCESS_STREAM_CAPTURE) {
+        if (!create_process_capture_pipe(ctx, &proc->stderr_pipe, func_name)) {
+            goto fail;
+        }
+    } else if (options->stderr_mode == PROCESS_STREAM_DISCARD) {
+        if (!open_null_redirect_file(ctx, &stderr_redirect, 1, func_name)) {
+            goto fail;
+        }
+    }
+
+#ifdef _WIN32
+    {
+        STARTUPINFOW startup_info;
+        PROCESS_INFORMATION process_info;
+        char *command_line = NULL;
+        wchar_t *command_line_wide = NULL;
+        wchar_t *environment = NULL;
+        wchar_t *cwd_wide = NULL;
+        DWORD creation_flags = 0;
+
+        ZeroMemory(&startup_info, sizeof(startup_info));
+        ZeroMemory(&process_info, sizeof(process_info));
+
+        command_line = build_windows_command_line(ctx, argv, func_name);
+        if (!command_line) {
+            goto fail;
+        }
+        command_line_wide = utf8_to_wide_alloc(ctx, command_line, func_name);
+        builtin_free(ctx, command_line);
+        if (!command_line_wide) {
+            goto fail;
+        }
+        if (options->use_env) {
+            environment = build_windows_environment_block(ctx, &options->env, func_name);
+            if (!environment) {
+                builtin_free(ctx, command_line_wide);
+                goto fail;
+            }
+            creation_flags |= CREATE_UNICODE_ENVIRONMENT;
+        }
+        if (options->cwd) {
+            cwd_wide = utf8_to_wide_alloc(ctx, options->cwd, func_name);
+            if (!cwd_wide) {
+                builtin_free(ctx, command_line_wide);
+                builtin_free(ctx, environment);
+                goto fail;
+            }
+        }
+
+        startup_info.cb = sizeof(startup_info);
+        startup_info.dwFlags = STARTF_USESTDHANDLES;
+        startup_info.hStdInput = proc->stdin_pipe.read_handle;
+        if (options->stdout_mode == PROCESS_STREAM_INHERIT) {
+            stdout_redirect.handle = duplicate_inheritable_handle(GetStdHandle(STD_OUTPUT_HANDLE));
+            if (stdout_redirect.handle == INVALID_HANDLE_VALUE) {
+                builtin_free(ctx, command_line_wide);
+                builtin_free(ctx, environment);
+                builtin_free(ctx, cwd_wide);
+                snprintf(msg, sizeof(msg), "%s: could not inherit stdout", func_name);
+                fe_error(ctx, msg);
+                goto fail;
+            }
+            startup_info.hStdOutput = stdout_redirect.handle;
+        } else if (options->stdout_mode == PROCESS_STREAM_CAPTURE) {
+            startup_info.hStdOutput = proc->stdout_pipe.write_handle;
+        } else {
+            startup_info.hStdOutput = stdout_redirect.handle;
+        }
+        if (options->stderr_mode == PROCESS_STREAM_INHERIT) {
+            stderr_redirect.handle = duplicate_inheritable_handle(GetStdHandle(STD_ERROR_HANDLE));
+            if (stderr_redirect.handle == INVALID_HANDLE_VALUE) {
+                builtin_free(ctx, command_line_wide);
+                builtin_free(ctx, environment);
+                builtin_free(ctx, cwd_wide);
+                snprintf(msg, sizeof(msg), "%s: could not inherit stderr", func_name);
+                fe_error(ctx, msg);
+                goto fail;
+            }
+            startup_info.hStdError = stderr_redirect.handle;
+        } else if (options->stderr_mode == PROCESS_STREAM_CAPTURE) {
+            startup_info.hStdError = proc->stderr_pipe.write_handle;
+        } else {
+            startup_info.hStdError = stderr_redirect.handle;
+        }
+
+        if (!CreateProcessW(NULL, command_line_wide, NULL, NULL, TRUE, creation_flags,
+                            environment, cwd_wide, &startup_info, &process_info)) {
+            builtin_free(ctx, command_line_wide);
+            builtin_free(ctx, environment);
+            builtin_free(ctx, cwd_wide);
+            snprintf(msg, sizeof(msg), "%s: could not start process", func_name);
+            fe_error(ctx, msg);
+            goto fail;
+        }
+
+        builtin_free(ctx, command_line_wide);
+        builtin_free(ctx, environment);
+        builtin_free(ctx, cwd_wide);
+        CloseHandle(process_info.hThread);
+        proc->process = process_info.hProcess;
+        close_process_capture_pipe_read(&proc->stdin_pipe);
+        close_temp_redirect_file(&stdout_redirect);
+        close_temp_redirect_file(&stderr_redirect);
+        close_process_capture_pipe_write(&proc->stdout_pipe);
+        close_process_capture_pipe_write(&proc->stderr_pipe);
+
+        if (proc->stdin_len > 0) {
+            proc->stdin_writer.write_handle = proc->stdin_pipe.write_handle;
+            proc->stdin_writer.data = proc->stdin_data
+                ? proc->stdin_data
+                : (const unsigned char*)"";
+            proc->stdin_writer.len = proc->stdin_len;
+            proc->stdin_thread = CreateThread(NULL, 0, process_input_writer_thread,
+                                              &proc->stdin_writer, 0, NULL);
+            if (proc->stdin_thread == NULL) {
+                snprintf(msg, sizeof(msg), "%s: could not start stdin writer", func_name);
+                fe_error(ctx, msg);
+                goto fail;
+            }
+            proc->stdin_pipe.write_handle = INVALID_HANDLE_VALUE;
+            proc->stdin_open = 1;
+        } else {
+            close_process_capture_pipe_write(&proc->stdin_pipe);
+        }
+    }
+#else
+    {
+        pid_t pid = fork();
+
+        if (pid < 0) {
+            snprintf(msg, sizeof(msg), "%s: could not start process", func_name);
+            fe_error(ctx, msg);
+            goto fail;
+        }
+
+        if (pid == 0) {
+            if (options->cwd && chdir(options->cwd) != 0) {
+                _exit(127);
+            }
+            if (dup2(proc->stdin_pipe.read_fd, 0) < 0) {
+                _exit(127);
+            }
+            close_process_capture_pipe_read(&proc->stdin_pipe);
+            close_process_capture_pipe_write(&proc->stdin_pipe);
+            if (options->stdout_mode == PROCESS_STREAM_CAPTURE) {
+                close_process_capture_pipe_read(&proc->stdout_pipe);
+                if (dup2(proc->stdout_pipe.write_fd, 1) < 0) {
+                    _exit(127);
+                }
+                close_process_capture_pipe_write(&proc->stdout_pipe);
+            } else if (options->stdout_mode == PROCESS_STREAM_DISCARD) {
+                if (dup2(stdout_redirect.fd, 1) < 0) {
+                    _exit(127);
+                }
+                close_temp_redirect_file(&stdout_redirect);
+            }
+            if (options->stderr_mode == PROCESS_STREAM_CAPTURE) {
+                close_process_capture_pipe_read(&proc->stderr_pipe);
+                if (dup2(proc->stderr_pipe.write_fd, 2) < 0) {
+                    _exit(127);
+                }
+                close_process_capture_pipe_write(&proc->stderr_pipe);
+            } else if (options->stderr_mode == PROCESS_STREAM_DISCARD) {
+                if (dup2(stderr_redirect.fd, 2) < 0) {
+                    _exit(127);
+                }
+                close_temp_redirect_file(&stderr_redirect);
+            }
+            if (options->use_env) {
+                environ = options->env.items;
+            }
+            execvp(argv->items[0], argv->items);
+            _exit(127);
+        }
+
+        proc->pid = pid;
+        close_process_capture_pipe_read(&proc->stdin_pipe);
+        close_temp_redirect_file(&stdout_redirect);
+        close_temp_redirect_file(&stderr_redirect);
+        close_process_capture_pipe_write(&proc->stdout_pipe);
+        close_process_capture_pipe_write(&proc->stderr_pipe);
+
+        if (proc->stdin_len > 0) {
+            proc->stdin_open = 1;
+        } else {
+            close_process_capture_pipe_write(&proc->stdin_pipe);
+        }
+    }
+#endif
+
+    proc->stdout_open = proc->stdout_captured;
+    proc->stderr_open = proc->stderr_captured;
+    proc->next = (FexProcess*)fe_ctx_process_state(ctx);
+    fe_ctx_set_process_state(ctx, proc);
+    return proc;
+
+fail:
+    destroy_process_capture_pipe(&proc->stdin_pipe);
+    destroy_process_capture_pipe(&proc->stdout_pipe);
+    destroy_process_capture_pipe(&proc->stderr_pipe);
+    destroy_temp_redirect_file(&stdout_redirect);
+    destroy_temp_redirect_file(&stderr_redirect);
+    builtin_free(ctx, proc->stdin_data);
+    tracked_builtin_free(ctx, proc);
+    return NULL;
+}
+
+/*
+================================================================================
+|                             SYSTEM FUNCTIONS                                |
+================================================================================
+*/
+
+static fe_Object* builtin_cwd(fe_Context *ctx, fe_Object *args) {
+    char *path;
+    fe_Object *result;
+
+    FEX_CHECK_NO_ARGS(ctx, args, "cwd");
+    path = current_working_directory_cstr(ctx);
+    if (!path) {
+        fe_error(ctx, "cwd: could not determine current directory");
+        return fe_nil(ctx);
+    }
+
+    result = fe_string(ctx, path, strlen(path));
+    builtin_free(ctx, path);
+    return result;
+}
+
+static fe_Object* builtin_chdir(fe_Context *ctx, fe_Object *args) {
+    fe_Object *path_obj;
+    char *path;
+    int ok;
+
+    FEX_CHECK_ARGS(ctx, args, 1, "chdir");
+    path_obj = fe_nextarg(ctx, &args);
+    path = string_to_cstr(ctx, path_obj, "chdir");
+    if (!path) {
+        return fe_nil(ctx);
+    }
+
+#ifdef _WIN32
+    {
+        wchar_t *wide_path = utf8_to_wide_alloc(ctx, path, "chdir");
+        if (!wide_path) {
+            builtin_free(ctx, path);
+            return fe_nil(ctx);
+        }
+        ok = SetCurrentDirectoryW(wide_path) != 0;
+        builtin_free(ctx, wide_path);
+    }
+#else
+    ok = chdir(path) == 0;
+#endif
+    builtin_free(ctx, path);
+
+    if (!ok) {
+        fe_error(ctx, "chdir: could not change directory");
+        return fe_nil(ctx);
+    }
+    fe_ctx_module_resolution_invalidate(ctx);
+    return fe_bool(ctx, 1);
+}
+
+static fe_Object* builtin_get_env(fe_Context *ctx, fe_Object *args) {
+    fe_Object *name_obj;
+    char *name;
+    const char *value;
+    fe_Object *result;
+
+    FEX_CHECK_ARGS(ctx, args, 1, "getenv");
+    name_obj = fe_nextarg(ctx, &args);
+    name = string_to_cstr(ctx, name_obj, "getenv");
+    if (!name) {
+        return fe_nil(ctx);
+    }
+
+    value = getenv(name);
+    builtin_free(ctx, name);
+    if (!value) {
+        return fe_nil(ctx);
+    }
+
+    result = fe_string(ctx, value, strlen(value));
+    return result;
+}
+
+static fe_Object* builtin_time(fe_Context *ctx, fe_Object *args) {
+    (void)args; /* Unused */
+    time_t current_time = time(NULL);
+    return fe_make_number(ctx, (fe_Number)current_time);
+}
+
+static fe_Object* builtin_exit(fe_Context *ctx, fe_Object *args) {
+    int code = 0;
+    if (!fe_isnil(ctx, args)) {
+        fe_Object *code_obj = fe_nextarg(ctx, &args);
+        code = (int)fe_tonumber(ctx, code_obj);
+    }
+    exit(code);
+    return fe_nil(ctx); /* Never reached */
+}
+
+static fe_Object* builtin_system(fe_Context *ctx, fe_Object *args) {
+    fe_Object *command_obj;
+    char *command;
+    CStringArray argv;
+    ProcessOptions options;
+    ProcessOutput output;
+    fe_Object *result;
+    const char *process_error = NULL;
+
+    memset(&argv, 0, sizeof(argv));
+    argv.ctx = ctx;
+    memset(&options, 0, sizeof(options));
+    options.env.ctx = ctx;
+    memset(&output, 0, sizeof(output));
+
+    FEX_CHECK_ARGS(ctx, args, 1, "system");
+    command_obj = fe_nextarg(ctx, &args);
+    command = string_to_cstr(ctx, command_obj, "system");
+
+    if (!command) {
+        return fe_nil(ctx);
+    }
+
+    if (!build_shell_process_argv(ctx, command, "system", &argv)) {
+        builtin_free(ctx, command);
+        free_cstring_array(&argv);
+        return fe_nil(ctx);
+    }
+    builtin_free(ctx, command);
+    options.stdout_mode = PROCESS_STREAM_INHERIT;
+    options.stderr_mode = PROCESS_STREAM_INHERIT;
+    if (!run_process_native(ctx, &argv, &options, &output, "system",
+                            &process_error)) {
+        free_cstring_array(&argv);
+        free_process_output(ctx, &output);
+        if (process_error != NULL) {
+            fe_error(ctx, process_error);
+        }
+        return fe_nil(ctx);
+    }
+
+    result = fe_make_number(ctx, (fe_Number)output.exit_code);
+    free_cstring_array(&argv);
+    free_process_output(ctx, &output);
+    return result;
+}
+
+static fe_Object* builtin_run_command(fe_Context *ctx, fe_Object *args) {
+    fe_Object *command_obj;
+    char *command;
+    char *merged_command;
+    CStringArray argv;
+    ProcessOptions options;
+    ProcessOutput output;
+    fe_Object *result;
+    const char *process_error = NULL;
+
+    memset(&argv, 0, sizeof(argv));
+    argv.ctx = ctx;
+    memset(&options, 0, sizeof(options));
+    options.env.ctx = ctx;
+    memset(&output, 0, sizeof(output));
+
+    FEX_CHECK_ARGS(ctx, args, 1, "runcommand");
+    command_obj = fe_nextarg(ctx, &args);
+    command = string_to_cstr(ctx, command_obj, "runcommand");
+    if (!command) {
+        return fe_nil(ctx);
+    }
+
+    merged_command = build_merged_command(ctx, command, "runcommand");
+    builtin_free(ctx, command);
+    if (!merged_command) {
+        return fe_nil(ctx);
+    }
+
+    if (!build_shell_process_argv(ctx, merged_command, "runcommand", &argv)) {
+        builtin_free(ctx, merged_command);
+        free_cstring_array(&argv);
+        return fe_nil(ctx);
+    }
+    builtin_free(ctx, merged_command);
+    options.stdout_mode = PROCESS_STREAM_CAPTURE;
+    options.stderr_mode = PROCESS_STREAM_DISCARD;
+    options.max_stdout = FEX_COMMAND_OUTPUT_MAX_BYTES;
+    if (!run_process_native(ctx, &argv, &options, &output, "runcommand",
+                            &process_error)) {
+        free_cstring_array(&argv);
+        free_process_output(ctx, &output);
+        if (process_error != NULL) {
+            fe_error(ctx, process_error);
+        }
+        return fe_nil(ctx);
+    }
+
+    result = fe_map(ctx);
+    fe_map_set(ctx, result, fe_symbol(ctx, "code"),
+               fe_make_number(ctx, (fe_Number)output.exit_code));
+    fe_map_set(ctx, result, fe_symbol(ctx, "ok"), fe_bool(ctx, output.exit_code == 0));
+    fe_map_set(ctx, result, fe_symbol(ctx, "output"),
+               fe_bytes(ctx,
+                        output.stdout_data ? output.stdout_data : (const unsigned char*)"",
+                        output.stdout_len));
+    free_cstring_array(&argv);
+    free_process_output(ctx, &output);
+    return result;
+}
+
+static fe_Object* builtin_run_process(fe_Context *ctx, fe_Object *args) {
+    fe_Object *exe_obj;
+    fe_Object *argv_obj = fe_nil(ctx);
+    fe_Object *opts_obj = fe_nil(ctx);
+    CStringArray argv;
+    ProcessOptions options;
+    ProcessOutput output;
+    fe_Object *result;
+    const char *process_error = NULL;
+
+    memset(&argv, 0, sizeof(argv));
+    argv.ctx = ctx;
+    memset(&options, 0, sizeof(options));
+    options.env.ctx = ctx;
+    memset(&output, 0, sizeof(output));
+
+    FEX_CHECK_ARGS(ctx, args, 1, "runprocess");
+    exe_obj = fe_nextarg(ctx, &args);
+    if (!fe_isnil(ctx, args)) {
+        argv_obj = fe_nextarg(ctx, &args);
+    }
+    if (!fe_isnil(ctx, args)) {
+        opts_obj = fe_nextarg(ctx, &args);
+    }
+    if (!fe_isnil(ctx, args)) {
+        fe_error(ctx, "runprocess: too many arguments");
+        return fe_nil(ctx);
+    }
+
+    if (!collect_process_argv(ctx, exe_obj, argv_obj, "runprocess", &argv) ||
+        !parse_process_options(ctx, opts_obj, "runprocess", &options) ||
+        !run_process_native(ctx, &argv, &options, &output, "runprocess",
+                            &process_error)) {
+        free_cstring_array(&argv);
+        free_process_options(ctx, &options);
+        free_process_output(ctx, &output);
+        if (process_error != NULL) {
+            fe_error(ctx, process_error);
+        }
+        return fe_nil(ctx);
+    }
+
+    result = build_process_result(ctx, &output);
+    free_cstring_array(&argv);
+    free_process_options(ctx, &options);
+    free_process_output(ctx, &output);
+    return result;
+}
+
+/* A truncated capture stream is unrecoverable, so an overflowing child is
+   killed right away instead of at processwait. */
+static void check_process_overflow(fe_Context *ctx, FexProcess *proc,
+                                   const char *func_name) {
+    char msg[96];
+
+    if (proc->stdout_overflow) {
+        release_process_resources(ctx, proc);
+        snprintf(msg, sizeof(msg), "%s stdout: file too large", func_name);
+        fe_error(ctx, msg);
+        return;
+    }
+    if (proc->stderr_overflow) {
+        release_process_resources(ctx, proc);
+        snprintf(msg, sizeof(msg), "%s stderr: file too large", func_name);
+        fe_error(ctx, msg);
+    }
+}
+
+static fe_Object* builtin_process_start(fe_Context *ctx, fe_Object *args) {
+    fe_Object *exe_obj;
+    fe_Object *argv_obj = fe_nil(ctx);
+    fe_Object *opts_obj = fe_nil(ctx);
+    CStringArray argv;
+    ProcessOptions options;
+    FexProcess *proc;
+
+    memset(&argv, 0, sizeof(argv));
+    argv.ctx = ctx;
+    memset(&options, 0, sizeof(options));
+    options.env.ctx = ctx;
+
+    FEX_CHECK_ARGS(ctx, args, 1, "processstart");
+    exe_obj = fe_nextarg(ctx, &args);
+    if (!fe_isnil(ctx, args)) {
+        argv_obj = fe_nextarg(ctx, &args);
+    }
+    if (!fe_isnil(ctx, args)) {
+        opts_obj = fe_nextarg(ctx, &args);
+    }
+    if (!fe_isnil(ctx, args)) {
+        fe_error(ctx, "processstart: too many arguments");
+        return fe_nil(ctx);
+    }
+
+    if (!collect_process_argv(ctx, exe_obj, argv_obj, "processstart", &argv) ||
+        !parse_process_options(ctx, opts_obj, "processstart", &options)) {
+        free_cstring_array(&argv);
+        free_process_options(ctx, &options);
+        return fe_nil(ctx);
+    }
+
+    proc = start_process_async(ctx, &argv, &options, "processstart");
+    free_cstring_array(&argv);
+    free_process_options(ctx, &options);
+    if (!proc) {
+        return fe_nil(ctx);
+    }
+    return fe_ptr(ctx, proc);
+}
+
+static fe_Object* builtin_process_poll(fe_Context *ctx, fe_Object *args) {
+    FexProcess *proc;
+    fe_Object *result;
+
+    FEX_CHECK_ARGS(ctx, args, 1, "processpoll");
+    proc = process_from_obj(ctx, fe_nextarg(ctx, &args), "processpoll");
+    if (!proc || !pump_process(ctx, proc, "processpoll")) {
+        return fe_nil(ctx);
+    }
+    check_process_overflow(ctx, proc, "processpoll");
+
+    result = fe_map(ctx);
+    fe_map_set(ctx, result, fe_symbol(ctx, "running"),
+               fe_bool(ctx, !proc->finished));
+    fe_map_set(ctx, result, fe_symbol(ctx, "code"),
+               proc->finished
+                   ? fe_make_number(ctx, (fe_Number)proc->exit_code)
+                   : fe_nil(ctx));
+    return result;
+}
+
+static fe_Object* builtin_process_read(fe_Context *ctx, fe_Object *args) {
+    FexProcess *proc;
+    TextBuffer *buf;
+    int stream_open;
+    int captured;
+    int want_stderr = 0;
+    fe_Object *result;
+
+    FEX_CHECK_ARGS(ctx, args, 1, "processread");
+    proc = process_from_obj(ctx, fe_nextarg(ctx, &args), "processread");
+    if (!proc) {
+        return fe_nil(ctx);
+    }
+    if (!fe_isnil(ctx, args)) {
+        char *stream_name = string_to_cstr(ctx, fe_nextarg(ctx, &args), "processread");
+        if (!stream_name) {
+            return fe_nil(ctx);
+        }
+        if (strcmp(stream_name, "stderr") == 0) {
+            want_stderr = 1;
+        } else if (strcmp(stream_name, "stdout") != 0) {
+            builtin_free(ctx, stream_name);
+            fe_error(ctx, "processread: stream must be \"stdout\" or \"stderr\"");
+            return fe_nil(ctx);
+        }
+        builtin_free(ctx, stream_name);
+    }
+
+    if (!pump_process(ctx, proc, "processread")) {
+        return fe_nil(ctx);
+    }
+    check_process_overflow(ctx, proc, "processread");
+
+    captured = want_stderr ? proc->stderr_captured : proc->stdout_captured;
+    stream_open = want_stderr ? proc->stderr_open : proc->stdout_open;
+    buf = want_stderr ? &proc->stderr_buf : &proc->stdout_buf;
+    if (!captured || (!stream_open && buf->len == 0)) {
+        return fe_nil(ctx);
+    }
+
+    result = fe_bytes(ctx,
+                      buf->data ? (const unsigned char*)buf->data
+                                : (const unsigned char*)"",
+                      buf->len);
+    buf->len = 0;
+    return result;
+}
+
+static fe_Object* builtin_process_wait(fe_Context *ctx, fe_Object *args) {
+    FexProcess *proc;
+    ProcessOutput output;
+    fe_Object *result;
+    const char *abort_error;
+
+    FEX_CHECK_ARGS(ctx, args, 1, "processwait");
+    proc = process_from_obj(ctx, fe_nextarg(ctx, &args), "processwait");
+    if (!proc) {
         return fe_nil(ctx);
     }
 
-    value = getenv(name);
-    builtin_free(ctx, name);
-    if (!value) {
-        return fe_nil(ctx);
-    }
+    for (;;) {
+        abort_error = fe_poll_abort(ctx);
+        if (abort_error != NULL) {
+            release_process_resources(ctx, proc);
+            fe_error(ctx, abort_error);
+            return fe_nil(ctx);
+        }
+        if (!pump_process(ctx, proc, "processwait")) {
+            return fe_nil(ctx);
+        }
+        check_process_overflow(ctx, proc, "processwait");
+        if (proc->finished && !proc->stdin_open &&
+            !proc->stdout_open && !proc->stderr_open) {
+            break;
+        }
+#ifdef _WIN32
+        Sleep(10);
+#else
+        {
+            struct timeval sleep_timeout;
+
+            sleep_timeout.tv_sec = 0;
+            sleep_timeout.tv_usec = 10000;
+            select(0, NULL, NULL, NULL, &sleep_timeout);
+        }
+#endif
+    }
+
+    memset(&output, 0, sizeof(output));
+    output.exit_code = proc->exit_code;
+    output.stdout_captured = proc->stdout_captured;
+    output.stdout_data = (unsigned char*)proc->stdout_buf.data;
+    output.stdout_len = proc->stdout_buf.len;
+    proc->stdout_buf.data = NULL;
+    proc->stdout_buf.len = 0;
+    proc->stdout_buf.cap = 0;
+    output.stderr_captured = proc->stderr_captured;
+    output.stderr_data = (unsigned char*)proc->stderr_buf.data;
+    output.stderr_len = proc->stderr_buf.len;
+    proc->stderr_buf.data = NULL;
+    proc->stderr_buf.len = 0;
+    proc->stderr_buf.cap = 0;
+    release_process_resources(ctx, proc);
+
+    result = build_process_result(ctx, &output);
+    free_process_output(ctx, &output);
+    return result;
+}
+
+/*
+================================================================================
+|                             TYPE FUNCTIONS                                  |
+================================================================================
+*/
+
+static fe_Object* builtin_type_of(fe_Context *ctx, fe_Object *args) {
+    FEX_CHECK_ARGS(ctx, args, 1, "typeof");
+    fe_Object *obj = fe_nextarg(ctx, &args);
+    int type = fe_type(ctx, obj);
+
+    const char *type_name;
+    switch (type) {
+        case FE_TNIL: type_name = "nil"; break;
+        case FE_TNUMBER: type_name = "number"; break;
+        case FE_TSTRING: type_name = "string"; break;
+        case FE_TBYTES: type_name = "bytes"; break;
+        case FE_TSYMBOL: type_name = "symbol"; break;
+        case FE_TPAIR: type_name = "pair"; break;
+        case FE_TFUNC: type_name = "function"; break;
+        case FE_TMACRO: type_name = "macro"; break;
+        case FE_TCFUNC: type_name = "cfunction"; break;
+        case FE_TPTR: type_name = "pointer"; break;
+        case FE_TMAP: type_name = "map"; break;
+        case FE_TARRAY: type_name = "array"; break;
+        case FE_TBOOLEAN: type_name = "boolean"; break;
+        default: type_name = "unknown"; break;
+    }
+
+    return fe_string(ctx, type_name, strlen(type_name));
+}
+
+static fe_Object* builtin_to_string(fe_Context *ctx, fe_Object *args) {
+    FEX_CHECK_ARGS(ctx, args, 1, "tostring");
+    fe_Object *obj = fe_nextarg(ctx, &args);
+
+    char buffer[1024];
+    int len = fe_tostring(ctx, obj, buffer, sizeof(buffer));
+
+    return fe_string(ctx, buffer, len);
+}
+
+static fe_Object* builtin_to_number(fe_Context *ctx, fe_Object *args) {
+    FEX_CHECK_ARGS(ctx, args, 1, "tonumber");
+    fe_Object *obj = fe_nextarg(ctx, &args);
+
+    if (fe_type(ctx, obj) == FE_TNUMBER) {
+        return obj;
+    }
+
+    if (fe_type(ctx, obj) == FE_TSTRING) {
+        size_t len;
+        char *buffer = string_to_buffer(ctx, obj, "tonumber", &len);
+        char *endptr;
+        double value;
+
+        if (!buffer) {
+            return fe_nil(ctx);
+        }
+        if (len > 0 && memchr(buffer, '\0', len) != NULL) {
+            builtin_free(ctx, buffer);
+            fe_error(ctx, "tonumber: invalid number format");
+            return fe_nil(ctx);
+        }
+
+        value = strtod(buffer, &endptr);
+
+        if (endptr != buffer + len) {
+            builtin_free(ctx, buffer);
+            fe_error(ctx, "tonumber: invalid number format");
+            return fe_nil(ctx);
+        }
+
+        builtin_free(ctx, buffer);
+        return fe_make_number(ctx, value);
+    }
+
+    fe_error(ctx, "tonumber: cannot convert to number");
+    return fe_nil(ctx);
+}
+
+static fe_Object* builtin_is_nil(fe_Context *ctx, fe_Object *args) {
+    FEX_CHECK_ARGS(ctx, args, 1, "isnil");
+    fe_Object *obj = fe_nextarg(ctx, &args);
+    return fe_bool(ctx, fe_isnil(ctx, obj));
+}
+
+static fe_Object* builtin_is_number(fe_Context *ctx, fe_Object *args) {
+    FEX_CHECK_ARGS(ctx, args, 1, "isnumber");
+    fe_Object *obj = fe_nextarg(ctx, &args);
+    return fe_bool(ctx, fe_type(ctx, obj) == FE_TNUMBER || FE_IS_FIXNUM(obj));
+}
+
+static fe_Object* builtin_is_string(fe_Context *ctx, fe_Object *args) {
+    FEX_CHECK_ARGS(ctx, args, 1, "isstring");
+    fe_Object *obj = fe_nextarg(ctx, &args);
+    return fe_bool(ctx, fe_type(ctx, obj) == FE_TSTRING);
+}
 
-    result = fe_string(ctx, value, strlen(value));
-    return result;
+static fe_Object* builtin_is_bytes(fe_Context *ctx, fe_Object *args) {
+    FEX_CHECK_ARGS(ctx, args, 1, "isbytes");
+    return fe_bool(ctx, fe_type(ctx, fe_nextarg(ctx, &args)) == FE_TBYTES);
 }
 
-static fe_Object* builtin_time(fe_Context *ctx, fe_Object *args) {
-    (void)args; /* Unused */
-    time_t current_time = time(NULL);
-    return fe_make_number(ctx, (fe_Number)current_time);
+static fe_Object* builtin_is_list(fe_Context *ctx, fe_Object *args) {
+    FEX_CHECK_ARGS(ctx, args, 1, "islist");
+    fe_Object *obj = fe_nextarg(ctx, &args);
+    return fe_bool(ctx, fe_type(ctx, obj) == FE_TPAIR || fe_isnil(ctx, obj));
 }
 
-static fe_Object* builtin_exit(fe_Context *ctx, fe_Object *args) {
-    int code = 0;
-    if (!fe_isnil(ctx, args)) {
-        fe_Object *code_obj = fe_nextarg(ctx, &args);
-        code = (int)fe_tonumber(ctx, code_obj);
-    }
-    exit(code);
-    return fe_nil(ctx); /* Never reached */
+static fe_Object* builtin_is_map(fe_Context *ctx, fe_Object *args) {
+    FEX_CHECK_ARGS(ctx, args, 1, "ismap");
+    return fe_bool(ctx, fe_type(ctx, fe_nextarg(ctx, &args)) == FE_TMAP);
 }
 
-static fe_Object* builtin_system(fe_Context *ctx, fe_Object *args) {
-    fe_Object *command_obj;
-    char *command;
-    CStringArray argv;
-    ProcessOptions options;
-    ProcessOutput output;
-    fe_Object *result;
-    const char *process_error = NULL;
+static fe_Object* builtin_is_array(fe_Context *ctx, fe_Object *args) {
+    FEX_CHECK_ARGS(ctx, args, 1, "isarray");
+    return fe_bool(ctx, fe_type(ctx, fe_nextarg(ctx, &args)) == FE_TARRAY);
+}
 
-    memset(&argv, 0, sizeof(argv));
-    argv.ctx = ctx;
-    memset(&options, 0, sizeof(options));
-    options.env.ctx = ctx;
-    memset(&output, 0, sizeof(output));
+/*
+================================================================================
+|                             WORKER CONTEXTS                                 |
+================================================================================
+*/
 
-    FEX_CHECK_ARGS(ctx, args, 1, "system");
-    command_obj = fe_nextarg(ctx, &args);
-    command = string_to_cstr(ctx, command_obj, "system");
+/*
+** Script-level multicore support: spawn(source) runs a script on a pool
+** thread inside its own fe_Context, and send/receive move values between
+** the two arenas by copy.  Values are serialized into a flat byte message
+** under the sender's context and rebuilt under the receiver's, so no
+** fe_Object ever crosses a thread or arena boundary (see doc/capi.md
+** "Threading and Re-entrancy").  Supported payloads: nil, booleans,
+** numbers, strings, bytes, proper lists, and maps of those.
+*/
 
-    if (!command) {
-        return fe_nil(ctx);
+#ifdef _WIN32
+typedef CRITICAL_SECTION FexWorkerMutex;
+typedef CONDITION_VARIABLE FexWorkerCond;
+typedef HANDLE FexWorkerThread;
+#else
+typedef pthread_mutex_t FexWorkerMutex;
+typedef pthread_cond_t FexWorkerCond;
+typedef pthread_t FexWorkerThread;
+#endif
+
+#define FEX_WORKER_ARENA_DEFAULT (4u * 1024u * 1024u)
+#define FEX_WORKER_ARENA_MIN (64u * 1024u)
+#define FEX_WORKER_MAX_DEPTH 64
+
+typedef struct FexWorkerMsg {
+    struct FexWorkerMsg *next;
+    size_t len;
+    unsigned char *data;
+} FexWorkerMsg;
+
+typedef struct {
+    FexWorkerMsg *head;
+    FexWorkerMsg *tail;
+} FexWorkerQueue;
+
+typedef struct FexWorker {
+    int id;
+    FexWorkerThread thread;
+    FexWorkerMutex lock;
+    FexWorkerCond inbox_ready;   /* signalled for the worker thread */
+    FexWorkerCond outbox_ready;  /* signalled for the owning thread */
+    FexWorkerQueue inbox;        /* owner -> worker */
+    FexWorkerQueue outbox;       /* worker -> owner */
+    int done;
+    int failed;
+    char error_message[512];
+    FexWorkerMsg *result;        /* serialized final value, when possible */
+    char *source;
+    size_t arena_size;
+    fe_Context *owner;
+    struct FexWorker *next;
+} FexWorker;
+
+/* Registry of live workers, keyed by fixnum ids handed to scripts.  A
+** worker struct is freed only by workerjoin on the owning thread; the
+** worker thread itself never touches the registry. */
+static FexWorker *g_worker_registry = NULL;
+static int g_worker_next_id = 1;
+#ifdef _WIN32
+static SRWLOCK g_worker_registry_lock = SRWLOCK_INIT;
+static void worker_registry_lock(void) { AcquireSRWLockExclusive(&g_worker_registry_lock); }
+static void worker_registry_unlock(void) { ReleaseSRWLockExclusive(&g_worker_registry_lock); }
+#else
+static pthread_mutex_t g_worker_registry_lock = PTHREAD_MUTEX_INITIALIZER;
+static void worker_registry_lock(void) { pthread_mutex_lock(&g_worker_registry_lock); }
+static void worker_registry_unlock(void) { pthread_mutex_unlock(&g_worker_registry_lock); }
+#endif
+
+/* Set on worker threads so the channel builtins rebound inside a worker
+** context can find their own endpoint. */
+static FEX_THREAD_LOCAL FexWorker *g_worker_self = NULL;
+
+static void worker_mutex_init(FexWorkerMutex *m) {
+#ifdef _WIN32
+    InitializeCriticalSection(m);
+#else
+    pthread_mutex_init(m, NULL);
+#endif
+}
+
+static void worker_mutex_destroy(FexWorkerMutex *m) {
+#ifdef _WIN32
+    DeleteCriticalSection(m);
+#else
+    pthread_mutex_destroy(m);
+#endif
+}
+
+static void worker_mutex_lock(FexWorkerMutex *m) {
+#ifdef _WIN32
+    EnterCriticalSection(m);
+#else
+    pthread_mutex_lock(m);
+#endif
+}
+
+static void worker_mutex_unlock(FexWorkerMutex *m) {
+#ifdef _WIN32
+    LeaveCriticalSection(m);
+#else
+    pthread_mutex_unlock(m);
+#endif
+}
+
+static void worker_cond_init(FexWorkerCond *c) {
+#ifdef _WIN32
+    InitializeConditionVariable(c);
+#else
+    pthread_cond_init(c, NULL);
+#endif
+}
+
+static void worker_cond_destroy(FexWorkerCond *c) {
+#ifdef _WIN32
+    (void)c; /* Windows condition variables need no teardown */
+#else
+    pthread_cond_destroy(c);
+#endif
+}
+
+static void worker_cond_broadcast(FexWorkerCond *c) {
+#ifdef _WIN32
+    WakeAllConditionVariable(c);
+#else
+    pthread_cond_broadcast(c);
+#endif
+}
+
+static void worker_cond_wait(FexWorkerCond *c, FexWorkerMutex *m) {
+#ifdef _WIN32
+    SleepConditionVariableCS(c, m, INFINITE);
+#else
+    pthread_cond_wait(c, m);
+#endif
+}
+
+/* Returns 0 when the wait timed out before being signalled. */
+static int worker_cond_timedwait(FexWorkerCond *c, FexWorkerMutex *m, long ms) {
+#ifdef _WIN32
+    return SleepConditionVariableCS(c, m, (DWORD)ms) != 0;
+#else
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += ms / 1000;
+    deadline.tv_nsec += (ms % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec += 1;
+        deadline.tv_nsec -= 1000000000L;
+    }
+    return pthread_cond_timedwait(c, m, &deadline) == 0;
+#endif
+}
+
+/* --- Message serialization --- */
+
+enum {
+    FEX_WMSG_NIL,
+    FEX_WMSG_FALSE,
+    FEX_WMSG_TRUE,
+    FEX_WMSG_FIXNUM,
+    FEX_WMSG_NUMBER,
+    FEX_WMSG_STRING,
+    FEX_WMSG_BYTES,
+    FEX_WMSG_LIST,
+    FEX_WMSG_MAP
+};
+
+typedef struct {
+    unsigned char *data;
+    size_t len;
+    size_t cap;
+} WorkerMsgBuffer;
+
+static int worker_msg_reserve(WorkerMsgBuffer *buf, size_t extra) {
+    unsigned char *grown;
+    size_t cap = buf->cap ? buf->cap : 64;
+    while (cap < buf->len + extra) {
+        cap *= 2;
+    }
+    if (cap == buf->cap) {
+        return 1;
+    }
+    grown = (unsigned char*)realloc(buf->data, cap);
+    if (!grown) {
+        return 0;
     }
+    buf->data = grown;
+    buf->cap = cap;
+    return 1;
+}
 
-    if (!build_shell_process_argv(ctx, command, "system", &argv)) {
-        builtin_free(ctx, command);
-        free_cstring_array(&argv);
-        return fe_nil(ctx);
+static int worker_msg_write(WorkerMsgBuffer *buf, const void *data, size_t len) {
+    if (!worker_msg_reserve(buf, len)) {
+        return 0;
     }
-    builtin_free(ctx, command);
-    options.stdout_mode = PROCESS_STREAM_INHERIT;
-    options.stderr_mode = PROCESS_STREAM_INHERIT;
-    if (!run_process_native(ctx, &argv, &options, &output, "system",
-                            &process_error)) {
-        free_cstring_array(&argv);
-        free_process_output(ctx, &output);
-        if (process_error != NULL) {
-            fe_error(ctx, process_error);
+    memcpy(buf->data + buf->len, data, len);
+    buf->len += len;
+    return 1;
+}
+
+static int worker_msg_write_u8(WorkerMsgBuffer *buf, unsigned char value) {
+    return worker_msg_write(buf, &value, 1);
+}
+
+static int worker_msg_write_u64(WorkerMsgBuffer *buf, unsigned long long value) {
+    return worker_msg_write(buf, &value, sizeof(value));
+}
+
+/* Serializes obj into buf.  On failure, *reason names the problem (a
+** static string); the caller raises the fe_error so serialization stays
+** usable off the script path (worker results). */
+static int worker_serialize_value(fe_Context *ctx, fe_Object *obj,
+                                  WorkerMsgBuffer *buf, int depth,
+                                  const char **reason) {
+    int type;
+
+    if (depth > FEX_WORKER_MAX_DEPTH) {
+        *reason = "value nests too deeply";
+        return 0;
+    }
+    if (FE_IS_FIXNUM(obj)) {
+        long long value = (long long)FE_UNBOX_FIXNUM(obj);
+        if (worker_msg_write_u8(buf, FEX_WMSG_FIXNUM) &&
+            worker_msg_write(buf, &value, sizeof(value))) {
+            return 1;
         }
-        return fe_nil(ctx);
+        *reason = "out of memory";
+        return 0;
+    }
+    if (FE_IS_BOOLEAN(obj)) {
+        if (worker_msg_write_u8(buf, FE_IS_TRUE(obj) ? FEX_WMSG_TRUE
+                                                     : FEX_WMSG_FALSE)) {
+            return 1;
+        }
+        *reason = "out of memory";
+        return 0;
+    }
+    if (fe_isnil(ctx, obj)) {
+        if (worker_msg_write_u8(buf, FEX_WMSG_NIL)) {
+            return 1;
+        }
+        *reason = "out of memory";
+        return 0;
     }
 
-    result = fe_make_number(ctx, (fe_Number)output.exit_code);
-    free_cstring_array(&argv);
-    free_process_output(ctx, &output);
-    return result;
+    type = fe_type(ctx, obj);
+    switch (type) {
+    case FE_TNUMBER: {
+        double value = (double)fe_tonumber(ctx, obj);
+        if (worker_msg_write_u8(buf, FEX_WMSG_NUMBER) &&
+            worker_msg_write(buf, &value, sizeof(value))) {
+            return 1;
+        }
+        *reason = "out of memory";
+        return 0;
+    }
+    case FE_TSTRING: {
+        size_t len = fe_strlen(ctx, obj);
+        if (len + 1 > (size_t)INT_MAX) {
+            *reason = "string too large";
+            return 0;
+        }
+        if (!worker_msg_write_u8(buf, FEX_WMSG_STRING) ||
+            !worker_msg_write_u64(buf, (unsigned long long)len) ||
+            !worker_msg_reserve(buf, len + 1)) {
+            *reason = "out of memory";
+            return 0;
+        }
+        fe_tostring(ctx, obj, (char*)buf->data + buf->len, (int)(len + 1));
+        buf->len += len;
+        return 1;
+    }
+    case FE_TBYTES: {
+        size_t len = fe_byteslen(ctx, obj);
+        if (!worker_msg_write_u8(buf, FEX_WMSG_BYTES) ||
+            !worker_msg_write_u64(buf, (unsigned long long)len) ||
+            !worker_msg_reserve(buf, len)) {
+            *reason = "out of memory";
+            return 0;
+        }
+        if (len > 0) {
+            fe_bytescopy(ctx, obj, 0, buf->data + buf->len, len);
+            buf->len += len;
+        }
+        return 1;
+    }
+    case FE_TPAIR: {
+        unsigned long long count = 0;
+        fe_Object *it;
+        for (it = obj; !fe_isnil(ctx, it); it = fe_cdr(ctx, it)) {
+            if (fe_type(ctx, it) != FE_TPAIR) {
+                *reason = "improper lists are not supported";
+                return 0;
+            }
+            count++;
+        }
+        if (!worker_msg_write_u8(buf, FEX_WMSG_LIST) ||
+            !worker_msg_write_u64(buf, count)) {
+            *reason = "out of memory";
+            return 0;
+        }
+        for (it = obj; !fe_isnil(ctx, it); it = fe_cdr(ctx, it)) {
+            if (!worker_serialize_value(ctx, fe_car(ctx, it), buf,
+                                        depth + 1, reason)) {
+                return 0;
+            }
+        }
+        return 1;
+    }
+    case FE_TMAP: {
+        int gc_save = fe_savegc(ctx);
+        fe_Object *keys = fe_map_keys(ctx, obj);
+        fe_Object *it;
+        if (!worker_msg_write_u8(buf, FEX_WMSG_MAP) ||
+            !worker_msg_write_u64(buf, (unsigned long long)fe_map_count(ctx, obj))) {
+            fe_restoregc(ctx, gc_save);
+            *reason = "out of memory";
+            return 0;
+        }
+        for (it = keys; !fe_isnil(ctx, it); it = fe_cdr(ctx, it)) {
+            fe_Object *key = fe_car(ctx, it);
+            if (!worker_serialize_value(ctx, key, buf, depth + 1, reason) ||
+                !worker_serialize_value(ctx, fe_map_get(ctx, obj, key), buf,
+                                        depth + 1, reason)) {
+                fe_restoregc(ctx, gc_save);
+                return 0;
+            }
+        }
+        fe_restoregc(ctx, gc_save);
+        return 1;
+    }
+    default:
+        *reason = "unsupported value type";
+        return 0;
+    }
 }
 
-static fe_Object* builtin_run_command(fe_Context *ctx, fe_Object *args) {
-    fe_Object *command_obj;
-    char *command;
-    char *merged_command;
-    CStringArray argv;
-    ProcessOptions options;
-    ProcessOutput output;
-    fe_Object *result;
-    const char *process_error = NULL;
+static int worker_msg_read(const unsigned char *data, size_t len,
+                           size_t *off, void *dst, size_t size) {
+    if (len - *off < size) {
+        return 0;
+    }
+    memcpy(dst, data + *off, size);
+    *off += size;
+    return 1;
+}
 
-    memset(&argv, 0, sizeof(argv));
-    argv.ctx = ctx;
-    memset(&options, 0, sizeof(options));
-    options.env.ctx = ctx;
-    memset(&output, 0, sizeof(output));
+/* Rebuilds a serialized value inside ctx.  Follows the json_parse_*
+** rooting discipline: freshly allocated containers stay rooted through
+** the GC stack while their elements are filled in. */
+static fe_Object* worker_deserialize_value(fe_Context *ctx,
+                                           const unsigned char *data,
+                                           size_t len, size_t *off) {
+    unsigned char tag;
 
-    FEX_CHECK_ARGS(ctx, args, 1, "runcommand");
-    command_obj = fe_nextarg(ctx, &args);
-    command = string_to_cstr(ctx, command_obj, "runcommand");
-    if (!command) {
+    if (!worker_msg_read(data, len, off, &tag, 1)) {
+        fe_error(ctx, "receive: truncated worker message");
+        return fe_nil(ctx);
+    }
+    switch (tag) {
+    case FEX_WMSG_NIL:
         return fe_nil(ctx);
+    case FEX_WMSG_FALSE:
+        return fe_bool(ctx, 0);
+    case FEX_WMSG_TRUE:
+        return fe_bool(ctx, 1);
+    case FEX_WMSG_FIXNUM: {
+        long long value;
+        if (!worker_msg_read(data, len, off, &value, sizeof(value))) {
+            break;
+        }
+        return fe_make_number(ctx, (fe_Number)value);
+    }
+    case FEX_WMSG_NUMBER: {
+        double value;
+        if (!worker_msg_read(data, len, off, &value, sizeof(value))) {
+            break;
+        }
+        return fe_make_number(ctx, (fe_Number)value);
+    }
+    case FEX_WMSG_STRING:
+    case FEX_WMSG_BYTES: {
+        unsigned long long payload_len;
+        fe_Object *obj;
+        if (!worker_msg_read(data, len, off, &payload_len, sizeof(payload_len)) ||
+            len - *off < (size_t)payload_len) {
+            break;
+        }
+        if (tag == FEX_WMSG_STRING) {
+            obj = fe_string(ctx, (const char*)data + *off, (size_t)payload_len);
+        } else {
+            obj = fe_bytes(ctx, data + *off, (size_t)payload_len);
+        }
+        *off += (size_t)payload_len;
+        return obj;
+    }
+    case FEX_WMSG_LIST: {
+        unsigned long long count;
+        fe_Object *result;
+        fe_Object **tail;
+        int gc_save = fe_savegc(ctx);
+        if (!worker_msg_read(data, len, off, &count, sizeof(count))) {
+            break;
+        }
+        result = fe_nil(ctx);
+        tail = &result;
+        while (count-- > 0) {
+            fe_Object *item = worker_deserialize_value(ctx, data, len, off);
+            *tail = fe_cons(ctx, item, fe_nil(ctx));
+            tail = fe_cdr_ptr(ctx, *tail);
+            fe_restoregc(ctx, gc_save);
+            fe_pushgc(ctx, result);
+        }
+        return result;
     }
-
-    merged_command = build_merged_command(ctx, command, "runcommand");
-    builtin_free(ctx, command);
-    if (!merged_command) {
-        return fe_nil(ctx);
+    case FEX_WMSG_MAP: {
+        unsigned long long count;
+        fe_Object *map = fe_map(ctx);
+        int gc_save = fe_savegc(ctx);
+        if (!worker_msg_read(data, len, off, &count, sizeof(count))) {
+            break;
+        }
+        while (count-- > 0) {
+            fe_Object *key = worker_deserialize_value(ctx, data, len, off);
+            fe_Object *value;
+            fe_pushgc(ctx, key);
+            value = worker_deserialize_value(ctx, data, len, off);
+            fe_map_set(ctx, map, key, value);
+            fe_restoregc(ctx, gc_save);
+        }
+        return map;
+    }
+    default:
+        break;
     }
+    fe_error(ctx, "receive: truncated worker message");
+    return fe_nil(ctx);
+}
 
-    if (!build_shell_process_argv(ctx, merged_command, "runcommand", &argv)) {
-        builtin_free(ctx, merged_command);
-        free_cstring_array(&argv);
-        return fe_nil(ctx);
+/* --- Queues and worker lifecycle --- */
+
+static void worker_queue_push(FexWorkerQueue *queue, FexWorkerMsg *msg) {
+    msg->next = NULL;
+    if (queue->tail) {
+        queue->tail->next = msg;
+    } else {
+        queue->head = msg;
     }
-    builtin_free(ctx, merged_command);
-    options.stdout_mode = PROCESS_STREAM_CAPTURE;
-    options.stderr_mode = PROCESS_STREAM_DISCARD;
-    options.max_stdout = FEX_COMMAND_OUTPUT_MAX_BYTES;
-    if (!run_process_native(ctx, &argv, &options, &output, "runcommand",
-                            &process_error)) {
-        free_cstring_array(&argv);
-        free_process_output(ctx, &output);
-        if (process_error != NULL) {
-            fe_error(ctx, process_error);
+    queue->tail = msg;
+}
+
+static FexWorkerMsg* worker_queue_pop(FexWorkerQueue *queue) {
+    FexWorkerMsg *msg = queue->head;
+    if (msg) {
+        queue->head = msg->next;
+        if (!queue->head) {
+            queue->tail = NULL;
         }
-        return fe_nil(ctx);
     }
+    return msg;
+}
 
-    result = fe_map(ctx);
-    fe_map_set(ctx, result, fe_symbol(ctx, "code"),
-               fe_make_number(ctx, (fe_Number)output.exit_code));
-    fe_map_set(ctx, result, fe_symbol(ctx, "ok"), fe_bool(ctx, output.exit_code == 0));
-    fe_map_set(ctx, result, fe_symbol(ctx, "output"),
-               fe_bytes(ctx,
-                        output.stdout_data ? output.stdout_data : (const unsigned char*)"",
-                        output.stdout_len));
-    free_cstring_array(&argv);
-    free_process_output(ctx, &output);
-    return result;
+static void worker_msg_free(FexWorkerMsg *msg) {
+    if (msg) {
+        free(msg->data);
+        free(msg);
+    }
 }
 
-static fe_Object* builtin_run_process(fe_Context *ctx, fe_Object *args) {
-    fe_Object *exe_obj;
-    fe_Object *argv_obj = fe_nil(ctx);
-    fe_Object *opts_obj = fe_nil(ctx);
-    CStringArray argv;
-    ProcessOptions options;
-    ProcessOutput output;
-    fe_Object *result;
-    const char *process_error = NULL;
+static FexWorkerMsg* worker_msg_from_buffer(WorkerMsgBuffer *buf) {
+    FexWorkerMsg *msg = (FexWorkerMsg*)malloc(sizeof(*msg));
+    if (!msg) {
+        free(buf->data);
+        return NULL;
+    }
+    msg->next = NULL;
+    msg->len = buf->len;
+    msg->data = buf->data;
+    return msg;
+}
+
+/* Serializes value into a heap message, raising func_name-prefixed errors
+** in ctx on failure. */
+static FexWorkerMsg* worker_msg_from_value(fe_Context *ctx, fe_Object *value,
+                                           const char *func_name) {
+    WorkerMsgBuffer buf = {NULL, 0, 0};
+    FexWorkerMsg *msg;
+    const char *reason = "out of memory";
+    char errmsg[160];
+
+    if (!worker_serialize_value(ctx, value, &buf, 0, &reason)) {
+        free(buf.data);
+        snprintf(errmsg, sizeof(errmsg), "%s: %s", func_name, reason);
+        fe_error(ctx, errmsg);
+        return NULL;
+    }
+    msg = worker_msg_from_buffer(&buf);
+    if (!msg) {
+        snprintf(errmsg, sizeof(errmsg), "%s: out of memory", func_name);
+        fe_error(ctx, errmsg);
+        return NULL;
+    }
+    return msg;
+}
 
-    memset(&argv, 0, sizeof(argv));
-    argv.ctx = ctx;
-    memset(&options, 0, sizeof(options));
-    options.env.ctx = ctx;
-    memset(&output, 0, sizeof(output));
+static FexWorker* worker_find(fe_Context *ctx, int id) {
+    FexWorker *worker;
+    worker_registry_lock();
+    for (worker = g_worker_registry; worker; worker = worker->next) {
+        if (worker->id == id) {
+            break;
+        }
+    }
+    worker_registry_unlock();
+    if (worker && worker->owner != ctx) {
+        return NULL; /* handles are private to the spawning context */
+    }
+    return worker;
+}
 
-    FEX_CHECK_ARGS(ctx, args, 1, "runprocess");
-    exe_obj = fe_nextarg(ctx, &args);
-    if (!fe_isnil(ctx, args)) {
-        argv_obj = fe_nextarg(ctx, &args);
+static void worker_destroy(FexWorker *worker) {
+    FexWorkerMsg *msg;
+    while ((msg = worker_queue_pop(&worker->inbox)) != NULL) {
+        worker_msg_free(msg);
     }
-    if (!fe_isnil(ctx, args)) {
-        opts_obj = fe_nextarg(ctx, &args);
+    while ((msg = worker_queue_pop(&worker->outbox)) != NULL) {
+        worker_msg_free(msg);
     }
-    if (!fe_isnil(ctx, args)) {
-        fe_error(ctx, "runprocess: too many arguments");
-        return fe_nil(ctx);
+    worker_msg_free(worker->result);
+    worker_cond_destroy(&worker->inbox_ready);
+    worker_cond_destroy(&worker->outbox_ready);
+    worker_mutex_destroy(&worker->lock);
+    free(worker->source);
+    free(worker);
+}
+
+static fe_Object* builtin_worker_send_self(fe_Context *ctx, fe_Object *args);
+static fe_Object* builtin_worker_receive_self(fe_Context *ctx, fe_Object *args);
+
+#ifdef _WIN32
+static DWORD WINAPI worker_thread_main(void *param)
+#else
+static void* worker_thread_main(void *param)
+#endif
+{
+    FexWorker *worker = (FexWorker*)param;
+    void *arena = malloc(worker->arena_size);
+    fe_Context *ctx = arena ? fe_open(arena, worker->arena_size) : NULL;
+    fe_Object *result = NULL;
+    FexError error;
+    FexStatus status;
+
+    g_worker_self = worker;
+    if (!ctx) {
+        worker_mutex_lock(&worker->lock);
+        worker->failed = 1;
+        snprintf(worker->error_message, sizeof(worker->error_message),
+                 "spawn: could not allocate worker arena");
+        worker->done = 1;
+        worker_cond_broadcast(&worker->outbox_ready);
+        worker_mutex_unlock(&worker->lock);
+        free(arena);
+#ifdef _WIN32
+        return 0;
+#else
+        return NULL;
+#endif
     }
 
-    if (!collect_process_argv(ctx, exe_obj, argv_obj, "runprocess", &argv) ||
-        !parse_process_options(ctx, opts_obj, "runprocess", &options) ||
-        !run_process_native(ctx, &argv, &options, &output, "runprocess",
-                            &process_error)) {
-        free_cstring_array(&argv);
-        free_process_options(ctx, &options);
-        free_process_output(ctx, &output);
-        if (process_error != NULL) {
-            fe_error(ctx, process_error);
+    fe_set_arena_growable(ctx, 1);
+    fex_init_with_builtins(ctx, FEX_CONFIG_NONE, FEX_BUILTINS_ALL);
+    /* Rebind the channel builtins to the worker-side endpoints: inside a
+       worker, send/receive take no handle and talk to the owner. */
+    fe_set(ctx, fe_symbol(ctx, "send"), fe_cfunc(ctx, builtin_worker_send_self));
+    fe_set(ctx, fe_symbol(ctx, "receive"), fe_cfunc(ctx, builtin_worker_receive_self));
+
+    status = fex_try_do_string(ctx, worker->source, &result, &error);
+
+    worker_mutex_lock(&worker->lock);
+    if (status != FEX_STATUS_OK) {
+        worker->failed = 1;
+        snprintf(worker->error_message, sizeof(worker->error_message),
+                 "%s", error.message);
+    } else if (result && !fe_isnil(ctx, result)) {
+        WorkerMsgBuffer buf = {NULL, 0, 0};
+        const char *reason;
+        if (worker_serialize_value(ctx, result, &buf, 0, &reason)) {
+            worker->result = worker_msg_from_buffer(&buf);
+        } else {
+            free(buf.data); /* unserializable results join as nil */
         }
-        return fe_nil(ctx);
     }
+    worker->done = 1;
+    worker_cond_broadcast(&worker->outbox_ready);
+    worker_mutex_unlock(&worker->lock);
 
-    result = build_process_result(ctx, &output);
-    free_cstring_array(&argv);
-    free_process_options(ctx, &options);
-    free_process_output(ctx, &output);
-    return result;
+    fe_close(ctx);
+    free(arena);
+    g_worker_self = NULL;
+#ifdef _WIN32
+    return 0;
+#else
+    return NULL;
+#endif
 }
 
-/*
-================================================================================
-|                             TYPE FUNCTIONS                                  |
-================================================================================
-*/
+static int worker_thread_start(FexWorker *worker) {
+#ifdef _WIN32
+    worker->thread = CreateThread(NULL, 0, worker_thread_main, worker, 0, NULL);
+    return worker->thread != NULL;
+#else
+    return pthread_create(&worker->thread, NULL, worker_thread_main, worker) == 0;
+#endif
+}
 
-static fe_Object* builtin_type_of(fe_Context *ctx, fe_Object *args) {
-    FEX_CHECK_ARGS(ctx, args, 1, "typeof");
-    fe_Object *obj = fe_nextarg(ctx, &args);
-    int type = fe_type(ctx, obj);
+static void worker_thread_join(FexWorker *worker) {
+#ifdef _WIN32
+    WaitForSingleObject(worker->thread, INFINITE);
+    CloseHandle(worker->thread);
+#else
+    pthread_join(worker->thread, NULL);
+#endif
+}
 
-    const char *type_name;
-    switch (type) {
-        case FE_TNIL: type_name = "nil"; break;
-        case FE_TNUMBER: type_name = "number"; break;
-        case FE_TSTRING: type_name = "string"; break;
-        case FE_TBYTES: type_name = "bytes"; break;
-        case FE_TSYMBOL: type_name = "symbol"; break;
-        case FE_TPAIR: type_name = "pair"; break;
-        case FE_TFUNC: type_name = "function"; break;
-        case FE_TMACRO: type_name = "macro"; break;
-        case FE_TCFUNC: type_name = "cfunction"; break;
-        case FE_TPTR: type_name = "pointer"; break;
-        case FE_TMAP: type_name = "map"; break;
-        case FE_TBOOLEAN: type_name = "boolean"; break;
-        default: type_name = "unknown"; break;
+static fe_Object* builtin_spawn(fe_Context *ctx, fe_Object *args) {
+    FexWorker *worker;
+    fe_Object *arena_obj;
+    size_t source_len;
+    char *source;
+    long long arena_size = FEX_WORKER_ARENA_DEFAULT;
+
+    FEX_CHECK_ARGS(ctx, args, 1, "spawn");
+    source = string_to_buffer(ctx, fe_nextarg(ctx, &args), "spawn", &source_len);
+    if (!source) {
+        return fe_nil(ctx);
+    }
+    arena_obj = fe_isnil(ctx, args) ? fe_nil(ctx) : fe_nextarg(ctx, &args);
+    if (!fe_isnil(ctx, arena_obj)) {
+        arena_size = (long long)fe_tonumber(ctx, arena_obj);
+        if (arena_size < (long long)FEX_WORKER_ARENA_MIN) {
+            builtin_free(ctx, source);
+            fe_error(ctx, "spawn: arena size too small");
+            return fe_nil(ctx);
+        }
     }
 
-    return fe_string(ctx, type_name, strlen(type_name));
+    worker = (FexWorker*)calloc(1, sizeof(*worker));
+    if (!worker) {
+        builtin_free(ctx, source);
+        fe_error(ctx, "spawn: out of memory");
+        return fe_nil(ctx);
+    }
+    worker->source = source;
+    worker->arena_size = (size_t)arena_size;
+    worker->owner = ctx;
+    worker_mutex_init(&worker->lock);
+    worker_cond_init(&worker->inbox_ready);
+    worker_cond_init(&worker->outbox_ready);
+
+    worker_registry_lock();
+    worker->id = g_worker_next_id++;
+    worker->next = g_worker_registry;
+    g_worker_registry = worker;
+    worker_registry_unlock();
+
+    if (!worker_thread_start(worker)) {
+        FexWorker **link;
+        worker_registry_lock();
+        for (link = &g_worker_registry; *link; link = &(*link)->next) {
+            if (*link == worker) {
+                *link = worker->next;
+                break;
+            }
+        }
+        worker_registry_unlock();
+        worker_destroy(worker);
+        fe_error(ctx, "spawn: could not start worker thread");
+        return fe_nil(ctx);
+    }
+    return fe_fixnum(worker->id);
 }
 
-static fe_Object* builtin_to_string(fe_Context *ctx, fe_Object *args) {
-    FEX_CHECK_ARGS(ctx, args, 1, "tostring");
-    fe_Object *obj = fe_nextarg(ctx, &args);
+static FexWorker* worker_arg(fe_Context *ctx, fe_Object **args,
+                             const char *func_name) {
+    fe_Object *id_obj = fe_nextarg(ctx, args);
+    FexWorker *worker;
+    char errmsg[128];
 
-    char buffer[1024];
-    int len = fe_tostring(ctx, obj, buffer, sizeof(buffer));
+    if (!FE_IS_FIXNUM(id_obj)) {
+        snprintf(errmsg, sizeof(errmsg), "%s: expected a worker handle", func_name);
+        fe_error(ctx, errmsg);
+        return NULL;
+    }
+    worker = worker_find(ctx, (int)FE_UNBOX_FIXNUM(id_obj));
+    if (!worker) {
+        snprintf(errmsg, sizeof(errmsg), "%s: unknown worker", func_name);
+        fe_error(ctx, errmsg);
+        return NULL;
+    }
+    return worker;
+}
 
-    return fe_string(ctx, buffer, len);
+static long worker_timeout_arg(fe_Context *ctx, fe_Object **args) {
+    fe_Object *timeout_obj;
+    if (fe_isnil(ctx, *args)) {
+        return -1; /* block until a message or worker exit */
+    }
+    timeout_obj = fe_nextarg(ctx, args);
+    return fe_isnil(ctx, timeout_obj) ? -1 : (long)fe_tonumber(ctx, timeout_obj);
 }
 
-static fe_Object* builtin_to_number(fe_Context *ctx, fe_Object *args) {
-    FEX_CHECK_ARGS(ctx, args, 1, "tonumber");
-    fe_Object *obj = fe_nextarg(ctx, &args);
+static fe_Object* builtin_worker_send(fe_Context *ctx, fe_Object *args) {
+    FexWorker *worker;
+    FexWorkerMsg *msg;
 
-    if (fe_type(ctx, obj) == FE_TNUMBER) {
-        return obj;
+    FEX_CHECK_ARGS(ctx, args, 2, "send");
+    worker = worker_arg(ctx, &args, "send");
+    if (!worker) {
+        return fe_nil(ctx);
     }
+    msg = worker_msg_from_value(ctx, fe_nextarg(ctx, &args), "send");
+    if (!msg) {
+        return fe_nil(ctx);
+    }
+    worker_mutex_lock(&worker->lock);
+    if (worker->done) {
+        worker_mutex_unlock(&worker->lock);
+        worker_msg_free(msg);
+        fe_error(ctx, "send: worker has exited");
+        return fe_nil(ctx);
+    }
+    worker_queue_push(&worker->inbox, msg);
+    worker_cond_broadcast(&worker->inbox_ready);
+    worker_mutex_unlock(&worker->lock);
+    return fe_bool(ctx, 1);
+}
 
-    if (fe_type(ctx, obj) == FE_TSTRING) {
-        size_t len;
-        char *buffer = string_to_buffer(ctx, obj, "tonumber", &len);
-        char *endptr;
-        double value;
+/* Shared wait loop: pops the next message from queue, blocking on cond
+** until one arrives, the worker finishes (finished_is_eof), or timeout_ms
+** elapses.  Returns nil on end-of-stream or timeout. */
+static fe_Object* worker_receive_from(fe_Context *ctx, FexWorker *worker,
+                                      FexWorkerQueue *queue, FexWorkerCond *cond,
+                                      int finished_is_eof, long timeout_ms) {
+    FexWorkerMsg *msg;
+    fe_Object *value;
+    size_t off = 0;
 
-        if (!buffer) {
-            return fe_nil(ctx);
+    worker_mutex_lock(&worker->lock);
+    for (;;) {
+        msg = worker_queue_pop(queue);
+        if (msg) {
+            break;
         }
-        if (len > 0 && memchr(buffer, '\0', len) != NULL) {
-            builtin_free(ctx, buffer);
-            fe_error(ctx, "tonumber: invalid number format");
+        if (finished_is_eof && worker->done) {
+            worker_mutex_unlock(&worker->lock);
             return fe_nil(ctx);
         }
-
-        value = strtod(buffer, &endptr);
-
-        if (endptr != buffer + len) {
-            builtin_free(ctx, buffer);
-            fe_error(ctx, "tonumber: invalid number format");
+        if (timeout_ms < 0) {
+            worker_cond_wait(cond, &worker->lock);
+        } else if (!worker_cond_timedwait(cond, &worker->lock, timeout_ms)) {
+            worker_mutex_unlock(&worker->lock);
             return fe_nil(ctx);
         }
-
-        builtin_free(ctx, buffer);
-        return fe_make_number(ctx, value);
     }
+    worker_mutex_unlock(&worker->lock);
 
-    fe_error(ctx, "tonumber: cannot convert to number");
-    return fe_nil(ctx);
+    value = worker_deserialize_value(ctx, msg->data, msg->len, &off);
+    worker_msg_free(msg);
+    return value;
 }
 
-static fe_Object* builtin_is_nil(fe_Context *ctx, fe_Object *args) {
-    FEX_CHECK_ARGS(ctx, args, 1, "isnil");
-    fe_Object *obj = fe_nextarg(ctx, &args);
-    return fe_bool(ctx, fe_isnil(ctx, obj));
-}
+static fe_Object* builtin_worker_receive(fe_Context *ctx, fe_Object *args) {
+    FexWorker *worker;
+    long timeout_ms;
 
-static fe_Object* builtin_is_number(fe_Context *ctx, fe_Object *args) {
-    FEX_CHECK_ARGS(ctx, args, 1, "isnumber");
-    fe_Object *obj = fe_nextarg(ctx, &args);
-    return fe_bool(ctx, fe_type(ctx, obj) == FE_TNUMBER || FE_IS_FIXNUM(obj));
+    FEX_CHECK_ARGS(ctx, args, 1, "receive");
+    worker = worker_arg(ctx, &args, "receive");
+    if (!worker) {
+        return fe_nil(ctx);
+    }
+    timeout_ms = worker_timeout_arg(ctx, &args);
+    return worker_receive_from(ctx, worker, &worker->outbox,
+                               &worker->outbox_ready, 1, timeout_ms);
 }
 
-static fe_Object* builtin_is_string(fe_Context *ctx, fe_Object *args) {
-    FEX_CHECK_ARGS(ctx, args, 1, "isstring");
-    fe_Object *obj = fe_nextarg(ctx, &args);
-    return fe_bool(ctx, fe_type(ctx, obj) == FE_TSTRING);
-}
+static fe_Object* builtin_worker_join(fe_Context *ctx, fe_Object *args) {
+    FexWorker *worker;
+    FexWorker **link;
+    fe_Object *result = fe_nil(ctx);
+    char errmsg[sizeof(((FexWorker*)0)->error_message)];
+    int failed;
 
-static fe_Object* builtin_is_bytes(fe_Context *ctx, fe_Object *args) {
-    FEX_CHECK_ARGS(ctx, args, 1, "isbytes");
-    return fe_bool(ctx, fe_type(ctx, fe_nextarg(ctx, &args)) == FE_TBYTES);
+    FEX_CHECK_ARGS(ctx, args, 1, "workerjoin");
+    worker = worker_arg(ctx, &args, "workerjoin");
+    if (!worker) {
+        return fe_nil(ctx);
+    }
+    worker_thread_join(worker);
+
+    failed = worker->failed;
+    if (failed) {
+        snprintf(errmsg, sizeof(errmsg), "%s", worker->error_message);
+    } else if (worker->result) {
+        size_t off = 0;
+        result = worker_deserialize_value(ctx, worker->result->data,
+                                          worker->result->len, &off);
+    }
+
+    worker_registry_lock();
+    for (link = &g_worker_registry; *link; link = &(*link)->next) {
+        if (*link == worker) {
+            *link = worker->next;
+            break;
+        }
+    }
+    worker_registry_unlock();
+    worker_destroy(worker);
+
+    if (failed) {
+        fe_error(ctx, errmsg);
+        return fe_nil(ctx);
+    }
+    return result;
 }
 
-static fe_Object* builtin_is_list(fe_Context *ctx, fe_Object *args) {
-    FEX_CHECK_ARGS(ctx, args, 1, "islist");
-    fe_Object *obj = fe_nextarg(ctx, &args);
-    return fe_bool(ctx, fe_type(ctx, obj) == FE_TPAIR || fe_isnil(ctx, obj));
+static fe_Object* builtin_worker_send_self(fe_Context *ctx, fe_Object *args) {
+    FexWorker *worker = g_worker_self;
+    FexWorkerMsg *msg;
+
+    FEX_CHECK_ARGS(ctx, args, 1, "send");
+    if (!worker) {
+        fe_error(ctx, "send: not inside a worker");
+        return fe_nil(ctx);
+    }
+    msg = worker_msg_from_value(ctx, fe_nextarg(ctx, &args), "send");
+    if (!msg) {
+        return fe_nil(ctx);
+    }
+    worker_mutex_lock(&worker->lock);
+    worker_queue_push(&worker->outbox, msg);
+    worker_cond_broadcast(&worker->outbox_ready);
+    worker_mutex_unlock(&worker->lock);
+    return fe_bool(ctx, 1);
 }
 
-static fe_Object* builtin_is_map(fe_Context *ctx, fe_Object *args) {
-    FEX_CHECK_ARGS(ctx, args, 1, "ismap");
-    return fe_bool(ctx, fe_type(ctx, fe_nextarg(ctx, &args)) == FE_TMAP);
+static fe_Object* builtin_worker_receive_self(fe_Context *ctx, fe_Object *args) {
+    FexWorker *worker = g_worker_self;
+    long timeout_ms;
+
+    if (!worker) {
+        fe_error(ctx, "receive: not inside a worker");
+        return fe_nil(ctx);
+    }
+    timeout_ms = worker_timeout_arg(ctx, &args);
+    return worker_receive_from(ctx, worker, &worker->inbox,
+                               &worker->inbox_ready, 0, timeout_ms);
 }
 
 /*
@@ -5161,6 +8054,10 @@ static void register_string_functions(fe_Context *ctx) {
     fe_set(ctx, fe_symbol(ctx, "upper"), fe_cfunc(ctx, builtin_string_upper));
     fe_set(ctx, fe_symbol(ctx, "lower"), fe_cfunc(ctx, builtin_string_lower));
     fe_set(ctx, fe_symbol(ctx, "concat"), fe_cfunc(ctx, builtin_string_concat));
+    fe_set(ctx, fe_symbol(ctx, "sbnew"), fe_cfunc(ctx, builtin_sb_new));
+    fe_set(ctx, fe_symbol(ctx, "sbappend"), fe_cfunc(ctx, builtin_sb_append));
+    fe_set(ctx, fe_symbol(ctx, "sbtostring"), fe_cfunc(ctx, builtin_sb_tostring));
+    fe_set(ctx, fe_symbol(ctx, "sbfree"), fe_cfunc(ctx, builtin_sb_free));
     fe_set(ctx, fe_symbol(ctx, "substring"), fe_cfunc(ctx, builtin_string_substring));
     fe_set(ctx, fe_symbol(ctx, "split"), fe_cfunc(ctx, builtin_string_split));
     fe_set(ctx, fe_symbol(ctx, "trim"), fe_cfunc(ctx, builtin_string_trim));
@@ -5177,6 +8074,8 @@ static void register_list_functions(fe_Context *ctx) {
     fe_set(ctx, fe_symbol(ctx, "nth"), fe_cfunc(ctx, builtin_list_nth));
     fe_set(ctx, fe_symbol(ctx, "append"), fe_cfunc(ctx, builtin_list_append));
     fe_set(ctx, fe_symbol(ctx, "reverse"), fe_cfunc(ctx, builtin_list_reverse));
+    fe_set(ctx, fe_symbol(ctx, "sort"), fe_cfunc(ctx, builtin_sort));
+    fe_set(ctx, fe_symbol(ctx, "binarysearch"), fe_cfunc(ctx, builtin_binary_search));
     fe_set(ctx, fe_symbol(ctx, "map"), fe_cfunc(ctx, builtin_map));
     fe_set(ctx, fe_symbol(ctx, "filter"), fe_cfunc(ctx, builtin_filter));
     fe_set(ctx, fe_symbol(ctx, "fold"), fe_cfunc(ctx, builtin_fold));
@@ -5198,6 +8097,13 @@ static void register_io_functions(fe_Context *ctx) {
     fe_set(ctx, fe_symbol(ctx, "readbytes"), fe_cfunc(ctx, builtin_read_bytes));
     fe_set(ctx, fe_symbol(ctx, "writefile"), fe_cfunc(ctx, builtin_write_file));
     fe_set(ctx, fe_symbol(ctx, "writebytes"), fe_cfunc(ctx, builtin_write_bytes));
+    fe_set(ctx, fe_symbol(ctx, "fopen"), fe_cfunc(ctx, builtin_file_open));
+    fe_set(ctx, fe_symbol(ctx, "freadline"), fe_cfunc(ctx, builtin_file_read_line));
+    fe_set(ctx, fe_symbol(ctx, "freadbytes"), fe_cfunc(ctx, builtin_file_read_bytes));
+    fe_set(ctx, fe_symbol(ctx, "fwrite"), fe_cfunc(ctx, builtin_file_write));
+    fe_set(ctx, fe_symbol(ctx, "fclose"), fe_cfunc(ctx, builtin_file_close));
+    fe_set(ctx, fe_symbol(ctx, "freadjson"), fe_cfunc(ctx, builtin_file_read_json));
+    fe_set(ctx, fe_symbol(ctx, "fwritejson"), fe_cfunc(ctx, builtin_file_write_json));
     fe_set(ctx, fe_symbol(ctx, "readjson"), fe_cfunc(ctx, builtin_read_json));
     fe_set(ctx, fe_symbol(ctx, "writejson"), fe_cfunc(ctx, builtin_write_json));
 
@@ -5214,11 +8120,21 @@ static void register_data_functions(fe_Context *ctx) {
     fe_set(ctx, fe_symbol(ctx, "mapdelete"), fe_cfunc(ctx, builtin_map_delete));
     fe_set(ctx, fe_symbol(ctx, "mapkeys"), fe_cfunc(ctx, builtin_map_keys));
     fe_set(ctx, fe_symbol(ctx, "mapcount"), fe_cfunc(ctx, builtin_map_count));
+    fe_set(ctx, fe_symbol(ctx, "array"), fe_cfunc(ctx, builtin_make_array));
+    fe_set(ctx, fe_symbol(ctx, "push"), fe_cfunc(ctx, builtin_array_push));
+    fe_set(ctx, fe_symbol(ctx, "setnth"), fe_cfunc(ctx, builtin_array_set));
+    fe_set(ctx, fe_symbol(ctx, "toarray"), fe_cfunc(ctx, builtin_to_array));
+    fe_set(ctx, fe_symbol(ctx, "tolist"), fe_cfunc(ctx, builtin_to_list));
     fe_set(ctx, fe_symbol(ctx, "makebytes"), fe_cfunc(ctx, builtin_make_bytes));
     fe_set(ctx, fe_symbol(ctx, "tobytes"), fe_cfunc(ctx, builtin_to_bytes));
     fe_set(ctx, fe_symbol(ctx, "byteslen"), fe_cfunc(ctx, builtin_bytes_length));
     fe_set(ctx, fe_symbol(ctx, "byteat"), fe_cfunc(ctx, builtin_byte_at));
     fe_set(ctx, fe_symbol(ctx, "byteslice"), fe_cfunc(ctx, builtin_bytes_slice));
+    fe_set(ctx, fe_symbol(ctx, "bytesfind"), fe_cfunc(ctx, builtin_bytes_find));
+    fe_set(ctx, fe_symbol(ctx, "bytescount"), fe_cfunc(ctx, builtin_bytes_count));
+    fe_set(ctx, fe_symbol(ctx, "bytesfill"), fe_cfunc(ctx, builtin_bytes_fill));
+    fe_set(ctx, fe_symbol(ctx, "bytescompare"), fe_cfunc(ctx, builtin_bytes_compare));
+    fe_set(ctx, fe_symbol(ctx, "bytesxor"), fe_cfunc(ctx, builtin_bytes_xor));
     fe_set(ctx, fe_symbol(ctx, "parsejson"), fe_cfunc(ctx, builtin_parse_json));
     fe_set(ctx, fe_symbol(ctx, "tojson"), fe_cfunc(ctx, builtin_to_json));
 
@@ -5236,6 +8152,14 @@ static void register_system_functions(fe_Context *ctx) {
     fe_set(ctx, fe_symbol(ctx, "system"), fe_cfunc(ctx, builtin_system));
     fe_set(ctx, fe_symbol(ctx, "runcommand"), fe_cfunc(ctx, builtin_run_command));
     fe_set(ctx, fe_symbol(ctx, "runprocess"), fe_cfunc(ctx, builtin_run_process));
+    fe_set(ctx, fe_symbol(ctx, "processstart"), fe_cfunc(ctx, builtin_process_start));
+    fe_set(ctx, fe_symbol(ctx, "processpoll"), fe_cfunc(ctx, builtin_process_poll));
+    fe_set(ctx, fe_symbol(ctx, "processread"), fe_cfunc(ctx, builtin_process_read));
+    fe_set(ctx, fe_symbol(ctx, "processwait"), fe_cfunc(ctx, builtin_process_wait));
+    fe_set(ctx, fe_symbol(ctx, "spawn"), fe_cfunc(ctx, builtin_spawn));
+    fe_set(ctx, fe_symbol(ctx, "send"), fe_cfunc(ctx, builtin_worker_send));
+    fe_set(ctx, fe_symbol(ctx, "receive"), fe_cfunc(ctx, builtin_worker_receive));
+    fe_set(ctx, fe_symbol(ctx, "workerjoin"), fe_cfunc(ctx, builtin_worker_join));
 
     fe_restoregc(ctx, gc_save);
 }
@@ -5252,6 +8176,7 @@ static void register_type_functions(fe_Context *ctx) {
     fe_set(ctx, fe_symbol(ctx, "isbytes"), fe_cfunc(ctx, builtin_is_bytes));
     fe_set(ctx, fe_symbol(ctx, "islist"), fe_cfunc(ctx, builtin_is_list));
     fe_set(ctx, fe_symbol(ctx, "ismap"), fe_cfunc(ctx, builtin_is_map));
+    fe_set(ctx, fe_symbol(ctx, "isarray"), fe_cfunc(ctx, builtin_is_array));
 
     fe_restoregc(ctx, gc_save);
 }
@@ -33,18 +33,62 @@ FexStatus fex_try_run_internal(fe_Context *ctx, fe_Object **out_result,
 /* Per-context span state accessors (implemented in fe.c) */
 void *fe_ctx_span_state(fe_Context *ctx);
 void fe_ctx_set_span_state(fe_Context *ctx, void *state);
+void *fe_ctx_file_state(fe_Context *ctx);
+void fe_ctx_set_file_state(fe_Context *ctx, void *state);
+void *fe_ctx_builder_state(fe_Context *ctx);
+void fe_ctx_set_builder_state(fe_Context *ctx, void *state);
+void *fe_ctx_process_state(fe_Context *ctx);
+void fe_ctx_set_process_state(fe_Context *ctx, void *state);
 void *fe_ctx_temp_allocs(fe_Context *ctx);
 void fe_ctx_set_temp_allocs(fe_Context *ctx, void *state);
 void *fe_ctx_tracked_alloc(fe_Context *ctx, size_t size);
 void *fe_ctx_tracked_realloc(fe_Context *ctx, void *ptr, size_t size);
 void fe_ctx_tracked_free(fe_Context *ctx, void *ptr);
 void fe_ctx_memory_error(fe_Context *ctx, const char *fallback_msg);
+void fe_ctx_map_release(fe_Context *ctx, fe_Object *map_obj);
 int fe_ctx_object_is_live(fe_Context *ctx, const fe_Object *obj);
+/* Lexicographic byte comparison of two string objects (implemented in
+   fe.c); returns -1, 0, or 1. Callers must check the types. */
+int fe_ctx_string_compare(fe_Context *ctx, fe_Object *a, fe_Object *b);
+
+/* Drops the import-resolution cache (implemented in fe.c); called when a
+   builtin changes the working directory, since relative search bases then
+   resolve differently. */
+void fe_ctx_module_resolution_invalidate(fe_Context *ctx);
+
+/* Compile cache storage (implemented in fe.c; the cached trees are GC
+   roots).  Lookup returns NULL on a miss; insertion is best-effort and a
+   no-op while the cache is disabled. */
+fe_Object *fe_ctx_compile_cache_get(fe_Context *ctx, const char *source,
+                                    const char *source_name);
+void fe_ctx_compile_cache_put(fe_Context *ctx, const char *source,
+                              const char *source_name, fe_Object *code);
+
+/* Fast number formatting (implemented in fe.c). Both NUL-terminate and
+   return the length; fe_format_fixnum needs at least 24 bytes of buffer,
+   fe_format_double emits the shortest round-tripping decimal form. */
+size_t fe_format_fixnum(char *buf, intptr_t value);
+size_t fe_format_double(char *buf, size_t cap, double value);
 
 /* Per-context span lifecycle (implemented in fex_span.c) */
 void fex_span_init(fe_Context *ctx);
 void fex_span_cleanup(fe_Context *ctx);
 void fex_span_prune(fe_Context *ctx);
+/* Invalidates the recorder's transient source-buffer cache at the end of a
+   compile unit (called from leave_compile_scope). */
+void fex_span_source_done(fe_Context *ctx);
+/* Registers a caller-owned source buffer (e.g. a file mapping held until
+   fe_close) so span excerpts borrow it instead of retaining a copy. */
+void fex_span_adopt_source(fe_Context *ctx, const char *src, size_t len);
 void fex_temp_cleanup_all(fe_Context *ctx);
 
+/* Per-context open file handles (implemented in fex_builtins.c) */
+void fex_file_cleanup(fe_Context *ctx);
+
+/* Per-context string builders (implemented in fex_builtins.c) */
+void fex_builder_cleanup(fe_Context *ctx);
+
+/* Per-context async child processes (implemented in fex_builtins.c) */
+void fex_process_cleanup(fe_Context *ctx);
+
 #endif
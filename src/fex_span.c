@@ -26,20 +26,60 @@
 #include <stdlib.h>
 #include <string.h>
 
-#define BUCKETS 8192
+/*
+ * Span storage layout.
+ *
+ * Records live in slabs (one tracked allocation per SPAN_SLAB_ENTRIES
+ * records) and are indexed by an open-addressing pointer hash sized to the
+ * live record count, so neither the per-node allocation overhead nor a
+ * fixed bucket array is paid.  Excerpt text is not copied per node either:
+ * all spans from one compile unit share a single reference-counted copy of
+ * that unit's source and point into it.  Pruning after GC walks the slabs
+ * contiguously, releases records for dead objects, and rebuilds the index
+ * in place; when the last record dies the slabs, index, and retained
+ * sources are all returned to the allocator.
+ */
+
+#define SPAN_SLAB_ENTRIES 64
+#define SPAN_TABLE_MIN_CAPACITY 64
 
 typedef struct FexSourceName {
     char *text;
     struct FexSourceName *next;
 } FexSourceName;
 
+struct FexSourceText {
+    char *text;
+    size_t len;
+    int refs;
+    int borrowed;   /* Points into a caller-owned mapping; never freed here */
+    struct FexSourceText *next;
+};
+
+typedef struct FexSpanSlab {
+    struct FexSpanSlab *next;
+    int used;                        /* records handed out, never shrinks */
+    FexSpan entries[SPAN_SLAB_ENTRIES];
+} FexSpanSlab;
+
 typedef struct {
-    FexSpan *buckets[BUCKETS];
+    FexSpan **table;                 /* open addressing; NULL = empty slot */
+    int table_capacity;              /* power of two; 0 until first record */
+    int count;                       /* records currently indexed */
+    FexSpanSlab *slabs;              /* newest first */
+    FexSpan *free_records;           /* recycled records, chained via next */
+    FexSourceText *texts;
+    /* One-compile pointer cache mapping the transient source buffer to its
+       retained copy; fex_span_source_done() invalidates it so a later
+       buffer reusing the same address cannot alias. */
+    const char *current_src;
+    FexSourceText *current_text;
     FexSourceName *source_names;
     int enabled;
+    int calls_only;
 } FexSpanState;
 
-#define hash_ptr(p) (((uintptr_t)(p) >> 3) & (BUCKETS - 1))
+#define hash_ptr(p) ((uintptr_t)(p) >> 3)
 
 static FexSpanState *get_state(fe_Context *ctx) {
     return (FexSpanState *)fe_ctx_span_state(ctx);
@@ -87,22 +127,203 @@ static const char *intern_source_name(fe_Context *ctx, FexSpanState *state, cons
     return entry->text;
 }
 
-static char *copy_span_excerpt(fe_Context *ctx, const char *start, const char *end) {
-    char *copy;
+/* Drop one reference to a retained source copy, freeing it when the last
+   span pointing into it dies. */
+static void release_source_text(fe_Context *ctx, FexSpanState *state,
+                                FexSourceText *text) {
+    FexSourceText **link;
+
+    if (!text) {
+        return;
+    }
+    if (--text->refs > 0) {
+        return;
+    }
+    for (link = &state->texts; *link; link = &(*link)->next) {
+        if (*link == text) {
+            *link = text->next;
+            break;
+        }
+    }
+    if (state->current_text == text) {
+        state->current_src = NULL;
+        state->current_text = NULL;
+    }
+    if (!text->borrowed) {
+        span_free(ctx, text->text);
+    }
+    span_free(ctx, text);
+}
+
+/* Resolve the retained copy the excerpt [start, end) should point into.
+   Pointers into an already-retained copy (spans copied from other spans)
+   reuse it directly; a transient compile buffer is copied once and then
+   matched by pointer for the rest of the compile.  Live allocations never
+   overlap, so the range test cannot match a foreign buffer. */
+static FexSourceText *intern_source_text(fe_Context *ctx, FexSpanState *state,
+                                         const char *src,
+                                         const char *start, const char *end) {
+    FexSourceText *text;
     size_t len;
 
-    if (!start || !end || end < start) {
-        return NULL;
+    for (text = state->texts; text; text = text->next) {
+        if (start >= text->text && end <= text->text + text->len) {
+            return text;
+        }
+    }
+    if (state->current_src == src && state->current_text) {
+        return state->current_text;
     }
 
-    len = (size_t)(end - start);
-    copy = span_alloc(ctx, len + 1);
-    if (!copy) {
+    len = strlen(src);
+    if (end > src + len) {
+        return NULL;  /* excerpt does not lie inside the claimed source */
+    }
+    text = span_alloc(ctx, sizeof(*text));
+    if (!text) {
+        return NULL;
+    }
+    text->text = span_alloc(ctx, len + 1);
+    if (!text->text) {
+        span_free(ctx, text);
         return NULL;
     }
-    memcpy(copy, start, len);
-    copy[len] = '\0';
-    return copy;
+    memcpy(text->text, src, len + 1);
+    text->len = len;
+    text->refs = 0;
+    text->borrowed = 0;
+    text->next = state->texts;
+    state->texts = text;
+    state->current_src = src;
+    state->current_text = text;
+    return text;
+}
+
+/* Register a caller-owned source (a read-only file mapping that outlives
+   every span) so excerpts point straight into it instead of retaining a
+   heap copy.  Failure to register is harmless: the next fex_record_span()
+   simply falls back to copying the unit. */
+void fex_span_adopt_source(fe_Context *ctx, const char *src, size_t len) {
+    FexSpanState *state = get_state(ctx);
+    FexSourceText *text;
+
+    if (!state || !state->enabled) {
+        return;
+    }
+    for (text = state->texts; text; text = text->next) {
+        if (text->text == src) {
+            state->current_src = src;
+            state->current_text = text;
+            return;
+        }
+    }
+    text = span_alloc(ctx, sizeof(*text));
+    if (!text) {
+        return;
+    }
+    text->text = (char *)src;
+    text->len = len;
+    text->refs = 0;
+    text->borrowed = 1;
+    text->next = state->texts;
+    state->texts = text;
+    state->current_src = src;
+    state->current_text = text;
+}
+
+void fex_span_source_done(fe_Context *ctx) {
+    FexSpanState *state = get_state(ctx);
+    if (state) {
+        state->current_src = NULL;
+        state->current_text = NULL;
+    }
+}
+
+static void table_insert(FexSpanState *state, FexSpan *record) {
+    uintptr_t mask = (uintptr_t)state->table_capacity - 1;
+    uintptr_t i = hash_ptr(record->node) & mask;
+    while (state->table[i] != NULL) {
+        i = (i + 1) & mask;
+    }
+    state->table[i] = record;
+}
+
+/* Grow (or create) the index and rehash every live record into it. */
+static int table_reserve(fe_Context *ctx, FexSpanState *state) {
+    FexSpan **grown;
+    int new_capacity;
+    FexSpanSlab *slab;
+    int i;
+
+    if (state->table_capacity > 0 &&
+        (state->count + 1) * 4 < state->table_capacity * 3) {
+        return 1;
+    }
+    new_capacity = state->table_capacity ? state->table_capacity * 2
+                                         : SPAN_TABLE_MIN_CAPACITY;
+    grown = span_alloc(ctx, sizeof(*grown) * (size_t)new_capacity);
+    if (!grown) {
+        return 0;
+    }
+    memset(grown, 0, sizeof(*grown) * (size_t)new_capacity);
+    span_free(ctx, state->table);
+    state->table = grown;
+    state->table_capacity = new_capacity;
+    for (slab = state->slabs; slab; slab = slab->next) {
+        for (i = 0; i < slab->used; i++) {
+            if (slab->entries[i].node != NULL) {
+                table_insert(state, &slab->entries[i]);
+            }
+        }
+    }
+    return 1;
+}
+
+/* Hand out a record slot, reusing pruned ones before opening a new slab. */
+static FexSpan *record_acquire(fe_Context *ctx, FexSpanState *state) {
+    FexSpanSlab *slab;
+
+    if (state->free_records) {
+        FexSpan *record = state->free_records;
+        state->free_records = record->next;
+        return record;
+    }
+    slab = state->slabs;
+    if (!slab || slab->used == SPAN_SLAB_ENTRIES) {
+        slab = span_alloc(ctx, sizeof(*slab));
+        if (!slab) {
+            return NULL;
+        }
+        slab->used = 0;
+        slab->next = state->slabs;
+        state->slabs = slab;
+    }
+    return &slab->entries[slab->used++];
+}
+
+/* Release every record, slab, index slot, and retained source; interned
+   source names stay (errors may still reference them). */
+static void release_all_records(fe_Context *ctx, FexSpanState *state) {
+    while (state->slabs) {
+        FexSpanSlab *next = state->slabs->next;
+        span_free(ctx, state->slabs);
+        state->slabs = next;
+    }
+    while (state->texts) {
+        FexSourceText *next = state->texts->next;
+        if (!state->texts->borrowed) {
+            span_free(ctx, state->texts->text);
+        }
+        span_free(ctx, state->texts);
+        state->texts = next;
+    }
+    span_free(ctx, state->table);
+    state->table = NULL;
+    state->table_capacity = 0;
+    state->count = 0;
+    state->free_records = NULL;
+    state->current_src = NULL;
+    state->current_text = NULL;
 }
 
 void fex_span_init(fe_Context *ctx) {
@@ -115,23 +336,11 @@ void fex_span_init(fe_Context *ctx) {
 
 void fex_span_cleanup(fe_Context *ctx) {
     FexSpanState *state = get_state(ctx);
-    unsigned i;
     FexSourceName *name_entry;
 
     if (!state) return;
 
-    /* Free all span entries */
-    for (i = 0; i < BUCKETS; i++) {
-        FexSpan *entry = state->buckets[i];
-        while (entry) {
-            FexSpan *next = entry->next;
-            if (entry->source) {
-                span_free(ctx, (void*)entry->source);
-            }
-            span_free(ctx, entry);
-            entry = next;
-        }
-    }
+    release_all_records(ctx, state);
 
     /* Free all interned source names */
     name_entry = state->source_names;
@@ -148,22 +357,60 @@ void fex_span_cleanup(fe_Context *ctx) {
 
 void fex_span_prune(fe_Context *ctx) {
     FexSpanState *state = get_state(ctx);
-    unsigned i;
-
-    if (!state) return;
-
-    for (i = 0; i < BUCKETS; i++) {
-        FexSpan **link = &state->buckets[i];
-        while (*link) {
-            FexSpan *entry = *link;
-            if (!fe_ctx_object_is_live(ctx, entry->node)) {
-                *link = entry->next;
-                if (entry->source) {
-                    span_free(ctx, (void*)entry->source);
+    FexSpanSlab **slab_link;
+    FexSpanSlab *slab;
+    int removed = 0;
+    int i;
+
+    if (!state || state->count == 0) return;
+
+    /* Release records whose nodes did not survive the sweep; slabs left
+       with no live record are returned to the allocator, and the free list
+       is rebuilt from the dead slots of the slabs that remain. */
+    state->free_records = NULL;
+    slab_link = &state->slabs;
+    while ((slab = *slab_link) != NULL) {
+        int live = 0;
+        for (i = 0; i < slab->used; i++) {
+            FexSpan *record = &slab->entries[i];
+            if (record->node && !fe_ctx_object_is_live(ctx, record->node)) {
+                release_source_text(ctx, state, record->text);
+                record->node = NULL;
+                record->text = NULL;
+                state->count--;
+                removed++;
+            }
+            if (record->node) {
+                live++;
+            }
+        }
+        if (live == 0) {
+            *slab_link = slab->next;
+            span_free(ctx, slab);
+            continue;
+        }
+        for (i = 0; i < slab->used; i++) {
+            if (slab->entries[i].node == NULL) {
+                slab->entries[i].next = state->free_records;
+                state->free_records = &slab->entries[i];
+            }
+        }
+        slab_link = &slab->next;
+    }
+    if (state->count == 0) {
+        release_all_records(ctx, state);
+        return;
+    }
+    if (removed > 0) {
+        /* Rebuild the index in place; pruning runs right after a sweep, so
+           no allocation happens here. */
+        memset(state->table, 0,
+               sizeof(*state->table) * (size_t)state->table_capacity);
+        for (slab = state->slabs; slab; slab = slab->next) {
+            for (i = 0; i < slab->used; i++) {
+                if (slab->entries[i].node != NULL) {
+                    table_insert(state, &slab->entries[i]);
                 }
-                span_free(ctx, entry);
-            } else {
-                link = &entry->next;
             }
         }
     }
@@ -189,76 +436,134 @@ int fex_span_is_enabled(fe_Context *ctx) {
     return state ? state->enabled : 0;
 }
 
+void fex_span_set_calls_only(fe_Context *ctx, int calls_only) {
+    FexSpanState *state = get_state(ctx);
+    if (calls_only && !state) {
+        fex_span_init(ctx);
+        state = get_state(ctx);
+        if (!state) {
+            fe_ctx_memory_error(ctx, "out of memory (span state)");
+            return;
+        }
+    }
+    if (state) {
+        state->calls_only = calls_only;
+    }
+}
+
+int fex_span_is_calls_only(fe_Context *ctx) {
+    FexSpanState *state = get_state(ctx);
+    return state ? state->calls_only : 0;
+}
+
+static FexSpan *find_record(FexSpanState *state, const fe_Object *node) {
+    uintptr_t mask, i;
+
+    if (state->table_capacity == 0) {
+        return NULL;
+    }
+    mask = (uintptr_t)state->table_capacity - 1;
+    for (i = hash_ptr(node) & mask; state->table[i]; i = (i + 1) & mask) {
+        if (state->table[i]->node == node) {
+            return state->table[i];
+        }
+    }
+    return NULL;
+}
+
+/* Free a retained source that no record ended up referencing (a later
+   allocation in the same record attempt failed). */
+static void discard_unreferenced_text(fe_Context *ctx, FexSpanState *state,
+                                      FexSourceText *text) {
+    if (text && text->refs == 0) {
+        text->refs = 1;
+        release_source_text(ctx, state, text);
+    }
+}
+
 void fex_record_span(fe_Context *ctx, const fe_Object *node, const char *src,
                      const char *source_name,
                      int sl, int sc, int el, int ec,
                      const char *start, const char *end) {
     FexSpanState *state = get_state(ctx);
-    unsigned h;
     FexSpan *entry;
     const char *stable_source_name;
-    char *excerpt = NULL;
-    size_t excerpt_len = 0;
+    FexSourceText *text = NULL;
 
     if (!state || !state->enabled) {
         return;
     }
-    (void)src;
+    if (state->calls_only &&
+        (FE_IS_FIXNUM(node) || FE_IS_BOOLEAN(node) ||
+         fe_type(ctx, (fe_Object *)node) != FE_TPAIR)) {
+        return;
+    }
 
-    if (start && end && end >= start) {
-        excerpt_len = (size_t)(end - start);
-        excerpt = copy_span_excerpt(ctx, start, end);
-        if (!excerpt) {
-            fe_ctx_memory_error(ctx, "out of memory (span excerpt)");
+    stable_source_name = intern_source_name(ctx, state, source_name);
+    if (!stable_source_name) {
+        fe_ctx_memory_error(ctx, "out of memory (span source name)");
+        return;
+    }
+
+    if (src && start && end && end >= start) {
+        text = intern_source_text(ctx, state, src, start, end);
+        if (!text) {
+            fe_ctx_memory_error(ctx, "out of memory (span source)");
             return;
         }
     }
 
-    h = hash_ptr(node);
-    entry = span_alloc(ctx, sizeof(*entry));
+    entry = find_record(state, node);
     if (!entry) {
-        if (excerpt) {
-            span_free(ctx, excerpt);
+        if (!table_reserve(ctx, state)) {
+            discard_unreferenced_text(ctx, state, text);
+            fe_ctx_memory_error(ctx, "out of memory (span table)");
+            return;
         }
-        fe_ctx_memory_error(ctx, "out of memory (span entry)");
-        return;
-    }
-
-    stable_source_name = intern_source_name(ctx, state, source_name);
-    if (!stable_source_name) {
-        if (excerpt) {
-            span_free(ctx, excerpt);
+        entry = record_acquire(ctx, state);
+        if (!entry) {
+            discard_unreferenced_text(ctx, state, text);
+            fe_ctx_memory_error(ctx, "out of memory (span entry)");
+            return;
         }
-        span_free(ctx, entry);
-        fe_ctx_memory_error(ctx, "out of memory (span source name)");
-        return;
+        entry->node = node;
+        table_insert(state, entry);
+        state->count++;
+    } else {
+        release_source_text(ctx, state, entry->text);
     }
 
-    entry->node = node;
-    entry->source = excerpt;
+    if (text) {
+        text->refs++;
+    }
+    entry->text = text;
+    entry->source = text ? text->text : NULL;
     entry->source_name = stable_source_name;
-    entry->start = excerpt;
-    entry->end = excerpt ? excerpt + excerpt_len : NULL;
+    if (text) {
+        /* Rebase transient-buffer pointers onto the retained copy; pointers
+           already inside it (copied spans) are kept as-is. */
+        if (start >= text->text && start <= text->text + text->len) {
+            entry->start = start;
+        } else {
+            entry->start = text->text + (start - src);
+        }
+        entry->end = entry->start + (end - start);
+    } else {
+        entry->start = NULL;
+        entry->end = NULL;
+    }
     entry->start_line = sl;
     entry->start_col = sc;
     entry->end_line = el;
     entry->end_col = ec;
-    entry->next = state->buckets[h];
-    state->buckets[h] = entry;
+    entry->next = NULL;
 }
 
 const FexSpan *fex_lookup_span(fe_Context *ctx, const fe_Object *node) {
     FexSpanState *state = get_state(ctx);
-    FexSpan *entry;
 
     if (!state || !state->enabled) {
         return NULL;
     }
-
-    for (entry = state->buckets[hash_ptr(node)]; entry; entry = entry->next) {
-        if (entry->node == node) {
-            return entry;
-        }
-    }
-    return NULL;
+    return find_record(state, node);
 }
@@ -25,9 +25,15 @@
 
 #include "fe.h"
 
+/* Shared, reference-counted copy of one compile unit's source text; every
+   span recorded from that unit points into the same copy instead of
+   carrying its own excerpt buffer. */
+typedef struct FexSourceText FexSourceText;
+
 typedef struct FexSpan {
     const fe_Object *node;
-    /* Owned excerpt buffer when source text is available; NULL otherwise. */
+    /* Retained source text of the compile unit when available; NULL
+       otherwise.  Shared between all spans from the same unit. */
     const char *source;
     const char *source_name;
     /* Slice into `source` when an excerpt is available; NULL otherwise. */
@@ -35,6 +41,8 @@ typedef struct FexSpan {
     const char *end;
     int start_line, start_col;
     int end_line, end_col;
+    /* Internal bookkeeping; not meaningful to callers. */
+    FexSourceText *text;
     struct FexSpan *next;
 } FexSpan;
 
@@ -49,4 +57,9 @@ const FexSpan *fex_lookup_span(fe_Context *ctx, const fe_Object *node);
 void fex_span_set_enabled(fe_Context *ctx, int enabled);
 int fex_span_is_enabled(fe_Context *ctx);
 
+/* Calls-only granularity records spans for list forms only, skipping the
+   per-atom (string/number literal) records; see FEX_CONFIG_SPANS_CALLS_ONLY. */
+void fex_span_set_calls_only(fe_Context *ctx, int calls_only);
+int fex_span_is_calls_only(fe_Context *ctx);
+
 #endif
@@ -281,6 +281,10 @@ static void print_runtime_stats(FILE *fp, fe_Context *ctx) {
   fprintf(fp, "  object_allocations_total: %llu\n", (unsigned long long)stats.object_allocations_total);
   fprintf(fp, "  allocs_since_gc: %llu\n", (unsigned long long)stats.allocs_since_gc);
   fprintf(fp, "  gc_runs: %llu\n", (unsigned long long)stats.gc_runs);
+  fprintf(fp, "  gc_pause_us_last: %llu\n", (unsigned long long)stats.gc_pause_us_last);
+  fprintf(fp, "  gc_pause_us_max: %llu\n", (unsigned long long)stats.gc_pause_us_max);
+  fprintf(fp, "  gc_reclaimed_last: %llu\n", (unsigned long long)stats.gc_reclaimed_last);
+  fprintf(fp, "  gc_reclaimed_total: %llu\n", (unsigned long long)stats.gc_reclaimed_total);
 }
 
 /* --- JSON output helpers --- */
@@ -330,7 +334,11 @@ static void print_json_stats(FILE *fp, fe_Context *ctx) {
   fprintf(fp, ",\"live_objects\":%llu", (unsigned long long)stats.live_objects);
   fprintf(fp, ",\"object_allocations_total\":%llu", (unsigned long long)stats.object_allocations_total);
   fprintf(fp, ",\"allocs_since_gc\":%llu", (unsigned long long)stats.allocs_since_gc);
-  fprintf(fp, ",\"gc_runs\":%llu}", (unsigned long long)stats.gc_runs);
+  fprintf(fp, ",\"gc_runs\":%llu", (unsigned long long)stats.gc_runs);
+  fprintf(fp, ",\"gc_pause_us_last\":%llu", (unsigned long long)stats.gc_pause_us_last);
+  fprintf(fp, ",\"gc_pause_us_max\":%llu", (unsigned long long)stats.gc_pause_us_max);
+  fprintf(fp, ",\"gc_reclaimed_last\":%llu", (unsigned long long)stats.gc_reclaimed_last);
+  fprintf(fp, ",\"gc_reclaimed_total\":%llu}", (unsigned long long)stats.gc_reclaimed_total);
 }
 
 static void print_json_result(FILE *fp, int exit_code, const FexError *error,
@@ -453,11 +461,25 @@ static int run_source(fe_Context *ctx, const char *source, const char *source_na
   return 0;
 }
 
+static int compile_file(fe_Context *ctx, const char *path, int json_output,
+                        FexError *out_error) {
+  FexError error;
+  FexStatus status = fex_try_compile_file(ctx, path, &error);
+
+  if (status != FEX_STATUS_OK) {
+    if (out_error) *out_error = error;
+    if (!json_output) fex_print_error(stderr, &error);
+    return exit_code_for_status(status);
+  }
+  return 0;
+}
+
 static void print_usage(const char *program_name) {
   fprintf(stderr, "Usage: %s [options] [file|-]\n", program_name);
   fprintf(stderr, "Options:\n");
   fprintf(stderr, "  -e CODE       Evaluate inline source (may repeat)\n");
   fprintf(stderr, "  --spans       Enable detailed error reporting with source spans\n");
+  fprintf(stderr, "  --spans-calls Record spans for call forms only (lower memory overhead)\n");
   fprintf(stderr, "  --builtins    Enable all extended built-in functions\n");
   fprintf(stderr, "  --builtin NAME  Enable a builtin category or preset (may repeat, comma-separated)\n");
   fprintf(stderr, "                Categories: math, string, list, io, system, type, data\n");
@@ -469,8 +491,13 @@ static void print_usage(const char *program_name) {
   fprintf(stderr, "  --max-memory N  Abort when tracked context memory exceeds N bytes (0 disables)\n");
   fprintf(stderr, "  --max-eval-depth N  Limit eval recursion depth (0 disables, default: 512)\n");
   fprintf(stderr, "  --max-read-depth N  Limit read nesting depth (0 disables, default: 512)\n");
+  fprintf(stderr, "  --compile     Compile the input file to its module cache (file.fexc) without running it\n");
+  fprintf(stderr, "  --no-module-cache  Ignore precompiled module caches and always compile sources\n");
+  fprintf(stderr, "  --gc-incremental  Spread GC sweep work across allocations to shorten pauses\n");
+  fprintf(stderr, "  --growable-heap  Grow the object heap on demand instead of failing when full\n");
   fprintf(stderr, "  --json-output Emit structured JSON diagnostics to stderr instead of text\n");
   fprintf(stderr, "  --stats       Print runtime stats to stderr after non-REPL execution\n");
+  fprintf(stderr, "  --profile     Print a per-function call/time profile to stderr after non-REPL execution\n");
   fprintf(stderr, "  --memory-pool-size SIZE  Set memory pool size in MB (default: 5MB)\n");
   fprintf(stderr, "  --version, -V  Show version information\n");
   fprintf(stderr, "  --help        Show this help message\n");
@@ -480,10 +507,15 @@ static void print_usage(const char *program_name) {
 }
 
 static int fex_main_utf8(int argc, char **argv) {
-  int enable_spans = 0, i, module_path_count = 0;
+  int enable_spans = 0, spans_calls_only = 0, i, module_path_count = 0;
   int read_stdin = 0;
   int end_of_options = 0;
   int show_stats = 0;
+  int show_profile = 0;
+  int compile_only = 0;
+  int no_module_cache = 0;
+  int gc_incremental = 0;
+  int growable_heap = 0;
   int json_output = 0;
   int exit_code = 0;
   int stdin_interactive;
@@ -545,6 +577,8 @@ static int fex_main_utf8(int argc, char **argv) {
       }
     } else if (!end_of_options && strcmp(argv[i], "--spans") == 0) {
       enable_spans = 1;
+    } else if (!end_of_options && strcmp(argv[i], "--spans-calls") == 0) {
+      spans_calls_only = 1;
     } else if (!end_of_options && strcmp(argv[i], "--builtins") == 0) {
       builtins |= FEX_BUILTINS_ALL;
     } else if (!end_of_options && strcmp(argv[i], "--builtin") == 0) {
@@ -675,8 +709,18 @@ static int fex_main_utf8(int argc, char **argv) {
       max_read_depth = (int)parsed_depth;
     } else if (!end_of_options && strcmp(argv[i], "--json-output") == 0) {
       json_output = 1;
+    } else if (!end_of_options && strcmp(argv[i], "--compile") == 0) {
+      compile_only = 1;
+    } else if (!end_of_options && strcmp(argv[i], "--no-module-cache") == 0) {
+      no_module_cache = 1;
+    } else if (!end_of_options && strcmp(argv[i], "--gc-incremental") == 0) {
+      gc_incremental = 1;
+    } else if (!end_of_options && strcmp(argv[i], "--growable-heap") == 0) {
+      growable_heap = 1;
     } else if (!end_of_options && strcmp(argv[i], "--stats") == 0) {
       show_stats = 1;
+    } else if (!end_of_options && strcmp(argv[i], "--profile") == 0) {
+      show_profile = 1;
     } else if (!end_of_options && strcmp(argv[i], "--memory-pool-size") == 0) {
       char *endptr;
       long size_mb;
@@ -758,10 +802,17 @@ static int fex_main_utf8(int argc, char **argv) {
   if (enable_spans) {
     config |= FEX_CONFIG_ENABLE_SPANS;
   }
+  if (spans_calls_only) {
+    config |= FEX_CONFIG_SPANS_CALLS_ONLY;
+  }
   fex_init_with_builtins(ctx, config, builtins);
   fe_set_step_limit(ctx, max_steps);
   fe_set_memory_limit(ctx, max_memory);
   fe_set_timeout_ms(ctx, timeout_ms);
+  if (gc_incremental) fe_set_gc_mode(ctx, FE_GC_INCREMENTAL);
+  if (growable_heap) fe_set_arena_growable(ctx, 1);
+  if (no_module_cache) fex_set_module_cache(ctx, 0);
+  if (show_profile) fe_profile_start(ctx);
   if (max_eval_depth >= 0) fe_set_eval_depth_limit(ctx, max_eval_depth);
   if (max_read_depth >= 0) fe_set_read_depth_limit(ctx, max_read_depth);
 
@@ -784,7 +835,21 @@ static int fex_main_utf8(int argc, char **argv) {
     int is_batch;
     fex_error_clear(&run_error);
 
-    if (eval_source != NULL) {
+    if (compile_only) {
+      if (filename == NULL) {
+        if (!json_output) {
+          fprintf(stderr, "Error: --compile requires an input file\n");
+        }
+        exit_code = 64;
+        run_error.status = FEX_STATUS_IO_ERROR;
+        snprintf(run_error.message, sizeof(run_error.message),
+                 "--compile requires an input file");
+        has_error = 1;
+      } else {
+        exit_code = compile_file(ctx, filename, json_output, &run_error);
+        has_error = (exit_code != 0);
+      }
+    } else if (eval_source != NULL) {
       exit_code = run_source(ctx, eval_source, "<expr>", json_output, &run_error);
       has_error = (exit_code != 0);
     } else if (filename != NULL) {
@@ -818,6 +883,11 @@ static int fex_main_utf8(int argc, char **argv) {
     } else if (show_stats && is_batch) {
       print_runtime_stats(stderr, ctx);
     }
+
+    if (show_profile && is_batch) {
+      fe_profile_stop(ctx);
+      fe_profile_report(ctx, stderr);
+    }
   }
 
   free(eval_source);
@@ -0,0 +1,170 @@
+/*
+** FeX benchmark harness.
+**
+** Runs the benchmark corpus in bench/ and reports one machine-readable
+** line per benchmark:
+**
+**     bench name=<name> ops=<n> time_ms=<ms> ops_per_sec=<rate> \
+**         allocs=<objects> gc_runs=<n> peak_bytes=<bytes>
+**
+** Each script's final expression must evaluate to true; anything else is
+** treated as a broken benchmark and fails the run. Wall time is the best
+** of FEX_BENCH_RUNS runs on a fresh context, so a stray collection or
+** scheduler hiccup in one run does not pollute the numbers; allocation
+** counts are deterministic and must match across runs.
+**
+** tools/run_benchmarks.py wraps this binary and diffs the report against
+** the stored baseline in bench/baseline.json.
+*/
+
+#ifdef _WIN32
+#define _CRT_SECURE_NO_WARNINGS
+#include <windows.h>
+#else
+#include <sys/time.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "fe.h"
+#include "fex.h"
+
+#define BENCH_MEM_SIZE (16 * 1024 * 1024)
+#define FEX_BENCH_RUNS 3
+
+#ifndef FEX_BENCH_SCRIPT_DIR
+#define FEX_BENCH_SCRIPT_DIR "bench"
+#endif
+
+typedef struct {
+    const char *name;   /* report key and <name>.fex in the bench dir */
+    size_t ops;         /* logical operations per run, for ops/sec */
+} Benchmark;
+
+/* `ops` counts the benchmark's inner-loop unit of work (cells consed,
+ * map operations, concats, round-trips, calls), not wall-clock-neutral
+ * "iterations"; see the comment at the top of each script. */
+static const Benchmark benchmarks[] = {
+    { "list_churn",     2000 * 100 },
+    { "map_churn",      200 * 200 * 2 },
+    { "gc_stress",      2000 * 150 },
+    { "string_build",   200 * 100 },
+    { "json_roundtrip", 2000 },
+    { "deep_recursion", 1500 * 400 },
+};
+
+static uint64_t bench_time_us(void) {
+#ifdef _WIN32
+    LARGE_INTEGER freq, now;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&now);
+    return (uint64_t)(now.QuadPart * 1000000 / freq.QuadPart);
+#else
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (uint64_t)tv.tv_sec * 1000000u + (uint64_t)tv.tv_usec;
+#endif
+}
+
+/* Runs one benchmark once on a fresh context. Returns 0 on success and
+ * fills the timing and stats outputs. */
+static int run_once(const char *path, uint64_t *out_us, fe_Stats *out_stats) {
+    void *pool = malloc(BENCH_MEM_SIZE);
+    fe_Context *ctx;
+    fe_Object *result = NULL;
+    FexError error;
+    FexStatus status;
+    uint64_t start;
+    int failed = 0;
+
+    if (!pool) {
+        fprintf(stderr, "fex_bench: out of memory for context pool\n");
+        return 1;
+    }
+    ctx = fe_open(pool, BENCH_MEM_SIZE);
+    fex_init_with_config(ctx, FEX_CONFIG_ENABLE_EXTENDED_BUILTINS);
+
+    start = bench_time_us();
+    status = fex_try_do_file(ctx, path, &result, &error);
+    *out_us = bench_time_us() - start;
+
+    if (status != FEX_STATUS_OK) {
+        fprintf(stderr, "fex_bench: %s failed: %s\n", path, error.message);
+        failed = 1;
+    } else if (fe_type(ctx, result) != FE_TBOOLEAN || !FE_IS_TRUE(result)) {
+        fprintf(stderr, "fex_bench: %s checksum mismatch "
+            "(final expression is not true)\n", path);
+        failed = 1;
+    }
+
+    fe_get_stats(ctx, out_stats);
+    fe_close(ctx);
+    free(pool);
+    return failed;
+}
+
+static int run_benchmark(const char *dir, const Benchmark *bench) {
+    char path[1024];
+    fe_Stats stats;
+    fe_Stats best_stats = {0};
+    uint64_t best_us = 0;
+    double time_ms, ops_per_sec;
+    int run;
+
+    snprintf(path, sizeof(path), "%s/%s.fex", dir, bench->name);
+
+    for (run = 0; run < FEX_BENCH_RUNS; run++) {
+        uint64_t us;
+        if (run_once(path, &us, &stats)) {
+            return 1;
+        }
+        if (run == 0 || us < best_us) {
+            best_us = us;
+            best_stats = stats;
+        }
+    }
+
+    if (best_us == 0) {
+        best_us = 1;
+    }
+    time_ms = (double)best_us / 1000.0;
+    ops_per_sec = (double)bench->ops * 1000000.0 / (double)best_us;
+
+    printf("bench name=%s ops=%lu time_ms=%.3f ops_per_sec=%.0f "
+        "allocs=%lu gc_runs=%lu peak_bytes=%lu\n",
+        bench->name,
+        (unsigned long)bench->ops,
+        time_ms,
+        ops_per_sec,
+        (unsigned long)best_stats.object_allocations_total,
+        (unsigned long)best_stats.gc_runs,
+        (unsigned long)best_stats.peak_memory_used);
+    fflush(stdout);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    const char *dir = FEX_BENCH_SCRIPT_DIR;
+    size_t i;
+    int failures = 0;
+
+    if (argc > 2) {
+        fprintf(stderr, "usage: %s [bench-script-dir]\n", argv[0]);
+        return 64;
+    }
+    if (argc == 2) {
+        dir = argv[1];
+    }
+
+    for (i = 0; i < sizeof(benchmarks) / sizeof(benchmarks[0]); i++) {
+        failures += run_benchmark(dir, &benchmarks[i]);
+    }
+
+    if (failures) {
+        fprintf(stderr, "fex_bench: %d benchmark(s) failed\n", failures);
+        return 1;
+    }
+    return 0;
+}
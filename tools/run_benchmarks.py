@@ -0,0 +1,137 @@
+#!/usr/bin/env python3
+"""Run the fex_bench corpus and diff the report against a stored baseline.
+
+Wall-clock throughput (ops/sec) is compared with a tolerance because it is
+machine- and load-dependent; allocation counts and GC runs are deterministic
+for a given build configuration and must match the baseline exactly.
+
+Typical use:
+
+    tools/run_benchmarks.py --exe build/fex_bench              # check
+    tools/run_benchmarks.py --exe build/fex_bench --update     # re-baseline
+"""
+from __future__ import annotations
+
+import argparse
+import json
+import subprocess
+import sys
+from pathlib import Path
+
+
+ROOT = Path(__file__).resolve().parent.parent
+DEFAULT_BASELINE = ROOT / "bench" / "baseline.json"
+
+
+def parse_report(output: str) -> dict[str, dict[str, float]]:
+    results: dict[str, dict[str, float]] = {}
+    for line in output.splitlines():
+        if not line.startswith("bench "):
+            continue
+        fields = dict(part.split("=", 1) for part in line.split()[1:])
+        results[fields["name"]] = {
+            "ops": int(fields["ops"]),
+            "ops_per_sec": float(fields["ops_per_sec"]),
+            "allocs": int(fields["allocs"]),
+            "gc_runs": int(fields["gc_runs"]),
+        }
+    return results
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description="Run FeX benchmarks against a baseline.")
+    parser.add_argument("--exe", required=True, help="Path to the fex_bench executable")
+    parser.add_argument(
+        "--baseline",
+        type=Path,
+        default=DEFAULT_BASELINE,
+        help=f"Baseline file to diff against (default: {DEFAULT_BASELINE})",
+    )
+    parser.add_argument(
+        "--update",
+        action="store_true",
+        help="Rewrite the baseline from this run instead of diffing",
+    )
+    parser.add_argument(
+        "--tolerance",
+        type=float,
+        default=0.25,
+        help="Allowed fractional ops/sec slowdown before failing (default: 0.25)",
+    )
+    args = parser.parse_args()
+
+    completed = subprocess.run(
+        [args.exe],
+        capture_output=True,
+        text=True,
+        check=False,
+    )
+    sys.stderr.write(completed.stderr)
+    if completed.returncode != 0:
+        print(f"error: fex_bench exited with code {completed.returncode}", file=sys.stderr)
+        return 2
+
+    results = parse_report(completed.stdout)
+    if not results:
+        print("error: fex_bench produced no benchmark report lines", file=sys.stderr)
+        return 2
+
+    if args.update:
+        args.baseline.parent.mkdir(parents=True, exist_ok=True)
+        args.baseline.write_text(json.dumps(results, indent=2) + "\n", encoding="utf-8")
+        print(f"Baseline updated: {args.baseline}")
+        for name, entry in results.items():
+            print(f"  {name}: {entry['ops_per_sec']:.0f} ops/sec, {entry['allocs']} allocs")
+        return 0
+
+    if not args.baseline.exists():
+        print(
+            f"error: no baseline at {args.baseline}; run with --update to create one",
+            file=sys.stderr,
+        )
+        return 2
+    baseline = json.loads(args.baseline.read_text(encoding="utf-8"))
+
+    failures = 0
+    for name, base in baseline.items():
+        current = results.get(name)
+        if current is None:
+            print(f"FAIL {name}: missing from report")
+            failures += 1
+            continue
+
+        errors = []
+        for key in ("ops", "allocs", "gc_runs"):
+            if current[key] != base[key]:
+                errors.append(f"{key} changed: baseline {base[key]}, got {current[key]}")
+
+        floor = base["ops_per_sec"] * (1.0 - args.tolerance)
+        if current["ops_per_sec"] < floor:
+            errors.append(
+                f"ops/sec regressed: baseline {base['ops_per_sec']:.0f}, "
+                f"got {current['ops_per_sec']:.0f} "
+                f"(allowed floor {floor:.0f})"
+            )
+
+        if errors:
+            failures += 1
+            print(f"FAIL {name}")
+            for error in errors:
+                print(f"  {error}")
+        else:
+            ratio = current["ops_per_sec"] / base["ops_per_sec"]
+            print(f"PASS {name} ({current['ops_per_sec']:.0f} ops/sec, {ratio:.2f}x baseline)")
+
+    for name in results:
+        if name not in baseline:
+            print(f"NOTE {name}: not in baseline; run --update to record it")
+
+    if failures:
+        print(f"{len(baseline) - failures}/{len(baseline)} benchmarks within baseline")
+        return 1
+    print(f"All {len(baseline)} benchmarks within baseline")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
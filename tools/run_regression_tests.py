@@ -124,6 +124,45 @@ def runprocess_timeout_case_source() -> str:
     )
 
 
+def processasync_case_source() -> str:
+    python_exe = str(Path(sys.executable).resolve())
+    slow = (
+        "import os, sys, time\n"
+        "sys.stdout.write('first')\n"
+        "sys.stdout.flush()\n"
+        "while not os.path.exists('go'):\n"
+        "    time.sleep(0.01)\n"
+        "sys.stdout.write('second')\n"
+        "sys.stderr.write('warn')\n"
+        "raise SystemExit(7)"
+    )
+    quick = "import sys; sys.stdout.write(sys.stdin.read().upper())"
+    return (
+        f"let slow = processstart({fex_string_literal(python_exe)}, "
+        f"[\"-c\", {fex_string_literal(slow)}]);\n"
+        f"let quick = processstart({fex_string_literal(python_exe)}, "
+        f"[\"-c\", {fex_string_literal(quick)}], "
+        "makemap(\"stdin\", tobytes(\"abc\")));\n"
+        "let streamed = nil;\n"
+        "let running = true;\n"
+        "while (running and streamed == nil) {\n"
+        "    let status = processpoll(slow);\n"
+        "    let data = processread(slow);\n"
+        "    if (data != nil and byteslen(data) > 0) { streamed = data; }\n"
+        "    running = status.running;\n"
+        "}\n"
+        "println(streamed);\n"
+        "let quickresult = processwait(quick);\n"
+        "println(quickresult.stdout);\n"
+        "writefile(\"go\", \"x\");\n"
+        "let slowresult = processwait(slow);\n"
+        "println(slowresult.code);\n"
+        "println(slowresult.ok);\n"
+        "println(slowresult.stdout);\n"
+        "println(slowresult.stderr);\n"
+    )
+
+
 def fs_helpers_case_source() -> str:
     return (
         'println("--- FS Helpers Regression ---");\n'
@@ -239,6 +278,31 @@ CASES = [
             "41\n"
         ),
     },
+    {
+        "name": "import resolution tracks chdir",
+        "source": (
+            'mkdir("d1");\n'
+            'mkdir("d2");\n'
+            'writefile("d1/m.fex", "export fn v() { return 1; }\\n");\n'
+            'writefile("d2/m.fex", "export fn v() { return 2; }\\n");\n'
+            'chdir("d1");\n'
+            'import m;\n'
+            'println(m.v());\n'
+            'import m;\n'
+            'println(m.v());\n'
+            'chdir("../d2");\n'
+            'import m;\n'
+            'println(m.v());\n'
+        ),
+        "args": ["--builtin", "io,system"],
+        "use_temp_dir_as_cwd": True,
+        "exit_code": 0,
+        "stdout": (
+            "1\n"
+            "1\n"
+            "2\n"
+        ),
+    },
     {
         "name": "long module name",
         "source": long_module_name_case_source(),
@@ -357,6 +421,125 @@ CASES = [
             "settings.missing:nil\n"
         ),
     },
+    {
+        "name": "integer map keys",
+        "source": (
+            'let m = makemap();\n'
+            'mapset(m, 1, "one");\n'
+            'mapset(m, 2.0, "two");\n'
+            'mapset(m, "2", "string two");\n'
+            'println(mapget(m, 1.0));\n'
+            'println(mapget(m, 2));\n'
+            'println(mapget(m, "2"));\n'
+            'println(maphas(m, 3));\n'
+            'mapdelete(m, 1);\n'
+            'println(mapcount(m));\n'
+        ),
+        "args": ["--builtins"],
+        "exit_code": 0,
+        "stdout": (
+            "one\n"
+            "two\n"
+            "string two\n"
+            "false\n"
+            "2\n"
+        ),
+    },
+    {
+        "name": "non-integral map key error",
+        "source": 'let m = makemap();\nmapset(m, 1.5, "x");\n',
+        "args": ["--builtins"],
+        "exit_code": 70,
+        "stderr_contains": [
+            "map keys must be strings, symbols, or integers",
+        ],
+    },
+    {
+        "name": "file handles",
+        "source": (
+            'let f = fopen("lines.txt", "w");\n'
+            'fwrite(f, "alpha\\nbeta\\n");\n'
+            'fwrite(f, tobytes("gamma"));\n'
+            'fclose(f);\n'
+            'let g = fopen("lines.txt");\n'
+            'let line = freadline(g);\n'
+            'while (line != nil) { println(line); line = freadline(g); }\n'
+            'fclose(g);\n'
+            'let h = fopen("lines.txt");\n'
+            'println(byteslen(freadbytes(h, 6)));\n'
+            'fclose(h);\n'
+            'println(fopen("missing_subdir/nope.txt"));\n'
+        ),
+        "args": ["--builtins"],
+        "use_temp_dir_as_cwd": True,
+        "exit_code": 0,
+        "stdout": (
+            "alpha\n"
+            "beta\n"
+            "gamma\n"
+            "6\n"
+            "nil\n"
+        ),
+    },
+    {
+        "name": "arrays",
+        "script": ROOT / "scripts" / "test_arrays.fex",
+        "args": ["--builtins"],
+        "exit_code": 0,
+        "stdout": (
+            "--- Array Regression ---\n"
+            "typeof(a):array\n"
+            "isarray(a):true\n"
+            "length(a):3\n"
+            "nth(a, 1):20\n"
+            "nth(a, 9):nil\n"
+            "length after push:4\n"
+            "nth(a, 3):40\n"
+            "nth after setnth:11\n"
+            "toarray length:3\n"
+            "tolist head:1\n"
+            "array json:[1,2,3]\n"
+            "sum:49995000\n"
+        ),
+    },
+    {
+        "name": "sort and binarysearch",
+        "source": (
+            'let xs = [5, 1, 4, 2, 3];\n'
+            'println(sort(xs));\n'
+            'println(nth(xs, 0));\n'
+            'let a = array(3, 1, 2);\n'
+            'sort(a);\n'
+            'println(tojson(a));\n'
+            'println(nth(sort(["pear", "apple", "fig"]), 0));\n'
+            'println(sort([3, 1, 2], fn(x, y) { return y - x; }));\n'
+            'let s = sort([10, 20, 20, 30]);\n'
+            'println(binarysearch(s, 20));\n'
+            'println(binarysearch(s, 25));\n'
+            'println(binarysearch(array(2, 4, 6, 8), 8));\n'
+        ),
+        "args": ["--builtins"],
+        "exit_code": 0,
+        "stdout": (
+            "(1 2 3 4 5)\n"
+            "5\n"
+            "[1,2,3]\n"
+            "apple\n"
+            "(3 2 1)\n"
+            "1\n"
+            "nil\n"
+            "3\n"
+        ),
+    },
+    {
+        "name": "sort rejects mixed types",
+        "source": 'sort([1, "one"]);\n',
+        "args": ["--builtins"],
+        "exit_code": 70,
+        "stderr_contains": [
+            "sort: values are not comparable without a comparator",
+        ],
+    },
     {
         "name": "json and path helpers",
         "script": ROOT / "scripts" / "test_json_path_helpers.fex",
@@ -377,6 +560,75 @@ CASES = [
             "loaded.items.tail.head:2\n"
         ),
     },
+    {
+        "name": "streaming json parse",
+        "source": (
+            'let xs = nil;\n'
+            'let i = 5000;\n'
+            'while (i > 0) { i = i - 1; xs = cons(i, xs); }\n'
+            'let f = fopen("doc.json", "w");\n'
+            'fwrite(f, tojson(xs));\n'
+            'fclose(f);\n'
+            'let g = fopen("doc.json");\n'
+            'let d = freadjson(g);\n'
+            'fclose(g);\n'
+            'println(length(d));\n'
+            'println(nth(d, 0));\n'
+            'println(nth(d, 4999));\n'
+            'let h = fopen("doc2.json", "w");\n'
+            'fwrite(h, "{\\"name\\": \\"f\\\\u00e9x\\", \\"ok\\": true}  ");\n'
+            'fclose(h);\n'
+            'let m = freadjson(fopen("doc2.json"));\n'
+            'println(m.name);\n'
+            'println(m.ok);\n'
+        ),
+        "args": ["--builtins"],
+        "use_temp_dir_as_cwd": True,
+        "exit_code": 0,
+        "stdout": (
+            "5000\n"
+            "0\n"
+            "4999\n"
+            "féx\n"
+            "true\n"
+        ),
+    },
+    {
+        "name": "streaming json write",
+        "source": (
+            'let doc = makemap();\n'
+            'mapset(doc, "name", "fe\\"x\\n\\t\\\\ok");\n'
+            'mapset(doc, "items", [1, 2.5, -3]);\n'
+            'let big = array();\n'
+            'let i = 0;\n'
+            'while (i < 4000) { push(big, "padding-padding-padding"); i = i + 1; }\n'
+            'mapset(doc, "big", big);\n'
+            'let f = fopen("out.json", "w");\n'
+            'let n = fwritejson(f, doc);\n'
+            'fclose(f);\n'
+            'println(n);\n'
+            'let g = fopen("out.json");\n'
+            'let back = freadjson(g);\n'
+            'fclose(g);\n'
+            'println(back.name);\n'
+            'println(nth(back.items, 1));\n'
+            'println(length(back.big));\n'
+            'println(writejson("out2.json", back.items));\n'
+            'println(tojson(readjson("out2.json")));\n'
+        ),
+        "args": ["--builtins"],
+        "use_temp_dir_as_cwd": True,
+        "exit_code": 0,
+        "stdout": (
+            "104051\n"
+            "fe\"x\n"
+            "\t\\ok\n"
+            "2.5\n"
+            "4000\n"
+            "10\n"
+            "[1,2.5,-3]\n"
+        ),
+    },
     {
         "name": "filesystem helpers",
         "source": fs_helpers_case_source(),
@@ -429,8 +681,94 @@ CASES = [
             "slice:#bytes[42 43]\n"
             "loaded eq:true\n"
             "loaded:#bytes[41 42 43]\n"
+            "view len:8\n"
+            "view at:52\n"
+            "view of view:#bytes[36 37 38]\n"
+            "view eq:true\n"
+            "find:4\n"
+            "find str:1\n"
+            "find from:8\n"
+            "find miss:-1\n"
+            "count:5\n"
+            "count seq:2\n"
+            "compare lt:-1\n"
+            "compare eq:0\n"
+            "compare gt:1\n"
+            "fill:#bytes[01 01 ff ff 01 01]\n"
+            "xor roundtrip:true\n"
+            "find in view:4\n"
         ),
     },
+    {
+        "name": "number formatting round trip",
+        "source": (
+            "println(0.1 + 0.2);\n"
+            "println(1 / 3);\n"
+            "println(1.5e2);\n"
+            "println(0 - 123456);\n"
+            "println(tojson([0.1, 1.5, 42]));\n"
+        ),
+        "args": ["--builtin", "data"],
+        "exit_code": 0,
+        "stdout": (
+            "0.30000000000000004\n"
+            "0.3333333333333333\n"
+            "150\n"
+            "-123456\n"
+            "[0.1,1.5,42]\n"
+        ),
+    },
+    {
+        "name": "string builder",
+        "source": (
+            "let sb = sbnew();\n"
+            "let i = 0;\n"
+            "while (i < 4) {\n"
+            '    sbappend(sb, "part", i, ";");\n'
+            "    i = i + 1;\n"
+            "}\n"
+            "println(sbtostring(sb));\n"
+            'sbappend(sb, "end");\n'
+            "println(sbtostring(sb));\n"
+        ),
+        "args": ["--builtin", "string"],
+        "exit_code": 0,
+        "stdout": (
+            "part0;part1;part2;part3;\n"
+            "part0;part1;part2;part3;end\n"
+        ),
+    },
+    {
+        "name": "string builder invalid handle",
+        "source": 'sbappend(42, "x");\n',
+        "args": ["--builtin", "string"],
+        "exit_code": 70,
+        "stderr_contains": [
+            "runtime error: sbappend: expected a string builder",
+        ],
+    },
+    {
+        "name": "string builder release",
+        "source": (
+            "let i = 0;\n"
+            "while (i < 100) {\n"
+            "    let sb = sbnew();\n"
+            '    sbappend(sb, "chunk", i);\n'
+            "    if (i == 0) { println(sbtostring(sb)); }\n"
+            "    sbfree(sb);\n"
+            "    i = i + 1;\n"
+            "}\n"
+            "let sb = sbnew();\n"
+            "sbfree(sb);\n"
+            'sbappend(sb, "late");\n'
+        ),
+        "args": ["--builtin", "string"],
+        "exit_code": 70,
+        "stdout": "chunk0\n",
+        "stderr_contains": [
+            "runtime error: sbappend: string builder is freed",
+        ],
+    },
     {
         "name": "embedded nul c-string rejection",
         "source": 'writefile("bad\\0path.txt", "x");\n',
@@ -560,6 +898,21 @@ CASES = [
             "runtime error: runprocess stdout: file too large",
         ],
     },
+    {
+        "name": "process async streaming",
+        "source": processasync_case_source(),
+        "args": ["--builtin", "system,data,io"],
+        "use_temp_dir_as_cwd": True,
+        "exit_code": 0,
+        "stdout": (
+            "#bytes[66 69 72 73 74]\n"
+            "#bytes[41 42 43]\n"
+            "7\n"
+            "false\n"
+            "#bytes[73 65 63 6f 6e 64]\n"
+            "#bytes[77 61 72 6e]\n"
+        ),
+    },
     {
         "name": "runprocess timeout budget",
         "source": runprocess_timeout_case_source(),
@@ -904,6 +1257,22 @@ CASES = [
         "exit_code": 0,
         "stdout": "12\nnil\n",
     },
+    {
+        "name": "while loop error traceback",
+        "source": (
+            "let i = 0;\n"
+            "while (i < 3) { i = i + 1; let q = 1 / (i - 2); }\n"
+        ),
+        "args": ["--spans"],
+        "exit_code": 70,
+        "stdout": "",
+        "stderr_contains": [
+            "runtime error: division by zero",
+            "=> (/ 1 (- i 2))",
+            "=> (let q (/ 1 (- i 2)))",
+            "=> (while (< i 3)",
+        ],
+    },
 ]
 
 
@@ -1,10 +1,13 @@
 #ifdef _WIN32
 #define _CRT_SECURE_NO_WARNINGS
 #include <direct.h>
+#include <sys/stat.h>
+#include <sys/utime.h>
 #define TEST_PATH_SEP '\\'
 #else
 #include <sys/stat.h>
 #include <unistd.h>
+#include <utime.h>
 #define TEST_PATH_SEP '/'
 #endif
 
@@ -15,6 +18,7 @@
 
 #include "fe.h"
 #include "fex.h"
+#include "fex_span.h"
 
 #define TEST_MEM_SIZE (1024 * 1024)
 #ifndef FEX_TEST_PYTHON_EXECUTABLE
@@ -67,6 +71,8 @@ static int g_test_interrupt_calls = 0;
 
 static char* make_large_read_list_source(size_t item_count);
 static char* make_large_string_literal_source(size_t literal_len);
+static int write_large_test_file(const char *path, size_t size, unsigned char fill_byte);
+static int write_text_file(const char *path, const char *text);
 
 static void read_try_error_handler(fe_Context *ctx, const char *err, fe_Object *cl) {
     (void)ctx;
@@ -291,6 +297,1207 @@ static const char* run_read_interrupt_test(void) {
     return NULL;
 }
 
+static int test_get_mtime(const char *path, time_t *mtime) {
+#ifdef _WIN32
+    struct _stat st;
+    if (_stat(path, &st) != 0) return 0;
+#else
+    struct stat st;
+    if (stat(path, &st) != 0) return 0;
+#endif
+    *mtime = st.st_mtime;
+    return 1;
+}
+
+static int test_set_mtime(const char *path, time_t mtime) {
+#ifdef _WIN32
+    struct _utimbuf times;
+    times.actime = mtime;
+    times.modtime = mtime;
+    return _utime(path, &times) == 0;
+#else
+    struct utimbuf times;
+    times.actime = mtime;
+    times.modtime = mtime;
+    return utime(path, &times) == 0;
+#endif
+}
+
+static const char* run_module_cache_test(void) {
+    static const char *source_path = "tmp_cache_mod.fex";
+    static const char *cache_path = "tmp_cache_mod.fexc";
+    void *cache_memory = malloc(TEST_MEM_SIZE);
+    fe_Context *cache_ctx;
+    fe_Object *result = NULL;
+    FexError error;
+    FexStatus status;
+    const char *failure = NULL;
+    time_t source_mtime = 0;
+    FILE *probe;
+
+    if (!cache_memory) {
+        return "failed to allocate module cache test memory";
+    }
+    cache_ctx = fe_open(cache_memory, TEST_MEM_SIZE);
+    if (!cache_ctx) {
+        free(cache_memory);
+        return "failed to open module cache test context";
+    }
+    fex_init(cache_ctx);
+
+    remove(cache_path);
+    if (!write_text_file(source_path, "let answer = 40 + 2;\nanswer;\n")) {
+        fe_close(cache_ctx);
+        free(cache_memory);
+        return "failed to write module cache test source";
+    }
+
+    if (!fex_get_module_cache(cache_ctx)) {
+        failure = "expected the module cache to be enabled by default";
+        goto done;
+    }
+
+    status = fex_try_compile_file(cache_ctx, source_path, &error);
+    if (status != FEX_STATUS_OK) {
+        failure = "expected fex_try_compile_file to succeed";
+        goto done;
+    }
+    probe = fopen(cache_path, "rb");
+    if (!probe) {
+        failure = "expected fex_try_compile_file to create the cache file";
+        goto done;
+    }
+    fclose(probe);
+
+    /* Rewrite the source with the same byte count and put its mtime back,
+       so the cache still validates: the run must see the cached 42, not
+       the new 43, proving the compiled form was loaded from disk. */
+    if (!test_get_mtime(source_path, &source_mtime) ||
+        !write_text_file(source_path, "let answer = 40 + 3;\nanswer;\n") ||
+        !test_set_mtime(source_path, source_mtime)) {
+        failure = "failed to stage the stale-source fixture";
+        goto done;
+    }
+
+    status = fex_try_do_file(cache_ctx, source_path, &result, &error);
+    if (status != FEX_STATUS_OK || !result ||
+        fe_tonumber(cache_ctx, result) != 42) {
+        failure = "expected a valid cache to shadow the rewritten source";
+        goto done;
+    }
+
+    fex_set_module_cache(cache_ctx, 0);
+    status = fex_try_do_file(cache_ctx, source_path, &result, &error);
+    if (status != FEX_STATUS_OK || !result ||
+        fe_tonumber(cache_ctx, result) != 43) {
+        failure = "expected fex_set_module_cache(0) to force recompilation";
+        goto done;
+    }
+    fex_set_module_cache(cache_ctx, 1);
+
+    /* Changing the source size must invalidate the cache. */
+    if (!write_text_file(source_path, "let answer = 40 + 3 + 1;\nanswer;\n")) {
+        failure = "failed to rewrite module cache test source";
+        goto done;
+    }
+    status = fex_try_do_file(cache_ctx, source_path, &result, &error);
+    if (status != FEX_STATUS_OK || !result ||
+        fe_tonumber(cache_ctx, result) != 44) {
+        failure = "expected a stale cache to fall back to the source";
+        goto done;
+    }
+
+    /* A truncated cache must also fall back instead of failing. */
+    status = fex_try_compile_file(cache_ctx, source_path, &error);
+    if (status != FEX_STATUS_OK) {
+        failure = "expected recompiling the module cache to succeed";
+        goto done;
+    }
+    if (!write_large_test_file(cache_path, 40, 0x5A)) {
+        failure = "failed to corrupt the cache file";
+        goto done;
+    }
+    status = fex_try_do_file(cache_ctx, source_path, &result, &error);
+    if (status != FEX_STATUS_OK || !result ||
+        fe_tonumber(cache_ctx, result) != 44) {
+        failure = "expected a corrupt cache to fall back to the source";
+        goto done;
+    }
+
+done:
+    remove(source_path);
+    remove(cache_path);
+    fe_close(cache_ctx);
+    free(cache_memory);
+    return failure;
+}
+
+static const char* run_clone_test(void) {
+    size_t region_size = 1024 * 1024;
+    void *template_memory = malloc(region_size);
+    void *clone_memory = malloc(region_size);
+    fe_Context *template_ctx;
+    fe_Context *clone_ctx;
+    fe_Object *result;
+    FexError error;
+    FexStatus status;
+    /* One statement per evaluation: top-level lets inside a multi-statement
+       program can compile as frame locals, and the template needs each
+       definition bound as a persistent global. */
+    const char *prelude[] = {
+        "let base = 10;",
+        "let cfg = makemap(\"name\", \"template\", \"id\", 7);",
+        "let arr = toarray([1, 2, 3]);",
+        "let scale = fn (n) { return n * base; };",
+    };
+    size_t i;
+
+    if (!template_memory || !clone_memory) {
+        free(template_memory);
+        free(clone_memory);
+        return "failed to allocate clone test pools";
+    }
+    template_ctx = fe_open(template_memory, region_size);
+    if (!template_ctx) {
+        free(template_memory);
+        free(clone_memory);
+        return "failed to open clone template context";
+    }
+    fex_init_with_config(template_ctx, FEX_CONFIG_ENABLE_EXTENDED_BUILTINS);
+    for (i = 0; i < sizeof(prelude) / sizeof(prelude[0]); i++) {
+        status = fex_try_do_string(template_ctx, prelude[i], &result, &error);
+        if (status != FEX_STATUS_OK) {
+            fe_close(template_ctx);
+            free(template_memory);
+            free(clone_memory);
+            return "failed to evaluate clone template prelude";
+        }
+    }
+
+    clone_ctx = fe_clone(template_ctx, clone_memory, region_size);
+    if (!clone_ctx) {
+        fe_close(template_ctx);
+        free(template_memory);
+        free(clone_memory);
+        return "expected fe_clone to succeed on a quiescent template";
+    }
+
+    /* The clone sees the template's globals, closures, maps, and arrays. */
+    status = fex_try_do_string(clone_ctx,
+        "scale(4) + mapget(cfg, \"id\") + nth(arr, 2);\n", &result, &error);
+    if (status != FEX_STATUS_OK || !FE_IS_FIXNUM(result) ||
+        FE_UNBOX_FIXNUM(result) != 50) {
+        fe_close(clone_ctx);
+        fe_close(template_ctx);
+        free(template_memory);
+        free(clone_memory);
+        return "expected the clone to evaluate against the template image";
+    }
+
+    /* Mutations in the clone must not leak back into the template. */
+    status = fex_try_do_string(clone_ctx, "base = 100;\n", &result, &error);
+    if (status != FEX_STATUS_OK) {
+        fe_close(clone_ctx);
+        fe_close(template_ctx);
+        free(template_memory);
+        free(clone_memory);
+        return "failed to mutate a clone global";
+    }
+    status = fex_try_do_string(template_ctx, "scale(1);\n", &result, &error);
+    if (status != FEX_STATUS_OK || !FE_IS_FIXNUM(result) ||
+        FE_UNBOX_FIXNUM(result) != 10) {
+        fe_close(clone_ctx);
+        fe_close(template_ctx);
+        free(template_memory);
+        free(clone_memory);
+        return "expected the template to be isolated from clone mutations";
+    }
+
+    /* The clone must stay usable after the template is gone. */
+    fe_close(template_ctx);
+    free(template_memory);
+    status = fex_try_do_string(clone_ctx,
+        "scale(1) + strlen(mapget(cfg, \"name\"));\n", &result, &error);
+    if (status != FEX_STATUS_OK || !FE_IS_FIXNUM(result) ||
+        FE_UNBOX_FIXNUM(result) != 108) {
+        fe_close(clone_ctx);
+        free(clone_memory);
+        return "expected the clone to outlive its template";
+    }
+
+    fe_close(clone_ctx);
+    free(clone_memory);
+    return NULL;
+}
+
+static const char* run_profiler_test(void) {
+    size_t region_size = 1024 * 1024;
+    void *profile_memory = malloc(region_size);
+    fe_Context *profile_ctx;
+    fe_Object *result;
+    FexError error;
+    FexStatus status;
+    FILE *report;
+    char report_text[4096];
+    size_t report_len;
+    const char *source =
+        "let descend = fn (n) {\n"
+        "    if (n == 0) { return 0; }\n"
+        "    return descend(n - 1) + 1;\n"
+        "};\n"
+        "descend(10) + descend(10);\n";
+
+    if (!profile_memory) {
+        return "failed to allocate profiler context";
+    }
+    profile_ctx = fe_open(profile_memory, region_size);
+    if (!profile_ctx) {
+        free(profile_memory);
+        return "failed to open profiler context";
+    }
+    fex_init(profile_ctx);
+
+    fe_profile_start(profile_ctx);
+    status = fex_try_do_string(profile_ctx, source, &result, &error);
+    fe_profile_stop(profile_ctx);
+    if (status != FEX_STATUS_OK || !FE_IS_FIXNUM(result) ||
+        FE_UNBOX_FIXNUM(result) != 20) {
+        fe_close(profile_ctx);
+        free(profile_memory);
+        return "expected profiled script to produce its normal result";
+    }
+
+    report = tmpfile();
+    if (!report) {
+        fe_close(profile_ctx);
+        free(profile_memory);
+        return "failed to open profiler report stream";
+    }
+    fe_profile_report(profile_ctx, report);
+    rewind(report);
+    report_len = fread(report_text, 1, sizeof(report_text) - 1, report);
+    report_text[report_len] = '\0';
+    fclose(report);
+
+    if (strstr(report_text, "descend") == NULL) {
+        fe_close(profile_ctx);
+        free(profile_memory);
+        return "expected the profile report to name the profiled function";
+    }
+    /* 2 top-level calls, each 11 invocations deep. */
+    if (strstr(report_text, "22") == NULL) {
+        fe_close(profile_ctx);
+        free(profile_memory);
+        return "expected the profile report to count 22 calls";
+    }
+
+    /* Anonymous callees key their row on the call-form pair. With the
+       compile cache off, that pair is garbage once the script finishes;
+       the collector must still treat it as a profiler root so the row's
+       span label survives until the report. */
+    fex_set_compile_cache(profile_ctx, 0);
+    fex_span_set_enabled(profile_ctx, 1);
+    fe_profile_start(profile_ctx);
+    status = fex_try_do_string(profile_ctx, "(fn (n) { return n + 1; })(41);",
+                               &result, &error);
+    fe_profile_stop(profile_ctx);
+    if (status != FEX_STATUS_OK || !FE_IS_FIXNUM(result) ||
+        FE_UNBOX_FIXNUM(result) != 42) {
+        fe_close(profile_ctx);
+        free(profile_memory);
+        return "expected anonymous profiled script to produce its result";
+    }
+    fe_gc(profile_ctx);
+
+    report = tmpfile();
+    if (!report) {
+        fe_close(profile_ctx);
+        free(profile_memory);
+        return "failed to open second profiler report stream";
+    }
+    fe_profile_report(profile_ctx, report);
+    rewind(report);
+    report_len = fread(report_text, 1, sizeof(report_text) - 1, report);
+    report_text[report_len] = '\0';
+    fclose(report);
+
+    if (strstr(report_text, "<fn@") == NULL) {
+        fe_close(profile_ctx);
+        free(profile_memory);
+        return "expected the anonymous row to keep its span label across gc";
+    }
+
+    fe_close(profile_ctx);
+    free(profile_memory);
+    return NULL;
+}
+
+static const char* run_resumable_eval_test(void) {
+    size_t region_size = 1024 * 1024;
+    void *memory = malloc(region_size);
+    fe_Context *ctx;
+    fe_Object *program = NULL;
+    fe_Object *result = NULL;
+    fe_Object *value;
+    FexError error;
+    FexStatus status;
+    const char *failure = NULL;
+    int suspensions = 0;
+
+    if (!memory) {
+        return "failed to allocate resumable eval context";
+    }
+    ctx = fe_open(memory, region_size);
+    if (!ctx) {
+        free(memory);
+        return "failed to open resumable eval context";
+    }
+    fex_init(ctx);
+
+    /* Assignments to fresh names bind globals, so progress is observable
+       between slices. */
+    status = fex_try_compile(ctx,
+        "a = 1; b = a + 1; c = b + 1; c * 10;", NULL, &program, &error);
+    if (status != FEX_STATUS_OK || !program) {
+        failure = "expected the resumable eval program to compile";
+        goto done;
+    }
+
+    fe_eval_begin(ctx, program);
+    /* A one-step quota forces a suspension after every top-level form. */
+    while (fe_eval_resume(ctx, 1, &result) == 1) {
+        suspensions++;
+        if (suspensions == 1) {
+            value = fe_eval(ctx, fe_symbol(ctx, "a"));
+            if (!FE_IS_FIXNUM(value) || FE_UNBOX_FIXNUM(value) != 1) {
+                failure = "expected the first slice to have bound a";
+                goto done;
+            }
+        }
+        if (suspensions > 16) {
+            failure = "expected the resumable eval program to finish";
+            goto done;
+        }
+    }
+    if (suspensions != 3) {
+        failure = "expected one suspension between each pair of forms";
+        goto done;
+    }
+    if (!result || !FE_IS_FIXNUM(result) || FE_UNBOX_FIXNUM(result) != 30) {
+        failure = "expected the resumed program to produce its final value";
+        goto done;
+    }
+    value = fe_eval(ctx, fe_symbol(ctx, "c"));
+    if (!FE_IS_FIXNUM(value) || FE_UNBOX_FIXNUM(value) != 3) {
+        failure = "expected the resumed program to have bound its globals";
+        goto done;
+    }
+
+    /* A zero quota runs the staged program to completion in one slice. */
+    fe_eval_begin(ctx, program);
+    if (fe_eval_resume(ctx, 0, &result) != 0 ||
+        !result || !FE_IS_FIXNUM(result) || FE_UNBOX_FIXNUM(result) != 30) {
+        failure = "expected a zero quota to finish in one slice";
+        goto done;
+    }
+
+    /* Aborting a suspended program must leave the context reusable. */
+    fe_eval_begin(ctx, program);
+    if (fe_eval_resume(ctx, 1, &result) != 1) {
+        failure = "expected the aborted program to suspend first";
+        goto done;
+    }
+    fe_eval_abort(ctx);
+    fe_eval_begin(ctx, program);
+    fe_eval_abort(ctx);
+
+done:
+    fe_close(ctx);
+    free(memory);
+    return failure;
+}
+
+static const char* run_compile_cache_test(void) {
+    size_t region_size = 1024 * 1024;
+    void *memory = malloc(region_size);
+    fe_Context *ctx;
+    fe_Object *result = NULL;
+    FexError error;
+    FexStatus status;
+    fe_Stats stats;
+    const char *failure = NULL;
+    size_t first_run_allocs;
+    size_t cached_run_allocs;
+    size_t used_before_clear;
+    const char *counter_source = "counter = counter + 1; counter;";
+    int i;
+
+    if (!memory) {
+        return "failed to allocate compile cache context";
+    }
+    ctx = fe_open(memory, region_size);
+    if (!ctx) {
+        free(memory);
+        return "failed to open compile cache context";
+    }
+    fex_init(ctx);
+
+    if (fex_get_compile_cache(ctx) != 0) {
+        failure = "expected compile caching to be disabled by default";
+        goto done;
+    }
+
+    fex_set_compile_cache(ctx, 2);
+    status = fex_try_do_string(ctx, "counter = 0;", &result, &error);
+    if (status != FEX_STATUS_OK) {
+        failure = "expected the counter seed to evaluate";
+        goto done;
+    }
+
+    /* A cache hit must still evaluate the snippet: side effects repeat. */
+    first_run_allocs = 0;
+    for (i = 1; i <= 3; i++) {
+        size_t run_start;
+        fe_get_stats(ctx, &stats);
+        run_start = stats.object_allocations_total;
+        status = fex_try_do_string(ctx, counter_source, &result, &error);
+        if (status != FEX_STATUS_OK ||
+            !FE_IS_FIXNUM(result) || FE_UNBOX_FIXNUM(result) != i) {
+            failure = "expected each cached run to re-evaluate the snippet";
+            goto done;
+        }
+        fe_get_stats(ctx, &stats);
+        if (i == 1) {
+            first_run_allocs = stats.object_allocations_total - run_start;
+        } else {
+            cached_run_allocs = stats.object_allocations_total - run_start;
+            /* A hit skips the parse, so it allocates strictly fewer
+               objects than the compiling run did. */
+            if (cached_run_allocs >= first_run_allocs) {
+                failure = "expected a cache hit to skip compilation";
+                goto done;
+            }
+        }
+    }
+
+    /* Cached trees must survive collections triggered by later work. */
+    status = fex_try_do_string(ctx,
+        "let j = 0; let g = nil;\n"
+        "while (j < 5000) { g = cons(j, g); j = j + 1; }\n"
+        "g = nil; j;", &result, &error);
+    if (status != FEX_STATUS_OK) {
+        failure = "expected the garbage churn snippet to evaluate";
+        goto done;
+    }
+    status = fex_try_do_string(ctx, counter_source, &result, &error);
+    if (status != FEX_STATUS_OK ||
+        !FE_IS_FIXNUM(result) || FE_UNBOX_FIXNUM(result) != 4) {
+        failure = "expected the cached tree to survive garbage collection";
+        goto done;
+    }
+
+    /* Three distinct snippets against a bound of two force an eviction;
+       everything must still evaluate correctly afterwards. */
+    status = fex_try_do_string(ctx, "evicted = 1;", &result, &error);
+    if (status == FEX_STATUS_OK) {
+        status = fex_try_do_string(ctx, counter_source, &result, &error);
+    }
+    if (status != FEX_STATUS_OK ||
+        !FE_IS_FIXNUM(result) || FE_UNBOX_FIXNUM(result) != 5) {
+        failure = "expected eviction to leave the cache usable";
+        goto done;
+    }
+
+    /* Flushing returns the entries' tracked memory. */
+    used_before_clear = fe_get_memory_used(ctx);
+    fex_clear_compile_cache(ctx);
+    if (fe_get_memory_used(ctx) >= used_before_clear) {
+        failure = "expected clearing the compile cache to release memory";
+        goto done;
+    }
+
+    /* Disabling leaves evaluation itself untouched. */
+    fex_set_compile_cache(ctx, 0);
+    status = fex_try_do_string(ctx, counter_source, &result, &error);
+    if (status != FEX_STATUS_OK ||
+        !FE_IS_FIXNUM(result) || FE_UNBOX_FIXNUM(result) != 6) {
+        failure = "expected evaluation to work with caching disabled";
+        goto done;
+    }
+
+done:
+    fe_close(ctx);
+    free(memory);
+    return failure;
+}
+
+static const char* run_worker_context_test(void) {
+    void *memory = malloc(TEST_MEM_SIZE);
+    fe_Context *ctx;
+    fe_Object *result = NULL;
+    FexError error;
+    FexStatus status;
+    const char *failure = NULL;
+
+    if (!memory) {
+        return "failed to allocate worker test memory";
+    }
+    ctx = fe_open(memory, TEST_MEM_SIZE);
+    if (!ctx) {
+        free(memory);
+        return "failed to open worker test context";
+    }
+    fex_init_with_builtins(ctx, FEX_CONFIG_NONE, FEX_BUILTINS_ALL);
+
+    /* Round-trip every supported payload type through a worker that echoes
+       its input back, then join for the final value. */
+    status = fex_try_do_string(ctx,
+        "let w = spawn(\"\n"
+        "  let msg = receive();\n"
+        "  while (msg != nil) { send(msg); msg = receive(); }\n"
+        "  send(nil);\n"
+        "  42;\n"
+        "\");\n"
+        "send(w, [1, 2.5, \"text\", true, makemap(\"k\", [3, 4])]);\n"
+        "let echoed = receive(w);\n"
+        "send(w, nil);\n"
+        "let joined = workerjoin(w);\n"
+        "car(echoed) == 1 and nth(echoed, 2) == \"text\"\n"
+        "  and mapget(nth(echoed, 4), \"k\") != nil and joined == 42;\n",
+        &result, &error);
+    if (status != FEX_STATUS_OK || !FE_IS_TRUE(result)) {
+        failure = "expected worker echo round-trip and join result";
+        goto done;
+    }
+
+    /* A worker failure surfaces through workerjoin as a runtime error. */
+    status = fex_try_do_string(ctx,
+        "let w = spawn(\"boom(1);\");\n"
+        "workerjoin(w);\n", &result, &error);
+    if (status != FEX_STATUS_RUNTIME_ERROR) {
+        failure = "expected workerjoin to raise the worker's error";
+        goto done;
+    }
+
+    /* Unserializable values are rejected at the sending side. */
+    status = fex_try_do_string(ctx,
+        "wbad = spawn(\"receive(); nil;\");\n"
+        "send(wbad, fn(x) { x; });\n", &result, &error);
+    if (status != FEX_STATUS_RUNTIME_ERROR ||
+        strstr(error.message, "unsupported value") == NULL) {
+        failure = "expected sending a function to raise an error";
+        goto done;
+    }
+    status = fex_try_do_string(ctx, "send(wbad, nil); workerjoin(wbad);",
+                               &result, &error);
+    if (status != FEX_STATUS_OK) {
+        failure = "expected the rejected-send worker to join cleanly";
+        goto done;
+    }
+
+    /* receive with a timeout returns nil instead of blocking forever. */
+    status = fex_try_do_string(ctx,
+        "let w = spawn(\"receive();\");\n"
+        "let got = receive(w, 20);\n"
+        "send(w, nil);\n"
+        "workerjoin(w);\n"
+        "got == nil;\n", &result, &error);
+    if (status != FEX_STATUS_OK || !FE_IS_TRUE(result)) {
+        failure = "expected a timed-out receive to return nil";
+        goto done;
+    }
+
+done:
+    fe_close(ctx);
+    free(memory);
+    return failure;
+}
+
+static const char* run_span_granularity_test(void) {
+    void *full_memory = malloc(TEST_MEM_SIZE);
+    void *calls_memory = malloc(TEST_MEM_SIZE);
+    fe_Context *full_ctx = NULL;
+    fe_Context *calls_ctx = NULL;
+    const char *failure = NULL;
+    /* Plenty of distinct string literals: full-span mode records one span
+       per literal object on top of the per-pair records, so the calls-only
+       saving is visible through the slab-sized storage granularity. */
+    char *source = NULL;
+    size_t source_cap = 0;
+    size_t source_len = 0;
+    int stmt;
+    size_t full_baseline, calls_baseline, full_delta, calls_delta;
+    size_t full_retained;
+    fe_Object *compiled = NULL;
+    fe_Object *probe = NULL;
+    const FexSpan *span;
+    FexError error;
+    FexStatus status;
+    int gc_save;
+
+    if (!full_memory || !calls_memory) {
+        free(full_memory);
+        free(calls_memory);
+        return "failed to allocate span granularity test memory";
+    }
+    source_cap = 32 + 160 * 32;
+    source = (char*)malloc(source_cap);
+    if (!source) {
+        free(full_memory);
+        free(calls_memory);
+        return "failed to allocate span granularity test source";
+    }
+    source_len = (size_t)snprintf(source, source_cap, "let x = nil;\n");
+    for (stmt = 0; stmt < 160; stmt++) {
+        source_len += (size_t)snprintf(source + source_len,
+                                       source_cap - source_len,
+                                       "x = \"tag-%03d\";\n", stmt);
+    }
+    snprintf(source + source_len, source_cap - source_len, "x;\n");
+    full_ctx = fe_open(full_memory, TEST_MEM_SIZE);
+    calls_ctx = fe_open(calls_memory, TEST_MEM_SIZE);
+    if (!full_ctx || !calls_ctx) {
+        if (full_ctx) fe_close(full_ctx);
+        if (calls_ctx) fe_close(calls_ctx);
+        free(full_memory);
+        free(calls_memory);
+        return "failed to open span granularity test contexts";
+    }
+    fex_init_with_config(full_ctx, FEX_CONFIG_ENABLE_SPANS);
+    fex_init_with_config(calls_ctx, FEX_CONFIG_SPANS_CALLS_ONLY);
+
+    if (!fex_span_is_enabled(calls_ctx) || !fex_span_is_calls_only(calls_ctx)) {
+        failure = "expected FEX_CONFIG_SPANS_CALLS_ONLY to enable calls-only span recording";
+        goto done;
+    }
+    if (fex_span_is_calls_only(full_ctx)) {
+        failure = "expected FEX_CONFIG_ENABLE_SPANS to record spans for every node";
+        goto done;
+    }
+
+    full_baseline = fe_get_memory_used(full_ctx);
+    calls_baseline = fe_get_memory_used(calls_ctx);
+    gc_save = fe_savegc(full_ctx);
+
+    status = fex_try_compile(full_ctx, source, "span-granularity", &compiled, &error);
+    if (status != FEX_STATUS_OK) {
+        failure = "expected full-span compile to succeed";
+        goto done;
+    }
+    status = fex_try_compile(calls_ctx, source, "span-granularity", NULL, &error);
+    if (status != FEX_STATUS_OK) {
+        failure = "expected calls-only compile to succeed";
+        goto done;
+    }
+
+    full_delta = fe_get_memory_used(full_ctx) - full_baseline;
+    calls_delta = fe_get_memory_used(calls_ctx) - calls_baseline;
+    if (calls_delta == 0) {
+        failure = "expected calls-only spans to contribute to tracked memory usage";
+        goto done;
+    }
+    if (calls_delta >= full_delta) {
+        failure = "expected calls-only spans to use less memory than full spans";
+        goto done;
+    }
+
+    span = fex_lookup_span(full_ctx, compiled);
+    if (!span || strcmp(span->source_name, "span-granularity") != 0 ||
+        span->start_line < 1) {
+        failure = "expected a span with the compile's source name on the compiled root";
+        goto done;
+    }
+
+    /* A string literal evaluates to the object the parser created, so its
+       span — excerpt included — is observable through the eval result. */
+    status = fex_try_do_string(full_ctx, "\"span-probe\";\n", &probe, &error);
+    if (status != FEX_STATUS_OK || !probe) {
+        failure = "expected the span probe literal to evaluate";
+        goto done;
+    }
+    span = fex_lookup_span(full_ctx, probe);
+    if (!span || !span->source || !span->start ||
+        span->end <= span->start || span->start < span->source) {
+        failure = "expected literal span excerpts to point into the retained source text";
+        goto done;
+    }
+    if (memcmp(span->start, "\"span-probe\"",
+               (size_t)(span->end - span->start) < 12
+                   ? (size_t)(span->end - span->start) : 12) != 0) {
+        failure = "expected the literal span excerpt to cover the literal text";
+        goto done;
+    }
+
+    /* Dropping the compiled tree must let GC prune the records and return
+       the span storage (slabs, index, retained source) to the allocator. */
+    full_retained = fe_get_memory_used(full_ctx);
+    fe_restoregc(full_ctx, gc_save);
+    status = fex_try_do_string(full_ctx,
+        "let l = nil;\n"
+        "let i = 0;\n"
+        "while (i < 30000) { l = cons(i, l); i = i + 1; }\n"
+        "i;\n", NULL, &error);
+    if (status != FEX_STATUS_OK) {
+        failure = "expected span pruning churn to evaluate";
+        goto done;
+    }
+    if (fe_get_memory_used(full_ctx) >= full_retained) {
+        failure = "expected pruning dead spans to release tracked memory";
+        goto done;
+    }
+
+done:
+    fe_close(full_ctx);
+    fe_close(calls_ctx);
+    free(full_memory);
+    free(calls_memory);
+    free(source);
+    return failure;
+}
+
+static const char* run_growable_arena_test(void) {
+    /* Deliberately tiny region: the list below cannot fit in the fixed
+       arena, so success requires on-demand chunk growth. */
+    size_t region_size = 128 * 1024;
+    void *arena_memory = malloc(region_size);
+    fe_Context *arena_ctx;
+    fe_Object *result;
+    FexError error;
+    FexStatus status;
+    fe_Stats stats;
+    const char *source =
+        "let l = nil;\n"
+        "let i = 0;\n"
+        "while (i < 20000) { l = cons(i, l); i = i + 1; }\n"
+        "i;\n";
+
+    if (!arena_memory) {
+        return "failed to allocate growable arena context";
+    }
+
+    arena_ctx = fe_open(arena_memory, region_size);
+    if (!arena_ctx) {
+        free(arena_memory);
+        return "failed to open growable arena context";
+    }
+
+    fex_init(arena_ctx);
+    fe_get_stats(arena_ctx, &stats);
+
+    status = fex_try_do_string(arena_ctx, source, &result, &error);
+    if (status != FEX_STATUS_RUNTIME_ERROR ||
+        strstr(error.message, "out of memory") == NULL) {
+        fe_close(arena_ctx);
+        free(arena_memory);
+        return "expected fixed arena to run out of memory";
+    }
+
+    fe_set_arena_growable(arena_ctx, 1);
+    if (!fe_get_arena_growable(arena_ctx)) {
+        fe_close(arena_ctx);
+        free(arena_memory);
+        return "expected fe_get_arena_growable to report the enabled mode";
+    }
+    status = fex_try_do_string(arena_ctx, source, &result, &error);
+    if (status != FEX_STATUS_OK || !FE_IS_FIXNUM(result) ||
+        FE_UNBOX_FIXNUM(result) != 20000) {
+        fe_close(arena_ctx);
+        free(arena_memory);
+        return "expected growable arena to absorb the allocation burst";
+    }
+    {
+        size_t base_capacity = stats.object_capacity;
+        fe_get_stats(arena_ctx, &stats);
+        if (stats.object_capacity <= base_capacity) {
+            fe_close(arena_ctx);
+            free(arena_memory);
+            return "expected growable arena to report added object capacity";
+        }
+    }
+
+    /* Growth is still bounded by the tracked memory limit. */
+    fe_set_memory_limit(arena_ctx, fe_get_memory_used(arena_ctx) + 16 * 1024);
+    status = fex_try_do_string(arena_ctx,
+        "let l = nil;\n"
+        "let i = 0;\n"
+        "while (i < 2000000) { l = cons(i, l); i = i + 1; }\n"
+        "i;\n", &result, &error);
+    fe_set_memory_limit(arena_ctx, 0);
+    if (status != FEX_STATUS_RUNTIME_ERROR ||
+        strstr(error.message, "out of memory") == NULL) {
+        fe_close(arena_ctx);
+        free(arena_memory);
+        return "expected memory limit to bound arena growth";
+    }
+
+    fe_close(arena_ctx);
+    free(arena_memory);
+    return NULL;
+}
+
+static const char* run_mapped_source_test(void) {
+    static const char *path = "tmp_mapped_src.fex";
+    enum { MAPPED_PAD_LINES = 6000 };  /* 17 bytes each: ~100 KB of comments */
+    size_t region_size = 1024 * 1024;
+    void *memory = malloc(region_size);
+    char *source;
+    size_t source_len = 0, file_size, used_before, delta;
+    fe_Context *ctx = NULL;
+    fe_Object *result = NULL;
+    const FexSpan *span;
+    FexError error;
+    FexStatus status;
+    FILE *file;
+    const char *failure = NULL;
+    char buf[64];
+    int i;
+
+    if (!memory) {
+        return "failed to allocate mapped source context";
+    }
+    source = malloc((size_t)MAPPED_PAD_LINES * 32 + 256);
+    if (!source) {
+        free(memory);
+        return "failed to allocate mapped source body";
+    }
+
+    /* Mostly comments: the file must clear the mapping size threshold
+       without compiling to a large tree. An odd byte count can never be a
+       page-size multiple, so the mapping path is always taken. */
+    for (i = 0; i < MAPPED_PAD_LINES; i++) {
+        snprintf(buf, sizeof(buf), "// pad line %04d\n", i);
+        memcpy(source + source_len, buf, strlen(buf));
+        source_len += strlen(buf);
+    }
+    memcpy(source + source_len, "\"mapped-probe\";\n", 16);
+    source_len += 16;
+    if (source_len % 2 == 0) {
+        source[source_len++] = '\n';
+    }
+    file_size = source_len;
+
+    file = fopen(path, "wb");
+    if (!file || fwrite(source, 1, source_len, file) != source_len) {
+        if (file) fclose(file);
+        free(source);
+        free(memory);
+        remove(path);
+        return "failed to write mapped source fixture";
+    }
+    fclose(file);
+    free(source);
+
+    ctx = fe_open(memory, region_size);
+    if (!ctx) {
+        free(memory);
+        remove(path);
+        return "failed to open mapped source context";
+    }
+    fex_init_with_config(ctx, FEX_CONFIG_ENABLE_SPANS);
+
+    used_before = fe_get_memory_used(ctx);
+    status = fex_try_do_file(ctx, path, &result, &error);
+    if (status != FEX_STATUS_OK || !result) {
+        failure = "expected the mapped source file to evaluate";
+        goto done;
+    }
+    fe_tostring(ctx, result, buf, sizeof(buf));
+    if (strcmp(buf, "mapped-probe") != 0) {
+        failure = "expected the mapped source to yield its probe literal";
+        goto done;
+    }
+
+    /* Neither the loader nor the span recorder may retain a heap copy of
+       the unit: both point into the mapping. */
+    delta = fe_get_memory_used(ctx) - used_before;
+    if (delta > file_size / 2) {
+        failure = "expected the mapped source to avoid a retained heap copy";
+        goto done;
+    }
+
+    span = fex_lookup_span(ctx, result);
+    if (!span || !span->start || span->end <= span->start ||
+        memcmp(span->start, "\"mapped-probe\"",
+               (size_t)(span->end - span->start) < 14
+                   ? (size_t)(span->end - span->start) : 14) != 0) {
+        failure = "expected the literal span excerpt to point into the mapped source";
+        goto done;
+    }
+
+done:
+    fe_close(ctx);
+    free(memory);
+    remove(path);
+    return failure;
+}
+
+static const char* run_gc_pacing_test(void) {
+    size_t region_size = 1024 * 1024;
+    void *memory = malloc(region_size);
+    fe_Context *ctx;
+    FexError error;
+    FexStatus status;
+    fe_Stats stats;
+    const char *failure = NULL;
+    size_t runs_before, reclaimed_before, default_byte_trigger;
+
+    if (!memory) {
+        return "failed to allocate gc pacing context";
+    }
+    ctx = fe_open(memory, region_size);
+    if (!ctx) {
+        free(memory);
+        return "failed to open gc pacing context";
+    }
+    fex_init(ctx);
+
+    if (fe_get_gc_threshold(ctx) == 0 || fe_get_gc_byte_threshold(ctx) == 0) {
+        failure = "expected default GC triggers to be non-zero";
+        goto done;
+    }
+    default_byte_trigger = fe_get_gc_byte_threshold(ctx);
+
+    /* A pinned allocation trigger must survive the post-collection
+       recalculation and collect far more eagerly than the default. */
+    fe_set_gc_threshold(ctx, 512);
+    fe_get_stats(ctx, &stats);
+    runs_before = stats.gc_runs;
+    status = fex_try_do_string(ctx,
+        "let l1 = nil;\n"
+        "let i1 = 0;\n"
+        "while (i1 < 4000) { l1 = cons(i1, l1); i1 = i1 + 1; }\n"
+        "i1;\n", NULL, &error);
+    if (status != FEX_STATUS_OK) {
+        failure = "expected the pinned-threshold churn to evaluate";
+        goto done;
+    }
+    if (fe_get_gc_threshold(ctx) != 512) {
+        failure = "expected the pinned allocation trigger to survive collection";
+        goto done;
+    }
+    fe_get_stats(ctx, &stats);
+    if (stats.gc_runs < runs_before + 2) {
+        failure = "expected a pinned 512-alloc trigger to collect eagerly";
+        goto done;
+    }
+    if (stats.gc_reclaimed_total == 0 ||
+        stats.gc_reclaimed_total < stats.gc_reclaimed_last) {
+        failure = "expected reclaimed-object counters to accumulate";
+        goto done;
+    }
+
+    /* fe_gc() runs exactly one collection on demand. */
+    fe_get_stats(ctx, &stats);
+    runs_before = stats.gc_runs;
+    reclaimed_before = stats.gc_reclaimed_total;
+    fe_gc(ctx);
+    fe_get_stats(ctx, &stats);
+    if (stats.gc_runs != runs_before + 1 ||
+        stats.gc_reclaimed_total < reclaimed_before) {
+        failure = "expected fe_gc to run a single collection";
+        goto done;
+    }
+
+    /* Deferring suppresses the threshold trigger for the burst; the first
+       allocation after fe_gc_undefer pays the postponed collection. */
+    fe_gc_defer(ctx);
+    if (!fe_gc_deferred(ctx)) {
+        failure = "expected fe_gc_deferred to report the deferred state";
+        goto done;
+    }
+    fe_get_stats(ctx, &stats);
+    runs_before = stats.gc_runs;
+    status = fex_try_do_string(ctx,
+        "let l2 = nil;\n"
+        "let i2 = 0;\n"
+        "while (i2 < 4000) { l2 = cons(i2, l2); i2 = i2 + 1; }\n"
+        "i2;\n", NULL, &error);
+    if (status != FEX_STATUS_OK) {
+        failure = "expected the deferred churn to evaluate";
+        goto done;
+    }
+    fe_get_stats(ctx, &stats);
+    if (stats.gc_runs != runs_before) {
+        failure = "expected fe_gc_defer to suppress threshold collections";
+        goto done;
+    }
+    fe_gc_undefer(ctx);
+    if (fe_gc_deferred(ctx)) {
+        failure = "expected fe_gc_undefer to clear the deferred state";
+        goto done;
+    }
+    status = fex_try_do_string(ctx, "cons(1, nil);\n", NULL, &error);
+    if (status != FEX_STATUS_OK) {
+        failure = "expected the post-defer allocation to evaluate";
+        goto done;
+    }
+    fe_get_stats(ctx, &stats);
+    if (stats.gc_runs <= runs_before) {
+        failure = "expected collection to resume after fe_gc_undefer";
+        goto done;
+    }
+
+    /* The deferred incremental sweep commits its reclaim count when the
+       cycle completes. */
+    fe_get_stats(ctx, &stats);
+    reclaimed_before = stats.gc_reclaimed_total;
+    fe_set_gc_mode(ctx, FE_GC_INCREMENTAL);
+    status = fex_try_do_string(ctx,
+        "l2 = nil;\n"
+        "let l3 = nil;\n"
+        "let i3 = 0;\n"
+        "while (i3 < 4000) { l3 = cons(i3, l3); i3 = i3 + 1; }\n"
+        "i3;\n", NULL, &error);
+    fe_set_gc_mode(ctx, FE_GC_FULL); /* finishes any deferred sweep */
+    if (status != FEX_STATUS_OK) {
+        failure = "expected the incremental-mode churn to evaluate";
+        goto done;
+    }
+    fe_get_stats(ctx, &stats);
+    if (stats.gc_reclaimed_total <= reclaimed_before) {
+        failure = "expected the incremental sweep to count reclaimed objects";
+        goto done;
+    }
+
+    /* Clearing the pin restores adaptive pacing; clearing the byte trigger
+       restores the fe_open default. */
+    fe_set_gc_threshold(ctx, 0);
+    if (fe_get_gc_threshold(ctx) == 512) {
+        failure = "expected clearing the pin to restore adaptive pacing";
+        goto done;
+    }
+    fe_set_gc_byte_threshold(ctx, 4096);
+    if (fe_get_gc_byte_threshold(ctx) != 4096) {
+        failure = "expected fe_set_gc_byte_threshold to take effect";
+        goto done;
+    }
+    fe_set_gc_byte_threshold(ctx, 0);
+    if (fe_get_gc_byte_threshold(ctx) != default_byte_trigger) {
+        failure = "expected clearing the byte trigger to restore the default";
+        goto done;
+    }
+
+done:
+    fe_close(ctx);
+    free(memory);
+    return failure;
+}
+
+static const char* run_map_growth_test(void) {
+    size_t region_size = 4 * 1024 * 1024;
+    void *memory = malloc(region_size);
+    fe_Context *ctx;
+    const char *failure = NULL;
+    fe_Object *map;
+    fe_Object *keys;
+    int gc_save;
+    int i;
+    int expected = 0;
+    int listed = 0;
+
+    if (!memory) {
+        return "failed to allocate map growth context";
+    }
+    ctx = fe_open(memory, region_size);
+    if (!ctx) {
+        free(memory);
+        return "failed to open map growth context";
+    }
+    fex_init(ctx);
+
+    gc_save = fe_savegc(ctx);
+    map = fe_map(ctx);
+    fe_pushgc(ctx, map);
+
+    /* Grow through several doublings with deletions interleaved so lookups
+       and removals land in both the active table and the draining one. */
+    for (i = 0; i < 5000; i++) {
+        int loop_save = fe_savegc(ctx);
+        if (!fe_map_set(ctx, map, fe_number(ctx, i), fe_number(ctx, i * 2))) {
+            failure = "expected fe_map_set to accept a fixnum key";
+            goto done;
+        }
+        expected++;
+        if (i % 3 == 0 && i > 0) {
+            if (!fe_map_delete(ctx, map, fe_number(ctx, i - 1))) {
+                failure = "expected fe_map_delete to find a recent key";
+                goto done;
+            }
+            expected--;
+        }
+        if (i == 2500) {
+            fe_gc(ctx); /* both tables must be marked while draining */
+        }
+        fe_restoregc(ctx, loop_save);
+    }
+    if (fe_map_count(ctx, map) != expected) {
+        failure = "expected fe_map_count to track interleaved churn";
+        goto done;
+    }
+    for (i = 0; i < 5000; i++) {
+        int loop_save = fe_savegc(ctx);
+        int deleted = i % 3 == 2;
+        int ok;
+        if (deleted) {
+            ok = !fe_map_has(ctx, map, fe_number(ctx, i));
+            fe_restoregc(ctx, loop_save);
+            if (!ok) {
+                failure = "expected deleted keys to stay deleted across growth";
+                goto done;
+            }
+            continue;
+        }
+        ok = fe_tonumber(ctx, fe_map_get(ctx, map, fe_number(ctx, i))) ==
+             (fe_Number)(i * 2);
+        fe_restoregc(ctx, loop_save);
+        if (!ok) {
+            failure = "expected surviving keys to keep their values";
+            goto done;
+        }
+    }
+
+    /* Updates replace in place regardless of which table holds the key. */
+    if (!fe_map_set(ctx, map, fe_number(ctx, 0), fe_number(ctx, -1))) {
+        failure = "expected fe_map_set to update an existing key";
+        goto done;
+    }
+    if (fe_map_count(ctx, map) != expected ||
+        fe_tonumber(ctx, fe_map_get(ctx, map, fe_number(ctx, 0))) != -1) {
+        failure = "expected an update to replace the value without growing";
+        goto done;
+    }
+
+    /* Equal string contents hash and compare equal as keys. */
+    if (!fe_map_set(ctx, map, fe_string(ctx, "grow-probe", 10),
+                    fe_number(ctx, 99))) {
+        failure = "expected fe_map_set to accept a string key";
+        goto done;
+    }
+    if (fe_tonumber(ctx, fe_map_get(ctx, map,
+                    fe_string(ctx, "grow-probe", 10))) != 99) {
+        failure = "expected an equal-content string key to find its value";
+        goto done;
+    }
+    expected++;
+
+    keys = fe_map_keys(ctx, map);
+    fe_pushgc(ctx, keys);
+    while (!fe_isnil(ctx, keys)) {
+        listed++;
+        keys = fe_cdr(ctx, keys);
+    }
+    if (listed != expected) {
+        failure = "expected fe_map_keys to list every live key exactly once";
+        goto done;
+    }
+
+done:
+    fe_restoregc(ctx, gc_save);
+    fe_close(ctx);
+    free(memory);
+    return failure;
+}
+
 static const char* run_direct_large_literal_limit_test(fe_Context *span_ctx) {
     char *large_literal_source = make_large_string_literal_source(4096);
     size_t baseline_used = fe_get_memory_used(span_ctx);
@@ -695,7 +1902,9 @@ int main(void) {
         int compiled_gc_depth;
         int i;
 
-        status = fex_try_compile(ctx, "40 + 2;", "try-compile-root", &compiled, &error);
+        /* The call keeps the program a heap AST: all-constant arithmetic
+           folds to an immediate at compile time and needs no GC root. */
+        status = fex_try_compile(ctx, "[40, 2].first + 2;", "try-compile-root", &compiled, &error);
         if (status != FEX_STATUS_OK) {
             fe_close(ctx);
             free(memory);
@@ -1269,7 +2478,8 @@ int main(void) {
         size_t baseline_used = fe_get_memory_used(span_ctx);
         fe_Object *compiled = NULL;
         FexError span_error;
-        FexStatus span_status = fex_try_compile(span_ctx, "1 + 2;\n", "span-usage", &compiled, &span_error);
+        /* A symbol operand keeps the node from constant-folding away. */
+        FexStatus span_status = fex_try_compile(span_ctx, "x + 2;\n", "span-usage", &compiled, &span_error);
 
         if (span_status != FEX_STATUS_OK) {
             fe_close(span_ctx);
@@ -1398,6 +2608,94 @@ int main(void) {
             return fail(mapkeys_error);
         }
     }
+    {
+        const char *arena_error = run_growable_arena_test();
+        if (arena_error != NULL) {
+            fe_close(ctx);
+            free(memory);
+            return fail(arena_error);
+        }
+    }
+    {
+        const char *mapped_error = run_mapped_source_test();
+        if (mapped_error != NULL) {
+            fe_close(ctx);
+            free(memory);
+            return fail(mapped_error);
+        }
+    }
+    {
+        const char *pacing_error = run_gc_pacing_test();
+        if (pacing_error != NULL) {
+            fe_close(ctx);
+            free(memory);
+            return fail(pacing_error);
+        }
+    }
+    {
+        const char *map_growth_error = run_map_growth_test();
+        if (map_growth_error != NULL) {
+            fe_close(ctx);
+            free(memory);
+            return fail(map_growth_error);
+        }
+    }
+    {
+        const char *granularity_error = run_span_granularity_test();
+        if (granularity_error != NULL) {
+            fe_close(ctx);
+            free(memory);
+            return fail(granularity_error);
+        }
+    }
+    {
+        const char *worker_error = run_worker_context_test();
+        if (worker_error != NULL) {
+            fe_close(ctx);
+            free(memory);
+            return fail(worker_error);
+        }
+    }
+    {
+        const char *cache_error = run_module_cache_test();
+        if (cache_error != NULL) {
+            fe_close(ctx);
+            free(memory);
+            return fail(cache_error);
+        }
+    }
+    {
+        const char *clone_error = run_clone_test();
+        if (clone_error != NULL) {
+            fe_close(ctx);
+            free(memory);
+            return fail(clone_error);
+        }
+    }
+    {
+        const char *profiler_error = run_profiler_test();
+        if (profiler_error != NULL) {
+            fe_close(ctx);
+            free(memory);
+            return fail(profiler_error);
+        }
+    }
+    {
+        const char *resume_error = run_resumable_eval_test();
+        if (resume_error != NULL) {
+            fe_close(ctx);
+            free(memory);
+            return fail(resume_error);
+        }
+    }
+    {
+        const char *cache_error = run_compile_cache_test();
+        if (cache_error != NULL) {
+            fe_close(ctx);
+            free(memory);
+            return fail(cache_error);
+        }
+    }
     {
         const char *symbol_error = run_symbol_interrupt_test(ctx);
         if (symbol_error != NULL) {